@@ -65,7 +65,6 @@ local img_panel = 1        -- which panel (1 or 2) was active when opening image
 local mp3_player      = nil
 local mp3_name        = ""
 local mp3_vol         = 80    -- default 80% (scale 0-100)
-local mp3_sample_rate = 44100 -- updated after load; used to convert samples→seconds
 
 -- Video player
 local vid_player = nil
@@ -347,6 +346,7 @@ end
 
 -- ── Drawing: MP3 player ───────────────────────────────────────────────────────
 local function fmt_time(s)
+  s = math.floor(s)
   return string.format("%d:%02d", s // 60, s % 60)
 end
 
@@ -362,12 +362,12 @@ local function draw_mp3_view()
 
   -- Status
   local playing  = mp3_player and mp3_player:isPlaying()
-  local pos_samp = mp3_player and mp3_player:getPosition() or 0
-  local pos_sec  = pos_samp // mp3_sample_rate
+  local pos_sec  = mp3_player and mp3_player:getPosition() or 0
+  local len_sec  = mp3_player and mp3_player:getLength() or 0
   local st_str, st_col
   if playing then
     st_str, st_col = "PLAYING",  GREEN
-  elseif pos_samp > 0 and not playing then
+  elseif pos_sec > 0 and not playing then
     st_str, st_col = "PAUSED",   YELLOW
   else
     st_str, st_col = "STOPPED",  GRAY
@@ -375,8 +375,9 @@ local function draw_mp3_view()
   local sx = math.max(0, (SW - #st_str * CHAR_W) // 2)
   disp.drawText(sx, 48, st_str, st_col, BG)
 
-  -- Time (elapsed only; getLength() always returns 0 so no end time)
+  -- Time
   local t_str = fmt_time(pos_sec)
+  if len_sec > 0 then t_str = t_str .. " / " .. fmt_time(len_sec) end
   local tx = math.max(0, (SW - #t_str * CHAR_W) // 2)
   disp.drawText(tx, 72, t_str, WHITE, BG)
 
@@ -703,8 +704,6 @@ local function open_mp3_view(path, fname)
     set_status("Cannot play: " .. (err or fname))
     return
   end
-  local sr = p:getSampleRate()
-  mp3_sample_rate = (sr and sr > 0) and sr or 44100
   p:setVolume(mp3_vol)
   p:play(1)           -- play once (no loop)
   mp3_player = p
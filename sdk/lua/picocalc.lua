@@ -33,6 +33,9 @@ APP_REQUIREMENTS = {}
 -- picocalc  (top-level namespace)
 -- =============================================================================
 
+---Sub-modules other than display, input, sys, network and wifi are built the
+---first time they are indexed, so `pairs(picocalc)` only lists the ones
+---already in use.
 ---@class picocalc
 picocalc = {}
 
@@ -113,19 +116,35 @@ function picocalc.display.setScrollArea(top, height, bottom) end
 ---@param offset integer Pixel offset
 function picocalc.display.setScrollOffset(offset) end
 
----Draw a text string. Background defaults to BLACK if omitted.
+---Draw a text string. Background defaults to BLACK if omitted; pass `false`
+---to draw only the foreground pixels over whatever is already there.
 ---Returns the pixel width of the rendered text.
 ---@param x integer
 ---@param y integer
 ---@param text string
 ---@param fg integer RGB565 foreground colour
----@param bg? integer RGB565 background colour
+---@param bg? integer|false RGB565 background colour, or false for transparent
 ---@return integer width Pixel width of the drawn text
 function picocalc.display.drawText(x, y, text, fg, bg) end
 
 ---Flush the framebuffer to the LCD (non-blocking DMA). Call once per frame.
 function picocalc.display.flush() end
 
+---Flush only the dirty rects queued by the sprite compositor (or
+---`sprite.addDirtyRect`). Use instead of `flush()` when a background
+---drawing callback is set. Does nothing if no rect is queued.
+function picocalc.display.flushDirty() end
+
+---Restrict drawing (primitives, text, images) to a rectangle.
+---@param x integer
+---@param y integer
+---@param w integer
+---@param h integer
+function picocalc.display.setClipRect(x, y, w, h) end
+
+---Remove the clip rectangle set by `setClipRect`.
+function picocalc.display.clearClipRect() end
+
 ---Returns the display width in pixels (320).
 ---@return integer
 function picocalc.display.getWidth() end
@@ -263,8 +282,10 @@ function picocalc.sys.getPowerStatus() end
 ---@return { synced: boolean, hour: integer, min: integer, sec: integer, epoch: integer }
 function picocalc.sys.getClock() end
 
----Return a snapshot of heap usage.
----@return { psram_free: integer, psram_used: integer, psram_total: integer, sram_free: integer, sram_used: integer }
+---Return a snapshot of heap usage. `slab` has one entry per small-object
+---size class (Lua allocations up to 256 bytes): object size, chunks carved,
+---live and free objects, and total allocations.
+---@return { psram_free: integer, psram_used: integer, psram_total: integer, sram_free: integer, sram_used: integer, slab: { size: integer, chunks: integer, used: integer, free: integer, allocs: integer }[] }
 function picocalc.sys.getMemInfo() end
 
 ---Return the OS firmware version string.
@@ -426,6 +447,46 @@ function picocalc.fs.diskInfo() end
 ---@return PicOSDirEntry[]
 function picocalc.fs.glob(path, pattern) end
 
+---Read a file in the background: Core 1 does the I/O while the app keeps
+---running, and `callback` fires from the system hook once the data is in.
+---Requests complete in the order they were made; up to 8 can be pending.
+---@param path string
+---@param callback fun(data: string?, err: string?)
+---@param offset? integer Byte offset to start at (default 0)
+---@param len? integer Bytes to read (default: to the end of the file)
+---@return integer? id Request id for `cancelAsync`, `nil` on error
+---@return string? error
+function picocalc.fs.readAsync(path, callback, offset, len) end
+
+---Write (or with `append`, extend) a file in the background.  `data` is
+---copied, so the string may be discarded straight away.
+---@param path string
+---@param data string
+---@param callback? fun(ok: boolean, err: string?)
+---@param append? boolean
+---@return integer? id
+---@return string? error
+function picocalc.fs.writeAsync(path, data, callback, append) end
+
+---Background `stat`.
+---@param path string
+---@param callback fun(info: PicOSStatResult?, err: string?)
+---@return integer? id
+---@return string? error
+function picocalc.fs.statAsync(path, callback) end
+
+---Background `listDir`.
+---@param path string
+---@param callback fun(entries: PicOSDirEntry[])
+---@return integer? id
+---@return string? error
+function picocalc.fs.listDirAsync(path, callback) end
+
+---Drop a pending request; its callback will not fire.
+---@param id integer
+---@return boolean cancelled `false` if it had already completed
+function picocalc.fs.cancelAsync(id) end
+
 -- =============================================================================
 -- picocalc.config  (system-wide, /system/config.json)
 -- =============================================================================
@@ -530,7 +591,9 @@ function picocalc.sound.resetTime() end
 ---@return integer
 function picocalc.sound.playingSources() end
 
----Create a Sample, optionally loading a WAV file immediately.
+---Create a Sample, optionally loading a WAV file immediately. 8/16-bit PCM
+---and 4-bit IMA ADPCM WAVs are accepted; ADPCM stays compressed in memory
+---and is decoded while mixing.
 ---@param path_or_duration? string|number WAV file path, or duration in seconds for an empty sample
 ---@return PicOSSample
 function picocalc.sound.sample(path_or_duration) end
@@ -541,11 +604,12 @@ function picocalc.sound.sample(path_or_duration) end
 function picocalc.sound.sampleplayer(sample_or_path) end
 
 ---Create a FilePlayer for streaming WAV files from the SD card.
----@param buffer_size? integer Internal streaming buffer size in bytes
+---@param buffer_size? integer Read-ahead buffer in bytes (default 32768; see setBufferSize)
 ---@return PicOSFilePlayer
 function picocalc.sound.fileplayer(buffer_size) end
 
 ---Create an MP3Player for streaming MP3 files from the SD card.
+---Each player decodes independently; up to 4 exist at once (nil after that).
 ---@return PicOSMp3Player
 function picocalc.sound.mp3player() end
 
@@ -565,12 +629,14 @@ function PicOSSample:getLength() end
 ---@return integer
 function PicOSSample:getSampleRate() end
 
----Return format metadata.
----@return { bits: integer, channels: integer, sampleRate: integer }
+---Return format metadata. `bits` is the decoded width (16 for ADPCM).
+---@return { bits: integer, channels: integer, sampleRate: integer, compressed: boolean }
 function PicOSSample:getFormat() end
 
----Decompress the sample (if compressed). Returns `self` for chaining.
----@return PicOSSample
+---Return a 16-bit PCM copy of an ADPCM sample (four times the memory, less
+---mixing time). PCM samples return `self`.
+---@return PicOSSample?
+---@return string? error
 function PicOSSample:decompress() end
 
 ---Return a new Sample containing the sub-range `[start, end]` (sample frames).
@@ -639,6 +705,25 @@ function PicOSSamplePlayer:setRate(rate) end
 ---@return number
 function PicOSSamplePlayer:getRate() end
 
+---Set the voice-stealing priority (0–255, default 0). When every voice is
+---busy, `play()` cuts the lowest-priority, oldest player that does not
+---outrank this one.
+---@param priority integer
+function PicOSSamplePlayer:setPriority(priority) end
+
+---Return the voice-stealing priority.
+---@return integer
+function PicOSSamplePlayer:getPriority() end
+
+---Blend neighbouring frames when resampling (smoother at rates other than
+---1.0, slightly more CPU). Off by default.
+---@param on boolean
+function PicOSSamplePlayer:setInterpolation(on) end
+
+---Return whether linear interpolation is enabled.
+---@return boolean
+function PicOSSamplePlayer:getInterpolation() end
+
 -- ── PicOSFilePlayer methods ──────────────────────────────────────────────────
 
 ---Open a WAV file for streaming.
@@ -702,6 +787,24 @@ function PicOSFilePlayer:setFinishCallback(fn) end
 ---@param flag boolean
 function PicOSFilePlayer:setStopOnUnderrun(flag) end
 
+---Set the read-ahead buffer size in bytes, applied on the next play().
+---Rounded up to a power of two between 8 KB and 512 KB. A bigger buffer
+---rides out longer SD card stalls (e.g. an app loading files) at the cost of
+---Lua heap.
+---@param bytes integer
+function PicOSFilePlayer:setBufferSize(bytes) end
+
+---@class PicOSFilePlayerStats
+---@field bufferSize integer Read-ahead buffer in bytes
+---@field buffered integer Bytes currently queued
+---@field lowWater integer Fewest bytes queued since play()
+---@field underruns integer Mixer blocks that ran out of data since play()
+---@field sdBusy integer Refills skipped because the SD card was in use
+
+---Return streaming statistics for tuning the buffer size.
+---@return PicOSFilePlayerStats
+function PicOSFilePlayer:getStats() end
+
 -- ── PicOSMp3Player methods ───────────────────────────────────────────────────
 
 ---Open an MP3 file for streaming.
@@ -730,10 +833,24 @@ function PicOSMp3Player:isPlaying() end
 ---@return number
 function PicOSMp3Player:getPosition() end
 
----Return total duration in seconds.
+---Return total duration in seconds. Exact for files with a Xing/VBRI header
+---or once the seek index is built (cached in /system/cache/mp3), otherwise
+---estimated from the bitrate.
 ---@return number
 function PicOSMp3Player:getLength() end
 
+---Seek to `seconds`. Sample-accurate once the file's seek index covers the
+---target; during the first play of a file without a Xing header, playback
+---waits for the background index to get there.
+---@param seconds number
+function PicOSMp3Player:setOffset(seconds) end
+
+---Loop `[start, end)` seconds without a gap (enables looping). `end` 0 or
+---omitted = the end of the track.
+---@param start? number
+---@param end_? number
+function PicOSMp3Player:setLoopRange(start, end_) end
+
 ---Return the sample rate of the MP3 stream in Hz.
 ---@return integer
 function PicOSMp3Player:getSampleRate() end
@@ -750,6 +867,21 @@ function PicOSMp3Player:getVolume() end
 ---@param loop boolean
 function PicOSMp3Player:setLoop(loop) end
 
+---Ramp the level (0–100, applied on top of the volume) over `seconds`.
+---With `stop`, a fade to 0 stops playback when it completes. The level
+---persists: called while stopped or paused, playback starts at it.
+---@param level integer
+---@param seconds number
+---@param stop? boolean
+function PicOSMp3Player:fade(level, seconds, stop) end
+
+---Start `next` (already loaded) from silence and fade it in while this
+---player fades out and stops.
+---@param next PicOSMp3Player
+---@param seconds number
+---@return boolean ok
+function PicOSMp3Player:crossfade(next, seconds) end
+
 -- =============================================================================
 -- picocalc.wifi  (low-level WiFi control)
 -- =============================================================================
@@ -1100,22 +1232,35 @@ local PicOSImageStream = {}
 ---@return string? error
 function picocalc.graphics.image.load(path) end
 
----Load a sub-region of an image from the SD card.
+---Load a sub-region of an image from the SD card.  Only the region is kept
+---in memory, so it works on images far larger than `load` can hold.  The
+---region is clipped to the image.
 ---@param path string
 ---@param x integer Source x offset
 ---@param y integer Source y offset
 ---@param w integer Region width
 ---@param h integer Region height
+---@param scale? integer 1, 2, 4 or 8: the result is `w/scale` x `h/scale` (JPEGs shrink during decode)
 ---@return PicOSImage?
-function picocalc.graphics.image.loadRegion(path, x, y, w, h) end
+function picocalc.graphics.image.loadRegion(path, x, y, w, h, scale) end
 
----Load and scale an image from the SD card.
+---Load and scale an image from the SD card.  JPEGs are decoded at 1/2, 1/4
+---or 1/8 size where that still covers the target.
 ---@param path string
 ---@param w integer Target width
----@param h integer Target height
+---@param h? integer Target height (default: keep the aspect ratio)
 ---@return PicOSImage?
 function picocalc.graphics.image.loadScaled(path, w, h) end
 
+---Decode an image file straight onto the screen at (x, y), without loading
+---it into an image first.  Honours the clip rect.
+---@param path string
+---@param x integer
+---@param y integer
+---@param scale? integer 1, 2, 4 or 8
+---@return boolean ok
+function picocalc.graphics.image.drawFile(path, x, y, scale) end
+
 ---Load an image from a Lua string (in-memory buffer).
 ---@param data string Raw encoded image bytes
 ---@param format? string `"bmp"`, `"jpeg"`, `"png"`, `"gif"`
@@ -1139,11 +1284,13 @@ function picocalc.graphics.image.new(width, height) end
 ---@return { width: integer, height: integer, format: string }?
 function picocalc.graphics.image.getInfo(path) end
 
----Create a streaming tile decoder for large images.
+---Create a streaming tile decoder for large images.  Tiles come left to
+---right, top to bottom.  JPEG and PNG rows are decoded in bands of up to
+---512 KB, each band costing one pass over the file, so prefer wide tiles.
 ---@param path string
----@param tile_w? integer
----@param tile_h? integer
----@return PicOSImageStream?
+---@param tile_w? integer Default: the image width
+---@param tile_h? integer Default: 16 (one JPEG MCU row)
+---@return PicOSImageStream
 function picocalc.graphics.image.newStream(path, tile_w, tile_h) end
 
 ---Set a placeholder image shown while an async load is pending.
@@ -1209,6 +1356,13 @@ function PicOSImage:setTransparentColor(color) end
 ---@return integer?
 function PicOSImage:getTransparentColor() end
 
+---Pre-encode the image as runs of opaque pixels for its current transparent
+---colour (or the global one), so keyed draws copy runs instead of testing
+---every pixel. Costs extra PSRAM roughly the size of the opaque pixels.
+---Sprites do this automatically in setImage/setSourceRect.
+---@return boolean ok false if there is no transparent colour or no memory
+function PicOSImage:optimize() end
+
 ---@param location string `"psram"` or `"sram"`
 function PicOSImage:setStorageLocation(location) end
 
@@ -1218,8 +1372,11 @@ function PicOSImage:getMetadata() end
 
 -- PicOSImageStream methods
 
----Decode and return the next tile. Returns `nil` when complete.
----@return PicOSImage?
+---Decode and return the next tile and its position in the image. Returns
+---`nil` when complete.
+---@return PicOSImage? tile
+---@return integer? x
+---@return integer? y
 function PicOSImageStream:getNextTile() end
 
 ---Return `true` when all tiles have been decoded.
@@ -1228,21 +1385,37 @@ function PicOSImageStream:isComplete() end
 
 -- ── Image cache ───────────────────────────────────────────────────────────────
 
+---Decoded images are cached by path, so `image.load` of the same file again
+---(scene switches, re-entering a menu) skips the SD read and decode.  Images
+---loaded from one path share their pixels.  Images no longer in use stay
+---cached until the budget or free memory runs short, least recently used
+---first; the cache is emptied when the app exits.
 ---@class picocalc.graphics.cache
 picocalc.graphics.cache = {}
 
----Set the maximum PSRAM memory budget for the image cache.
+---Set the PSRAM budget for images nothing is using (default 2 MB). `0`
+---keeps only images still referenced.
 ---@param bytes integer
 function picocalc.graphics.cache.setMaxMemory(bytes) end
 
----Pin an image in the cache by path so it is not evicted.
+---Load an image into the cache (if needed) and pin it so it is not evicted.
+---Pins nest; each needs a matching `release`.
 ---@param path string
+---@return boolean ok
 function picocalc.graphics.cache.retain(path) end
 
 ---Unpin a previously retained image.
 ---@param path string
+---@return boolean ok `false` if it was not retained
 function picocalc.graphics.cache.release(path) end
 
+---Drop every cached image that is neither in use nor retained.
+function picocalc.graphics.cache.clear() end
+
+---Cache counters since the app started.
+---@return { hits: integer, misses: integer, evictions: integer, entries: integer, bytes: integer, maxBytes: integer }
+function picocalc.graphics.cache.getStats() end
+
 -- ── Sprite ────────────────────────────────────────────────────────────────────
 
 ---@class picocalc.graphics.sprite
@@ -1263,7 +1436,8 @@ function picocalc.graphics.sprite.addSprite(sprite) end
 ---@param sprite PicOSSprite
 function picocalc.graphics.sprite.removeSprite(sprite) end
 
----Update all sprites (calls each sprite's update callback).
+---Update all sprites (calls each sprite's update callback). Sprites draw
+---in ascending z-index order; equal z-indices draw in the order added.
 function picocalc.graphics.sprite.update() end
 
 ---Return all sprites in the global list.
@@ -1334,6 +1508,30 @@ function picocalc.graphics.sprite.clearClipRectsInRange(z_start, z_end) end
 ---@return PicOSSprite
 function picocalc.graphics.sprite.addEmptyCollisionSprite(x, y, w, h) end
 
+---Resolve many `moveWithCollisions` calls at once, in order. Collisions are
+---written flat into `results` (six values each: sprite, other, normalX,
+---normalY, touchX, touchY); pass the same table every frame to avoid
+---allocating. Final positions are applied to the sprites.
+---@param moves any[] Flat list `{sprite1, goalX1, goalY1, sprite2, ...}`
+---@param results? any[] Table to reuse for the results
+---@return integer count Number of collisions
+---@return any[] results
+function picocalc.graphics.sprite.moveAllWithCollisions(moves, results) end
+
+---Enable dirty-rect compositing. `fn(x, y, w, h)` must redraw the background
+---inside that rect (drawing is clipped to it); `update()` then repaints only
+---the areas sprites moved into or out of. Pair with `display.flushDirty()`.
+---Pass nil to go back to drawing every sprite each frame.
+---@param fn fun(x: integer, y: integer, w: integer, h: integer)|nil
+function picocalc.graphics.sprite.setBackgroundDrawingCallback(fn) end
+
+---Force the compositor to repaint a rect on the next `update()`.
+---@param x integer
+---@param y integer
+---@param w integer
+---@param h integer
+function picocalc.graphics.sprite.addDirtyRect(x, y, w, h) end
+
 -- PicOSSprite methods
 
 ---@param image PicOSImage
@@ -1514,6 +1712,16 @@ function PicOSSprite:overlappingSprites() end
 ---@return PicOSSprite[]
 function PicOSSprite:allOverlappingSprites() end
 
+---Move toward a goal, stopping at the first collision on each axis (X then
+---Y, so the sprite slides along walls). Movement is swept, so fast sprites
+---can't pass through thin ones.
+---@param goalX integer
+---@param goalY integer
+---@return integer actualX
+---@return integer actualY
+---@return table[] collisions `{sprite, other, type, normal={x,y}, touch={x,y}}`
+function PicOSSprite:moveWithCollisions(goalX, goalY) end
+
 ---Clear the stencil mask.
 function PicOSSprite:clearStencil() end
 
@@ -1822,7 +2030,13 @@ function PicOSVideoPlayer:setAutoFlush(af) end
 ---@return integer
 function PicOSVideoPlayer:getDroppedFrames() end
 
----Reset dropped-frame counter.
+---Return decode timing totals (microseconds) since load or `resetStats()`.
+---`split_frames` counts frames whose bottom half was decoded on Core 1; this
+---needs MJPEG with restart markers (see tools/video_converter.sh).
+---@return { frames: integer, split_frames: integer, read_us: integer, flush_wait_us: integer, core0_us: integer, core1_us: integer, sync_us: integer }
+function PicOSVideoPlayer:getStats() end
+
+---Reset dropped-frame counter and timing totals.
 function PicOSVideoPlayer:resetStats() end
 
 ---Free all resources. Also called by the garbage collector.
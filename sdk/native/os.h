@@ -228,6 +228,8 @@ typedef struct {
 
 // --- PSRAM ------------------------------------------------------------------
 
+// Native apps own PIO PSRAM 0x048000..0x3FFFFF (3808 KB); the rest holds
+// the OS MP3 rings, video buffer and sound sample bank.
 typedef struct {
     bool (*pioAvailable)(void);
     bool (*pioBulkAvailable)(void);
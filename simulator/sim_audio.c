@@ -8,6 +8,7 @@
 #include "drivers/fileplayer.h"
 #include "drivers/mp3_player.h"
 #include "drivers/sdcard.h"
+#include "drivers/ima_adpcm.h"
 
 #ifndef FPM_64BIT
 #define FPM_64BIT
@@ -158,11 +159,6 @@ alarm_pool_t *audio_get_core1_alarm_pool(void) {
     return NULL;
 }
 
-void audio_pwm_setup(uint32_t sample_rate) {
-    (void)sample_rate;
-    // No-op in simulator
-}
-
 void audio_play_tone(uint32_t freq_hz, uint32_t duration_ms) {
     if (freq_hz < 20) freq_hz = 20;
     if (freq_hz > 20000) freq_hz = 20000;
@@ -229,6 +225,7 @@ static bool sim_parse_wav_header(sound_sample_t *sample, uint8_t *data, uint32_t
     if (memcmp(data + 8, "WAVE", 4) != 0) return false;
 
     uint32_t data_offset = 0, data_size = 0;
+    uint16_t format_tag = 1, block_align = 0;
     uint32_t pos = 12;
     while (pos + 8 < size) {
         uint32_t chunk_id, chunk_size;
@@ -240,6 +237,8 @@ static bool sim_parse_wav_header(sound_sample_t *sample, uint8_t *data, uint32_t
         memcpy(&data_tag, "data", 4);
 
         if (chunk_id == fmt_tag) {
+            memcpy(&format_tag, data + pos + 8, 2);
+            memcpy(&block_align, data + pos + 20, 2);
             uint16_t ch;
             memcpy(&ch, data + pos + 10, 2);
             sample->channels = (uint8_t)ch;
@@ -257,9 +256,32 @@ static bool sim_parse_wav_header(sound_sample_t *sample, uint8_t *data, uint32_t
     }
 
     if (data_offset == 0 || data_size == 0) return false;
-    if (data_size > SOUND_MAX_SAMPLE_SIZE) data_size = SOUND_MAX_SAMPLE_SIZE;
     if (data_offset + data_size > size) data_size = size - data_offset;
 
+    // The simulator has memory to spare: ADPCM is decoded once, here.
+    if (format_tag == IMA_ADPCM_FORMAT_TAG) {
+        uint32_t block_frames = ima_adpcm_frames_in(block_align, sample->channels);
+        if (block_frames < 2) return false;
+        uint32_t blocks = (data_size + block_align - 1) / block_align;
+        int16_t *pcm = malloc((size_t)blocks * block_frames * sample->channels * 2);
+        if (!pcm) return false;
+        uint32_t frames = 0;
+        for (uint32_t b = 0; b < blocks; b++) {
+            uint32_t off = b * block_align;
+            uint32_t len = data_size - off < block_align ? data_size - off : block_align;
+            frames += ima_adpcm_decode_block(data + data_offset + off, len, sample->channels,
+                                             pcm + (size_t)frames * sample->channels, block_frames);
+        }
+        sample->data = (uint8_t *)pcm;
+        sample->length = frames * sample->channels * 2;
+        sample->bits_per_sample = 16;
+        sample->adpcm = true;
+        sample->block_align = block_align;
+        sample->block_frames = (uint16_t)block_frames;
+        sample->loaded = true;
+        return true;
+    }
+
     sample->data = malloc(data_size);
     if (!sample->data) return false;
 
@@ -276,7 +298,7 @@ void sound_init(void) {
     pthread_mutex_unlock(&s_sound_mutex);
 }
 
-void sound_update(void) {
+static void sound_update(void) {
     // Called from hal_audio_update() to mix active sound players into SDL output
     pthread_mutex_lock(&s_sound_mutex);
 
@@ -285,7 +307,7 @@ void sound_update(void) {
     int mix_frames = 256;
     memset(mix_buf, 0, sizeof(mix_buf));
 
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
         sound_player_t *player = &s_sound_ctx.players[i];
         if (!player->playing || player->paused || !player->sample || !player->sample->loaded)
             continue;
@@ -408,7 +430,6 @@ bool sound_sample_load(sound_sample_t *sample, const char *path) {
 
     int file_size = sdcard_fsize(path);
     if (file_size <= 0) { sdcard_fclose(f); return false; }
-    if (file_size > SOUND_MAX_SAMPLE_SIZE) file_size = SOUND_MAX_SAMPLE_SIZE;
 
     uint8_t *data = malloc(file_size);
     if (!data) { sdcard_fclose(f); return false; }
@@ -441,9 +462,11 @@ uint32_t sound_sample_get_sample_rate(const sound_sample_t *sample) {
 
 sound_player_t *sound_player_create(void) {
     pthread_mutex_lock(&s_sound_mutex);
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
         sound_player_t *p = &s_sound_ctx.players[i];
-        if (!p->sample) {
+        if (!p->allocated) {
+            memset(p, 0, sizeof(*p));
+            p->allocated = true;
             p->volume = 100;
             p->rate = 1.0f;
             p->play_start = 0;
@@ -461,6 +484,7 @@ void sound_player_destroy(sound_player_t *player) {
     pthread_mutex_lock(&s_sound_mutex);
     sound_player_stop(player);
     player->sample = NULL;
+    player->allocated = false;
     pthread_mutex_unlock(&s_sound_mutex);
 }
 
@@ -519,6 +543,26 @@ float sound_player_get_rate(const sound_player_t *player) {
     return player ? player->rate : 1.0f;
 }
 
+// SDL mixes every player, so priority only matters on hardware.
+void sound_player_set_priority(sound_player_t *player, uint8_t priority) {
+    if (player) player->priority = priority;
+}
+
+uint8_t sound_player_get_priority(const sound_player_t *player) {
+    return player ? player->priority : 0;
+}
+
+void sound_player_set_interpolation(sound_player_t *player, bool on) {
+    if (player) player->interpolate = on;
+}
+
+bool sound_player_get_interpolation(const sound_player_t *player) {
+    return player && player->interpolate;
+}
+
+// Samples always live in host memory; nothing to stream.
+void sound_poll(void) {}
+
 sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint8_t bits_per_sample, uint8_t channels) {
     sound_sample_t *sample = sound_sample_create();
     if (!sample) return NULL;
@@ -526,7 +570,6 @@ sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint
     uint32_t bytes_per_frame = (bits_per_sample / 8) * channels;
     uint32_t num_frames = (uint32_t)(seconds * sample_rate);
     uint32_t data_size = num_frames * bytes_per_frame;
-    if (data_size > SOUND_MAX_SAMPLE_SIZE) data_size = SOUND_MAX_SAMPLE_SIZE;
 
     sample->data = calloc(1, data_size);
     if (!sample->data) {
@@ -573,9 +616,15 @@ sound_sample_t *sound_sample_get_subsample(const sound_sample_t *sample, uint32_
     return sub;
 }
 
+sound_sample_t *sound_sample_decompress(const sound_sample_t *sample) {
+    if (!sample || !sample->loaded || !sample->adpcm) return NULL;
+    uint32_t bpf = sample->channels * 2;
+    return sound_sample_get_subsample(sample, 0, sample->length / bpf);
+}
+
 int sound_get_playing_source_count(void) {
     int count = 0;
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
         if (s_sound_ctx.players[i].playing) count++;
     }
     return count;
@@ -649,6 +698,7 @@ fileplayer_t *fileplayer_create(void) {
         if (s_fileplayers[i].state == FILEPLAYER_STATE_IDLE) {
             memset(&s_fileplayers[i], 0, sizeof(fileplayer_t));
             s_fileplayers[i].volume = 100;
+            s_fileplayers[i].buffer_size = FILEPLAYER_BUFFER_SIZE;
             s_fileplayers[i].channels = 2;
             return &s_fileplayers[i];
         }
@@ -826,6 +876,25 @@ void fileplayer_set_stop_on_underrun(fileplayer_t *player, bool flag) {
     player->stop_on_underrun = flag;
 }
 
+// SDL owns the buffering here; the size is only recorded for getStats().
+void fileplayer_set_buffer_size(fileplayer_t *player, uint32_t bytes) {
+    if (!player) return;
+    if (bytes < FILEPLAYER_BUFFER_MIN) bytes = FILEPLAYER_BUFFER_MIN;
+    if (bytes > FILEPLAYER_BUFFER_MAX) bytes = FILEPLAYER_BUFFER_MAX;
+    uint32_t size = FILEPLAYER_BUFFER_MIN;
+    while (size < bytes) size <<= 1;
+    player->buffer_size = size;
+}
+
+void fileplayer_get_stats(const fileplayer_t *player, fileplayer_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!player) return;
+    stats->buffer_size = player->buffer_size;
+    if (player == s_fp_active)
+        stats->buffered = SDL_GetQueuedAudioSize(1);
+    stats->low_water = stats->buffered;
+}
+
 // Called from Core 1 thread every 5ms
 void fileplayer_update(void) {
     if (!s_fp_initialized) return;
@@ -906,7 +975,9 @@ void fileplayer_update(void) {
 }
 
 bool fileplayer_did_underrun(void) {
-    return s_fp_underflow;
+    bool under = s_fp_underflow;
+    s_fp_underflow = false;
+    return under;
 }
 
 // ══════════════════════════════════════════════════════════════════════════════
@@ -1446,6 +1517,34 @@ bool mp3_player_is_fed_mode(void) {
     return s_fed_mode;
 }
 
+mp3_player_t *mp3_player_fed(void) {
+    return s_fed_mode ? &s_mp3_player : NULL;
+}
+
+// The simulator has a single MP3 decoder, so fades are not ramped: a fade
+// to 0 with stop stops at once and a crossfade just starts the new track.
+void mp3_player_fade(mp3_player_t *player, uint8_t level, uint32_t ms, bool stop) {
+    (void)ms;
+    if (player && stop && level == 0)
+        mp3_player_stop(player);
+}
+
+bool mp3_player_crossfade(mp3_player_t *from, mp3_player_t *to, uint32_t ms) {
+    (void)from; (void)ms;
+    return to && mp3_player_play(to, 0);
+}
+
+// No seek index in the simulator: offsets are ignored and a loop range
+// loops the whole track.
+void mp3_player_set_offset(mp3_player_t *player, uint32_t sample) {
+    (void)player; (void)sample;
+}
+
+void mp3_player_set_loop_range(mp3_player_t *player, uint32_t start, uint32_t end) {
+    (void)start; (void)end;
+    if (player) player->loop = true;
+}
+
 void mp3_player_start_dma_fed(void) {
     // Simulator: no DMA, decode happens in mp3_player_update() via SDL
 }
@@ -264,7 +264,8 @@ static const uint8_t s_font8x12[95][12] = {
 // Active font tracking
 static int s_active_font = 0;  // 0 = 6x8, 1 = 8x12, 2 = scientifica, 3 = bold
 
-int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg) {
+static int sim_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg,
+                         bool opaque) {
     int start_x = x;
     uint16_t* fb = display_get_back_buffer();
     
@@ -281,7 +282,8 @@ int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg)
                 for (int col = 0; col < FONT8X12_W; col++) {
                     int px = x + col;
                     if (px >= 0 && px < 320) {
-                        fb[py * 320 + px] = (rowdata & (0x80 >> col)) ? fg : bg;
+                        if (rowdata & (0x80 >> col)) fb[py * 320 + px] = fg;
+                        else if (opaque) fb[py * 320 + px] = bg;
                     }
                 }
             }
@@ -302,7 +304,8 @@ int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg)
                 for (int col = 0; col < FONT_SCI_WIDTH; col++) {
                     int px = x + col;
                     if (px >= 0 && px < 320) {
-                        fb[py * 320 + px] = (rowdata & (0x80 >> col)) ? fg : bg;
+                        if (rowdata & (0x80 >> col)) fb[py * 320 + px] = fg;
+                        else if (opaque) fb[py * 320 + px] = bg;
                     }
                 }
             }
@@ -320,7 +323,8 @@ int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg)
                     int px = x + col;
                     int py = y + row;
                     if (px >= 0 && px < 320 && py >= 0 && py < 320) {
-                        fb[py * 320 + px] = (coldata & (1 << row)) ? fg : bg;
+                        if (coldata & (1 << row)) fb[py * 320 + px] = fg;
+                        else if (opaque) fb[py * 320 + px] = bg;
                     }
                 }
             }
@@ -330,6 +334,14 @@ int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg)
     return x - start_x;
 }
 
+int display_draw_text(int x, int y, const char* text, uint16_t fg, uint16_t bg) {
+    return sim_draw_text(x, y, text, fg, bg, true);
+}
+
+int display_draw_text_transparent(int x, int y, const char* text, uint16_t fg) {
+    return sim_draw_text(x, y, text, fg, 0, false);
+}
+
 int display_text_width(const char* text) {
     int len = strlen(text);
     if (s_active_font == 1) return len * FONT8X12_W;
@@ -369,6 +381,39 @@ void display_flush(void) {
     g_current_buffer = 1 - g_current_buffer;
 }
 
+// Dirty-rect flushing: the simulator always presents the whole frame, so
+// rects are only tracked for callers that read them back.
+typedef struct { int16_t x, y, w, h; } display_rect_t;
+#define DISPLAY_MAX_DIRTY_RECTS 16
+static display_rect_t s_dirty_rects[DISPLAY_MAX_DIRTY_RECTS];
+static int s_dirty_count = 0;
+
+void display_add_dirty_rect(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    if (s_dirty_count == DISPLAY_MAX_DIRTY_RECTS) {
+        s_dirty_rects[0] = (display_rect_t){0, 0, 320, 320};
+        s_dirty_count = 1;
+        return;
+    }
+    s_dirty_rects[s_dirty_count++] = (display_rect_t){x, y, w, h};
+}
+int display_get_dirty_rects(const display_rect_t** out) {
+    *out = s_dirty_rects;
+    return s_dirty_count;
+}
+void display_clear_dirty_rects(void) { s_dirty_count = 0; }
+void display_flush_rects(const display_rect_t* rects, int count) {
+    (void)rects; (void)count;
+    display_flush();
+    s_dirty_count = 0;
+}
+void display_flush_dirty(void) {
+    if (s_dirty_count) display_flush_rects(s_dirty_rects, s_dirty_count);
+}
+bool display_back_buffer_in_sync(void) { return false; }
+void display_set_clip_rect(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+void display_clear_clip_rect(void) {}
+
 void display_apply_clock(void) {}
 
 void display_clear(uint16_t color) { 
@@ -469,6 +514,23 @@ void display_draw_image_partial(int x, int y, const uint16_t* data, int w, int h
     }
 }
 
+// Run-length keyed images are never built in the simulator, so callers
+// always take the per-pixel keyed path.
+void* display_rle_encode(const uint16_t* data, int w, int h, uint16_t key) {
+    (void)data; (void)w; (void)h; (void)key;
+    return NULL;
+}
+
+void display_rle_free(void* img) {
+    (void)img;
+}
+
+void display_draw_rle(int x, int y, const void* img, int sx, int sy, int sw, int sh,
+                      bool flip_x, bool flip_y) {
+    (void)x; (void)y; (void)img; (void)sx; (void)sy; (void)sw; (void)sh;
+    (void)flip_x; (void)flip_y;
+}
+
 void display_draw_image_scaled_nn(int x, int y, const uint16_t* data, int w, int h, float scale) {
     uint16_t* fb = display_get_back_buffer();
     int new_w = (int)(w * scale);
@@ -502,6 +564,9 @@ void usb_msc_enter_mode(void) {
 // SD card stubs
 void sdcard_remount(void) {}
 void sdcard_apply_clock(void) {}
+void sdcard_cache_init(void) {}
+bool sdcard_cache_flush(void) { return true; }
+void sdcard_cache_enable(bool on) { (void)on; }
 
 bool sdcard_fexists(const char* path) {
     extern char g_base_path[512];
@@ -657,6 +722,12 @@ size_t sdcard_fsize_handle(void* f) {
     return (size_t)pos; 
 }
 int sdcard_fwrite(void* f, const void* buf, int len) { return (int)hal_sdcard_write(f, buf, (size_t)len); }
+// No DMA here: async reads complete before they return.
+static int s_async_result;
+int sdcard_read_async(void* f, void* buf, int len) { s_async_result = sdcard_fread(f, buf, len); return 1; }
+bool sdcard_async_done(int token) { (void)token; return true; }
+int sdcard_async_wait(int token) { (void)token; return s_async_result; }
+void sdcard_async_cancel(int token) { (void)token; }
 size_t sdcard_fsize(const char* path) { return (size_t)hal_sdcard_size(path); }
 bool sdcard_mkdir(const char* path) { return hal_sdcard_mkdir(path); }
 bool sdcard_delete(const char* path) { (void)path; return false; }
@@ -666,7 +737,70 @@ bool sdcard_copy(const char* src, const char* dst,
                  void* user) {
     (void)src; (void)dst; (void)progress_cb; (void)user; return false;
 }
-bool sdcard_stat(const char* path, void* st) { (void)path; (void)st; return false; }
+// Same layout as sdcard_stat_t in sdcard.h; stamps are left at zero.
+typedef struct {
+    uint32_t size;
+    bool     is_dir;
+    uint16_t fdate;
+    uint16_t ftime;
+} sim_stat_t;
+
+bool sdcard_stat(const char* path, void* out) {
+    extern char g_base_path[512];
+    char full_path[1024];
+    if (path[0] == '/') {
+        snprintf(full_path, sizeof(full_path), "%s%s", g_base_path, path);
+    } else {
+        snprintf(full_path, sizeof(full_path), "%s/%s", g_base_path, path);
+    }
+
+    struct stat st;
+    if (!out || stat(full_path, &st) != 0) return false;
+    sim_stat_t* o = (sim_stat_t*)out;
+    o->size = S_ISDIR(st.st_mode) ? 0 : (uint32_t)st.st_size;
+    o->is_dir = S_ISDIR(st.st_mode);
+    o->fdate = 0;
+    o->ftime = 0;
+    return true;
+}
+// Cache files: the simulator keeps none, so every lookup misses.
+bool sdcard_cache_path(const char* subdir, const char* name, const char* ext,
+                       char* out, int out_len) {
+    (void)subdir; (void)name; (void)ext; (void)out; (void)out_len;
+    return false;
+}
+bool sdcard_write_file_atomic(const char* path, const void* parts, int count) {
+    (void)path; (void)parts; (void)count; return false;
+}
+uint32_t sdcard_hash(uint32_t h, const void* data, uint32_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len--) h = (h ^ *p++) * 16777619u;
+    return h;
+}
+// Same layout as sdcard_file_id_t; hashes the whole file.
+typedef struct {
+    uint32_t size;
+    uint16_t fdate;
+    uint16_t ftime;
+    uint32_t hash;
+} sim_file_id_t;
+
+bool sdcard_file_id_ends(const char* path, uint32_t end_bytes, void* out) {
+    (void)end_bytes;
+    sim_stat_t st;
+    if (!sdcard_stat(path, &st) || st.is_dir) return false;
+    int len = 0;
+    char* data = sdcard_read_file(path, &len);
+    if (!data) return false;
+    sim_file_id_t* id = (sim_file_id_t*)out;
+    id->size = st.size;
+    id->fdate = st.fdate;
+    id->ftime = st.ftime;
+    id->hash = sdcard_hash(2166136261u, data, (uint32_t)len);
+    free(data);
+    return true;
+}
+bool sdcard_file_id(const char* path, void* out) { return sdcard_file_id_ends(path, 0, out); }
 bool sdcard_disk_info(uint32_t* out_free_kb, uint32_t* out_total_kb) {
     if (out_free_kb) *out_free_kb = 0;
     if (out_total_kb) *out_total_kb = 0;
@@ -719,6 +853,7 @@ void video_player_update(void* player) { (void)player; }
 float video_player_get_fps(void* player) { (void)player; return 0; }
 int video_player_get_dropped_frames(void* player) { (void)player; return 0; }
 void video_player_reset_stats(void* player) { (void)player; }
+void video_player_get_stats(void* player, void* stats) { (void)player; memset(stats, 0, 7 * sizeof(uint32_t)); /* video_stats_t */ }
 bool video_player_has_audio(void* player) { (void)player; return false; }
 void video_player_set_audio_volume(void* player, uint8_t volume) { (void)player; (void)volume; }
 uint8_t video_player_get_audio_volume(void* player) { (void)player; return 100; }
@@ -0,0 +1,169 @@
+// fs_queue for the simulator: no second core, so each request is carried
+// out as it is posted and its callback fires from the next
+// fs_queue_dispatch(), as on the device.
+#include <stdio.h>
+#include <string.h>
+#include "fs_queue.h"
+#include "umm_malloc.h"
+
+typedef struct {
+    bool in_use;
+    bool firing;
+    bool own_buf;
+    fs_queue_cb_t cb;
+    void *user;
+    void *buf;
+    fs_result_t res;
+    char path[FS_QUEUE_PATH_MAX];
+} sim_req_t;
+
+static sim_req_t s_reqs[FS_QUEUE_SLOTS];
+static int s_next_id = 1;
+
+static sim_req_t *req_alloc(const char *path, fs_req_op_t op,
+                            fs_queue_cb_t cb, void *user) {
+    if (!path || strlen(path) >= FS_QUEUE_PATH_MAX) return NULL;
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        sim_req_t *r = &s_reqs[i];
+        if (r->in_use) continue;
+        memset(r, 0, sizeof(*r));
+        strcpy(r->path, path);
+        r->in_use = true;
+        r->cb = cb;
+        r->user = user;
+        r->res.id = s_next_id++;
+        r->res.op = op;
+        r->res.path = r->path;
+        return r;
+    }
+    return NULL;
+}
+
+int fs_queue_read(const char *path, uint32_t offset, void *buf, uint32_t len,
+                  fs_queue_cb_t cb, void *user) {
+    if (buf && len == 0) return -1;
+    sim_req_t *r = req_alloc(path, FS_REQ_READ, cb, user);
+    if (!r) return -1;
+    r->res.result = -1;
+    sdfile_t f = sdcard_fopen(path, "rb");
+    int size = f ? sdcard_fsize(path) : -1;
+    if (size >= 0) {
+        uint32_t avail = (uint32_t)size > offset ? (uint32_t)size - offset : 0;
+        if (len == 0 || len > avail) len = avail;
+        if (!buf && len) {
+            buf = umm_malloc(len);
+            r->own_buf = buf != NULL;
+        }
+        if (len == 0)
+            r->res.result = 0;
+        else if (buf && sdcard_fseek(f, offset))
+            r->res.result = sdcard_fread(f, buf, (int)len);
+    }
+    if (f) sdcard_fclose(f);
+    r->buf = buf;
+    r->res.data = r->res.result >= 0 ? buf : NULL;
+    return r->res.id;
+}
+
+int fs_queue_write(const char *path, const void *data, uint32_t len,
+                   bool append, bool copy, fs_queue_cb_t cb, void *user) {
+    (void)copy;  // written before this returns
+    if (len && !data) return -1;
+    sim_req_t *r = req_alloc(path, FS_REQ_WRITE, cb, user);
+    if (!r) return -1;
+    sdfile_t f = sdcard_fopen(path, append ? "ab" : "wb");
+    r->res.result = f ? sdcard_fwrite(f, data, (int)len) : -1;
+    if (f) sdcard_fclose(f);
+    return r->res.id;
+}
+
+int fs_queue_stat(const char *path, fs_queue_cb_t cb, void *user) {
+    sim_req_t *r = req_alloc(path, FS_REQ_STAT, cb, user);
+    if (!r) return -1;
+    r->res.result = sdcard_stat(path, &r->res.stat) ? 0 : -1;
+    return r->res.id;
+}
+
+typedef struct {
+    sdcard_entry_t *entries;
+    int max;
+    int n;
+} sim_list_t;
+
+static void sim_list_cb(const sdcard_entry_t *e, void *user) {
+    sim_list_t *l = (sim_list_t *)user;
+    if (l->entries && l->n < l->max)
+        l->entries[l->n] = *e;
+    l->n++;
+}
+
+int fs_queue_list_dir(const char *path, sdcard_entry_t *entries, int max,
+                      fs_queue_cb_t cb, void *user) {
+    if (entries && max <= 0) return -1;
+    sim_req_t *r = req_alloc(path, FS_REQ_LIST, cb, user);
+    if (!r) return -1;
+    if (!entries) {
+        int count = sdcard_list_dir(path, NULL, NULL);
+        if (count > 0) {
+            entries = (sdcard_entry_t *)umm_malloc(count * sizeof(*entries));
+            r->own_buf = entries != NULL;
+            max = count;
+        }
+    }
+    sim_list_t l = {entries, max, 0};
+    int count = sdcard_list_dir(path, sim_list_cb, &l);
+    r->res.result = count < 0 ? -1 : (l.n < max ? l.n : max);
+    if (!entries && count > 0) r->res.result = -1;
+    r->buf = entries;
+    r->res.data = r->res.result >= 0 ? entries : NULL;
+    return r->res.id;
+}
+
+static void req_release(sim_req_t *r) {
+    if (r->own_buf) umm_free(r->buf);
+    r->in_use = false;
+}
+
+bool fs_queue_cancel(int id, void **user) {
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        sim_req_t *r = &s_reqs[i];
+        if (!r->in_use || r->firing || r->res.id != id) continue;
+        if (user) *user = r->user;
+        req_release(r);
+        return true;
+    }
+    return false;
+}
+
+void fs_queue_reset(void) {
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++)
+        if (s_reqs[i].in_use) req_release(&s_reqs[i]);
+}
+
+int fs_queue_pending(void) {
+    int n = 0;
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++)
+        if (s_reqs[i].in_use) n++;
+    return n;
+}
+
+void fs_queue_poll(void) {}
+
+int fs_queue_dispatch(void) {
+    int fired = 0;
+    for (;;) {
+        sim_req_t *next = NULL;
+        for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+            sim_req_t *r = &s_reqs[i];
+            if (r->in_use && !r->firing &&
+                (!next || r->res.id < next->res.id))
+                next = r;
+        }
+        if (!next) return fired;
+        next->firing = true;  // not picked again, nor cancelled
+        if (next->cb)
+            next->cb(&next->res, next->user);
+        req_release(next);
+        fired++;
+    }
+}
@@ -23,6 +23,14 @@ static inline absolute_time_t get_absolute_time(void) {
     return hal_get_time_us();
 }
 
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)hal_get_time_us();
+}
+
+static inline uint64_t time_us_64(void) {
+    return hal_get_time_us();
+}
+
 static inline uint32_t to_ms_since_boot(absolute_time_t t) {
     return (uint32_t)(t / 1000);
 }
@@ -4,8 +4,9 @@
 #include "pico/time.h"
 #include "../os/os.h"
 
+// Output goes through the software mixer (audio_mixer.h); the tone and the
+// PCM stream below are voices in it and play alongside sounds and music.
 void audio_init(void);
-void audio_pwm_setup(uint32_t sample_rate);
 void audio_play_tone(uint32_t freq_hz, uint32_t duration_ms);
 void audio_stop_tone(void);
 void audio_set_volume(uint8_t volume);
@@ -15,19 +16,17 @@ void audio_set_volume(uint8_t volume);
 // Core 0 free for the app/game loop.
 void audio_core1_init(void);
 
-// Returns the Core 1 alarm pool for audio timer registration.
-// Used by sound.c and fileplayer.c to ensure their playback timers
-// also fire on Core 1.
+// Returns the Core 1 alarm pool, for timers that must fire on Core 1.
 alarm_pool_t *audio_get_core1_alarm_pool(void);
 
 // PCM sample streaming (for emulators, music players, etc.)
-// Uses DMA paced by PWM DREQ — ~750x fewer interrupts than the old timer ISR.
+// Frames are queued in a ring that the mixer resamples to its output rate.
 // Samples are stereo interleaved int16_t pairs (L, R, L, R, ...).
 // count = number of stereo frames (each frame = 2 int16_t values).
 void audio_start_stream(uint32_t sample_rate);
 void audio_stop_stream(void);
 void audio_push_samples(const int16_t *samples, int count);
 
-// Must be called periodically from Core 1 to handle deferred DMA start.
-// This ensures the stream DMA ISR fires on Core 1, not Core 0.
+// Must be called periodically from Core 1: runs audio_mixer_poll(), which
+// registers the mixer's DMA ISR on Core 1 and starts output.
 void audio_stream_poll(void);
@@ -0,0 +1,326 @@
+#include "audio_mixer.h"
+#include "../hardware.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/platform.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#define MIX_SAT16(x) __ssat((x), 16)
+#else
+static inline int32_t MIX_SAT16(int32_t x) {
+  return x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+}
+#endif
+
+typedef struct {
+  audio_voice_fn fn;
+  void *ctx;
+} mixer_voice_t;
+
+// Voice table.  The ISR holds s_voice_lock for the whole mix, so removing a
+// voice from either core waits until its render function has returned.
+static mixer_voice_t s_voices[AUDIO_MIXER_MAX_VOICES];
+static volatile int s_voice_count = 0;
+static spin_lock_t *s_voice_lock = NULL;
+
+static int32_t s_mix[AUDIO_MIXER_BLOCK_FRAMES * 2];
+
+// ── DMA output (paced by PWM DREQ) ──────────────────────────────────────────
+// Both audio pins sit on one PWM slice (A = left, B = right), so each DMA
+// word is a full CC register write: (right << 16) | left.
+static int s_dma_chan = -1;
+static uint32_t s_dma_buf[2][AUDIO_MIXER_BLOCK_FRAMES];
+static volatile int s_dma_active_buf = 0;
+static volatile bool s_running = false;
+static volatile bool s_irq_on_core1 = false;
+static unsigned int s_pwm_slice = 0;
+static volatile uint32_t s_pwm_wrap = 0;
+static uint32_t s_sys_clk = 0;
+static volatile uint32_t s_frames = 0;
+
+static inline uint32_t silence_word(void) {
+  uint32_t mid = (s_pwm_wrap + 1) / 2;
+  return (mid << 16) | mid;
+}
+
+// Clock divider 1 with the wrap derived from clk_sys: the finest PWM
+// resolution available (4535 levels at 200 MHz) and a rate within 0.01% of
+// AUDIO_MIXER_RATE at any system clock.
+static void mixer_set_wrap(void) {
+  s_sys_clk = clock_get_hz(clk_sys);
+  uint32_t period = (s_sys_clk + AUDIO_MIXER_RATE / 2) / AUDIO_MIXER_RATE;
+  if (period > 65536)
+    period = 65536;
+  s_pwm_wrap = period - 1;
+  pwm_set_wrap(s_pwm_slice, (uint16_t)s_pwm_wrap);
+}
+
+static void __time_critical_func(mixer_fill)(uint32_t *out) {
+  uint32_t save = spin_lock_blocking(s_voice_lock);
+  int count = s_voice_count;
+  if (count == 0) {
+    spin_unlock(s_voice_lock, save);
+    uint32_t word = silence_word();
+    for (int i = 0; i < AUDIO_MIXER_BLOCK_FRAMES; i++)
+      out[i] = word;
+    s_frames += AUDIO_MIXER_BLOCK_FRAMES;
+    return;
+  }
+
+  int32_t *mix = s_mix;
+  memset(mix, 0, sizeof(s_mix));
+  for (int i = 0; i < count;) {
+    if (s_voices[i].fn(s_voices[i].ctx, mix, AUDIO_MIXER_BLOCK_FRAMES)) {
+      i++;
+      continue;
+    }
+    s_voices[i] = s_voices[--count];  // finished: drop it
+  }
+  s_voice_count = count;
+  spin_unlock(s_voice_lock, save);
+
+  // Saturate to 16-bit (one SSAT each on the M33), then scale
+  // [-32768, 32767] onto [0, wrap].
+  uint32_t range = s_pwm_wrap + 1;
+  for (int i = 0; i < AUDIO_MIXER_BLOCK_FRAMES; i++) {
+    int32_t l = MIX_SAT16(mix[i * 2]);
+    int32_t r = MIX_SAT16(mix[i * 2 + 1]);
+    uint32_t lv = ((uint32_t)(l + 32768) * range) >> 16;
+    uint32_t rv = ((uint32_t)(r + 32768) * range) >> 16;
+    out[i] = (rv << 16) | lv;
+  }
+  s_frames += AUDIO_MIXER_BLOCK_FRAMES;
+}
+
+// DMA completion ISR (Core 1): restart on the pre-mixed buffer first so the
+// output never stalls, then mix into the one that just finished.
+static void mixer_dma_irq_handler(void) {
+  dma_hw->ints1 = 1u << s_dma_chan;  // clear IRQ (using DMA_IRQ_1)
+
+  int next_buf = s_dma_active_buf ^ 1;
+  dma_channel_set_read_addr(s_dma_chan, s_dma_buf[next_buf], true);
+  mixer_fill(s_dma_buf[s_dma_active_buf]);
+  s_dma_active_buf = next_buf;
+}
+
+static void mixer_start_dma(void) {
+  uint32_t word = silence_word();
+  for (int i = 0; i < AUDIO_MIXER_BLOCK_FRAMES; i++) {
+    s_dma_buf[0][i] = word;
+    s_dma_buf[1][i] = word;
+  }
+  s_dma_active_buf = 0;
+
+  dma_channel_config dc = dma_channel_get_default_config(s_dma_chan);
+  channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+  channel_config_set_read_increment(&dc, true);
+  channel_config_set_write_increment(&dc, false);
+  channel_config_set_dreq(&dc, DREQ_PWM_WRAP0 + s_pwm_slice);
+  dma_channel_configure(s_dma_chan, &dc, &pwm_hw->slice[s_pwm_slice].cc,
+                        s_dma_buf[0], AUDIO_MIXER_BLOCK_FRAMES, false);
+  dma_channel_set_irq1_enabled(s_dma_chan, true);
+  dma_channel_start(s_dma_chan);
+}
+
+// Claims the right to start the DMA.  The ISR only exists on Core 1, so
+// nothing starts until audio_mixer_poll() has registered it there; after
+// that either core may kick the channel.
+static bool mixer_claim_start(void) {
+  bool start = !s_running && s_irq_on_core1 && s_voice_count > 0;
+  if (start)
+    s_running = true;
+  return start;
+}
+
+void audio_mixer_init(void) {
+  if (s_voice_lock)
+    return;
+  s_dma_chan = dma_claim_unused_channel(true);
+
+  gpio_set_function(AUDIO_PIN_L, GPIO_FUNC_PWM);
+  gpio_set_function(AUDIO_PIN_R, GPIO_FUNC_PWM);
+  s_pwm_slice = pwm_gpio_to_slice_num(AUDIO_PIN_L);
+
+  pwm_config cfg = pwm_get_default_config();
+  pwm_init(s_pwm_slice, &cfg, false);
+  mixer_set_wrap();
+  // Idle at the midpoint: true silence for the AC-coupled output, and no pop
+  // when the first voice starts.
+  pwm_hw->slice[s_pwm_slice].cc = silence_word();
+  pwm_set_enabled(s_pwm_slice, true);
+
+  // Set last: a non-NULL lock tells the other entry points we're ready.
+  s_voice_lock = spin_lock_instance(spin_lock_claim_unused(true));
+
+  printf("[MIXER] %u Hz, wrap %lu, %d-frame blocks\n", AUDIO_MIXER_RATE,
+         (unsigned long)s_pwm_wrap, AUDIO_MIXER_BLOCK_FRAMES);
+}
+
+bool audio_mixer_add_voice(audio_voice_fn fn, void *ctx) {
+  if (!s_voice_lock || !fn)
+    return false;
+
+  uint32_t save = spin_lock_blocking(s_voice_lock);
+  bool ok = true;
+  int i;
+  for (i = 0; i < s_voice_count; i++)
+    if (s_voices[i].fn == fn && s_voices[i].ctx == ctx)
+      break;
+  if (i == s_voice_count) {
+    if (s_voice_count < AUDIO_MIXER_MAX_VOICES) {
+      s_voices[i].fn = fn;
+      s_voices[i].ctx = ctx;
+      s_voice_count = i + 1;
+    } else {
+      ok = false;
+    }
+  }
+  bool start = mixer_claim_start();
+  spin_unlock(s_voice_lock, save);
+
+  if (start)
+    mixer_start_dma();
+  if (!ok)
+    printf("[MIXER] No free voice slot\n");
+  return ok;
+}
+
+void audio_mixer_remove_voice(audio_voice_fn fn, void *ctx) {
+  if (!s_voice_lock)
+    return;
+  uint32_t save = spin_lock_blocking(s_voice_lock);
+  for (int i = 0; i < s_voice_count; i++) {
+    if (s_voices[i].fn == fn && s_voices[i].ctx == ctx) {
+      s_voices[i] = s_voices[--s_voice_count];
+      break;
+    }
+  }
+  spin_unlock(s_voice_lock, save);
+}
+
+int audio_mixer_voice_count(void) {
+  return s_voice_count;
+}
+
+uint32_t audio_mixer_get_frames(void) {
+  return s_frames;
+}
+
+void audio_mixer_poll(void) {
+  if (!s_voice_lock)
+    return;
+
+  if (!s_irq_on_core1) {
+    irq_set_exclusive_handler(DMA_IRQ_1, mixer_dma_irq_handler);
+    irq_set_enabled(DMA_IRQ_1, true);
+    s_irq_on_core1 = true;
+  }
+
+  uint32_t save = spin_lock_blocking(s_voice_lock);
+  bool start = mixer_claim_start();
+  spin_unlock(s_voice_lock, save);
+  if (start)
+    mixer_start_dma();
+
+  // Per-app clock changes (launcher) would otherwise shift the output rate.
+  if (clock_get_hz(clk_sys) != s_sys_clk)
+    mixer_set_wrap();
+}
+
+// ── PCM ring voice ───────────────────────────────────────────────────────────
+
+void audio_ring_init(audio_ring_t *r, int16_t *buf, uint32_t frames,
+                     uint32_t sample_rate) {
+  r->buf = buf;
+  r->mask = frames - 1;
+  r->gain_l = 256;
+  r->gain_r = 256;
+  r->underruns = 0;
+  r->wr = 0;
+  r->rd = 0;
+  r->frac = 0;
+  audio_ring_set_rate(r, sample_rate);
+}
+
+void audio_ring_clear(audio_ring_t *r) {
+  r->rd = r->wr;
+  r->frac = 0;
+}
+
+void audio_ring_set_rate(audio_ring_t *r, uint32_t sample_rate) {
+  r->step = (uint32_t)(((uint64_t)sample_rate << 16) / AUDIO_MIXER_RATE);
+}
+
+uint32_t audio_ring_level(const audio_ring_t *r) {
+  return r->wr - r->rd;
+}
+
+uint32_t audio_ring_space(const audio_ring_t *r) {
+  return r->mask + 1 - (r->wr - r->rd);
+}
+
+uint32_t audio_ring_write(audio_ring_t *r, const int16_t *frames, uint32_t count) {
+  uint32_t space = audio_ring_space(r);
+  if (count > space)
+    count = space;
+  if (count == 0)
+    return 0;
+
+  uint32_t wr = r->wr;
+  uint32_t idx = wr & r->mask;
+  uint32_t to_end = r->mask + 1 - idx;
+  uint32_t first = count < to_end ? count : to_end;
+  memcpy(r->buf + idx * 2, frames, first * 2 * sizeof(int16_t));
+  if (count > first)
+    memcpy(r->buf, frames + first * 2, (count - first) * 2 * sizeof(int16_t));
+
+  __dmb();  // data visible to the other core before the new write index
+  r->wr = wr + count;
+  return count;
+}
+
+// Nearest-frame resampling: the 16.16 step walks the source at its own rate
+// while the mixer produces AUDIO_MIXER_RATE frames.
+bool __time_critical_func(audio_ring_render)(void *ctx, int32_t *mix, int frames) {
+  audio_ring_t *r = (audio_ring_t *)ctx;
+  uint32_t rd = r->rd;
+  uint32_t avail = r->wr - rd;
+  __dmb();
+  if (avail == 0) {
+    r->underruns++;
+    return true;
+  }
+
+  const int16_t *buf = r->buf;
+  uint32_t mask = r->mask;
+  uint32_t step = r->step;
+  uint32_t frac = r->frac;
+  int32_t gl = r->gain_l, gr = r->gain_r;
+  uint32_t used = 0;
+
+  for (int i = 0; i < frames; i++) {
+    if (used >= avail) {
+      r->underruns++;
+      break;
+    }
+    const int16_t *f = buf + ((rd + used) & mask) * 2;
+    mix[i * 2] += (f[0] * gl) >> 8;
+    mix[i * 2 + 1] += (f[1] * gr) >> 8;
+    frac += step;
+    used += frac >> 16;
+    frac &= 0xFFFF;
+  }
+  if (used > avail)
+    used = avail;
+  r->frac = frac;
+  r->rd = rd + used;
+  return true;
+}
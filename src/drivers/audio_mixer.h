@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Software audio mixer
+//
+// The only owner of the audio PWM slice.  Output runs at a fixed rate from a
+// DMA ping-pong buffer paced by the PWM wrap DREQ; each time a block finishes
+// the DMA ISR (registered on Core 1) mixes every active voice into the next
+// one in 32-bit, saturates to 16-bit and converts to PWM levels.
+//
+// Voices add their output on top of what is already in the block, so several
+// sources (sample players, file streams, MP3, tone, native pushSamples) are
+// heard at once instead of overwriting each other.
+// =============================================================================
+
+#ifndef AUDIO_MIXER_RATE
+#define AUDIO_MIXER_RATE 44100
+#endif
+
+#define AUDIO_MIXER_BLOCK_FRAMES 256
+#define AUDIO_MIXER_MAX_VOICES   32
+
+// Adds `frames` stereo frames (interleaved L, R in int16 units) into mix.
+// Runs in the DMA ISR on Core 1, so it must only touch memory the mixer can
+// read without blocking (SRAM or QMI PSRAM, never PIO PSRAM or the SD card).
+// Return false when the voice has finished; the mixer then drops it.
+typedef bool (*audio_voice_fn)(void *ctx, int32_t *mix, int frames);
+
+void audio_mixer_init(void);
+
+// Register a voice.  Adding a (fn, ctx) pair that is already active is a
+// no-op.  Returns false if every slot is taken.
+bool audio_mixer_add_voice(audio_voice_fn fn, void *ctx);
+
+// Remove the voice for (fn, ctx), if any.  Once this returns the ISR is no
+// longer inside fn, so ctx may be freed.
+void audio_mixer_remove_voice(audio_voice_fn fn, void *ctx);
+
+int audio_mixer_voice_count(void);
+
+// Frames played since boot; a sample-accurate clock for sound.getCurrentTime.
+uint32_t audio_mixer_get_frames(void);
+
+// Called from the Core 1 loop: registers the DMA ISR on Core 1 the first
+// time, starts output once a voice exists and follows sys clock changes.
+void audio_mixer_poll(void);
+
+// ── PCM ring voice ───────────────────────────────────────────────────────────
+// Single-producer / single-consumer ring of stereo int16 frames at an
+// arbitrary source rate.  The producer (any core) calls audio_ring_write;
+// the mixer consumes it through audio_ring_render.
+
+typedef struct {
+    int16_t *buf;                 // size * 2 int16 (L, R)
+    uint32_t mask;                // size - 1, size is a power of two
+    volatile uint32_t wr;         // free-running frame counters
+    volatile uint32_t rd;
+    uint32_t step;                // 16.16 source frames per output frame
+    uint32_t frac;
+    uint16_t gain_l;              // 256 = unity
+    uint16_t gain_r;
+    volatile uint32_t underruns;  // blocks that ran out of data
+} audio_ring_t;
+
+void audio_ring_init(audio_ring_t *r, int16_t *buf, uint32_t frames,
+                     uint32_t sample_rate);
+void audio_ring_clear(audio_ring_t *r);
+void audio_ring_set_rate(audio_ring_t *r, uint32_t sample_rate);
+uint32_t audio_ring_level(const audio_ring_t *r);
+uint32_t audio_ring_space(const audio_ring_t *r);
+// Copies up to count frames; returns how many fitted.
+uint32_t audio_ring_write(audio_ring_t *r, const int16_t *frames, uint32_t count);
+// audio_voice_fn for a ring (ctx = the ring).  Never finishes on its own.
+bool audio_ring_render(void *ctx, int32_t *mix, int frames);
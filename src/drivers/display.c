@@ -18,6 +18,7 @@
 #include <math.h>
 
 #include "../os/image_decoders.h"
+#include "umm_malloc.h"
 #include "../fonts/font_scientifica.h"
 
 // ── Framebuffer ──────────────────────────────────────────────────────────────
@@ -37,6 +38,17 @@ static uint s_pio_sm = 0;
 // Transparent color key (0 = disabled)
 static uint16_t s_transparent_color = 0;
 
+// Clip rectangle, half-open: x0 <= x < x1, y0 <= y < y1
+static int s_clip_x0 = 0, s_clip_y0 = 0;
+static int s_clip_x1 = FB_WIDTH, s_clip_y1 = FB_HEIGHT;
+
+// Dirty rects pending for display_flush_dirty()
+static display_rect_t s_dirty_rects[DISPLAY_MAX_DIRTY_RECTS];
+static int s_dirty_count = 0;
+
+// True while the back buffer mirrors the front buffer (see header)
+static bool s_back_in_sync = false;
+
 // ── Built-in 6x8 font (ASCII 0x20–0x7E) ─────────────────────────────────────
 // Minimal 6x8 pixel font data — each character is 6 bytes (columns), 8 rows.
 // This is a standard "font6x8" pattern used widely in embedded projects.
@@ -273,6 +285,155 @@ int display_get_font_height(void) {
   return FONT_H;
 }
 
+// ── Text engine
+// ─────────────────────────────────────────────────────────────── All fonts
+// are drawn from row-major glyphs (MSB = leftmost pixel).  The 6x8 font above
+// is column-major, so display_init() transposes it once into s_font6x8_rows.
+// Glyph rows go out through s_text_lut: the four fg/bg pixels for every 4-bit
+// row pattern, pre-packed as two 32-bit words and rebuilt only when the
+// colours change.
+
+static uint8_t s_font6x8_rows[95][FONT_H];
+
+static void font6x8_transpose(void) {
+  for (int g = 0; g < 95; g++) {
+    for (int row = 0; row < FONT_H; row++) {
+      uint8_t bits = 0;
+      for (int col = 0; col < FONT_W; col++)
+        if (s_font6x8[g][col] & (1 << row))
+          bits |= 0x80 >> col;
+      s_font6x8_rows[g][row] = bits;
+    }
+  }
+}
+
+static uint32_t s_text_lut[16][2];
+static uint16_t s_text_lut_fg, s_text_lut_bg;
+static bool s_text_lut_valid = false;
+
+static void text_lut_build(uint16_t fg_be, uint16_t bg_be) {
+  if (s_text_lut_valid && fg_be == s_text_lut_fg && bg_be == s_text_lut_bg)
+    return;
+  for (int i = 0; i < 16; i++) {
+    uint32_t px[4];
+    for (int b = 0; b < 4; b++)
+      px[b] = (i & (8 >> b)) ? fg_be : bg_be;
+    s_text_lut[i][0] = px[0] | (px[1] << 16);
+    s_text_lut[i][1] = px[2] | (px[3] << 16);
+  }
+  s_text_lut_fg = fg_be;
+  s_text_lut_bg = bg_be;
+  s_text_lut_valid = true;
+}
+
+// One opaque glyph row of w pixels, glyph bits left-aligned at bit 7.
+static inline void text_row_opaque(uint16_t *p, uint32_t bits, int w) {
+  if ((uintptr_t)p & 2) {
+    *p++ = (bits & 0x80) ? s_text_lut_fg : s_text_lut_bg;
+    bits <<= 1;
+    w--;
+  }
+  for (; w >= 4; w -= 4, p += 4, bits <<= 4) {
+    const uint32_t *e = s_text_lut[(bits >> 4) & 15];
+    ((uint32_t *)p)[0] = e[0];
+    ((uint32_t *)p)[1] = e[1];
+  }
+  if (w >= 2) {
+    *(uint32_t *)p = s_text_lut[(bits >> 4) & 12][0];
+    p += 2;
+    bits <<= 2;
+    w -= 2;
+  }
+  if (w)
+    *p = (bits & 0x80) ? s_text_lut_fg : s_text_lut_bg;
+}
+
+// Foreground pixels only: jump straight from one set bit to the next.
+static inline void text_row_transparent(uint16_t *p, uint32_t bits,
+                                        uint16_t fg_be) {
+  uint32_t m = (bits & 0xFF) << 24;
+  while (m) {
+    int i = __builtin_clz(m);
+    p[i] = fg_be;
+    m &= ~(0x80000000u >> i);
+  }
+}
+
+static int text_draw(int x, int y, const char *text, uint16_t fg, uint16_t bg,
+                     bool opaque) {
+  const uint8_t *base;
+  int w, h;
+  if (s_active_font == 1) {
+    base = &s_font8x12[0][0];
+    w = FONT8X12_W;
+    h = FONT8X12_H;
+  } else if (s_active_font == 2 || s_active_font == 3) {
+    base = s_active_font == 3 ? &font_scientifica_bold[0][0]
+                              : &font_scientifica[0][0];
+    w = FONT_SCI_WIDTH;
+    h = FONT_SCI_HEIGHT;
+  } else {
+    base = &s_font6x8_rows[0][0];
+    w = FONT_W;
+    h = FONT_H;
+  }
+
+  // Vertical clip once per string
+  int start_x = x;
+  int r0 = s_clip_y0 - y, r1 = s_clip_y1 - y;
+  if (r0 < 0)
+    r0 = 0;
+  if (r1 > h)
+    r1 = h;
+  if (r0 >= r1)
+    return (int)strlen(text) * w;
+
+  uint16_t fg_be = (fg >> 8) | (fg << 8);
+  uint16_t bg_be = (bg >> 8) | (bg << 8);
+  if (opaque)
+    text_lut_build(fg_be, bg_be);
+  uint32_t mask = (0xFF00u >> w) & 0xFF;
+  uint16_t *rows = &s_framebuffer[(y + r0) * FB_WIDTH];
+
+  for (; *text; text++, x += w) {
+    if (x >= s_clip_x1) {
+      x += (int)strlen(text) * w;
+      break;
+    }
+    if (x + w <= s_clip_x0)
+      continue;
+    char c = *text;
+    if (c < 0x20 || c > 0x7E) c = '?';
+    const uint8_t *glyph = base + (c - 0x20) * h;
+
+    if (x >= s_clip_x0 && x + w <= s_clip_x1) {
+      uint16_t *p = rows + x;
+      for (int row = r0; row < r1; row++, p += FB_WIDTH) {
+        if (opaque)
+          text_row_opaque(p, glyph[row] & mask, w);
+        else
+          text_row_transparent(p, glyph[row] & mask, fg_be);
+      }
+      continue;
+    }
+
+    // Glyph straddles the left or right clip edge
+    int c0 = x < s_clip_x0 ? s_clip_x0 - x : 0;
+    int c1 = x + w > s_clip_x1 ? s_clip_x1 - x : w;
+    uint16_t *p = rows;
+    for (int row = r0; row < r1; row++, p += FB_WIDTH) {
+      uint8_t rowdata = glyph[row];
+      for (int col = c0; col < c1; col++) {
+        if (rowdata & (0x80 >> col))
+          p[x + col] = fg_be;
+        else if (opaque)
+          p[x + col] = bg_be;
+      }
+    }
+  }
+  return x - start_x;
+}
+
 // ── ST7365P Command set
 // ───────────────────────────────────────────────────────
 
@@ -418,6 +579,8 @@ void display_apply_clock(void) {
 }
 
 void display_init(void) {
+  font6x8_transpose();
+
   // Initialize PIO for SPI master
   uint offset = pio_add_program(LCD_PIO, &lcd_spi_program);
   pio_sm_config cfg_pio = lcd_spi_program_get_default_config(offset);
@@ -550,47 +713,108 @@ void display_clear(uint16_t color) {
 }
 
 void display_set_pixel(int x, int y, uint16_t color) {
-  if (x < 0 || x >= FB_WIDTH || y < 0 || y >= FB_HEIGHT)
+  if (x < s_clip_x0 || x >= s_clip_x1 || y < s_clip_y0 || y >= s_clip_y1)
     return;
   uint16_t be = (color >> 8) | (color << 8);
   s_framebuffer[y * FB_WIDTH + x] = be;
 }
 
+// ── Span core
+// ───────────────────────────────────────────────────────────────── Every
+// shape primitive below reduces to clipped horizontal / vertical runs of an
+// already byte-swapped colour, so the clip test is paid once per run instead
+// of once per pixel and long runs go out as 32-bit stores.
+
+// Fill n pixels at p: one 16-bit store to reach word alignment, then pairs.
+static inline void span_fill(uint16_t *p, int n, uint16_t be) {
+  if (n <= 0)
+    return;
+  if ((uintptr_t)p & 2) {
+    *p++ = be;
+    n--;
+  }
+  uint32_t c32 = ((uint32_t)be << 16) | be;
+  uint32_t *p32 = (uint32_t *)p;
+  int pairs = n >> 1;
+  while (pairs >= 4) {
+    p32[0] = c32;
+    p32[1] = c32;
+    p32[2] = c32;
+    p32[3] = c32;
+    p32 += 4;
+    pairs -= 4;
+  }
+  while (pairs-- > 0)
+    *p32++ = c32;
+  if (n & 1)
+    *(uint16_t *)p32 = be;
+}
+
+// Horizontal run x0..x1 inclusive (any order) on row y, clipped.
+static inline void hspan(int x0, int x1, int y, uint16_t be) {
+  if (y < s_clip_y0 || y >= s_clip_y1)
+    return;
+  if (x0 > x1) {
+    int t = x0;
+    x0 = x1;
+    x1 = t;
+  }
+  if (x0 < s_clip_x0)
+    x0 = s_clip_x0;
+  if (x1 >= s_clip_x1)
+    x1 = s_clip_x1 - 1;
+  if (x0 > x1)
+    return;
+  span_fill(&s_framebuffer[y * FB_WIDTH + x0], x1 - x0 + 1, be);
+}
+
+// Vertical run y0..y1 inclusive (any order) in column x, clipped.
+static inline void vspan(int x, int y0, int y1, uint16_t be) {
+  if (x < s_clip_x0 || x >= s_clip_x1)
+    return;
+  if (y0 > y1) {
+    int t = y0;
+    y0 = y1;
+    y1 = t;
+  }
+  if (y0 < s_clip_y0)
+    y0 = s_clip_y0;
+  if (y1 >= s_clip_y1)
+    y1 = s_clip_y1 - 1;
+  if (y0 > y1)
+    return;
+  uint16_t *p = &s_framebuffer[y0 * FB_WIDTH + x];
+  for (int y = y0; y <= y1; y++, p += FB_WIDTH)
+    *p = be;
+}
+
 void display_fill_rect(int x, int y, int w, int h, uint16_t color) {
-  if (x < 0) {
-    w += x;
-    x = 0;
-  }
-  if (y < 0) {
-    h += y;
-    y = 0;
-  }
-  if (x + w > FB_WIDTH)
-    w = FB_WIDTH - x;
-  if (y + h > FB_HEIGHT)
-    h = FB_HEIGHT - y;
+  if (x < s_clip_x0) {
+    w -= s_clip_x0 - x;
+    x = s_clip_x0;
+  }
+  if (y < s_clip_y0) {
+    h -= s_clip_y0 - y;
+    y = s_clip_y0;
+  }
+  if (x + w > s_clip_x1)
+    w = s_clip_x1 - x;
+  if (y + h > s_clip_y1)
+    h = s_clip_y1 - y;
   if (w <= 0 || h <= 0)
     return;
 
   uint16_t be = (color >> 8) | (color << 8);
 
-  // Optimize for full-width fills
+  // Full-width rows are contiguous: fill them as one span
   if (x == 0 && w == FB_WIDTH) {
-    uint32_t color32 = ((uint32_t)be << 16) | be;
-    uint32_t *fb32 = (uint32_t *)&s_framebuffer[y * FB_WIDTH];
-    size_t count32 = (w * h) / 2;
-    for (size_t i = 0; i < count32; i++) {
-      fb32[i] = color32;
-    }
+    span_fill(&s_framebuffer[y * FB_WIDTH], w * h, be);
     return;
   }
 
-  // Standard per-row fill
-  for (int row = y; row < y + h; row++) {
-    uint16_t *p = &s_framebuffer[row * FB_WIDTH + x];
-    for (int col = 0; col < w; col++)
-      p[col] = be;
-  }
+  uint16_t *p = &s_framebuffer[y * FB_WIDTH + x];
+  for (int row = 0; row < h; row++, p += FB_WIDTH)
+    span_fill(p, w, be);
 }
 
 void display_draw_rect(int x, int y, int w, int h, uint16_t color) {
@@ -600,39 +824,91 @@ void display_draw_rect(int x, int y, int w, int h, uint16_t color) {
   display_fill_rect(x + w - 1, y, 1, h, color);
 }
 
+// Bresenham, emitted as runs: an x-major line is a staircase of horizontal
+// spans, a y-major one of vertical spans.
 void display_draw_line(int x0, int y0, int x1, int y1, uint16_t color) {
-  // Bresenham's line algorithm
-  int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-  int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
-  int err = dx + dy, e2;
-  while (true) {
-    display_set_pixel(x0, y0, color);
-    if (x0 == x1 && y0 == y1)
-      break;
-    e2 = 2 * err;
-    if (e2 >= dy) {
-      err += dy;
-      x0 += sx;
+  uint16_t be = (color >> 8) | (color << 8);
+  if (y0 == y1) {
+    hspan(x0, x1, y0, be);
+    return;
+  }
+  if (x0 == x1) {
+    vspan(x0, y0, y1, be);
+    return;
+  }
+  // Trivial reject against the clip rect
+  if ((x0 < s_clip_x0 && x1 < s_clip_x0) ||
+      (x0 >= s_clip_x1 && x1 >= s_clip_x1) ||
+      (y0 < s_clip_y0 && y1 < s_clip_y0) ||
+      (y0 >= s_clip_y1 && y1 >= s_clip_y1))
+    return;
+
+  int dx = abs(x1 - x0), dy = abs(y1 - y0);
+  if (dx >= dy) {
+    if (x0 > x1) {
+      int t = x0;
+      x0 = x1;
+      x1 = t;
+      t = y0;
+      y0 = y1;
+      y1 = t;
     }
-    if (e2 <= dx) {
-      err += dx;
-      y0 += sy;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx >> 1, run = x0, y = y0;
+    for (int x = x0; x <= x1; x++) {
+      err -= dy;
+      if (err < 0 || x == x1) {
+        hspan(run, x, y, be);
+        y += sy;
+        err += dx;
+        run = x + 1;
+      }
+    }
+  } else {
+    if (y0 > y1) {
+      int t = x0;
+      x0 = x1;
+      x1 = t;
+      t = y0;
+      y0 = y1;
+      y1 = t;
+    }
+    int sx = x0 < x1 ? 1 : -1;
+    int err = dy >> 1, run = y0, x = x0;
+    for (int y = y0; y <= y1; y++) {
+      err -= dx;
+      if (err < 0 || y == y1) {
+        vspan(x, run, y, be);
+        x += sx;
+        err += dy;
+        run = y + 1;
+      }
     }
   }
 }
 
-// Midpoint circle algorithm (outline only)
+// The eight octant runs of a circle for one midpoint-x value `x`, covering
+// offsets ya..yb along the other axis.
+static void circle_runs(int cx, int cy, int x, int ya, int yb, uint16_t be) {
+  vspan(cx + x, cy + ya, cy + yb, be);
+  vspan(cx - x, cy + ya, cy + yb, be);
+  vspan(cx + x, cy - yb, cy - ya, be);
+  vspan(cx - x, cy - yb, cy - ya, be);
+  hspan(cx + ya, cx + yb, cy + x, be);
+  hspan(cx - yb, cx - ya, cy + x, be);
+  hspan(cx + ya, cx + yb, cy - x, be);
+  hspan(cx - yb, cx - ya, cy - x, be);
+}
+
+// Midpoint circle algorithm (outline only), flushed as one set of runs each
+// time x steps
 void display_draw_circle(int cx, int cy, int r, uint16_t color) {
-  int x = r, y = 0, d = 1 - r;
+  if (r < 0)
+    return;
+  uint16_t be = (color >> 8) | (color << 8);
+  int x = r, y = 0, d = 1 - r, run = 0;
   while (x >= y) {
-    display_set_pixel(cx + x, cy + y, color);
-    display_set_pixel(cx - x, cy + y, color);
-    display_set_pixel(cx + x, cy - y, color);
-    display_set_pixel(cx - x, cy - y, color);
-    display_set_pixel(cx + y, cy + x, color);
-    display_set_pixel(cx - y, cy + x, color);
-    display_set_pixel(cx + y, cy - x, color);
-    display_set_pixel(cx - y, cy - x, color);
+    int xr = x, yl = y;
     y++;
     if (d <= 0) {
       d += 2 * y + 1;
@@ -640,17 +916,22 @@ void display_draw_circle(int cx, int cy, int r, uint16_t color) {
       x--;
       d += 2 * (y - x) + 1;
     }
+    if (x != xr || x < y) {
+      circle_runs(cx, cy, xr, run, yl, be);
+      run = y;
+    }
   }
 }
 
 // Filled circle using horizontal spans
 void display_fill_circle(int cx, int cy, int r, uint16_t color) {
+  uint16_t be = (color >> 8) | (color << 8);
   int x = r, y = 0, d = 1 - r;
   while (x >= y) {
-    display_fill_rect(cx - x, cy + y, 2 * x + 1, 1, color);
-    display_fill_rect(cx - x, cy - y, 2 * x + 1, 1, color);
-    display_fill_rect(cx - y, cy + x, 2 * y + 1, 1, color);
-    display_fill_rect(cx - y, cy - x, 2 * y + 1, 1, color);
+    hspan(cx - x, cx + x, cy + y, be);
+    hspan(cx - x, cx + x, cy - y, be);
+    hspan(cx - y, cx + y, cy + x, be);
+    hspan(cx - y, cx + y, cy - x, be);
     y++;
     if (d <= 0) {
       d += 2 * y + 1;
@@ -661,7 +942,9 @@ void display_fill_circle(int cx, int cy, int r, uint16_t color) {
   }
 }
 
-// Fill a triangle using scanline algorithm
+// Fill a triangle with one span per row.  Edges are stepped in 16.16 fixed
+// point (64-bit so far off-screen vertices can't overflow), starting at the
+// first visible row rather than at the top vertex.
 void display_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2,
                            uint16_t color) {
   // Sort vertices by Y coordinate
@@ -693,122 +976,44 @@ void display_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2,
   // Degenerate: all same y
   if (y0 == y2) return;
 
-  float inv_dy02 = 1.0f / (float)(y2 - y0);  // long edge, always valid
-
-  if (y0 == y1) {
-    // Top-flat: both v0 and v1 at top, scan down to v2
-    for (int y = y0; y <= y2; y++) {
-      float t = (float)(y - y0) * inv_dy02;
-      int xa = x0 + (int)((x2 - x0) * t);  // v0->v2
-      int xb = x1 + (int)((x2 - x1) * t);  // v1->v2 (same span since y0==y1)
-      if (xa > xb) { int tmp = xa; xa = xb; xb = tmp; }
-      display_draw_line(xa, y, xb, y, color);
-    }
-  } else if (y1 == y2) {
-    // Bottom-flat: v0 at top, both v1 and v2 at bottom
-    float inv_dy01 = 1.0f / (float)(y1 - y0);
-    for (int y = y0; y <= y1; y++) {
-      float t = (float)(y - y0) * inv_dy01;
-      int xa = x0 + (int)((x1 - x0) * t);  // v0->v1
-      int xb = x0 + (int)((x2 - x0) * t);  // v0->v2 (same span since y1==y2)
-      if (xa > xb) { int tmp = xa; xa = xb; xb = tmp; }
-      display_draw_line(xa, y, xb, y, color);
-    }
-  } else {
-    // General: split at y1
-    float inv_dy01 = 1.0f / (float)(y1 - y0);
-    float inv_dy12 = 1.0f / (float)(y2 - y1);
+  int ys = y0 < s_clip_y0 ? s_clip_y0 : y0;
+  int ye = y2 >= s_clip_y1 ? s_clip_y1 - 1 : y2;
+  if (ys > ye)
+    return;
 
-    // Top half (y0 to y1): short edge v0->v1, long edge v0->v2
-    for (int y = y0; y <= y1; y++) {
-      float t_short = (float)(y - y0) * inv_dy01;
-      float t_long  = (float)(y - y0) * inv_dy02;
-      int xa = x0 + (int)((x1 - x0) * t_short);
-      int xb = x0 + (int)((x2 - x0) * t_long);
-      if (xa > xb) { int tmp = xa; xa = xb; xb = tmp; }
-      display_draw_line(xa, y, xb, y, color);
-    }
-    // Bottom half (y1 to y2): short edge v1->v2, long edge v0->v2
-    for (int y = y1; y <= y2; y++) {
-      float t_short = (float)(y - y1) * inv_dy12;
-      float t_long  = (float)(y - y0) * inv_dy02;
-      int xa = x1 + (int)((x2 - x1) * t_short);
-      int xb = x0 + (int)((x2 - x0) * t_long);
-      if (xa > xb) { int tmp = xa; xa = xb; xb = tmp; }
-      display_draw_line(xa, y, xb, y, color);
+  uint16_t be = (color >> 8) | (color << 8);
+  const int64_t half = 1 << 15; // round to nearest pixel
+
+  // Long edge v0->v2
+  int64_t dl = ((int64_t)(x2 - x0) * 65536) / (y2 - y0);
+  int64_t xl = ((int64_t)x0 * 65536) + half + dl * (ys - y0);
+
+  // Short edge: v0->v1 above y1, v1->v2 from y1 down
+  int64_t ds = 0, xs = 0;
+  for (int y = ys; y <= ye; y++) {
+    if (y == ys || y == y1) {
+      if (y < y1) {
+        ds = ((int64_t)(x1 - x0) * 65536) / (y1 - y0);
+        xs = ((int64_t)x0 * 65536) + half + ds * (y - y0);
+      } else {
+        ds = y2 > y1 ? ((int64_t)(x2 - x1) * 65536) / (y2 - y1) : 0;
+        xs = ((int64_t)x1 * 65536) + half + ds * (y - y1);
+      }
     }
+    hspan((int)(xl >> 16), (int)(xs >> 16), y, be);
+    xl += dl;
+    xs += ds;
   }
 }
 
 int display_draw_text(int x, int y, const char *text, uint16_t fg,
                       uint16_t bg) {
-  int start_x = x;
-  uint16_t fg_be = (fg >> 8) | (fg << 8);
-  uint16_t bg_be = (bg >> 8) | (bg << 8);
+  return text_draw(x, y, text, fg, bg, true);
+}
 
-  if (s_active_font == 1) {
-    // 8x12 font: row-major, MSB = leftmost pixel
-    while (*text) {
-      char c = *text++;
-      if (c < 0x20 || c > 0x7E) c = '?';
-      const uint8_t *glyph = s_font8x12[c - 0x20];
-      for (int row = 0; row < FONT8X12_H; row++) {
-        uint8_t rowdata = glyph[row];
-        int py = y + row;
-        if (py < 0 || py >= FB_HEIGHT) continue;
-        for (int col = 0; col < FONT8X12_W; col++) {
-          int px = x + col;
-          if (px >= 0 && px < FB_WIDTH) {
-            s_framebuffer[py * FB_WIDTH + px] =
-                (rowdata & (0x80 >> col)) ? fg_be : bg_be;
-          }
-        }
-      }
-      x += FONT8X12_W;
-    }
-  } else if (s_active_font == 2 || s_active_font == 3) {
-    // scientifica / scientifica-bold: row-major, MSB = leftmost pixel, 6x12
-    while (*text) {
-      char c = *text++;
-      if (c < 0x20 || c > 0x7E) c = '?';
-      const uint8_t *glyph = (s_active_font == 3)
-          ? font_scientifica_bold_glyph(c)
-          : font_scientifica_glyph(c);
-      for (int row = 0; row < FONT_SCI_HEIGHT; row++) {
-        uint8_t rowdata = glyph[row];
-        int py = y + row;
-        if (py < 0 || py >= FB_HEIGHT) continue;
-        for (int col = 0; col < FONT_SCI_WIDTH; col++) {
-          int px = x + col;
-          if (px >= 0 && px < FB_WIDTH) {
-            s_framebuffer[py * FB_WIDTH + px] =
-                (rowdata & (0x80 >> col)) ? fg_be : bg_be;
-          }
-        }
-      }
-      x += FONT_SCI_WIDTH;
-    }
-  } else {
-    // 6x8 font: column-major, LSB = top pixel
-    while (*text) {
-      char c = *text++;
-      if (c < 0x20 || c > 0x7E) c = '?';
-      const uint8_t *glyph = s_font6x8[c - 0x20];
-      for (int col = 0; col < FONT_W; col++) {
-        uint8_t coldata = glyph[col];
-        for (int row = 0; row < FONT_H; row++) {
-          int px = x + col;
-          int py = y + row;
-          if (px >= 0 && px < FB_WIDTH && py >= 0 && py < FB_HEIGHT) {
-            s_framebuffer[py * FB_WIDTH + px] =
-                (coldata & (1 << row)) ? fg_be : bg_be;
-          }
-        }
-      }
-      x += FONT_W;
-    }
-  }
-  return x - start_x;
+int display_draw_text_transparent(int x, int y, const char *text,
+                                  uint16_t fg) {
+  return text_draw(x, y, text, fg, 0, false);
 }
 
 int display_text_width(const char *text) {
@@ -824,11 +1029,11 @@ int display_text_width(const char *text) {
 void display_draw_image(int x, int y, int w, int h, const uint16_t *data) {
   for (int row = 0; row < h; row++) {
     int py = y + row;
-    if (py < 0 || py >= FB_HEIGHT)
+    if (py < s_clip_y0 || py >= s_clip_y1)
       continue;
     for (int col = 0; col < w; col++) {
       int px = x + col;
-      if (px < 0 || px >= FB_WIDTH)
+      if (px < s_clip_x0 || px >= s_clip_x1)
         continue;
       uint16_t c = data[row * w + col];
       s_framebuffer[py * FB_WIDTH + px] = (c >> 8) | (c << 8);
@@ -865,14 +1070,14 @@ void display_draw_image_partial(int x, int y, int img_w, int img_h,
 
   for (int row = 0; row < sh; row++) {
     int py = draw_y + row;
-    if (py < 0 || py >= FB_HEIGHT)
+    if (py < s_clip_y0 || py >= s_clip_y1)
       continue;
 
     int src_row = flip_y ? (sy + sh - 1 - row) : (sy + row);
 
     for (int col = 0; col < sw; col++) {
       int px = draw_x + col;
-      if (px < 0 || px >= FB_WIDTH)
+      if (px < s_clip_x0 || px >= s_clip_x1)
         continue;
 
       int src_col = flip_x ? (sx + sw - 1 - col) : (sx + col);
@@ -887,6 +1092,145 @@ void display_draw_image_partial(int x, int y, int img_w, int img_h,
   }
 }
 
+// ── Run-length keyed images
+// ──────────────────────────────────────────────────── Row r's runs live at
+// runs[rows[r]] .. runs[rows[r + 1]] as {skip, len, len pixels} records,
+// skip counted from the end of the previous run.  Pixels are stored
+// byte-swapped so a run is a straight copy into the framebuffer.
+
+display_rle_image_t *display_rle_encode(const uint16_t *data, int w, int h,
+                                        uint16_t key) {
+  if (!data || w <= 0 || h <= 0 || w > 0xFFFF)
+    return NULL;
+
+  // Pass 1: size the run stream
+  size_t total = 0;
+  for (int row = 0; row < h; row++) {
+    const uint16_t *src = data + (size_t)row * w;
+    for (int col = 0; col < w;) {
+      while (col < w && src[col] == key)
+        col++;
+      if (col == w)
+        break;
+      int start = col;
+      while (col < w && src[col] != key)
+        col++;
+      total += 2 + (col - start);
+    }
+  }
+
+  size_t rows_bytes = (size_t)(h + 1) * sizeof(uint32_t);
+  display_rle_image_t *img = (display_rle_image_t *)umm_malloc(
+      sizeof(display_rle_image_t) + rows_bytes + total * sizeof(uint16_t));
+  if (!img)
+    return NULL;
+  img->w = w;
+  img->h = h;
+  img->key = key;
+  img->rows = (uint32_t *)(img + 1);
+  img->runs = (uint16_t *)((uint8_t *)img->rows + rows_bytes);
+
+  // Pass 2: emit
+  uint32_t pos = 0;
+  for (int row = 0; row < h; row++) {
+    const uint16_t *src = data + (size_t)row * w;
+    img->rows[row] = pos;
+    int prev_end = 0;
+    for (int col = 0; col < w;) {
+      while (col < w && src[col] == key)
+        col++;
+      if (col == w)
+        break;
+      int start = col;
+      while (col < w && src[col] != key)
+        col++;
+      img->runs[pos++] = (uint16_t)(start - prev_end);
+      img->runs[pos++] = (uint16_t)(col - start);
+      for (int i = start; i < col; i++)
+        img->runs[pos++] = (src[i] >> 8) | (src[i] << 8);
+      prev_end = col;
+    }
+  }
+  img->rows[h] = pos;
+  return img;
+}
+
+void display_rle_free(display_rle_image_t *img) {
+  if (img)
+    umm_free(img);
+}
+
+void display_draw_rle(int x, int y, const display_rle_image_t *img, int sx,
+                      int sy, int sw, int sh, bool flip_x, bool flip_y) {
+  if (sx < 0) {
+    sw += sx;
+    sx = 0;
+  }
+  if (sy < 0) {
+    sh += sy;
+    sy = 0;
+  }
+  if (sx + sw > img->w)
+    sw = img->w - sx;
+  if (sy + sh > img->h)
+    sh = img->h - sy;
+  if (sw <= 0 || sh <= 0)
+    return;
+
+  // Visible destination rows, and the source columns that can land inside
+  // the clip rect (mirrored when flipping).
+  int r0 = s_clip_y0 - y, r1 = s_clip_y1 - y;
+  if (r0 < 0)
+    r0 = 0;
+  if (r1 > sh)
+    r1 = sh;
+  int c0 = s_clip_x0 - x, c1 = s_clip_x1 - x; // destination offsets
+  if (c0 < 0)
+    c0 = 0;
+  if (c1 > sw)
+    c1 = sw;
+  if (r0 >= r1 || c0 >= c1)
+    return;
+  int s0 = flip_x ? sx + sw - c1 : sx + c0; // source column window
+  int s1 = flip_x ? sx + sw - c0 : sx + c1;
+
+  for (int row = r0; row < r1; row++) {
+    int src_row = flip_y ? (sy + sh - 1 - row) : (sy + row);
+    const uint16_t *run = img->runs + img->rows[src_row];
+    const uint16_t *end = img->runs + img->rows[src_row + 1];
+    uint16_t *dst_row = &s_framebuffer[(y + row) * FB_WIDTH];
+    int pos = 0;
+
+    while (run < end) {
+      pos += run[0];
+      int len = run[1];
+      const uint16_t *px = run + 2;
+      run = px + len;
+      if (pos >= s1)
+        break;
+      int a = pos, b = pos + len;
+      pos = b;
+      if (b <= s0)
+        continue;
+      if (a < s0) {
+        px += s0 - a;
+        a = s0;
+      }
+      if (b > s1)
+        b = s1;
+
+      if (!flip_x) {
+        memcpy(&dst_row[x + a - sx], px, (size_t)(b - a) * sizeof(uint16_t));
+      } else {
+        // Source column c lands at x + (sx + sw - 1 - c)
+        uint16_t *d = &dst_row[x + sx + sw - 1 - a];
+        for (int n = b - a; n > 0; n--)
+          *d-- = *px++;
+      }
+    }
+  }
+}
+
 void display_draw_image_scaled(int x, int y, int img_w, int img_h,
                                const uint16_t *data, float scale, float angle,
                                uint16_t transparent_color) {
@@ -925,15 +1269,17 @@ void display_draw_image_scaled(int x, int y, int img_w, int img_h,
     if (ty > max_y) max_y = ty;
   }
 
-  // Clamp to framebuffer bounds
+  // Clamp to the clip rect
   int bx = (int)floorf(min_x);
   int by = (int)floorf(min_y);
-  int bw = (int)ceilf(max_x - min_x);
-  int bh = (int)ceilf(max_y - min_y);
-  if (bx < 0) bx = 0;
-  if (by < 0) by = 0;
-  if (bx + bw > FB_WIDTH) bw = FB_WIDTH - bx;
-  if (by + bh > FB_HEIGHT) bh = FB_HEIGHT - by;
+  int bx1 = (int)ceilf(max_x);
+  int by1 = (int)ceilf(max_y);
+  if (bx < s_clip_x0) bx = s_clip_x0;
+  if (by < s_clip_y0) by = s_clip_y0;
+  if (bx1 > s_clip_x1) bx1 = s_clip_x1;
+  if (by1 > s_clip_y1) by1 = s_clip_y1;
+  int bw = bx1 - bx;
+  int bh = by1 - by;
   if (bw <= 0 || bh <= 0) return;
 
   // Byte-swap only the affected region
@@ -944,13 +1290,16 @@ void display_draw_image_scaled(int x, int y, int img_w, int img_h,
     }
   }
 
-  // Use masked version if transparency is enabled, otherwise use regular version
+  // Render into a strided view of just the clamped region so TGX cannot
+  // touch pixels outside the clip rect (or outside the swapped area).
+  uint16_t *view = &fb[by * FB_WIDTH + bx];
   if (transparent_color != 0) {
-    tgx_draw_image_scaled_masked(fb, FB_WIDTH, FB_HEIGHT, data, img_w, img_h, (int)cx, (int)cy,
+    tgx_draw_image_scaled_masked(view, bw, bh, FB_WIDTH, data, img_w, img_h,
+                                  (int)cx - bx, (int)cy - by,
                                   scale, angle, transparent_color);
   } else {
-    tgx_draw_image_scaled(fb, FB_WIDTH, FB_HEIGHT, data, img_w, img_h, (int)cx, (int)cy,
-                          scale, angle);
+    tgx_draw_image_scaled(view, bw, bh, FB_WIDTH, data, img_w, img_h,
+                          (int)cx - bx, (int)cy - by, scale, angle);
   }
 
   // Byte-swap back only the affected region
@@ -1035,6 +1384,11 @@ void display_blit_be(int x, int y, const uint16_t *data, int w, int h) {
   if (dst_x + (src_x1 - src_x0) > FB_WIDTH)  src_x1 = src_x0 + (FB_WIDTH - dst_x);
   if (dst_y + (src_y1 - src_y0) > FB_HEIGHT) src_y1 = src_y0 + (FB_HEIGHT - dst_y);
 
+  if (dst_x < s_clip_x0) { src_x0 += s_clip_x0 - dst_x; dst_x = s_clip_x0; }
+  if (dst_y < s_clip_y0) { src_y0 += s_clip_y0 - dst_y; dst_y = s_clip_y0; }
+  if (dst_x + (src_x1 - src_x0) > s_clip_x1) src_x1 = src_x0 + (s_clip_x1 - dst_x);
+  if (dst_y + (src_y1 - src_y0) > s_clip_y1) src_y1 = src_y0 + (s_clip_y1 - dst_y);
+
   int copy_w = src_x1 - src_x0;
   int copy_h = src_y1 - src_y0;
   if (copy_w <= 0 || copy_h <= 0)
@@ -1065,10 +1419,10 @@ void display_draw_image_scaled_nn(int x, int y, const uint16_t *data,
     return;
 
   // Calculate actual drawing bounds
-  int start_x = draw_x < 0 ? -draw_x : 0;
-  int start_y = draw_y < 0 ? -draw_y : 0;
-  int end_x = (draw_x + dst_w > FB_WIDTH) ? FB_WIDTH - draw_x : dst_w;
-  int end_y = (draw_y + dst_h > FB_HEIGHT) ? FB_HEIGHT - draw_y : dst_h;
+  int start_x = draw_x < s_clip_x0 ? s_clip_x0 - draw_x : 0;
+  int start_y = draw_y < s_clip_y0 ? s_clip_y0 - draw_y : 0;
+  int end_x = (draw_x + dst_w > s_clip_x1) ? s_clip_x1 - draw_x : dst_w;
+  int end_y = (draw_y + dst_h > s_clip_y1) ? s_clip_y1 - draw_y : dst_h;
 
   if (end_x <= start_x || end_y <= start_y)
     return;
@@ -1136,6 +1490,10 @@ void display_flush(void) {
   int front_buffer_idx = s_back_buffer_idx;
   s_back_buffer_idx = 1 - s_back_buffer_idx;
   s_framebuffer = s_framebuffers[s_back_buffer_idx];
+  // The new back buffer holds the frame before last; the whole screen is
+  // about to be sent, so any pending dirty rects are moot.
+  s_back_in_sync = false;
+  s_dirty_count = 0;
 
   lcd_set_window(0, 0, FB_WIDTH - 1, FB_HEIGHT - 1);
 
@@ -1185,6 +1543,7 @@ void display_flush_region(int y0, int y1) {
   int front_buffer_idx = s_back_buffer_idx;
   s_back_buffer_idx = 1 - s_back_buffer_idx;
   s_framebuffer = s_framebuffers[s_back_buffer_idx];
+  s_back_in_sync = false;
 
   // Set partial window
   lcd_set_window(0, y0, FB_WIDTH - 1, y1);
@@ -1241,6 +1600,189 @@ void display_flush_rows(int y0, int y1) {
   // Non-blocking: no buffer swap — caller uses display_flush() for that.
 }
 
+void display_flush_rects(const display_rect_t *rects, int count) {
+  if (!rects || count <= 0)
+    return;
+
+  if (s_dma_active) {
+    dma_channel_wait_for_finish_blocking(s_dma_chan);
+    lcd_spi_wait_idle();
+    lcd_cs_high();
+    s_dma_active = false;
+  }
+
+  int front_buffer_idx = s_back_buffer_idx;
+  s_back_buffer_idx = 1 - s_back_buffer_idx;
+  s_framebuffer = s_framebuffers[s_back_buffer_idx];
+  const uint16_t *front = s_framebuffers[front_buffer_idx];
+  uint16_t *back = s_framebuffer;
+
+  bool covers_screen = false;
+  for (int i = 0; i < count; i++) {
+    int x0 = rects[i].x, y0 = rects[i].y;
+    int x1 = x0 + rects[i].w, y1 = y0 + rects[i].h;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > FB_WIDTH) x1 = FB_WIDTH;
+    if (y1 > FB_HEIGHT) y1 = FB_HEIGHT;
+    if (x0 >= x1 || y0 >= y1)
+      continue;
+    int w = x1 - x0;
+    int h = y1 - y0;
+    if (w == FB_WIDTH && h == FB_HEIGHT)
+      covers_screen = true;
+
+    // Each rect is its own RAMWR window; the previous one must be fully
+    // clocked out before CASET/RASET are sent.
+    if (s_dma_active) {
+      dma_channel_wait_for_finish_blocking(s_dma_chan);
+      lcd_spi_wait_idle();
+      lcd_cs_high();
+      s_dma_active = false;
+    }
+
+    lcd_set_window(x0, y0, x1 - 1, y1 - 1);
+    lcd_cs_low();
+    lcd_dc_data();
+
+    if (w == FB_WIDTH) {
+      // Rows are contiguous in the framebuffer: one transfer.
+      dma_channel_set_read_addr(s_dma_chan, &front[y0 * FB_WIDTH], false);
+      dma_channel_set_trans_count(s_dma_chan, w * h * sizeof(uint16_t), true);
+    } else {
+      // The LCD auto-advances within the window, so rows are streamed
+      // back-to-back with CS held low.  Only the last row is left in flight.
+      for (int row = y0; row < y1; row++) {
+        if (row > y0)
+          dma_channel_wait_for_finish_blocking(s_dma_chan);
+        dma_channel_set_read_addr(s_dma_chan, &front[row * FB_WIDTH + x0],
+                                  false);
+        dma_channel_set_trans_count(s_dma_chan, w * sizeof(uint16_t), true);
+      }
+    }
+    s_dma_active = true;
+
+    // Keep the new back buffer identical to the screen inside this rect.
+    for (int row = y0; row < y1; row++)
+      memcpy(&back[row * FB_WIDTH + x0], &front[row * FB_WIDTH + x0],
+             w * sizeof(uint16_t));
+  }
+
+  s_back_in_sync = s_back_in_sync || covers_screen;
+  s_dirty_count = 0;
+
+  if (g_display_flush_blocking)
+    display_wait_for_flush();
+}
+
+// Area of the bounding box of a and b.
+static int dirty_union_area(const display_rect_t *a, const display_rect_t *b) {
+  int x0 = a->x < b->x ? a->x : b->x;
+  int y0 = a->y < b->y ? a->y : b->y;
+  int x1 = (a->x + a->w) > (b->x + b->w) ? (a->x + a->w) : (b->x + b->w);
+  int y1 = (a->y + a->h) > (b->y + b->h) ? (a->y + a->h) : (b->y + b->h);
+  return (x1 - x0) * (y1 - y0);
+}
+
+static void dirty_union(display_rect_t *a, const display_rect_t *b) {
+  int x0 = a->x < b->x ? a->x : b->x;
+  int y0 = a->y < b->y ? a->y : b->y;
+  int x1 = (a->x + a->w) > (b->x + b->w) ? (a->x + a->w) : (b->x + b->w);
+  int y1 = (a->y + a->h) > (b->y + b->h) ? (a->y + a->h) : (b->y + b->h);
+  a->x = x0;
+  a->y = y0;
+  a->w = x1 - x0;
+  a->h = y1 - y0;
+}
+
+// Merge two rects when their union wastes little area — each extra rect
+// costs a window setup, so near-neighbours are cheaper sent together.
+#define DIRTY_MERGE_SLACK 1024
+
+static bool dirty_should_merge(const display_rect_t *a,
+                               const display_rect_t *b) {
+  int u = dirty_union_area(a, b);
+  return u <= a->w * a->h + b->w * b->h + DIRTY_MERGE_SLACK;
+}
+
+void display_add_dirty_rect(int x, int y, int w, int h) {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > FB_WIDTH) w = FB_WIDTH - x;
+  if (y + h > FB_HEIGHT) h = FB_HEIGHT - y;
+  if (w <= 0 || h <= 0)
+    return;
+
+  display_rect_t r = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+
+  // Absorb any existing rect the new one merges with; repeat since the
+  // grown rect may now reach others.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (int i = 0; i < s_dirty_count; i++) {
+      if (dirty_should_merge(&r, &s_dirty_rects[i])) {
+        dirty_union(&r, &s_dirty_rects[i]);
+        s_dirty_rects[i] = s_dirty_rects[--s_dirty_count];
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (s_dirty_count < DISPLAY_MAX_DIRTY_RECTS) {
+    s_dirty_rects[s_dirty_count++] = r;
+    return;
+  }
+
+  // List full: fold into whichever rect grows the least.
+  int best = 0;
+  int best_cost = 0x7FFFFFFF;
+  for (int i = 0; i < s_dirty_count; i++) {
+    int cost = dirty_union_area(&r, &s_dirty_rects[i]) -
+               s_dirty_rects[i].w * s_dirty_rects[i].h;
+    if (cost < best_cost) {
+      best_cost = cost;
+      best = i;
+    }
+  }
+  dirty_union(&s_dirty_rects[best], &r);
+}
+
+int display_get_dirty_rects(const display_rect_t **out) {
+  if (out)
+    *out = s_dirty_rects;
+  return s_dirty_count;
+}
+
+void display_clear_dirty_rects(void) { s_dirty_count = 0; }
+
+void display_flush_dirty(void) {
+  if (s_dirty_count == 0)
+    return;
+  display_flush_rects(s_dirty_rects, s_dirty_count);
+}
+
+bool display_back_buffer_in_sync(void) { return s_back_in_sync; }
+
+void display_set_clip_rect(int x, int y, int w, int h) {
+  int x1 = x + w, y1 = y + h;
+  s_clip_x0 = x < 0 ? 0 : x;
+  s_clip_y0 = y < 0 ? 0 : y;
+  s_clip_x1 = x1 > FB_WIDTH ? FB_WIDTH : x1;
+  s_clip_y1 = y1 > FB_HEIGHT ? FB_HEIGHT : y1;
+  // An empty clip rect draws nothing rather than everything.
+  if (s_clip_x1 < s_clip_x0) s_clip_x1 = s_clip_x0;
+  if (s_clip_y1 < s_clip_y0) s_clip_y1 = s_clip_y0;
+}
+
+void display_clear_clip_rect(void) {
+  s_clip_x0 = 0;
+  s_clip_y0 = 0;
+  s_clip_x1 = FB_WIDTH;
+  s_clip_y1 = FB_HEIGHT;
+}
+
 void display_set_brightness(uint8_t brightness) {
   // Backlight is controlled by the STM32 keyboard MCU (kbd_set_backlight).
   // This function is a no-op on PicoCalc v2.0.
@@ -1274,6 +1816,7 @@ void display_darken(void) {
     front[i] = darkened;
     back[i] = darkened;
   }
+  s_back_in_sync = true;
 }
 
 // =============================================================================
@@ -55,6 +55,8 @@ void display_fill_circle(int cx, int cy, int r, uint16_t color);
 // Text rendering using the active bitmap font (default: 6x8)
 // Returns pixel width of the rendered text
 int display_draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg);
+// As display_draw_text, but leaves background pixels untouched
+int display_draw_text_transparent(int x, int y, const char *text, uint16_t fg);
 int display_text_width(const char *text);
 
 // Font selection: 0 = 6x8 (default), 1 = 8x12, 2 = scientifica 6x12, 3 = scientifica-bold 6x12
@@ -77,6 +79,26 @@ void display_draw_image_partial(int x, int y, int img_w, int img_h,
                                 int sh, bool flip_x, bool flip_y,
                                 uint16_t transparent_color);
 
+// Run-length keyed image: the same pixels as a keyed image, with every run
+// of the key colour dropped so blits copy opaque runs without a per-pixel
+// compare.  Built once from immutable pixel data; valid only while `key` is
+// the transparent colour the caller would otherwise pass.
+typedef struct {
+  int w, h;
+  uint16_t key;    // RGB565 colour removed at encode time
+  uint32_t *rows;  // h + 1 offsets into runs
+  uint16_t *runs;  // {skip, len, len byte-swapped pixels} records per row
+} display_rle_image_t;
+
+// Encode w x h native-endian pixels; one PSRAM allocation, NULL on OOM.
+display_rle_image_t *display_rle_encode(const uint16_t *data, int w, int h,
+                                        uint16_t key);
+void display_rle_free(display_rle_image_t *img);
+
+// Same contract as display_draw_image_partial, minus the transparent colour.
+void display_draw_rle(int x, int y, const display_rle_image_t *img, int sx,
+                      int sy, int sw, int sh, bool flip_x, bool flip_y);
+
 // Draw a scaled/rotated image to the framebuffer at (x, y).
 // transparent_color: 0 = use global setting, otherwise RGB565 color to treat as transparent.
 void display_draw_image_scaled(int x, int y, int img_w, int img_h,
@@ -124,6 +146,37 @@ void display_flush_region(int y0, int y1);
 // partial screen updates (status bars, emulator viewports, etc.).
 void display_flush_rows(int y0, int y1);
 
+// Screen-space rectangle used by the dirty-rect and clipping APIs.
+typedef struct {
+  int16_t x, y, w, h;
+} display_rect_t;
+
+// Swap buffers and push only the given rectangles to the LCD, each through
+// its own CASET/RASET window.  The flushed rectangles are copied into the new
+// back buffer so both buffers stay identical inside them.  Full-width rects
+// go out as a single DMA transfer; narrower rects are streamed row by row.
+void display_flush_rects(const display_rect_t *rects, int count);
+
+// Dirty-rect accumulator.  Rectangles are merged into a small list (adjacent
+// or overlapping rects are unioned) and pushed by display_flush_dirty().
+// display_flush() discards the list since it transfers the whole screen.
+#define DISPLAY_MAX_DIRTY_RECTS 16
+void display_add_dirty_rect(int x, int y, int w, int h);
+int display_get_dirty_rects(const display_rect_t **out);
+void display_clear_dirty_rects(void);
+void display_flush_dirty(void);
+
+// True when the back buffer holds exactly what is on screen, i.e. the last
+// buffer swap was a display_flush_rects()/display_flush_dirty() that copied
+// its rects back.  Partial compositors must redraw everything when false.
+bool display_back_buffer_in_sync(void);
+
+// Clip rectangle applied to drawing primitives, text and image blits (the
+// display_draw_image_nn emulator fast path and the effects are unclipped).
+// Defaults to the full screen; display_clear_clip_rect() restores that.
+void display_set_clip_rect(int x, int y, int w, int h);
+void display_clear_clip_rect(void);
+
 // Block until any in-flight DMA flush completes.
 // Does NOT swap buffers or start a new transfer.
 void display_wait_for_flush(void);
@@ -1,9 +1,11 @@
 #include "fileplayer.h"
-#include "audio.h"
+#include "audio_mixer.h"
 #include "../hardware.h"
 #include "sdcard.h"
 #include "ff.h"       // direct FatFS calls for non-blocking SD reads
 #include "pico/stdlib.h"
+#include "pico/platform.h"
+#include "hardware/sync.h"
 #include "mp3_player.h"
 #include "umm_malloc.h"
 
@@ -11,7 +13,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#define WAV_BUFFER_SIZE FILEPLAYER_BUFFER_SIZE
+// Largest single refill.  Reads are sized to end on a sector boundary so
+// FatFS hands whole sectors straight to the card driver (multi-block reads,
+// no sector bounce) instead of splitting off a partial one.
+#define READ_CHUNK_MAX  (32 * 1024)
+#define READ_CHUNK_MIN  2048
+#define SECTOR_BYTES    512
 
 static fileplayer_t s_players[FILEPLAYER_MAX_INSTANCES];
 static fileplayer_t *s_active_player = NULL;
@@ -20,12 +27,154 @@ static uint8_t s_volume_l = 100;
 static uint8_t s_volume_r = 100;
 static bool s_initialized = false;
 static sdfile_t s_current_file = NULL;
-static uint8_t *s_wav_buffer = NULL;
 static volatile bool s_underflow = false;
 
+// File bytes of the WAV data chunk.
+static uint32_t s_data_offset = 44;
+static uint32_t s_data_end = 44;
+static uint32_t s_file_pos = 44;
+
+// Read-ahead ring holding the file's own 16-bit PCM, mono or stereo.  f_read
+// lands directly in it and the mixer voice applies volume while resampling,
+// so samples are never copied or converted on the way.  At EOF the voice
+// keeps playing until the ring is empty, then drops out by itself.
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;                // bytes, power of two
+    volatile uint32_t wr;         // free-running byte counters
+    volatile uint32_t rd;
+    uint32_t step;                // 16.16 source frames per output frame
+    uint32_t frac;
+    volatile int32_t gain_l;      // 256 = unity
+    volatile int32_t gain_r;
+    uint8_t frame_bytes;          // 2 mono, 4 stereo
+    volatile uint32_t underruns;
+    volatile uint32_t low_water;
+    uint32_t sd_busy;
+} wav_stream_t;
+
+static wav_stream_t s_stream;
+static volatile bool s_draining = false;
+
+static inline void stream_ran_dry(void) {
+    s_stream.underruns++;
+    s_underflow = true;
+}
+
+static bool __time_critical_func(fileplayer_voice_render)(void *ctx, int32_t *mix, int frames) {
+    wav_stream_t *st = (wav_stream_t *)ctx;
+    uint32_t rd = st->rd;
+    uint32_t level = st->wr - rd;
+    __dmb();
+    uint32_t fb = st->frame_bytes;
+    uint32_t avail = level / fb;
+    if (avail == 0) {
+        if (s_draining)
+            return false;
+        stream_ran_dry();
+        return true;
+    }
+
+    const uint8_t *buf = st->buf;
+    uint32_t mask = st->size - 1;
+    uint32_t step = st->step;
+    uint32_t frac = st->frac;
+    int32_t gl = st->gain_l, gr = st->gain_r;
+    uint32_t used = 0;
+    int i = 0;
+
+    if (fb == 2) {
+        // Mono: one load feeds both channels
+        for (; i < frames && used < avail; i++) {
+            int32_t v = *(const int16_t *)(buf + ((rd + used * 2) & mask));
+            mix[i * 2] += (v * gl) >> 8;
+            mix[i * 2 + 1] += (v * gr) >> 8;
+            frac += step;
+            used += frac >> 16;
+            frac &= 0xFFFF;
+        }
+    } else {
+        for (; i < frames && used < avail; i++) {
+            const int16_t *f = (const int16_t *)(buf + ((rd + used * 4) & mask));
+            mix[i * 2] += (f[0] * gl) >> 8;
+            mix[i * 2 + 1] += (f[1] * gr) >> 8;
+            frac += step;
+            used += frac >> 16;
+            frac &= 0xFFFF;
+        }
+    }
+    if (i < frames && !s_draining)
+        stream_ran_dry();
+    if (used > avail)
+        used = avail;
+    st->frac = frac;
+    st->rd = rd + used * fb;
+
+    level -= used * fb;
+    if (level < st->low_water)
+        st->low_water = level;
+    return true;
+}
+
+static void stream_set_gain(void) {
+    s_stream.gain_l = (int32_t)s_volume_l * 256 / 100;
+    s_stream.gain_r = (int32_t)s_volume_r * 256 / 100;
+}
+
+static uint32_t buffer_size_for(uint32_t bytes) {
+    if (bytes < FILEPLAYER_BUFFER_MIN) bytes = FILEPLAYER_BUFFER_MIN;
+    if (bytes > FILEPLAYER_BUFFER_MAX) bytes = FILEPLAYER_BUFFER_MAX;
+    uint32_t size = FILEPLAYER_BUFFER_MIN;
+    while (size < bytes)
+        size <<= 1;
+    return size;
+}
+
+// (Re)allocates the ring for this player's requested size.  A failed grow
+// keeps the ring we already have.
+static bool stream_alloc(uint32_t bytes) {
+    uint32_t size = buffer_size_for(bytes);
+    if (s_stream.buf && s_stream.size == size)
+        return true;
+    uint8_t *buf = umm_malloc(size);
+    if (!buf) {
+        printf("[FILEPLAYER] FAILED to alloc %lu-byte ring\n", (unsigned long)size);
+        return s_stream.buf != NULL;
+    }
+    if (s_stream.buf)
+        umm_free(s_stream.buf);
+    s_stream.buf = buf;
+    s_stream.size = size;
+    return true;
+}
+
+// Empties the ring, starting it at the same offset within a sector as
+// file_pos so that reads which stop at the ring's end also stop on a sector
+// boundary of the file.
+static void stream_align(uint32_t file_pos) {
+    uint32_t start = file_pos % SECTOR_BYTES;
+    if (!s_stream.frame_bytes || start % s_stream.frame_bytes)
+        start = 0;
+    s_stream.wr = start;
+    s_stream.rd = start;
+    s_stream.frac = 0;
+}
+
+static void stream_reset(uint8_t channels) {
+    s_stream.frame_bytes = channels == 1 ? 2 : 4;
+    s_stream.step = (uint32_t)(((uint64_t)s_sample_rate << 16) / AUDIO_MIXER_RATE);
+    stream_align(s_data_offset);
+    s_stream.underruns = 0;
+    s_stream.low_water = s_stream.size;
+    s_stream.sd_busy = 0;
+    stream_set_gain();
+}
+
+// Walks the RIFF chunks (LIST, fact, etc. may precede data) and leaves the
+// data chunk's file range in s_data_offset / s_data_end.
 static bool parse_wav_header(sdfile_t f, uint32_t *sample_rate, uint16_t *channels, uint16_t *bits_per_sample, uint32_t *data_size) {
-    uint8_t header[44];
-    if (sdcard_fread(f, header, 44) < 44) {
+    uint8_t header[24];
+    if (sdcard_fread(f, header, 12) < 12) {
         return false;
     }
 
@@ -33,22 +182,34 @@ static bool parse_wav_header(sdfile_t f, uint32_t *sample_rate, uint16_t *channe
         return false;
     }
 
+    int file_size = sdcard_fsize_handle(f);
     uint32_t pos = 12;
-    while (pos + 8 < 44) {
-        uint32_t chunk_id = *(uint32_t *)(header + pos);
-        uint32_t chunk_size = *(uint32_t *)(header + pos + 4);
-
-        if (chunk_id == *(uint32_t *)"fmt ") {
-            *channels = *(uint16_t *)(header + pos + 10);
-            *sample_rate = *(uint32_t *)(header + pos + 12);
-            *bits_per_sample = *(uint16_t *)(header + pos + 22);
-        } else if (chunk_id == *(uint32_t *)"data") {
+    bool have_fmt = false;
+    while (sdcard_fseek(f, pos) && sdcard_fread(f, header, 8) == 8) {
+        uint32_t chunk_size = *(uint32_t *)(header + 4);
+
+        if (memcmp(header, "fmt ", 4) == 0) {
+            if (chunk_size < 16 || sdcard_fread(f, header + 8, 16) < 16)
+                return false;
+            uint16_t format = *(uint16_t *)(header + 8);
+            if (format != 1 && format != 0xFFFE)
+                return false;
+            *channels = *(uint16_t *)(header + 10);
+            *sample_rate = *(uint32_t *)(header + 12);
+            *bits_per_sample = *(uint16_t *)(header + 22);
+            have_fmt = true;
+        } else if (memcmp(header, "data", 4) == 0) {
+            if (!have_fmt)
+                return false;
+            s_data_offset = pos + 8;
+            if (file_size > 0 && s_data_offset + chunk_size > (uint32_t)file_size)
+                chunk_size = (uint32_t)file_size - s_data_offset;
             *data_size = chunk_size;
+            s_data_end = s_data_offset + chunk_size;
             return true;
         }
 
-        pos += 8 + chunk_size;
-        if (chunk_size % 2 != 0) pos++;
+        pos += 8 + chunk_size + (chunk_size & 1);
     }
 
     return false;
@@ -83,8 +244,7 @@ static fileplayer_type_t detect_file_type(sdfile_t f) {
 
 void fileplayer_reset(void) {
     if (!s_initialized) return;
-    if (s_active_player && s_active_player->state == FILEPLAYER_STATE_PLAYING)
-        audio_stop_stream();
+    audio_mixer_remove_voice(fileplayer_voice_render, &s_stream);
     if (s_current_file) {
         sdcard_fclose(s_current_file);
         s_current_file = NULL;
@@ -97,9 +257,9 @@ void fileplayer_reset(void) {
 void fileplayer_init(void) {
     if (s_initialized) return;
 
-    printf("[FILEPLAYER] Allocating WAV buffer (%d bytes)...\n", WAV_BUFFER_SIZE);
-    s_wav_buffer = umm_malloc(WAV_BUFFER_SIZE);
-    printf("[FILEPLAYER] WAV buffer allocated: %s\n", s_wav_buffer ? "OK" : "FAILED");
+    printf("[FILEPLAYER] Allocating read-ahead ring (%d bytes)...\n", FILEPLAYER_BUFFER_SIZE);
+    stream_alloc(FILEPLAYER_BUFFER_SIZE);
+    printf("[FILEPLAYER] Read-ahead ring allocated: %s\n", s_stream.buf ? "OK" : "FAILED");
 
     memset(s_players, 0, sizeof(s_players));
 
@@ -112,6 +272,7 @@ fileplayer_t *fileplayer_create(void) {
             memset(&s_players[i], 0, sizeof(fileplayer_t));
             s_players[i].volume = 100;
             s_players[i].channels = 2;
+            s_players[i].buffer_size = FILEPLAYER_BUFFER_SIZE;
             return &s_players[i];
         }
     }
@@ -167,6 +328,13 @@ bool fileplayer_load(fileplayer_t *player, const char *path) {
         return false;
     }
 
+    if (bits != 16 || wav_channels < 1 || wav_channels > 2 || sample_rate == 0) {
+        sdcard_fclose(s_current_file);
+        s_current_file = NULL;
+        printf("fileplayer: only 16-bit mono/stereo PCM is supported\n");
+        return false;
+    }
+
     s_sample_rate = sample_rate;
     player->channels = wav_channels;
     player->length = data_size / (wav_channels * bits / 8);
@@ -182,16 +350,21 @@ bool fileplayer_play(fileplayer_t *player, uint8_t repeat_count) {
     (void)repeat_count;
     if (!player || !s_current_file) return false;
 
-    player->state = FILEPLAYER_STATE_PLAYING;
-    s_active_player = player;
-
-    // Use the PCM streaming API — its ISR runs on Core 1 via s_core1_alarm_pool,
-    // eliminating the 44.1kHz timer ISR that used to preempt Core 0.
-    audio_start_stream(s_sample_rate);
+    audio_mixer_remove_voice(fileplayer_voice_render, &s_stream);
+    if (!stream_alloc(player->buffer_size)) return false;
+    stream_reset(player->channels);
+    s_draining = false;
+    s_underflow = false;
 
-    sdcard_fseek(s_current_file, 44);
+    s_file_pos = s_data_offset;
+    sdcard_fseek(s_current_file, s_file_pos);
     player->position = 0;
 
+    player->state = FILEPLAYER_STATE_PLAYING;
+    s_active_player = player;
+
+    // Mixed by the DMA ISR on Core 1; fileplayer_update() keeps the ring fed.
+    audio_mixer_add_voice(fileplayer_voice_render, &s_stream);
     return true;
 }
 
@@ -214,7 +387,7 @@ void fileplayer_stop(fileplayer_t *player) {
     }
 
     if (!any_playing)
-        audio_stop_stream();
+        audio_mixer_remove_voice(fileplayer_voice_render, &s_stream);
 
     if (s_current_file) {
         sdcard_fclose(s_current_file);
@@ -225,20 +398,28 @@ void fileplayer_stop(fileplayer_t *player) {
 void fileplayer_pause(fileplayer_t *player) {
     if (!player || player->state != FILEPLAYER_STATE_PLAYING) return;
     player->state = FILEPLAYER_STATE_PAUSED;
+    if (player == s_active_player)
+        audio_mixer_remove_voice(fileplayer_voice_render, &s_stream);
 }
 
 void fileplayer_resume(fileplayer_t *player) {
     if (!player || player->state != FILEPLAYER_STATE_PAUSED) return;
     player->state = FILEPLAYER_STATE_PLAYING;
+    if (player == s_active_player)
+        audio_mixer_add_voice(fileplayer_voice_render, &s_stream);
 }
 
 bool fileplayer_is_playing(const fileplayer_t *player) {
     return player && player->state == FILEPLAYER_STATE_PLAYING;
 }
 
+static uint32_t frame_bytes_of(const fileplayer_t *player) {
+    return player->channels == 1 ? 2 : 4;
+}
+
 uint32_t fileplayer_get_position(const fileplayer_t *player) {
     if (!player) return 0;
-    return player->position / 4;
+    return player->position / frame_bytes_of(player);
 }
 
 uint32_t fileplayer_get_length(const fileplayer_t *player) {
@@ -251,6 +432,7 @@ void fileplayer_set_volume(fileplayer_t *player, uint8_t left, uint8_t right) {
     player->volume = left;
     s_volume_l = left;
     s_volume_r = right > 0 ? right : left;
+    stream_set_gain();
 }
 
 void fileplayer_get_volume(const fileplayer_t *player, uint8_t *left, uint8_t *right) {
@@ -274,14 +456,30 @@ void fileplayer_set_finish_callback(fileplayer_t *player, int (*cb)(void *), voi
 
 void fileplayer_set_offset(fileplayer_t *player, uint32_t seconds) {
     if (!player || !s_current_file) return;
-    uint32_t offset = seconds * s_sample_rate * 4;
-    sdcard_fseek(s_current_file, 44 + offset);
+    uint32_t offset = seconds * s_sample_rate * frame_bytes_of(player);
+    if (offset > s_data_end - s_data_offset)
+        offset = s_data_end - s_data_offset;
+
+    // Drop what was read ahead of the old position.  The voice is out of the
+    // mixer meanwhile, and holding the card keeps fileplayer_update() out, so
+    // neither can race the ring reset.
+    bool live = player == s_active_player && player->state == FILEPLAYER_STATE_PLAYING;
+    if (player == s_active_player)
+        audio_mixer_remove_voice(fileplayer_voice_render, &s_stream);
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    s_file_pos = s_data_offset + offset;
+    stream_align(s_file_pos);
+    s_draining = false;
+    sdcard_fseek(s_current_file, s_file_pos);
     player->position = offset;
+    recursive_mutex_exit(&g_sdcard_mutex);
+    if (live)
+        audio_mixer_add_voice(fileplayer_voice_render, &s_stream);
 }
 
 uint32_t fileplayer_get_offset(const fileplayer_t *player) {
     if (!player) return 0;
-    return player->position / 4 / s_sample_rate;
+    return player->position / frame_bytes_of(player) / s_sample_rate;
 }
 
 void fileplayer_set_stop_on_underrun(fileplayer_t *player, bool flag) {
@@ -289,90 +487,138 @@ void fileplayer_set_stop_on_underrun(fileplayer_t *player, bool flag) {
     player->stop_on_underrun = flag;
 }
 
-// Called from Core 1 every 5ms. Reads WAV data from SD, converts to
-// stereo int16_t, and pushes into the PCM stream ring buffer.
+void fileplayer_set_buffer_size(fileplayer_t *player, uint32_t bytes) {
+    if (!player) return;
+    player->buffer_size = buffer_size_for(bytes);
+}
+
+void fileplayer_get_stats(const fileplayer_t *player, fileplayer_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!player) return;
+    stats->buffer_size = player->buffer_size;
+    if (player != s_active_player) return;
+    stats->buffer_size = s_stream.size;
+    stats->buffered = s_stream.wr - s_stream.rd;
+    stats->low_water = s_stream.low_water;
+    stats->underruns = s_stream.underruns;
+    stats->sd_busy = s_stream.sd_busy;
+}
+
+// Where the current pass over the file ends: the loop end if one is set.
+static uint32_t pass_end(const fileplayer_t *player) {
+    if (player->loop && player->loop_end) {
+        uint32_t end = s_data_offset +
+                       player->loop_end * s_sample_rate * frame_bytes_of(player);
+        if (end > s_data_offset && end < s_data_end)
+            return end;
+    }
+    return s_data_end;
+}
+
+// Called from Core 1 every 5ms.  Tops the read-ahead ring up straight from
+// the file in large, sector-aligned reads.
 void fileplayer_update(void) {
     if (!s_initialized) return;
     if (!s_current_file || !s_active_player ||
         s_active_player->state != FILEPLAYER_STATE_PLAYING)
         return;
 
+    fileplayer_t *player = s_active_player;
+
     // Stop on underrun if configured
-    if (s_underflow && s_active_player->stop_on_underrun) {
-        fileplayer_stop(s_active_player);
+    if (s_underflow && player->stop_on_underrun) {
+        fileplayer_stop(player);
         return;
     }
 
+    uint32_t fb = s_stream.frame_bytes;
+    uint32_t level = s_stream.wr - s_stream.rd;
+    uint32_t space = s_stream.size - level;
+    // Wait for room for a decent read unless the ring is nearly dry:
+    // fewer, longer transfers make better use of each SD mutex hold.
+    if (space < READ_CHUNK_MIN && level >= READ_CHUNK_MIN) return;
+
+    uint32_t end = pass_end(player);
+    bool at_end = s_file_pos >= end;
+
     // Non-blocking: skip if Core 0 owns the SD card
-    if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL))
+    if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL)) {
+        s_stream.sd_busy++;
         return;
+    }
 
-    // Read a chunk of WAV data
-    size_t to_read = 4096;
-    UINT br = 0;
-    FRESULT res = f_read((FIL *)s_current_file, s_wav_buffer, to_read, &br);
-    recursive_mutex_exit(&g_sdcard_mutex);
-
-    if (res == FR_OK && br > 0) {
-        // WAV data is 16-bit signed PCM. Convert to stereo int16_t pairs
-        // and push into the PCM stream ring buffer.
-        int16_t *pcm = (int16_t *)s_wav_buffer;
-        uint32_t num_samples = br / 2;  // 16-bit samples
-
-        if (s_active_player->channels == 1) {
-            // Mono: duplicate to both channels via a temp buffer
-            // Process in-place backwards to avoid overwrite
-            int16_t stereo_buf[512];  // 256 stereo frames at a time
-            uint32_t pos = 0;
-            while (pos < num_samples) {
-                uint32_t chunk = num_samples - pos;
-                if (chunk > 256) chunk = 256;
-                for (uint32_t i = 0; i < chunk; i++) {
-                    int32_t s = ((int32_t)pcm[pos + i] * s_volume_l) / 100;
-                    if (s > 32767) s = 32767;
-                    if (s < -32768) s = -32768;
-                    stereo_buf[i * 2] = (int16_t)s;
-                    stereo_buf[i * 2 + 1] = (int16_t)s;
-                }
-                audio_push_samples(stereo_buf, chunk);
-                pos += chunk;
-            }
-            s_active_player->position += br;
-        } else {
-            // Stereo: apply volume and push directly
-            uint32_t num_frames = num_samples / 2;
-            int16_t stereo_buf[512];  // 256 stereo frames at a time
-            uint32_t pos = 0;
-            while (pos < num_frames) {
-                uint32_t chunk = num_frames - pos;
-                if (chunk > 256) chunk = 256;
-                for (uint32_t i = 0; i < chunk; i++) {
-                    int32_t l = ((int32_t)pcm[(pos + i) * 2] * s_volume_l) / 100;
-                    int32_t r = ((int32_t)pcm[(pos + i) * 2 + 1] * s_volume_r) / 100;
-                    if (l > 32767) l = 32767;
-                    if (l < -32768) l = -32768;
-                    if (r > 32767) r = 32767;
-                    if (r < -32768) r = -32768;
-                    stereo_buf[i * 2] = (int16_t)l;
-                    stereo_buf[i * 2 + 1] = (int16_t)r;
-                }
-                audio_push_samples(stereo_buf, chunk);
-                pos += chunk;
-            }
-            s_active_player->position += br;
+    uint32_t got = 0;
+    FRESULT res = FR_OK;
+    uint32_t budget = space < READ_CHUNK_MAX ? space : READ_CHUNK_MAX;
+    // At most two pieces: up to the end of the ring, then from its start.
+    for (int piece = 0; piece < 2 && !at_end && budget >= fb; piece++) {
+        uint32_t idx = (s_stream.wr + got) & (s_stream.size - 1);
+        uint32_t n = s_stream.size - idx;
+        if (n > budget) n = budget;
+        uint32_t left = end - s_file_pos;
+        if (left < fb) {
+            at_end = true;  // a partial frame at the end of the data
+            break;
         }
-    } else if (res != FR_OK || br == 0) {
-        if (s_active_player->loop) {
-            sdcard_fseek(s_current_file, 44);
-            s_active_player->position = 0;
+        if (n >= left) {
+            n = left;
         } else {
-            s_active_player->state = FILEPLAYER_STATE_STOPPED;
-            if (s_active_player->finish_callback)
-                s_active_player->finish_callback(s_active_player->finish_callback_arg);
+            // Stop on a file sector boundary when that still leaves a frame.
+            // The ring isn't always in step with the file's sectors (a
+            // header that isn't a whole number of frames, a loop seek), so
+            // the piece up to the ring's end may be shorter than the trim.
+            uint32_t over = (s_file_pos + n) % SECTOR_BYTES;
+            if (over + fb <= n)
+                n -= over;
+        }
+        n -= n % fb;
+        if (n == 0) break;
+
+        UINT br = 0;
+        res = f_read((FIL *)s_current_file, s_stream.buf + idx, n, &br);
+        br -= br % fb;
+        got += br;
+        budget -= br;
+        s_file_pos += br;
+        if (res != FR_OK || br < n) {
+            at_end = true;
+            break;
+        }
+        at_end = s_file_pos >= end;
+    }
+
+    bool looped = false;
+    if (at_end && res == FR_OK && player->loop) {
+        uint32_t start = s_data_offset +
+                         player->loop_start * s_sample_rate * frame_bytes_of(player);
+        if (start >= end) start = s_data_offset;
+        if (f_lseek((FIL *)s_current_file, start) == FR_OK) {
+            s_file_pos = start;
+            looped = true;
         }
     }
+
+    // Still under the mutex, so a setOffset from Core 0 can't interleave.
+    if (got) {
+        __dmb();  // data visible to the mixer before the new write index
+        s_stream.wr += got;
+        player->position += got;
+    }
+    if (looped)
+        player->position = s_file_pos - s_data_offset;
+    recursive_mutex_exit(&g_sdcard_mutex);
+
+    if (at_end && !looped) {
+        player->state = FILEPLAYER_STATE_STOPPED;
+        s_draining = true;
+        if (player->finish_callback)
+            player->finish_callback(player->finish_callback_arg);
+    }
 }
 
+// Reports and clears the underrun flag.
 bool fileplayer_did_underrun(void) {
-    return s_underflow;
+    bool under = s_underflow;
+    s_underflow = false;
+    return under;
 }
@@ -3,7 +3,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define FILEPLAYER_BUFFER_SIZE 8192
+// Read-ahead ring between the SD card and the mixer, in bytes of source PCM.
+// The default is ~186ms of 44.1kHz stereo; raise it (setBufferSize) for
+// apps that keep Core 0 on the SD card for long stretches.
+#define FILEPLAYER_BUFFER_SIZE (32 * 1024)
+#define FILEPLAYER_BUFFER_MIN  (8 * 1024)
+#define FILEPLAYER_BUFFER_MAX  (512 * 1024)
 #define FILEPLAYER_MAX_INSTANCES 2
 
 typedef enum {
@@ -33,8 +38,17 @@ typedef struct {
     int (*finish_callback)(void *);
     void *finish_callback_arg;
     bool stop_on_underrun;
+    uint32_t buffer_size;   // requested read-ahead, applied on play
 } fileplayer_t;
 
+typedef struct {
+    uint32_t buffer_size;   // bytes in the active ring
+    uint32_t buffered;      // bytes queued right now
+    uint32_t low_water;     // fewest bytes queued since play
+    uint32_t underruns;     // mixer blocks that ran dry
+    uint32_t sd_busy;       // refills skipped because Core 0 held the card
+} fileplayer_stats_t;
+
 void fileplayer_init(void);
 void fileplayer_reset(void);
 fileplayer_t *fileplayer_create(void);
@@ -55,6 +69,9 @@ void fileplayer_set_offset(fileplayer_t *player, uint32_t seconds);
 uint32_t fileplayer_get_offset(const fileplayer_t *player);
 
 void fileplayer_set_stop_on_underrun(fileplayer_t *player, bool flag);
+// Rounded up to a power of two within FILEPLAYER_BUFFER_MIN..MAX.
+void fileplayer_set_buffer_size(fileplayer_t *player, uint32_t bytes);
+void fileplayer_get_stats(const fileplayer_t *player, fileplayer_stats_t *stats);
 
 void fileplayer_update(void);
 bool fileplayer_did_underrun(void);
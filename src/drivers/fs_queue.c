@@ -0,0 +1,376 @@
+#include "fs_queue.h"
+#include "ff.h"       // direct FatFS calls, as fileplayer.c: no allocation on Core 1
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "umm_malloc.h"
+#include <string.h>
+#include <stdio.h>
+
+// Directory entries read per Core 1 step.
+#define DIR_STEP 16
+
+// A slot belongs to Core 1 while QUEUED and to Core 0 otherwise.  Core 1
+// only looks at slots with g_sdcard_mutex held, so Core 0 takes it before
+// pulling a QUEUED slot back (cancel, reset); posting a FREE slot needs
+// only the barrier before its state is set.
+typedef enum {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_NEED_BUF,   // sized by Core 1, dispatch allocates and requeues it
+    SLOT_DONE,
+    SLOT_FIRING,     // callback running
+} slot_state_t;
+
+typedef struct {
+    volatile uint8_t state;
+    bool     own_buf;    // umm_malloc'd by the queue, freed after dispatch
+    bool     open;       // s_fil / s_dir belong to this request
+    bool     append;
+    fs_queue_cb_t cb;
+    void    *user;
+    uint8_t *buf;
+    uint32_t cap;        // bytes, or entries for LIST
+    uint32_t done;       // likewise
+    uint32_t offset;     // READ: file position of buf[0]
+    uint32_t need;       // size found for an allocating READ/LIST
+    fs_result_t res;
+    char     path[FS_QUEUE_PATH_MAX];
+} fs_slot_t;
+
+static fs_slot_t s_slots[FS_QUEUE_SLOTS];
+static int s_next_id = 1;
+
+// Only one request has a file or directory open at a time, so they share
+// these (static: FIL and DIR are too big for Core 1's stack).
+static FIL s_fil;
+static DIR s_dir;
+static FILINFO s_fi;
+static int s_active = -1;  // slot with s_fil/s_dir open, -1 if none
+
+// ── Core 1 ───────────────────────────────────────────────────────────────────
+
+static void slot_close(fs_slot_t *s) {
+    if (!s->open) return;
+    if (s->res.op == FS_REQ_LIST)
+        f_closedir(&s_dir);
+    else
+        f_close(&s_fil);
+    s->open = false;
+    s_active = -1;
+}
+
+static void slot_finish(fs_slot_t *s, int result) {
+    slot_close(s);
+    s->res.result = result;
+    s->res.data = (s->res.op == FS_REQ_WRITE || result < 0) ? NULL : s->buf;
+    __dmb();
+    s->state = SLOT_DONE;
+}
+
+static void slot_need_buf(fs_slot_t *s, uint32_t need) {
+    slot_close(s);
+    s->need = need;
+    __dmb();
+    s->state = SLOT_NEED_BUF;
+}
+
+static void step_read(fs_slot_t *s) {
+    if (!s->open) {
+        if (f_open(&s_fil, s->path, FA_READ) != FR_OK) {
+            slot_finish(s, -1);
+            return;
+        }
+        s->open = true;
+        if (!s->buf) {
+            uint32_t size = f_size(&s_fil);
+            uint32_t avail = size > s->offset ? size - s->offset : 0;
+            uint32_t need = (s->cap && s->cap < avail) ? s->cap : avail;
+            if (need == 0)
+                slot_finish(s, 0);
+            else
+                slot_need_buf(s, need);
+            return;
+        }
+        if (f_lseek(&s_fil, s->offset + s->done) != FR_OK) {
+            slot_finish(s, -1);
+            return;
+        }
+    }
+
+    uint32_t n = s->cap - s->done;
+    if (n > FS_QUEUE_CHUNK) n = FS_QUEUE_CHUNK;
+    UINT br = 0;
+    if (f_read(&s_fil, s->buf + s->done, n, &br) != FR_OK) {
+        slot_finish(s, -1);
+        return;
+    }
+    s->done += br;
+    if (br < n || s->done == s->cap)
+        slot_finish(s, (int)s->done);
+}
+
+static void step_write(fs_slot_t *s) {
+    if (!s->open) {
+        BYTE mode = FA_WRITE | (s->append ? FA_OPEN_APPEND : FA_CREATE_ALWAYS);
+        if (f_open(&s_fil, s->path, mode) != FR_OK) {
+            slot_finish(s, -1);
+            return;
+        }
+        s->open = true;
+    }
+
+    uint32_t n = s->cap - s->done;
+    if (n > FS_QUEUE_CHUNK) n = FS_QUEUE_CHUNK;
+    UINT bw = 0;
+    if (n && (f_write(&s_fil, s->buf + s->done, n, &bw) != FR_OK || bw < n)) {
+        slot_finish(s, -1);
+        return;
+    }
+    s->done += bw;
+    if (s->done < s->cap) return;
+
+    // f_close writes back the directory entry; report a failure there too.
+    s->open = false;
+    s_active = -1;
+    slot_finish(s, f_close(&s_fil) == FR_OK ? (int)s->done : -1);
+}
+
+static void step_stat(fs_slot_t *s) {
+    if (f_stat(s->path, &s_fi) != FR_OK) {
+        slot_finish(s, -1);
+        return;
+    }
+    s->res.stat.size   = s_fi.fsize;
+    s->res.stat.is_dir = (s_fi.fattrib & AM_DIR) != 0;
+    s->res.stat.fdate  = s_fi.fdate;
+    s->res.stat.ftime  = s_fi.ftime;
+    slot_finish(s, 0);
+}
+
+// Without a buffer the first pass only counts entries; the second fills
+// the array dispatch allocated for them.
+static void step_list(fs_slot_t *s) {
+    if (!s->open) {
+        if (f_opendir(&s_dir, s->path) != FR_OK) {
+            slot_finish(s, -1);
+            return;
+        }
+        s->open = true;
+        s->done = 0;
+    }
+
+    sdcard_entry_t *entries = (sdcard_entry_t *)s->buf;
+    for (int i = 0; i < DIR_STEP; i++) {
+        if (f_readdir(&s_dir, &s_fi) != FR_OK) {
+            slot_finish(s, -1);
+            return;
+        }
+        if (!s_fi.fname[0]) {
+            if (entries || s->done == 0)
+                slot_finish(s, (int)s->done);
+            else
+                slot_need_buf(s, s->done);
+            return;
+        }
+        if (entries) {
+            sdcard_entry_t *e = &entries[s->done];
+            strncpy(e->name, s_fi.fname, sizeof(e->name) - 1);
+            e->name[sizeof(e->name) - 1] = '\0';
+            e->is_dir = (s_fi.fattrib & AM_DIR) != 0;
+            e->size   = s_fi.fsize;
+            e->fdate  = s_fi.fdate;
+            e->ftime  = s_fi.ftime;
+        }
+        if (++s->done == s->cap && entries) {
+            slot_finish(s, (int)s->done);
+            return;
+        }
+    }
+}
+
+static fs_slot_t *oldest(uint8_t state) {
+    fs_slot_t *best = NULL;
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        fs_slot_t *s = &s_slots[i];
+        if (s->state == state && (!best || s->res.id - best->res.id < 0))
+            best = s;
+    }
+    return best;
+}
+
+void fs_queue_poll(void) {
+    if (!oldest(SLOT_QUEUED)) return;  // idle: leave the card alone
+
+    // Non-blocking: skip this tick if Core 0 owns the SD card
+    if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL)) return;
+
+    // Stay on the request holding s_fil/s_dir until it completes.
+    fs_slot_t *s = s_active >= 0 ? &s_slots[s_active] : oldest(SLOT_QUEUED);
+    if (s && s->state == SLOT_QUEUED) {
+        __dmb();  // fields posted by Core 0 before its state
+        if (!sdcard_is_mounted()) {
+            slot_finish(s, -1);
+        } else {
+            switch (s->res.op) {
+            case FS_REQ_READ:  step_read(s);  break;
+            case FS_REQ_WRITE: step_write(s); break;
+            case FS_REQ_STAT:  step_stat(s);  break;
+            case FS_REQ_LIST:  step_list(s);  break;
+            }
+            s_active = s->open ? (int)(s - s_slots) : -1;
+        }
+    }
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
+// ── Core 0 ───────────────────────────────────────────────────────────────────
+
+static fs_slot_t *slot_alloc(const char *path, fs_req_op_t op,
+                             fs_queue_cb_t cb, void *user) {
+    if (!path || strlen(path) >= FS_QUEUE_PATH_MAX) return NULL;
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        fs_slot_t *s = &s_slots[i];
+        if (s->state != SLOT_FREE) continue;
+        memset(s, 0, sizeof(*s));
+        strcpy(s->path, path);
+        s->cb = cb;
+        s->user = user;
+        s->res.id = s_next_id;
+        s->res.op = op;
+        s->res.path = s->path;
+        s_next_id = s_next_id == INT32_MAX ? 1 : s_next_id + 1;
+        return s;
+    }
+    printf("[FSQ] No free request slot\n");
+    return NULL;
+}
+
+static int slot_post(fs_slot_t *s) {
+    __dmb();  // request visible to Core 1 before its state
+    s->state = SLOT_QUEUED;
+    return s->res.id;
+}
+
+static void slot_release(fs_slot_t *s) {
+    if (s->own_buf && s->buf)
+        umm_free(s->buf);
+    s->buf = NULL;
+    s->state = SLOT_FREE;
+}
+
+int fs_queue_read(const char *path, uint32_t offset, void *buf, uint32_t len,
+                  fs_queue_cb_t cb, void *user) {
+    if (buf && len == 0) return -1;
+    fs_slot_t *s = slot_alloc(path, FS_REQ_READ, cb, user);
+    if (!s) return -1;
+    s->buf = (uint8_t *)buf;
+    s->cap = len;
+    s->offset = offset;
+    return slot_post(s);
+}
+
+int fs_queue_write(const char *path, const void *data, uint32_t len,
+                   bool append, bool copy, fs_queue_cb_t cb, void *user) {
+    if (len && !data) return -1;
+    fs_slot_t *s = slot_alloc(path, FS_REQ_WRITE, cb, user);
+    if (!s) return -1;
+    if (copy && len) {
+        s->buf = (uint8_t *)umm_malloc(len);
+        if (!s->buf) {
+            s->state = SLOT_FREE;
+            return -1;
+        }
+        memcpy(s->buf, data, len);
+        s->own_buf = true;
+    } else {
+        s->buf = (uint8_t *)data;
+    }
+    s->cap = len;
+    s->append = append;
+    return slot_post(s);
+}
+
+int fs_queue_stat(const char *path, fs_queue_cb_t cb, void *user) {
+    fs_slot_t *s = slot_alloc(path, FS_REQ_STAT, cb, user);
+    return s ? slot_post(s) : -1;
+}
+
+int fs_queue_list_dir(const char *path, sdcard_entry_t *entries, int max,
+                      fs_queue_cb_t cb, void *user) {
+    if (entries && max <= 0) return -1;
+    fs_slot_t *s = slot_alloc(path, FS_REQ_LIST, cb, user);
+    if (!s) return -1;
+    s->buf = (uint8_t *)entries;
+    s->cap = entries ? (uint32_t)max : 0;
+    return slot_post(s);
+}
+
+bool fs_queue_cancel(int id, void **user) {
+    bool found = false;
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        fs_slot_t *s = &s_slots[i];
+        if (s->res.id != id || s->state == SLOT_FREE || s->state == SLOT_FIRING)
+            continue;
+        slot_close(s);
+        if (user) *user = s->user;
+        slot_release(s);
+        found = true;
+        break;
+    }
+    recursive_mutex_exit(&g_sdcard_mutex);
+    return found;
+}
+
+void fs_queue_reset(void) {
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        fs_slot_t *s = &s_slots[i];
+        if (s->state == SLOT_FREE) continue;
+        slot_close(s);
+        slot_release(s);
+    }
+    s_active = -1;
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
+int fs_queue_pending(void) {
+    int n = 0;
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++)
+        if (s_slots[i].state != SLOT_FREE) n++;
+    return n;
+}
+
+int fs_queue_dispatch(void) {
+    // Allocate for the requests Core 1 has sized and send them back.
+    fs_slot_t *s;
+    while ((s = oldest(SLOT_NEED_BUF)) != NULL) {
+        uint32_t bytes = s->res.op == FS_REQ_LIST
+                             ? s->need * sizeof(sdcard_entry_t) : s->need;
+        s->buf = (uint8_t *)umm_malloc(bytes);
+        if (!s->buf) {
+            printf("[FSQ] No memory for %lu bytes of %s\n",
+                   (unsigned long)bytes, s->path);
+            s->res.result = -1;
+            s->state = SLOT_DONE;
+            continue;
+        }
+        s->own_buf = true;
+        s->cap = s->need;
+        s->done = 0;
+        slot_post(s);
+    }
+
+    // A callback may post, cancel or dispatch again: FIRING keeps its own
+    // slot (and the path the result points at) out of reach until it returns.
+    int fired = 0;
+    while ((s = oldest(SLOT_DONE)) != NULL) {
+        __dmb();  // result written by Core 1 before its state
+        s->state = SLOT_FIRING;
+        if (s->cb)
+            s->cb(&s->res, s->user);
+        slot_release(s);
+        fired++;
+    }
+    return fired;
+}
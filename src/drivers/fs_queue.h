@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdcard.h"
+
+// =============================================================================
+// Asynchronous file I/O queue
+//
+// Core 0 posts reads, writes, stats and directory listings to a fixed set of
+// request slots.  Core 1 services them from its tick loop, oldest first, one
+// FS_QUEUE_CHUNK step per tick under g_sdcard_mutex, so a long transfer
+// neither stalls the caller nor starves the audio streamers of the card.
+// Completion callbacks run on Core 0 from fs_queue_dispatch(), which the Lua
+// hook and the native sys.poll() call.
+// =============================================================================
+
+#define FS_QUEUE_SLOTS    8
+#define FS_QUEUE_CHUNK    4096   // bytes (or 16 directory entries) per step
+#define FS_QUEUE_PATH_MAX 192
+
+typedef enum {
+    FS_REQ_READ,
+    FS_REQ_WRITE,
+    FS_REQ_STAT,
+    FS_REQ_LIST,
+} fs_req_op_t;
+
+typedef struct {
+    int           id;
+    fs_req_op_t   op;
+    const char   *path;
+    int           result;  // bytes read/written, entries listed, 0 for a
+                           // stat; -1 on error
+    void         *data;    // READ: the bytes, LIST: sdcard_entry_t[result]
+    sdcard_stat_t stat;    // STAT
+} fs_result_t;
+
+// Runs on Core 0 inside fs_queue_dispatch().  Buffers the queue allocated
+// are freed when it returns.
+typedef void (*fs_queue_cb_t)(const fs_result_t *res, void *user);
+
+// Reads up to len bytes from offset.  With buf NULL the queue allocates
+// (umm_malloc) a buffer for them, len 0 meaning the rest of the file.
+// Returns a request id, or -1 when the path is too long or all slots are
+// in use.  Caller-owned buffers must stay valid until the callback.
+int fs_queue_read(const char *path, uint32_t offset, void *buf, uint32_t len,
+                  fs_queue_cb_t cb, void *user);
+
+// Creates (or with append, extends) path with len bytes of data.  With copy
+// the queue takes its own copy, so data may be freed straight away.
+int fs_queue_write(const char *path, const void *data, uint32_t len,
+                   bool append, bool copy, fs_queue_cb_t cb, void *user);
+
+int fs_queue_stat(const char *path, fs_queue_cb_t cb, void *user);
+
+// Lists path into entries[max], or with entries NULL into an array the
+// queue sizes to the directory.
+int fs_queue_list_dir(const char *path, sdcard_entry_t *entries, int max,
+                      fs_queue_cb_t cb, void *user);
+
+// Drops a request that has not completed; its callback never runs.  Waits
+// for Core 1 to finish any step in progress.  *user receives the request's
+// user pointer so the caller can release it.
+bool fs_queue_cancel(int id, void **user);
+
+// Drops every request (app exit).
+void fs_queue_reset(void);
+
+// Requests posted and not yet dispatched.
+int fs_queue_pending(void);
+
+// Core 1 tick: one step of the oldest request.
+void fs_queue_poll(void);
+
+// Core 0: fires the callbacks of completed requests in the order they were
+// posted.  Returns how many fired.
+int fs_queue_dispatch(void);
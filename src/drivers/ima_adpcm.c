@@ -0,0 +1,77 @@
+#include "ima_adpcm.h"
+
+static const int16_t s_step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t s_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+typedef struct {
+    int32_t pred;
+    int32_t index;
+} adpcm_state_t;
+
+static inline int16_t adpcm_step(adpcm_state_t *st, uint8_t code) {
+    int32_t step = s_step_table[st->index];
+    int32_t diff = step >> 3;
+    if (code & 1) diff += step >> 2;
+    if (code & 2) diff += step >> 1;
+    if (code & 4) diff += step;
+    st->pred += (code & 8) ? -diff : diff;
+    if (st->pred > 32767) st->pred = 32767;
+    if (st->pred < -32768) st->pred = -32768;
+    st->index += s_index_table[code];
+    if (st->index < 0) st->index = 0;
+    if (st->index > 88) st->index = 88;
+    return (int16_t)st->pred;
+}
+
+uint32_t ima_adpcm_frames_in(uint32_t len, int channels) {
+    uint32_t header = 4u * (uint32_t)channels;
+    if (channels < 1 || channels > 2 || len < header)
+        return 0;
+    // Codes come in whole 4-byte groups per channel.
+    uint32_t groups = (len - header) / header;
+    return groups * 8 + 1;
+}
+
+uint32_t ima_adpcm_decode_block(const uint8_t *block, uint32_t len, int channels,
+                                int16_t *out, uint32_t frames) {
+    uint32_t have = ima_adpcm_frames_in(len, channels);
+    if (frames > have)
+        frames = have;
+    if (frames == 0)
+        return 0;
+
+    adpcm_state_t st[2];
+    for (int ch = 0; ch < channels; ch++) {
+        const uint8_t *h = block + ch * 4;
+        st[ch].pred = (int16_t)(h[0] | (h[1] << 8));
+        st[ch].index = h[2] > 88 ? 88 : h[2];
+        out[ch] = (int16_t)st[ch].pred;
+    }
+
+    const uint8_t *p = block + 4 * channels;
+    for (uint32_t f = 1; f < frames; f += 8) {
+        uint32_t n = frames - f < 8 ? frames - f : 8;
+        for (int ch = 0; ch < channels; ch++, p += 4) {
+            int16_t *o = out + f * channels + ch;
+            for (uint32_t k = 0; k < n; k++) {
+                uint8_t code = (p[k >> 1] >> ((k & 1) * 4)) & 0x0F;
+                o[k * channels] = adpcm_step(&st[ch], code);
+            }
+        }
+    }
+    return frames;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// =============================================================================
+// IMA ADPCM (WAV format tag 0x11) block decoder
+//
+// Each block starts with a 4-byte header per channel (first sample, step
+// index), followed by 4-bit codes in 4-byte groups per channel, so a block
+// of block_align bytes holds (block_align - 4 * channels) * 2 / channels + 1
+// frames.  Pure C, shared by the firmware mixer and the simulator.
+// =============================================================================
+
+#define IMA_ADPCM_FORMAT_TAG 0x11
+
+// Frames held by a block of len bytes: block_align for a full block, less
+// for a short final one.  0 if len can't hold the headers.
+uint32_t ima_adpcm_frames_in(uint32_t len, int channels);
+
+// Decode up to `frames` interleaved int16 frames from one block of len
+// bytes.  Returns the number of frames written.
+uint32_t ima_adpcm_decode_block(const uint8_t *block, uint32_t len, int channels,
+                                int16_t *out, uint32_t frames);
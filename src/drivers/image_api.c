@@ -13,6 +13,73 @@
 #define RGB565(r, g, b) ((uint16_t)(((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | (((b) & 0xF8) >> 3))
 #endif
 
+typedef struct {
+    uint32_t data_offset;
+    int      w, h;
+    int      bpp;
+    int      row_bytes;
+    bool     flip_y;     // rows stored bottom-up
+} bmp_header_t;
+
+// Parses the BITMAPFILEHEADER/BITMAPINFOHEADER pair at the start of f.
+// Only uncompressed (or bitfield) 16/24/32 bpp images up to 2048 pixels.
+static bool bmp_read_header(sdfile_t f, bmp_header_t *bh) {
+    uint8_t full_header[54];
+    sdcard_fseek(f, 0);
+    if (sdcard_fread(f, full_header, 54) != 54)
+        return false;
+
+    int32_t  w_raw, h_raw;
+    uint16_t bpp;
+    uint32_t compression;
+    memcpy(&bh->data_offset, &full_header[10], sizeof(bh->data_offset));
+    memcpy(&w_raw,           &full_header[18], sizeof(w_raw));
+    memcpy(&h_raw,           &full_header[22], sizeof(h_raw));
+    memcpy(&bpp,             &full_header[28], sizeof(bpp));
+    memcpy(&compression,     &full_header[30], sizeof(compression));
+
+    if ((compression != 0 && compression != 3) ||
+        (bpp != 16 && bpp != 24 && bpp != 32))
+        return false;
+
+    bh->w = (int)w_raw;
+    bh->h = (int)h_raw;
+    bh->flip_y = true;
+    if (bh->h < 0) {
+        bh->h = -bh->h;
+        bh->flip_y = false;
+    }
+    if (bh->w <= 0 || bh->h <= 0 || bh->w > 2048 || bh->h > 2048)
+        return false;
+
+    bh->bpp = bpp;
+    bh->row_bytes = ((bh->w * bpp + 31) / 32) * 4;
+    return true;
+}
+
+static void bmp_convert_row(const uint8_t *row_buf, uint16_t *out, int n,
+                            int bpp) {
+    for (int x = 0; x < n; x++) {
+        uint16_t color = 0;
+        if (bpp == 24) {
+            uint8_t b = row_buf[x * 3];
+            uint8_t g = row_buf[x * 3 + 1];
+            uint8_t r = row_buf[x * 3 + 2];
+            color = RGB565(r, g, b);
+        } else if (bpp == 32) {
+            uint8_t b = row_buf[x * 4];
+            uint8_t g = row_buf[x * 4 + 1];
+            uint8_t r = row_buf[x * 4 + 2];
+            color = RGB565(r, g, b);
+        } else if (bpp == 16) {
+            uint16_t p;
+            memcpy(&p, &row_buf[x * 2], sizeof(p));
+            color = p;
+        }
+        out[x] = color;
+    }
+}
+
 pc_image_t *image_load(const char *path) {
     if (!path) return NULL;
 
@@ -38,42 +105,13 @@ pc_image_t *image_load(const char *path) {
     }
 
     if (is_bmp) {
-        sdcard_fseek(f, 0);
-        uint8_t full_header[54];
-        if (sdcard_fread(f, full_header, 54) != 54) {
-            sdcard_fclose(f);
-            return NULL;
-        }
-
-        uint32_t data_offset;
-        int32_t  w_raw, h_raw;
-        uint16_t bpp;
-        uint32_t compression;
-        memcpy(&data_offset, &full_header[10], sizeof(data_offset));
-        memcpy(&w_raw,       &full_header[18], sizeof(w_raw));
-        memcpy(&h_raw,       &full_header[22], sizeof(h_raw));
-        memcpy(&bpp,         &full_header[28], sizeof(bpp));
-        memcpy(&compression, &full_header[30], sizeof(compression));
-
-        int w = (int)w_raw;
-        int h = (int)h_raw;
-
-        if ((compression != 0 && compression != 3) ||
-            (bpp != 16 && bpp != 24 && bpp != 32)) {
-            sdcard_fclose(f);
-            return NULL;
-        }
-
-        bool flip_y = true;
-        if (h < 0) {
-            h = -h;
-            flip_y = false;
-        }
-
-        if (w <= 0 || h <= 0 || w > 2048 || h > 2048) {
+        bmp_header_t bh;
+        if (!bmp_read_header(f, &bh)) {
             sdcard_fclose(f);
             return NULL;
         }
+        int w = bh.w;
+        int h = bh.h;
 
         size_t pixel_bytes = (size_t)w * (size_t)h * sizeof(uint16_t);
         uint16_t *pixel_data = (uint16_t *)umm_malloc(pixel_bytes);
@@ -82,10 +120,9 @@ pc_image_t *image_load(const char *path) {
             return NULL;
         }
 
-        sdcard_fseek(f, data_offset);
+        sdcard_fseek(f, bh.data_offset);
 
-        int row_bytes = ((w * bpp + 31) / 32) * 4;
-        uint8_t *row_buf = (uint8_t *)umm_malloc(row_bytes);
+        uint8_t *row_buf = (uint8_t *)umm_malloc(bh.row_bytes);
         if (!row_buf) {
             umm_free(pixel_data);
             sdcard_fclose(f);
@@ -93,29 +130,10 @@ pc_image_t *image_load(const char *path) {
         }
 
         for (int y = 0; y < h; y++) {
-            int dest_y = flip_y ? (h - 1 - y) : y;
-            if (sdcard_fread(f, row_buf, row_bytes) != row_bytes)
+            int dest_y = bh.flip_y ? (h - 1 - y) : y;
+            if (sdcard_fread(f, row_buf, bh.row_bytes) != bh.row_bytes)
                 break;
-
-            for (int x = 0; x < w; x++) {
-                uint16_t color = 0;
-                if (bpp == 24) {
-                    uint8_t b = row_buf[x * 3];
-                    uint8_t g = row_buf[x * 3 + 1];
-                    uint8_t r = row_buf[x * 3 + 2];
-                    color = RGB565(r, g, b);
-                } else if (bpp == 32) {
-                    uint8_t b = row_buf[x * 4];
-                    uint8_t g = row_buf[x * 4 + 1];
-                    uint8_t r = row_buf[x * 4 + 2];
-                    color = RGB565(r, g, b);
-                } else if (bpp == 16) {
-                    uint16_t p;
-                    memcpy(&p, &row_buf[x * 2], sizeof(p));
-                    color = p;
-                }
-                pixel_data[dest_y * w + x] = color;
-            }
+            bmp_convert_row(row_buf, &pixel_data[dest_y * w], w, bh.bpp);
         }
 
         umm_free(row_buf);
@@ -221,3 +239,399 @@ void image_draw_scaled(const pc_image_t *img, int x, int y, int dst_w, int dst_h
                                  img->w, img->h, dst_w, dst_h,
                                  img->transparent_color);
 }
+
+// ── Partial and streamed decoding ───────────────────────────────────────────
+
+static bool jpeg_read_size(sdfile_t f, int *w, int *h) {
+    // Walk the marker segments to the first SOFn
+    uint32_t pos = 2;
+    for (int n = 0; n < 256; n++) {
+        uint8_t m[4];
+        if (!sdcard_fseek(f, pos) || sdcard_fread(f, m, 4) != 4 || m[0] != 0xFF)
+            return false;
+        if (m[1] == 0xFF) {  // fill byte
+            pos++;
+            continue;
+        }
+        uint32_t len = ((uint32_t)m[2] << 8) | m[3];
+        if (m[1] >= 0xC0 && m[1] <= 0xCF &&
+            m[1] != 0xC4 && m[1] != 0xC8 && m[1] != 0xCC) {
+            uint8_t sof[5];  // precision, height, width
+            if (sdcard_fread(f, sof, 5) != 5)
+                return false;
+            *h = (sof[1] << 8) | sof[2];
+            *w = (sof[3] << 8) | sof[4];
+            return *w > 0 && *h > 0;
+        }
+        if (m[1] == 0xD9 || m[1] == 0xDA || len < 2)
+            return false;
+        pos += 2 + len;
+    }
+    return false;
+}
+
+bool image_get_info(const char *path, image_info_t *info) {
+    if (!path || !info) return false;
+
+    sdfile_t f = sdcard_fopen(path, "r");
+    if (!f) return false;
+
+    // Bytes each format's size needs: BMP and JPEG read their own headers,
+    // PNG has IHDR's width and height at 16..23, GIF its screen size at 6..9.
+    uint8_t header[24];
+    bool ok = false;
+    int got = sdcard_fread(f, header, sizeof(header));
+    if (got >= 2) {
+        if (header[0] == 'B' && header[1] == 'M') {
+            bmp_header_t bh;
+            ok = bmp_read_header(f, &bh);
+            info->format = IMAGE_FORMAT_BMP;
+            info->w = ok ? bh.w : 0;
+            info->h = ok ? bh.h : 0;
+        } else if (header[0] == 0xFF && header[1] == 0xD8) {
+            info->format = IMAGE_FORMAT_JPEG;
+            ok = jpeg_read_size(f, &info->w, &info->h);
+        } else if (got >= 24 && header[0] == 0x89 && header[1] == 0x50 &&
+                   header[2] == 0x4E && header[3] == 0x47) {
+            // IHDR is always the first chunk
+            info->format = IMAGE_FORMAT_PNG;
+            info->w = (header[16] << 24) | (header[17] << 16) |
+                      (header[18] << 8) | header[19];
+            info->h = (header[20] << 24) | (header[21] << 16) |
+                      (header[22] << 8) | header[23];
+            ok = info->w > 0 && info->h > 0;
+        } else if (got >= 10 && header[0] == 'G' && header[1] == 'I' &&
+                   header[2] == 'F') {
+            info->format = IMAGE_FORMAT_GIF;
+            info->w = header[6] | (header[7] << 8);
+            info->h = header[8] | (header[9] << 8);
+            ok = info->w > 0 && info->h > 0;
+        }
+    }
+    sdcard_fclose(f);
+    return ok;
+}
+
+const char *image_format_name(image_format_t format) {
+    switch (format) {
+    case IMAGE_FORMAT_BMP:  return "BMP";
+    case IMAGE_FORMAT_JPEG: return "JPEG";
+    case IMAGE_FORMAT_PNG:  return "PNG";
+    case IMAGE_FORMAT_GIF:  return "GIF";
+    }
+    return "unknown";
+}
+
+// Where decoded pixels go.  The window (sx, sy, sw, sh) of the decoded image
+// is resampled, nearest neighbour, to dw x dh and written into dst (rows
+// `stride` apart) or, with dst NULL, drawn on screen at (ox, oy).
+typedef struct {
+    int       sx, sy, sw, sh;
+    int       dw, dh;
+    uint16_t *dst;
+    int       stride;
+    int       ox, oy;
+} img_sink_t;
+
+// First destination index that samples source offset i or beyond.
+static inline int sink_first(int i, int d, int s) {
+    return (int)(((int64_t)i * d + s - 1) / s);
+}
+
+static bool img_sink_block(void *user, int x, int y, int w, int h,
+                           const uint16_t *pixels, int stride) {
+    img_sink_t *s = (img_sink_t *)user;
+    int wx1 = s->sx + s->sw, wy1 = s->sy + s->sh;
+    int c0 = x > s->sx ? x : s->sx;
+    int c1 = x + w < wx1 ? x + w : wx1;
+    int r0 = y > s->sy ? y : s->sy;
+    int r1 = y + h < wy1 ? y + h : wy1;
+
+    int dx0 = c0 < c1 ? sink_first(c0 - s->sx, s->dw, s->sw) : 0;
+    int dx1 = c0 < c1 ? sink_first(c1 - s->sx, s->dw, s->sw) : 0;
+    if (dx1 > s->dw) dx1 = s->dw;
+    int n = dx1 - dx0;
+    uint16_t run[FB_WIDTH];  // on-screen rows are at most this wide
+
+    for (int r = r0; r < r1 && n > 0; r++) {
+        int dy0 = sink_first(r - s->sy, s->dh, s->sh);
+        int dy1 = sink_first(r + 1 - s->sy, s->dh, s->sh);
+        if (dy1 > s->dh) dy1 = s->dh;
+        if (dy0 >= dy1) continue;
+
+        const uint16_t *src = pixels + (r - y) * stride;
+        uint16_t *out = s->dst ? &s->dst[dy0 * s->stride + dx0] : run;
+        for (int i = 0; i < n; i++) {
+            int col = s->sx + (int)((int64_t)(dx0 + i) * s->sw / s->dw);
+            out[i] = src[col - x];
+        }
+
+        if (s->dst) {
+            for (int dy = dy0 + 1; dy < dy1; dy++)
+                memcpy(&s->dst[dy * s->stride + dx0], out, n * sizeof(uint16_t));
+        } else {
+            for (int dy = dy0; dy < dy1; dy++)
+                display_draw_image(s->ox + dx0, s->oy + dy, n, 1, run);
+        }
+    }
+    // Wide JPEGs arrive in several blocks per MCU row
+    return y + h < wy1 || x + w < wx1;
+}
+
+// BMP rows are read by seeking straight to them, and only the ones some
+// destination row samples.
+static bool bmp_decode_window(const char *path, img_sink_t *s) {
+    sdfile_t f = sdcard_fopen(path, "r");
+    if (!f) return false;
+
+    bmp_header_t bh;
+    if (!bmp_read_header(f, &bh)) {
+        sdcard_fclose(f);
+        return false;
+    }
+
+    int bytes_pp = bh.bpp / 8;
+    int n = bh.w - s->sx < s->sw ? bh.w - s->sx : s->sw;
+    uint8_t  *raw = (uint8_t *)umm_malloc((size_t)n * bytes_pp);
+    uint16_t *row = (uint16_t *)umm_malloc((size_t)n * sizeof(uint16_t));
+    bool ok = raw && row && n > 0;
+
+    int last = -1;
+    for (int dy = 0; ok && dy < s->dh; dy++) {
+        int r = s->sy + (int)((int64_t)dy * s->sh / s->dh);
+        if (r == last) continue;  // the sink already copied it down
+        if (r >= bh.h) break;
+        last = r;
+        int file_row = bh.flip_y ? bh.h - 1 - r : r;
+        uint32_t off = bh.data_offset + (uint32_t)file_row * bh.row_bytes +
+                       (uint32_t)s->sx * bytes_pp;
+        int len = n * bytes_pp;
+        if (!sdcard_fseek(f, off) || sdcard_fread(f, raw, len) != len) {
+            ok = false;
+            break;
+        }
+        bmp_convert_row(raw, row, n, bh.bpp);
+        img_sink_block(s, s->sx, r, n, 1, row, n);
+    }
+
+    umm_free(raw);
+    umm_free(row);
+    sdcard_fclose(f);
+    return ok;
+}
+
+// Feeds the sink from the file.  The window is in full-size pixels; JPEGs are
+// decoded at 1/scale and the window shrunk to match, other formats are
+// decoded full size and the sink subsamples them.
+static bool img_decode_window(const char *path, const image_info_t *info,
+                              int scale, img_sink_t *s) {
+    switch (info->format) {
+    case IMAGE_FORMAT_BMP:
+        return bmp_decode_window(path, s);
+
+    case IMAGE_FORMAT_JPEG: {
+        int x1 = (s->sx + s->sw + scale - 1) / scale;
+        int y1 = (s->sy + s->sh + scale - 1) / scale;
+        s->sx /= scale;
+        s->sy /= scale;
+        s->sw = x1 - s->sx;
+        s->sh = y1 - s->sy;
+        return decode_jpeg_file_blocks(path, scale, img_sink_block, s);
+    }
+
+    case IMAGE_FORMAT_PNG:
+        return decode_png_file_blocks(path, img_sink_block, s);
+
+    case IMAGE_FORMAT_GIF: {
+        // Whole first frame, then cropped; GIFs are small in practice
+        image_decode_result_t res = {0, 0, NULL};
+        if (!decode_gif_file(path, &res) || !res.data) {
+            umm_free(res.data);
+            return false;
+        }
+        img_sink_block(s, 0, 0, res.w, res.h, res.data, res.w);
+        umm_free(res.data);
+        return true;
+    }
+    }
+    return false;
+}
+
+static int scale_pow2(int scale) {
+    return scale >= 8 ? 8 : scale >= 4 ? 4 : scale >= 2 ? 2 : 1;
+}
+
+pc_image_t *image_load_region(const char *path, int x, int y, int w, int h,
+                              int scale) {
+    image_info_t info;
+    if (!image_get_info(path, &info)) return NULL;
+
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > info.w) w = info.w - x;
+    if (y + h > info.h) h = info.h - y;
+    if (w <= 0 || h <= 0) return NULL;
+
+    scale = scale_pow2(scale);
+    pc_image_t *img = image_new_blank((w + scale - 1) / scale,
+                                      (h + scale - 1) / scale);
+    if (!img) return NULL;
+
+    // A window of whole scale steps, so every scale-th pixel is sampled;
+    // the part past the edge is never reached.
+    img_sink_t s = {x, y, img->w * scale, img->h * scale,
+                    img->w, img->h, img->data, img->w, 0, 0};
+    if (!img_decode_window(path, &info, scale, &s)) {
+        image_free(img);
+        return NULL;
+    }
+    return img;
+}
+
+pc_image_t *image_load_scaled(const char *path, int w, int h) {
+    image_info_t info;
+    if (!image_get_info(path, &info) || w <= 0) return NULL;
+    if (h <= 0) {
+        h = (int)((int64_t)info.h * w / info.w);
+        if (h < 1) h = 1;
+    }
+
+    // Largest IDCT reduction that still leaves at least w x h
+    int scale = 1;
+    if (info.format == IMAGE_FORMAT_JPEG) {
+        while (scale < 8 && info.w / (scale * 2) >= w &&
+               info.h / (scale * 2) >= h)
+            scale *= 2;
+    }
+
+    pc_image_t *img = image_new_blank(w, h);
+    if (!img) return NULL;
+
+    img_sink_t s = {0, 0, info.w, info.h, w, h, img->data, w, 0, 0};
+    if (!img_decode_window(path, &info, scale, &s)) {
+        image_free(img);
+        return NULL;
+    }
+    return img;
+}
+
+bool image_draw_file(const char *path, int x, int y, int scale) {
+    image_info_t info;
+    if (!image_get_info(path, &info)) return false;
+
+    scale = scale_pow2(scale);
+    int dw = (info.w + scale - 1) / scale;
+    int dh = (info.h + scale - 1) / scale;
+
+    // Only the part that can land on screen is decoded
+    int vx0 = x > 0 ? x : 0, vy0 = y > 0 ? y : 0;
+    int vx1 = x + dw < FB_WIDTH ? x + dw : FB_WIDTH;
+    int vy1 = y + dh < FB_HEIGHT ? y + dh : FB_HEIGHT;
+    if (vx0 >= vx1 || vy0 >= vy1) return true;
+
+    int fx = (vx0 - x) * scale, fy = (vy0 - y) * scale;
+    int fw = (vx1 - vx0) * scale, fh = (vy1 - vy0) * scale;
+
+    img_sink_t s = {fx, fy, fw, fh, vx1 - vx0, vy1 - vy0, NULL, 0, vx0, vy0};
+    return img_decode_window(path, &info, scale, &s);
+}
+
+struct image_stream {
+    char        *path;
+    image_info_t info;
+    int          tile_w, tile_h;
+    int          tx, ty;        // next tile
+    uint16_t    *band;          // decoded rows [band_y, band_y + band_h)
+    int          band_y, band_h;
+    int          band_rows;     // capacity, a multiple of tile_h
+};
+
+image_stream_t *image_stream_open(const char *path, int tile_w, int tile_h) {
+    image_info_t info;
+    if (!image_get_info(path, &info)) return NULL;
+
+    if (tile_w <= 0 || tile_w > info.w) tile_w = info.w;
+    if (tile_h <= 0) tile_h = 16;
+    if (tile_h > info.h) tile_h = info.h;
+    if (tile_w > 2048 || tile_h > 2048) return NULL;
+
+    image_stream_t *s = (image_stream_t *)umm_malloc(sizeof(image_stream_t));
+    if (!s) return NULL;
+    memset(s, 0, sizeof(*s));
+    s->path = (char *)umm_malloc(strlen(path) + 1);
+    if (!s->path) {
+        umm_free(s);
+        return NULL;
+    }
+    strcpy(s->path, path);
+    s->info = info;
+    s->tile_w = tile_w;
+    s->tile_h = tile_h;
+    s->band_y = -1;
+
+    // Sequential formats get as many tile rows per pass as the budget allows
+    int rows = tile_h;
+    if (info.format != IMAGE_FORMAT_BMP) {
+        int fit = IMAGE_STREAM_BAND_BYTES / (info.w * (int)sizeof(uint16_t));
+        if (fit > rows) rows = fit / tile_h * tile_h;
+    }
+    if (rows > info.h) rows = info.h;
+    s->band_rows = rows;
+    return s;
+}
+
+static bool image_stream_fill(image_stream_t *s) {
+    if (!s->band) {
+        s->band = (uint16_t *)umm_malloc((size_t)s->info.w * s->band_rows *
+                                         sizeof(uint16_t));
+        if (!s->band) return false;
+    }
+    s->band_y = s->ty;
+    s->band_h = s->info.h - s->ty < s->band_rows ? s->info.h - s->ty
+                                                  : s->band_rows;
+    memset(s->band, 0, (size_t)s->info.w * s->band_h * sizeof(uint16_t));
+
+    img_sink_t sink = {0, s->band_y, s->info.w, s->band_h,
+                       s->info.w, s->band_h, s->band, s->info.w, 0, 0};
+    if (!img_decode_window(s->path, &s->info, 1, &sink)) {
+        s->band_y = -1;
+        return false;
+    }
+    return true;
+}
+
+pc_image_t *image_stream_next(image_stream_t *s, int *x, int *y) {
+    if (!s || image_stream_done(s)) return NULL;
+    if (s->band_y < 0 || s->ty >= s->band_y + s->band_h) {
+        if (!image_stream_fill(s)) return NULL;
+    }
+
+    int tw = s->info.w - s->tx < s->tile_w ? s->info.w - s->tx : s->tile_w;
+    int th = s->info.h - s->ty < s->tile_h ? s->info.h - s->ty : s->tile_h;
+    pc_image_t *img = image_new_blank(tw, th);
+    if (!img) return NULL;
+
+    const uint16_t *src = &s->band[(s->ty - s->band_y) * s->info.w + s->tx];
+    for (int r = 0; r < th; r++)
+        memcpy(&img->data[r * tw], &src[r * s->info.w], tw * sizeof(uint16_t));
+
+    if (x) *x = s->tx;
+    if (y) *y = s->ty;
+    s->tx += s->tile_w;
+    if (s->tx >= s->info.w) {
+        s->tx = 0;
+        s->ty += s->tile_h;
+    }
+    return img;
+}
+
+bool image_stream_done(const image_stream_t *s) {
+    return !s || s->ty >= s->info.h;
+}
+
+void image_stream_close(image_stream_t *s) {
+    if (!s) return;
+    umm_free(s->band);
+    umm_free(s->path);
+    umm_free(s);
+}
@@ -29,3 +29,56 @@ void image_draw_region(const pc_image_t *img,
                        int sx, int sy, int sw, int sh,
                        int dx, int dy);
 void image_draw_scaled(const pc_image_t *img, int x, int y, int dst_w, int dst_h);
+
+// ── Partial and streamed decoding ───────────────────────────────────────────
+//
+// These decode straight from the file through the decoders' block callbacks
+// (JPEG MCU strips, PNG rows, BMP rows read by seeking), keeping only the
+// pixels that land in the result.  JPEGs are shrunk by 1/2, 1/4 or 1/8 in
+// the IDCT; anything finer is nearest-neighbour.  Decoding stops as soon as
+// the last wanted row has been seen.
+
+typedef enum {
+    IMAGE_FORMAT_BMP,
+    IMAGE_FORMAT_JPEG,
+    IMAGE_FORMAT_PNG,
+    IMAGE_FORMAT_GIF,
+} image_format_t;
+
+typedef struct {
+    int            w;
+    int            h;
+    image_format_t format;
+} image_info_t;
+
+// Dimensions and format from the file header, without decoding.
+bool image_get_info(const char *path, image_info_t *info);
+const char *image_format_name(image_format_t format);
+
+// The (x, y, w, h) rectangle of the file, clipped to the image, at 1/scale
+// (1, 2, 4 or 8): the result is ceil(w / scale) x ceil(h / scale).
+pc_image_t *image_load_region(const char *path, int x, int y, int w, int h,
+                              int scale);
+
+// The whole file resampled to w x h; h <= 0 keeps the aspect ratio.
+pc_image_t *image_load_scaled(const char *path, int w, int h);
+
+// Decodes the file at 1/scale straight into the back buffer at (x, y),
+// honouring the clip rect, without an image buffer.
+bool image_draw_file(const char *path, int x, int y, int scale);
+
+// Tile stream: the image cut into tile_w x tile_h tiles (smaller at the right
+// and bottom edges), handed out left to right, top to bottom.  JPEG and PNG
+// can only be decoded from the top, so rows are decoded a band of
+// IMAGE_STREAM_BAND_BYTES at a time and each band costs one pass over the
+// file up to it; BMP bands are read directly.  tile_w <= 0 means the image
+// width, tile_h <= 0 one 16-pixel MCU row.
+#define IMAGE_STREAM_BAND_BYTES (512 * 1024)
+
+typedef struct image_stream image_stream_t;
+
+image_stream_t *image_stream_open(const char *path, int tile_w, int tile_h);
+// Next tile and its position in the image; NULL when complete or on error.
+pc_image_t *image_stream_next(image_stream_t *s, int *x, int *y);
+bool image_stream_done(const image_stream_t *s);
+void image_stream_close(image_stream_t *s);
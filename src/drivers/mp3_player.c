@@ -1,16 +1,12 @@
 #include "mp3_player.h"
-#include "audio.h"
-#include "../hardware.h"
+#include "mp3_seek.h"
+#include "audio_mixer.h"
 #include "sdcard.h"
 #include "ff.h"       // direct FatFS calls for non-blocking SD reads
 #include "pico/platform.h"
-#include "hardware/gpio.h"
-#include "hardware/pwm.h"
-#include "hardware/dma.h"
-#include "hardware/clocks.h"
-#include "hardware/irq.h"
 #include "pico/mutex.h"
 #include "pico/time.h"
+#include "hardware/sync.h"
 #include "pio_psram.h"
 
 #define FPM_DEFAULT
@@ -24,62 +20,99 @@
 #include <stdlib.h>
 
 #define MP3_DECODE_BUFFER_SIZE (8192 + MAD_BUFFER_GUARD)
-#define PCM_RING_SIZE          32768
-#define DMA_BUF_SAMPLES        256
-
-// PWM_WRAP chosen so that at 300 MHz (video playback clock), common sample
-// rates land on clean integer dividers:  44100 Hz → div=4, 22050 Hz → div=8.
-// Period 1700 gives 0.04% timing error vs 0.28% with period 2048.
-#define PWM_WRAP  1699
-#define PWM_MID   ((PWM_WRAP + 1) / 2)  // 850
-
-#define FADE_SAMPLES 64
-
-typedef enum {
-    FADE_NONE,
-    FADE_IN,
-    FADE_OUT,
-} fade_state_t;
-
-static volatile fade_state_t s_fade_state = FADE_NONE;
-static volatile int          s_fade_pos   = 0;
-static volatile bool         s_stop_after_fade = false;
-
-static struct mad_stream *s_mad_stream = NULL;
-static struct mad_frame  *s_mad_frame  = NULL;
-static struct mad_synth  *s_mad_synth  = NULL;
-static sdfile_t    s_file = NULL;
-static uint8_t     s_decode_buffer[MP3_DECODE_BUFFER_SIZE] __attribute__((aligned(4)));
-static int         s_bytes_in_buffer = 0;
-static int         s_buffer_pos = 0;
-
-static mp3_player_t s_player;
+#define PCM_RING_SIZE          PIO_PSRAM_MP3_RING_SIZE
+#define OUT_RING_FRAMES        2048   // ring the mixer reads, ~46ms
+
+_Static_assert((MP3_MAX_PLAYERS - 1) * PCM_RING_SIZE <= PIO_PSRAM_MP3_EXTRA_SIZE,
+               "extra MP3 rings overflow their PIO PSRAM region");
+
+// Start, stop and pause ramp, just long enough to avoid a click.
+#define CLICK_FADE_FRAMES 64
+
+// Envelope on top of the volume: 16.16 gain, 256 = unity.
+#define ENV_UNITY (256 << 16)
+
+#define NO_SEEK UINT32_MAX
+// Frames decoded (and dropped) ahead of a seek target so the bit reservoir
+// is primed by the time the target frame comes round.
+#define SEEK_PREROLL_FRAMES 2
+// Bytes of the file indexed per update, more while a seek waits on it.
+#define SCAN_BUDGET      4096
+#define SCAN_BUDGET_SEEK (32 * 1024)
+
+// ── Per-player decoder state ────────────────────────────────────────────────
+// One of these hangs off each mp3_player_t (player->decoder), so every
+// instance decodes and mixes independently.  Allocated in the Lua heap.
+typedef struct {
+    struct mad_stream stream;
+    struct mad_frame  frame;
+    struct mad_synth  synth;
+    uint8_t  decode_buffer[MP3_DECODE_BUFFER_SIZE] __attribute__((aligned(4)));
+    int      bytes_in_buffer;
+    int      buffer_pos;
+    sdfile_t file;
+    bool     fed;                 // compressed data comes from the fed ring
+
+    // Decoded stereo PCM, in PIO PSRAM when present (else the Lua heap)
+    uint8_t *pcm_ring;
+    uint32_t pio_base;
+    volatile size_t ring_rd;
+    volatile size_t ring_wr;
+
+    // Output side: decoded PCM moves from pcm_ring into this ring on Core 1's
+    // loop; the mixer ISR never touches PIO PSRAM.
+    int16_t      out_buf[OUT_RING_FRAMES * 2];
+    audio_ring_t out;
+    bool         voice_active;
+    uint32_t     vol_scale;       // 256 = 100%
+
+    // Envelope.  env / env_step belong to the ISR; other code posts a ramp
+    // through the ramp_* fields and the ISR picks it up at its next block.
+    int32_t           env;
+    int32_t           env_step;
+    int32_t           env_target;
+    int32_t           level;          // last fade() level: output starts ramping to it
+    bool              stop_at_target;
+    volatile bool     ramp_pending;
+    volatile int32_t  ramp_target;
+    volatile uint32_t ramp_frames;
+    volatile bool     ramp_stop;
+
+    // Seeking and looping, all in track samples (encoder delay excluded).
+    mp3_seek_t seek;
+    uint32_t   data_start;        // first byte past any ID3v2 tag
+    bool       file_eof;          // f_read has reached the end of the file
+    bool       eof;               // track decoded through: drain, then stop
+    uint32_t   seek_to;           // pending seek, NO_SEEK if none
+    uint32_t   start_at;          // where the next play() starts
+    uint32_t   discard;           // decoded samples to drop after a seek
+    uint32_t   sample_pos;        // track sample of the next decoded sample
+    uint32_t   loop_start;
+    uint32_t   loop_end;          // 0 = end of track
+    uint32_t   wrap_at;           // where the last loop actually wrapped
+    bool       looped;
+    bool       start_pending;     // output starts once the pending seek lands
+    uint32_t   start_fade;
+} mp3_decoder_t;
+
+static mp3_player_t s_players[MP3_MAX_PLAYERS];
 static bool         s_initialized = false;
 static mutex_t      s_mp3_mutex;
 #define MAX_ERRORS_PER_UPDATE  32
 
-static uint8_t *s_pcm_ring = NULL;
-static volatile size_t s_ring_rd = 0;
-static volatile size_t s_ring_wr = 0;
-static bool s_use_pio_psram = false;
-static uint32_t s_pio_psram_base = 0;
-
-#define STAGING_BUF_SIZE  (DMA_BUF_SAMPLES * 4 * 4)
-static uint8_t  s_staging_buf[STAGING_BUF_SIZE] __attribute__((aligned(4)));
-static size_t   s_staging_avail = 0;
-static size_t   s_staging_pos   = 0;
-
-static uint8_t s_pio_read_buf[STAGING_BUF_SIZE] __attribute__((aligned(4)));
-
 // ── Fed mode: compressed MP3 ring in QMI PSRAM, written by Core 0 (video) ───
 // Uses umm_malloc (not PIO PSRAM) because both cores access this ring
 // concurrently and PIO1 SPI is not thread-safe across cores.
 #define FED_RING_SIZE  (64 * 1024)
-static bool     s_fed_mode = false;
+static mp3_player_t *s_fed_player = NULL;
 static uint8_t *s_fed_ring_buf = NULL; // umm_malloc'd in QMI PSRAM
 static volatile uint32_t s_fed_wr = 0; // written by Core 0
 static volatile uint32_t s_fed_rd = 0; // read by Core 1
 
+static inline mp3_decoder_t *dec(const mp3_player_t *player) {
+    return (mp3_decoder_t *)player->decoder;
+}
+
 static inline uint32_t fed_ring_available(void) {
     uint32_t wr = s_fed_wr, rd = s_fed_rd;
     return (wr >= rd) ? (wr - rd) : (FED_RING_SIZE - rd + wr);
@@ -101,358 +134,416 @@ static void fed_ring_read(uint8_t *dst, uint32_t len) {
     s_fed_rd = (rd + len) % FED_RING_SIZE;
 }
 
-static inline size_t __time_critical_func(ring_available)(void) {
-    size_t wr = s_ring_wr, rd = s_ring_rd;
+static inline size_t ring_available(const mp3_decoder_t *d) {
+    size_t wr = d->ring_wr, rd = d->ring_rd;
     return (wr >= rd) ? (wr - rd) : (PCM_RING_SIZE - rd + wr);
 }
 
-static inline size_t __time_critical_func(ring_free)(void) {
-    return PCM_RING_SIZE - 1 - ring_available();
+static inline size_t ring_free(const mp3_decoder_t *d) {
+    return PCM_RING_SIZE - 1 - ring_available(d);
 }
 
-static void ring_write(const uint8_t *data, size_t len) {
+static void ring_write(mp3_decoder_t *d, const uint8_t *data, size_t len) {
     while (len > 0) {
-        size_t wr = s_ring_wr;
-        size_t free_space = ring_free();
+        size_t wr = d->ring_wr;
+        size_t free_space = ring_free(d);
         if (free_space == 0) break;
 
         size_t chunk = (len < free_space) ? len : free_space;
         size_t to_end = PCM_RING_SIZE - wr;
 
-        if (s_use_pio_psram) {
+        if (!d->pcm_ring) {
             if (chunk <= to_end) {
-                pio_psram_write(s_pio_psram_base + wr, data, chunk);
+                pio_psram_write(d->pio_base + wr, data, chunk);
             } else {
-                pio_psram_write(s_pio_psram_base + wr, data, to_end);
-                pio_psram_write(s_pio_psram_base, data + to_end, chunk - to_end);
+                pio_psram_write(d->pio_base + wr, data, to_end);
+                pio_psram_write(d->pio_base, data + to_end, chunk - to_end);
             }
         } else {
             if (chunk <= to_end) {
-                memcpy(s_pcm_ring + wr, data, chunk);
+                memcpy(d->pcm_ring + wr, data, chunk);
             } else {
-                memcpy(s_pcm_ring + wr, data, to_end);
-                memcpy(s_pcm_ring, data + to_end, chunk - to_end);
+                memcpy(d->pcm_ring + wr, data, to_end);
+                memcpy(d->pcm_ring, data + to_end, chunk - to_end);
             }
         }
-        s_ring_wr = (wr + chunk) % PCM_RING_SIZE;
+        d->ring_wr = (wr + chunk) % PCM_RING_SIZE;
         data += chunk;
         len -= chunk;
     }
 }
 
-// ── DMA audio output (paced by PWM DREQ — zero jitter) ─────────────────────
-static int  s_dma_chan = -1;
-static uint32_t s_dma_buf[2][DMA_BUF_SAMPLES];  // ping-pong SRAM buffers
-static volatile int s_dma_active_buf = 0;
-static volatile bool s_dma_active = false;
-static int  s_pcm_channels = 2;
-static unsigned int s_pwm_slice = 0;
-
-// Deferred DMA start: set on Core 0, consumed on Core 1 so the DMA ISR
-// fires on Core 1 instead of preempting the game loop on Core 0.
-static volatile bool s_dma_start_pending = false;
-static bool          s_irq_on_core1 = false;
-
-// ── Refill the SRAM staging buffer from the PCM ring ────────────────────────
-// Called from mp3_player_update() (Core 1, non-ISR context) to keep the
-// staging buffer topped up before the decode cycle begins.
-static void refill_staging_buf(void) {
-    if (s_staging_avail >= STAGING_BUF_SIZE / 2)
-        return;
-
-    if (s_staging_pos > 0 && s_staging_avail > 0) {
-        memmove(s_staging_buf, s_staging_buf + s_staging_pos, s_staging_avail);
-    }
-    s_staging_pos = 0;
-
-    size_t space = STAGING_BUF_SIZE - s_staging_avail;
-    size_t avail = ring_available();
-    size_t to_read = (space < avail) ? space : avail;
-    if (to_read == 0) return;
-
-    size_t rd = s_ring_rd;
-    size_t to_end = PCM_RING_SIZE - rd;
+static void ring_reset(mp3_decoder_t *d) {
+    d->ring_rd = d->ring_wr = 0;
+    audio_ring_clear(&d->out);
+}
 
-    if (s_use_pio_psram) {
-        if (to_read <= to_end) {
-            pio_psram_read(s_pio_psram_base + rd, s_staging_buf + s_staging_avail, to_read);
+// ── Move PCM from the decode ring into the mixer's ring ─────────────────────
+// Called from mp3_player_update() (Core 1, non-ISR context) and before
+// playback starts.  Both rings hold stereo frames, so PCM is read straight
+// into the output ring's free space with no staging copy.
+static void refill_out_ring(mp3_decoder_t *d) {
+    audio_ring_t *out = &d->out;
+    for (int piece = 0; piece < 2; piece++) {
+        uint32_t space = audio_ring_space(out);
+        uint32_t idx = out->wr & out->mask;
+        uint32_t frames = out->mask + 1 - idx;
+        if (frames > space) frames = space;
+        size_t avail = ring_available(d) / 4;
+        if (frames > avail) frames = (uint32_t)avail;
+        if (frames == 0) return;
+
+        uint8_t *dst = (uint8_t *)(out->buf + idx * 2);
+        size_t len = (size_t)frames * 4;
+        size_t rd = d->ring_rd;
+        size_t to_end = PCM_RING_SIZE - rd;
+        size_t first = len < to_end ? len : to_end;
+        if (!d->pcm_ring) {
+            pio_psram_read(d->pio_base + rd, dst, first);
+            if (len > first)
+                pio_psram_read(d->pio_base, dst + first, len - first);
         } else {
-            pio_psram_read(s_pio_psram_base + rd, s_staging_buf + s_staging_avail, to_end);
-            pio_psram_read(s_pio_psram_base, s_staging_buf + s_staging_avail + to_end, to_read - to_end);
-        }
-    } else {
-        if (to_read <= to_end) {
-            memcpy(s_staging_buf + s_staging_avail, s_pcm_ring + rd, to_read);
-        } else {
-            memcpy(s_staging_buf + s_staging_avail, s_pcm_ring + rd, to_end);
-            memcpy(s_staging_buf + s_staging_avail + to_end, s_pcm_ring, to_read - to_end);
+            memcpy(dst, d->pcm_ring + rd, first);
+            if (len > first)
+                memcpy(dst + first, d->pcm_ring, len - first);
         }
+        d->ring_rd = (rd + len) % PCM_RING_SIZE;
+
+        __dmb();  // frames visible to the mixer before the new write index
+        out->wr += frames;
     }
-    s_ring_rd = (rd + to_read) % PCM_RING_SIZE;
-    s_staging_avail += to_read;
 }
 
-// ── Fill one DMA buffer from the staging buffer (called from DMA ISR) ───────
-// Reads only from SRAM (s_staging_buf) — never touches PIO PSRAM directly.
-// Precomputed volume scale: vol_scale = volume * 256 / 100, so
-// (sample * vol_scale) >> 8  ≈  sample * volume / 100
-// Updated whenever mp3_player_set_volume() is called.
-static uint32_t s_vol_scale = 256;  // 256 = 100%
+// ── Mixer voice (DMA ISR, Core 1) ───────────────────────────────────────────
+// Volume is the ring gain; the envelope (fades, crossfades) is applied on
+// top, so it is rendered into a scratch block first while the envelope is
+// anything but unity.  Voices mix one at a time, so the block is shared.
+static int32_t s_fade_mix[AUDIO_MIXER_BLOCK_FRAMES * 2];
 
-static void __time_critical_func(fill_dma_buffer)(uint32_t *buf, int count) {
-    size_t bytes_per_pair = (s_pcm_channels > 1) ? 4 : 2;
-    uint32_t vol_scale = s_vol_scale;
-
-    for (int i = 0; i < count; i++) {
-        int32_t lv, rv;
+static bool __time_critical_func(mp3_voice_render)(void *ctx, int32_t *mix, int frames) {
+    mp3_player_t *player = (mp3_player_t *)ctx;
+    mp3_decoder_t *d = dec(player);
+    if (!player->playing)
+        return false;
 
-        if (s_staging_avail < bytes_per_pair) {
-            lv = PWM_MID;
-            rv = PWM_MID;
-        } else {
-            uint8_t raw[4];
-            memcpy(raw, s_staging_buf + s_staging_pos, bytes_per_pair);
-            s_staging_pos   += bytes_per_pair;
-            s_staging_avail -= bytes_per_pair;
-
-            int16_t left, right;
-            memcpy(&left, raw, 2);
-            if (s_pcm_channels > 1)
-                memcpy(&right, raw + 2, 2);
-            else
-                right = left;
-
-            // 16-bit signed → PWM range (0–PWM_WRAP), then apply volume
-            lv = (int32_t)(((uint32_t)(left  + 32768) * (PWM_WRAP + 1)) >> 16);
-            rv = (int32_t)(((uint32_t)(right + 32768) * (PWM_WRAP + 1)) >> 16);
-            lv = (lv * vol_scale) >> 8;
-            rv = (rv * vol_scale) >> 8;
-            if (lv > PWM_WRAP) lv = PWM_WRAP;
-            if (rv > PWM_WRAP) rv = PWM_WRAP;
-        }
+    if (d->ramp_pending) {
+        int32_t target = d->ramp_target;
+        uint32_t len = d->ramp_frames ? d->ramp_frames : 1;
+        d->env_target = target;
+        d->env_step = (target - d->env) / (int32_t)len;
+        if (d->env_step == 0)
+            d->env = target;
+        d->stop_at_target = d->ramp_stop;
+        d->ramp_pending = false;
+    }
 
-        // Apply fade envelope
-        // FADE_SAMPLES=64, so *256/64 == *4 == <<2 (no division needed)
-        if (s_fade_state == FADE_IN) {
-            int32_t gain = s_fade_pos << 2;
-            lv = PWM_MID + (((lv - PWM_MID) * gain) >> 8);
-            rv = PWM_MID + (((rv - PWM_MID) * gain) >> 8);
-            if (++s_fade_pos >= FADE_SAMPLES)
-                s_fade_state = FADE_NONE;
-        } else if (s_fade_state == FADE_OUT) {
-            int32_t gain = (FADE_SAMPLES - s_fade_pos) << 2;
-            lv = PWM_MID + (((lv - PWM_MID) * gain) >> 8);
-            rv = PWM_MID + (((rv - PWM_MID) * gain) >> 8);
-            if (++s_fade_pos >= FADE_SAMPLES) {
-                s_fade_state = FADE_NONE;
-                if (s_stop_after_fade)
-                    s_player.playing = false;
+    uint32_t rd0 = d->out.rd;
+    if ((d->env_step == 0 && d->env == ENV_UNITY) || frames > AUDIO_MIXER_BLOCK_FRAMES) {
+        audio_ring_render(&d->out, mix, frames);
+    } else {
+        memset(s_fade_mix, 0, (size_t)frames * 2 * sizeof(int32_t));
+        audio_ring_render(&d->out, s_fade_mix, frames);
+        int32_t env = d->env, step = d->env_step, target = d->env_target;
+        for (int i = 0; i < frames; i++) {
+            int32_t gain = env >> 16;
+            mix[i * 2] += (s_fade_mix[i * 2] * gain) >> 8;
+            mix[i * 2 + 1] += (s_fade_mix[i * 2 + 1] * gain) >> 8;
+            if (step) {
+                env += step;
+                if ((step > 0) ? env >= target : env <= target) {
+                    env = target;
+                    step = 0;
+                }
             }
         }
-
-        buf[i] = ((uint32_t)rv << 16) | (uint32_t)lv;
+        d->env = env;
+        d->env_step = step;
+        if (step == 0 && d->stop_at_target && env == 0)
+            player->playing = false;
     }
+    player->position += d->out.rd - rd0;
+    return player->playing;
 }
 
-// ── DMA completion ISR: swap buffers, restart, refill ───────────────────────
-// With Fix 2 this ISR fires on Core 1 (registered via deferred start),
-// keeping the game loop on Core 0 free from audio interrupt overhead.
-static void dma_audio_irq_handler(void) {
-    dma_hw->ints1 = 1u << s_dma_chan;          // clear IRQ (using DMA_IRQ_1)
-
-    if (!s_dma_active || !s_player.playing) {
-        // Stopped or paused: silence outputs, don't restart DMA
-        pwm_set_gpio_level(AUDIO_PIN_L, PWM_MID);
-        pwm_set_gpio_level(AUDIO_PIN_R, PWM_MID);
-        s_dma_active = false;
-        return;
-    }
-
-    // Swap to the pre-filled buffer and start DMA immediately
-    int next_buf = s_dma_active_buf ^ 1;
-    dma_channel_set_read_addr(s_dma_chan, s_dma_buf[next_buf], true);
-
-    // Refill the buffer that just finished playing
-    fill_dma_buffer(s_dma_buf[s_dma_active_buf], DMA_BUF_SAMPLES);
-    s_player.position += DMA_BUF_SAMPLES;
-    s_dma_active_buf = next_buf;
+// Posts a ramp of the envelope to `target` over `frames` output frames.
+static void post_ramp(mp3_decoder_t *d, int32_t target, uint32_t frames, bool stop) {
+    d->ramp_target = target;
+    d->ramp_frames = frames;
+    d->ramp_stop = stop;
+    __dmb();
+    d->ramp_pending = true;
 }
 
 // ── Refill compressed-data buffer from SD card or fed ring ────────────────────
-static bool refill_decode_buffer(void) {
+// Returns true if any bytes were added.  An SD read that returns nothing
+// sets file_eof; a busy card just leaves the buffer for the next update.
+static bool refill_decode_buffer(mp3_decoder_t *d) {
+    int before = d->bytes_in_buffer;
     // Shift leftover data to front
-    if (s_buffer_pos > 0 && s_bytes_in_buffer > 0) {
-        memmove(s_decode_buffer, s_decode_buffer + s_buffer_pos, s_bytes_in_buffer);
+    if (d->buffer_pos > 0 && d->bytes_in_buffer > 0) {
+        memmove(d->decode_buffer, d->decode_buffer + d->buffer_pos, d->bytes_in_buffer);
     }
-    s_buffer_pos = 0;
+    d->buffer_pos = 0;
 
-    int space = (int)MP3_DECODE_BUFFER_SIZE - s_bytes_in_buffer - MAD_BUFFER_GUARD;
+    int space = (int)MP3_DECODE_BUFFER_SIZE - d->bytes_in_buffer - MAD_BUFFER_GUARD;
     if (space > 0) {
-        if (s_fed_mode) {
-            // Fed mode: read from compressed audio ring in PIO PSRAM
+        if (d->fed) {
+            // Fed mode: read from compressed audio ring in QMI PSRAM
             uint32_t avail = fed_ring_available();
             uint32_t to_read = ((uint32_t)space < avail) ? (uint32_t)space : avail;
             if (to_read > 4096) to_read = 4096;
             if (to_read > 0) {
-                fed_ring_read(s_decode_buffer + s_bytes_in_buffer, to_read);
-                s_bytes_in_buffer += (int)to_read;
+                fed_ring_read(d->decode_buffer + d->bytes_in_buffer, to_read);
+                d->bytes_in_buffer += (int)to_read;
             }
         } else {
             // SD mode: non-blocking read
-            if (!s_file) goto pad;
+            if (!d->file) goto pad;
             if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL))
                 goto pad;
             int to_read = (space > 4096) ? 4096 : space;
             UINT br = 0;
-            FRESULT res = f_read((FIL *)s_file, s_decode_buffer + s_bytes_in_buffer, to_read, &br);
+            FRESULT res = f_read((FIL *)d->file, d->decode_buffer + d->bytes_in_buffer, to_read, &br);
             recursive_mutex_exit(&g_sdcard_mutex);
             if (res == FR_OK && br > 0)
-                s_bytes_in_buffer += (int)br;
+                d->bytes_in_buffer += (int)br;
+            else if (res == FR_OK)
+                d->file_eof = true;
         }
     }
 
 pad:
     // Zero-pad guard bytes for libmad
-    memset(s_decode_buffer + s_bytes_in_buffer, 0, MAD_BUFFER_GUARD);
+    memset(d->decode_buffer + d->bytes_in_buffer, 0, MAD_BUFFER_GUARD);
+
+    return d->bytes_in_buffer > before;
+}
 
-    return s_bytes_in_buffer > 0;
+// ── Seek the decoder to track sample seek_to ─────────────────────────────────
+// Starts a few frames early from the nearest indexed frame and drops the
+// decoded samples up to the target, so the result is sample-exact.  Core 1
+// only tries for the card (block = false).  Returns false while the seek is
+// still pending: card busy, or the index hasn't reached the target yet.
+static bool decoder_seek(mp3_decoder_t *d, bool block) {
+    uint32_t target = d->seek_to;
+    uint32_t spf = d->seek.samples_per_frame;
+    uint32_t abs_pos = target + mp3_seek_start_trim(&d->seek);
+    uint32_t at = 0, offset = d->data_start;
+
+    if (d->seek.count && spf) {
+        uint32_t frame = abs_pos / spf;
+        uint32_t want = frame > SEEK_PREROLL_FRAMES ? frame - SEEK_PREROLL_FRAMES : 0;
+        if (!mp3_seek_locate(&d->seek, want, &at, &offset)) {
+            if (!d->seek.failed && !d->seek.complete)
+                return false;
+            // Index stopped short: decode forward from its last entry
+            at = (d->seek.count - 1) * MP3_SEEK_STRIDE;
+            offset = d->seek.offsets[d->seek.count - 1];
+        }
+    }
+
+    if (block)
+        recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    else if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL))
+        return false;
+    UINT br = 0;
+    FRESULT res = f_lseek((FIL *)d->file, offset);
+    if (res == FR_OK)
+        res = f_read((FIL *)d->file, d->decode_buffer,
+                     MP3_DECODE_BUFFER_SIZE - MAD_BUFFER_GUARD, &br);
+    recursive_mutex_exit(&g_sdcard_mutex);
+    if (res != FR_OK)
+        br = 0;   // treated as the end of the file
+
+    d->bytes_in_buffer = (int)br;
+    d->buffer_pos = 0;
+    d->file_eof = br == 0;
+    memset(d->decode_buffer + d->bytes_in_buffer, 0, MAD_BUFFER_GUARD);
+    mad_stream_init(&d->stream);
+    mad_frame_mute(&d->frame);
+    mad_synth_mute(&d->synth);
+
+    d->discard = abs_pos - at * spf;
+    d->sample_pos = target;
+    d->seek_to = NO_SEEK;
+    return true;
+}
+
+// Last track sample to decode: the loop end while looping, else the exact
+// length when the headers or the index give one.
+static uint32_t track_end(const mp3_player_t *player) {
+    const mp3_decoder_t *d = dec(player);
+    if (player->loop && d->loop_end)
+        return d->loop_end;
+    bool exact;
+    uint32_t len = mp3_seek_length(&d->seek, &exact);
+    return exact && len ? len : UINT32_MAX;
+}
+
+// Decoded through the track (or loop range): jump back to the loop start
+// while the rings still hold the tail, or let them drain and stop.
+static void track_end_reached(mp3_player_t *player) {
+    mp3_decoder_t *d = dec(player);
+    if (player->loop && !d->fed) {
+        d->wrap_at = d->sample_pos;
+        d->looped = true;
+        d->seek_to = d->loop_start;
+        decoder_seek(d, false);
+    } else {
+        d->eof = true;
+    }
+}
+
+// libmad synthesises mono into channel 0 only.  Copy it across a whole
+// frame at a time (one word per sample pair) so the frame goes into the
+// PCM ring as a single stereo write.
+static void widen_mono(struct mad_pcm *pcm) {
+    uint32_t *w = (uint32_t *)pcm->samplesX;
+    unsigned int n = pcm->length;
+    for (unsigned int i = 0; i < n; i++) {
+        uint32_t l = w[i] & 0xFFFF;
+        w[i] = l | (l << 16);
+    }
 }
 
 // ── Decode: fill PCM ring buffer (called from main loop, NOT ISR) ───────────
-static void decode_fill_ring(void) {
-    if (!s_player.playing || s_player.paused || !s_mad_stream)
+static void decode_fill_ring(mp3_player_t *player) {
+    mp3_decoder_t *d = dec(player);
+    if (!player->playing || player->paused)
         return;
-    if (!s_fed_mode && !s_file)
+    if (!d->fed && !d->file)
+        return;
+    if (d->eof)
+        return;
+    if (d->seek_to != NO_SEEK && !decoder_seek(d, false))
         return;
 
     // Batch decode: only decode when ring buffer is below 50% capacity,
     // then decode up to 3 frames to refill quickly.  This creates bursty
     // PSRAM access (~10ms decode burst, ~30-40ms idle) instead of constant
     // pressure every 5ms, reducing QMI contention with Core 0's XIP cache.
-    size_t avail = ring_available();
+    size_t avail = ring_available(d);
     if (avail > PCM_RING_SIZE / 2)
         return;  // ring buffer is >50% full, skip this cycle
 
+    struct mad_stream *stream = &d->stream;
     int max_frames = 3;
     int frames_decoded = 0;
-    int errors_this_update = 0;
-    while (frames_decoded < max_frames && ring_free() >= 1152 * 2 * 2) {
-        mad_stream_buffer(s_mad_stream, s_decode_buffer + s_buffer_pos, s_bytes_in_buffer + MAD_BUFFER_GUARD);
+    int errors = 0;
+    while (frames_decoded < max_frames && ring_free(d) >= 1152 * 2 * 2 &&
+           !d->eof && d->seek_to == NO_SEEK && errors < MAX_ERRORS_PER_UPDATE) {
+        mad_stream_buffer(stream, d->decode_buffer + d->buffer_pos, d->bytes_in_buffer + MAD_BUFFER_GUARD);
 
-        if (mad_frame_decode(s_mad_frame, s_mad_stream) != 0) {
+        if (mad_frame_decode(&d->frame, stream) != 0) {
             // Track consumed bytes
-            if (s_mad_stream->next_frame) {
-                int consumed = (int)(s_mad_stream->next_frame - (s_decode_buffer + s_buffer_pos));
-                if (consumed > 0 && consumed <= s_bytes_in_buffer) {
-                    s_buffer_pos += consumed;
-                    s_bytes_in_buffer -= consumed;
+            if (stream->next_frame) {
+                int consumed = (int)(stream->next_frame - (d->decode_buffer + d->buffer_pos));
+                if (consumed > 0 && consumed <= d->bytes_in_buffer) {
+                    d->buffer_pos += consumed;
+                    d->bytes_in_buffer -= consumed;
                 }
             }
 
-            if (s_mad_stream->error == MAD_ERROR_BUFLEN) {
-                if (!refill_decode_buffer()) {
-                    if (s_fed_mode) {
-                        // Fed mode: no more data right now, just break
+            errors++;
+            if (stream->error == MAD_ERROR_BUFLEN) {
+                if (!refill_decode_buffer(d)) {
+                    // Fed mode or a busy card: no more data right now
+                    if (!d->fed && d->file_eof)
+                        track_end_reached(player);
+                    else
                         break;
-                    }
-                    if (s_player.loop) {
-                        sdcard_fseek(s_file, 0);
-                        s_bytes_in_buffer = 0;
-                        s_buffer_pos = 0;
-                        refill_decode_buffer();
-                        mad_stream_init(s_mad_stream);
-                        mad_frame_init(s_mad_frame);
-                        mad_synth_init(s_mad_synth);
-                        continue;
-                    }
-                    s_player.playing = false;
-                    break;
                 }
                 continue;
             }
 
-            if (MAD_RECOVERABLE(s_mad_stream->error)) {
+            if (MAD_RECOVERABLE(stream->error)) {
                 // For LOSTSYNC with low buffer, try to refill first
-                if (s_mad_stream->error == MAD_ERROR_LOSTSYNC && s_bytes_in_buffer < 256) {
-                    if (!refill_decode_buffer()) {
-                        if (s_fed_mode) {
+                if (stream->error == MAD_ERROR_LOSTSYNC && d->bytes_in_buffer < 256) {
+                    if (!refill_decode_buffer(d)) {
+                        if (!d->fed && d->file_eof)
+                            track_end_reached(player);
+                        else
                             break;
-                        }
-                        if (s_player.loop) {
-                            sdcard_fseek(s_file, 0);
-                            s_bytes_in_buffer = 0;
-                            s_buffer_pos = 0;
-                            refill_decode_buffer();
-                            mad_stream_init(s_mad_stream);
-                            mad_frame_init(s_mad_frame);
-                            mad_synth_init(s_mad_synth);
-                            continue;
-                        }
-                        s_player.playing = false;
-                        break;
                     }
                     continue;
                 }
-                
+
+                // Just after a seek the bit reservoir is empty: the frame
+                // is lost, and would have been dropped as preroll anyway
+                if (stream->error == MAD_ERROR_BADDATAPTR) {
+                    uint32_t spf = 32 * MAD_NSBSAMPLES(&d->frame.header);
+                    d->discard = d->discard > spf ? d->discard - spf : 0;
+                }
+
                 // Allow more recoverable errors - don't count toward the error limit
                 // just continue to next frame
                 continue;
             }
 
             // Non-recoverable error — stop
-            printf("[MP3] libmad error: 0x%04x\n", s_mad_stream->error);
-            s_player.playing = false;
+            printf("[MP3] libmad error: 0x%04x\n", stream->error);
+            player->playing = false;
             break;
         }
 
         // Track consumed bytes on success
-        if (s_mad_stream->next_frame) {
-            int consumed = (int)(s_mad_stream->next_frame - (s_decode_buffer + s_buffer_pos));
-            if (consumed > 0 && consumed <= s_bytes_in_buffer) {
-                s_buffer_pos += consumed;
-                s_bytes_in_buffer -= consumed;
+        if (stream->next_frame) {
+            int consumed = (int)(stream->next_frame - (d->decode_buffer + d->buffer_pos));
+            if (consumed > 0 && consumed <= d->bytes_in_buffer) {
+                d->buffer_pos += consumed;
+                d->bytes_in_buffer -= consumed;
             }
         }
 
-        mad_synth_frame(s_mad_synth, s_mad_frame);
+        mad_synth_frame(&d->synth, &d->frame);
         frames_decoded++;
 
-        struct mad_pcm *pcm = &s_mad_synth->pcm;
-        s_pcm_channels = pcm->channels;
-        unsigned int nsamples = pcm->length;
-
-        if (pcm->channels == 2) {
-            // Stereo: samplesX is already interleaved [sample][2] int16_t
-            ring_write((const uint8_t *)pcm->samplesX, nsamples * 2 * sizeof(int16_t));
-        } else {
-            // Mono: write only left channel (samplesX[n][0])
-            for (unsigned int i = 0; i < nsamples; i++) {
-                ring_write((const uint8_t *)&pcm->samplesX[i][0], sizeof(int16_t));
-            }
-        }
+        // samplesX is interleaved [sample][2] int16_t: one write per frame,
+        // less any seek preroll at the front and anything past the end
+        struct mad_pcm *pcm = &d->synth.pcm;
+        if (pcm->channels == 1)
+            widen_mono(pcm);
+        uint32_t skip = d->discard < pcm->length ? d->discard : pcm->length;
+        uint32_t keep = pcm->length - skip;
+        uint32_t end = track_end(player);
+        uint32_t left = end > d->sample_pos ? end - d->sample_pos : 0;
+        d->discard -= skip;
+        if (keep > left)
+            keep = left;
+        ring_write(d, (const uint8_t *)pcm->samplesX[skip], keep * 2 * sizeof(int16_t));
+        d->sample_pos += keep;
+        if (d->sample_pos >= end)
+            track_end_reached(player);
     }
 }
 
-// ── Stop DMA and PWM ────────────────────────────────────────────────────────
-static void stop_playback(void) {
-    s_dma_start_pending = false;           // cancel any deferred start
-    if (s_dma_chan >= 0) {
-        dma_channel_set_irq1_enabled(s_dma_chan, false); // prevent ISR restart
-        dma_channel_abort(s_dma_chan);
-    }
-    s_dma_active = false;
-    // Midpoint is true silence for AC-coupled output (no pop)
-    pwm_set_gpio_level(AUDIO_PIN_L, PWM_MID);
-    pwm_set_gpio_level(AUDIO_PIN_R, PWM_MID);
-    s_fade_state = FADE_NONE;
-    s_stop_after_fade = false;
+// ── Take the voice out of the mixer ─────────────────────────────────────────
+static void stop_playback(mp3_player_t *player) {
+    mp3_decoder_t *d = dec(player);
+    audio_mixer_remove_voice(mp3_voice_render, player);
+    d->voice_active = false;
+    d->ramp_pending = false;
+    d->env_step = 0;
+    d->stop_at_target = false;
 }
 
-// ── Helper to skip ID3v2 tags ───────────────────────────────────────────────
-static int skip_id3v2tag(struct mad_stream *stream) {
-    const unsigned char *ptr = stream->buffer;
-    size_t len = stream->bufend - stream->buffer;
+// ── Fade the voice out and wait until the mixer has played the ramp ─────────
+// Called with s_mp3_mutex held; drops it while waiting.
+static void fade_out_and_wait(mp3_player_t *player) {
+    mp3_decoder_t *d = dec(player);
+    if (!d->voice_active || !player->playing || player->paused)
+        return;
+    post_ramp(d, 0, CLICK_FADE_FRAMES, true);
 
+    // The ramp lands in the next mixed block: at most two blocks away.
+    mutex_exit(&s_mp3_mutex);
+    for (int i = 0; i < 20 && player->playing; i++)
+        sleep_ms(1);
+    mutex_enter_blocking(&s_mp3_mutex);
+}
+
+// ── Size of a leading ID3v2 tag, 0 if there is none ─────────────────────────
+static uint32_t id3v2_size(const uint8_t *ptr, int len) {
     if (len < 10) return 0;
 
     // ID3v2 header: "ID3" (3 bytes), version (2 bytes), flags (1 byte), size (4 bytes)
@@ -469,10 +560,7 @@ static int skip_id3v2tag(struct mad_stream *stream) {
         // If footer flag is set (bit 4 of flags byte 5), there's a 10-byte footer
         if (ptr[5] & 0x10) size += 10;
 
-        if (size > len) size = len; // sanity check
-
-        mad_stream_skip(stream, size);
-        return (int)size;
+        return (uint32_t)size;
     }
 
     return 0;
@@ -480,38 +568,34 @@ static int skip_id3v2tag(struct mad_stream *stream) {
 
 // ── Public API ──────────────────────────────────────────────────────────────
 
+static int player_slot(const mp3_player_t *player) {
+    return (int)(player - s_players);
+}
+
+static void decoder_free(mp3_player_t *player) {
+    mp3_decoder_t *d = dec(player);
+    if (!d) return;
+    stop_playback(player);
+    if (d->file) { sdcard_fclose(d->file); d->file = NULL; }
+    mp3_seek_close(&d->seek);
+    if (d->pcm_ring) umm_free(d->pcm_ring);
+    umm_free(d);
+    memset(player, 0, sizeof(*player));
+}
+
 void mp3_player_reset(void) {
     if (!s_initialized) return;
-    if (s_fed_mode) mp3_player_stop_fed();
+    if (s_fed_player) mp3_player_stop_fed();
     mutex_enter_blocking(&s_mp3_mutex);
-    stop_playback();
-    if (s_file) { sdcard_fclose(s_file); s_file = NULL; }
-    memset(&s_player, 0, sizeof(s_player));
-    s_player.volume = 100;
-    s_vol_scale = 256;
-    s_bytes_in_buffer = 0;
-    s_buffer_pos = 0;
-    s_pcm_channels = 2;
-
-    s_ring_rd = s_ring_wr = 0;
-    s_staging_avail = 0;
-    s_staging_pos = 0;
-    if (s_mad_stream) mad_stream_init(s_mad_stream);
-    if (s_mad_frame)  mad_frame_init(s_mad_frame);
-    if (s_mad_synth)  mad_synth_init(s_mad_synth);
+    for (int i = 0; i < MP3_MAX_PLAYERS; i++)
+        decoder_free(&s_players[i]);
     mutex_exit(&s_mp3_mutex);
 }
 
 void mp3_player_deinit(void) {
     if (!s_initialized) return;
+    mp3_player_reset();
     mutex_enter_blocking(&s_mp3_mutex);
-    stop_playback();
-    if (s_file) { sdcard_fclose(s_file); s_file = NULL; }
-    if (s_mad_stream) { umm_free(s_mad_stream); s_mad_stream = NULL; }
-    if (s_mad_frame)  { umm_free(s_mad_frame); s_mad_frame = NULL; }
-    if (s_mad_synth)  { umm_free(s_mad_synth); s_mad_synth = NULL; }
-    if (s_pcm_ring)   { umm_free(s_pcm_ring); s_pcm_ring = NULL; }
-    s_use_pio_psram = false;
     s_initialized = false;
     mutex_exit(&s_mp3_mutex);
 }
@@ -519,51 +603,12 @@ void mp3_player_deinit(void) {
 bool mp3_player_init(void) {
     if (s_initialized) return true;
 
-    mutex_init(&s_mp3_mutex);
-    printf("[MP3] Initializing libmad decoder...\n");
+    if (!mutex_is_initialized(&s_mp3_mutex))
+        mutex_init(&s_mp3_mutex);
+    printf("[MP3] Initializing libmad decoder (%d players, %u bytes each)...\n",
+           MP3_MAX_PLAYERS, (unsigned)sizeof(mp3_decoder_t));
 
-    if (!s_mad_stream) {
-        s_mad_stream = umm_malloc(sizeof(struct mad_stream));
-        if (!s_mad_stream) { printf("[MP3] FAILED to alloc mad_stream\n"); return false; }
-    }
-    if (!s_mad_frame) {
-        s_mad_frame = umm_malloc(sizeof(struct mad_frame));
-        if (!s_mad_frame) { printf("[MP3] FAILED to alloc mad_frame\n"); return false; }
-    }
-    if (!s_mad_synth) {
-        s_mad_synth = umm_malloc(sizeof(struct mad_synth));
-        if (!s_mad_synth) { printf("[MP3] FAILED to alloc mad_synth\n"); return false; }
-    }
-
-    mad_stream_init(s_mad_stream);
-    mad_frame_init(s_mad_frame);
-    mad_synth_init(s_mad_synth);
-
-    printf("[MP3] libmad structs: stream=%u frame=%u synth=%u bytes\n",
-           (unsigned)sizeof(struct mad_stream),
-           (unsigned)sizeof(struct mad_frame),
-           (unsigned)sizeof(struct mad_synth));
-
-    if (!s_pcm_ring && !s_use_pio_psram) {
-        if (pio_psram_available()) {
-            s_use_pio_psram = true;
-            s_pio_psram_base = PIO_PSRAM_MP3_RING_BASE;
-            printf("[MP3] PCM ring buffer → PIO PSRAM @ 0x%lx (%d bytes, 8KB bulk xfers)\n",
-                   (unsigned long)s_pio_psram_base, PCM_RING_SIZE);
-        } else {
-            s_pcm_ring = umm_malloc(PCM_RING_SIZE);
-            if (!s_pcm_ring) {
-                printf("[MP3] FAILED to alloc ring buffer\n");
-                return false;
-            }
-            s_use_pio_psram = false;
-            printf("[MP3] PCM ring buffer → QMI PSRAM (umm_malloc, %d bytes)\n", PCM_RING_SIZE);
-        }
-    }
-
-    memset(&s_player, 0, sizeof(s_player));
-    s_player.volume = 100;
-    s_vol_scale = 256;
+    memset(s_players, 0, sizeof(s_players));
     s_initialized = true;
 
     return true;
@@ -573,219 +618,260 @@ mp3_player_t *mp3_player_create(void) {
     if (!s_initialized) {
         mp3_player_init();
     }
-    return &s_player;
+
+    mutex_enter_blocking(&s_mp3_mutex);
+    mp3_player_t *player = NULL;
+    for (int i = 0; i < MP3_MAX_PLAYERS; i++) {
+        if (!s_players[i].decoder) {
+            player = &s_players[i];
+            break;
+        }
+    }
+    if (!player) {
+        mutex_exit(&s_mp3_mutex);
+        printf("[MP3] No free player (max %d)\n", MP3_MAX_PLAYERS);
+        return NULL;
+    }
+
+    mp3_decoder_t *d = umm_malloc(sizeof(mp3_decoder_t));
+    if (!d) {
+        mutex_exit(&s_mp3_mutex);
+        printf("[MP3] FAILED to alloc decoder\n");
+        return NULL;
+    }
+    memset(d, 0, sizeof(*d));
+
+    // Each slot owns a fixed PCM ring in PIO PSRAM: slot 0 the original
+    // MP3 ring, the others the extra MP3 region below the sound bank.
+    int slot = player_slot(player);
+    if (pio_psram_available()) {
+        d->pio_base = slot == 0 ? PIO_PSRAM_MP3_RING_BASE
+                                : PIO_PSRAM_MP3_EXTRA_BASE + (uint32_t)(slot - 1) * PCM_RING_SIZE;
+    } else {
+        d->pcm_ring = umm_malloc(PCM_RING_SIZE);
+        if (!d->pcm_ring) {
+            umm_free(d);
+            mutex_exit(&s_mp3_mutex);
+            printf("[MP3] FAILED to alloc ring buffer\n");
+            return NULL;
+        }
+    }
+
+    mad_stream_init(&d->stream);
+    mad_frame_init(&d->frame);
+    mad_synth_init(&d->synth);
+    audio_ring_init(&d->out, d->out_buf, OUT_RING_FRAMES, 44100);
+    d->vol_scale = 256;
+    d->env = ENV_UNITY;
+    d->level = ENV_UNITY;
+    d->seek_to = NO_SEEK;
+
+    memset(player, 0, sizeof(*player));
+    player->volume = 100;
+    player->decoder = d;
+    mutex_exit(&s_mp3_mutex);
+    return player;
 }
 
 void mp3_player_destroy(mp3_player_t *player) {
-    (void)player;
+    if (!player || !player->decoder) return;
     mp3_player_stop(player);
+    mutex_enter_blocking(&s_mp3_mutex);
+    decoder_free(player);
+    mutex_exit(&s_mp3_mutex);
 }
 
 bool mp3_player_load(mp3_player_t *player, const char *path) {
-    if (!player || !path) return false;
-
-    // Stop fed mode if active (video audio and file playback are mutually exclusive)
-    if (s_fed_mode) mp3_player_stop_fed();
+    if (!player || !player->decoder || !path) return false;
+    mp3_decoder_t *d = dec(player);
+    if (d->fed) return false;
 
     mutex_enter_blocking(&s_mp3_mutex);
 
-    stop_playback();
+    stop_playback(player);
+    player->playing = false;
 
-    if (s_file) { sdcard_fclose(s_file); s_file = NULL; }
+    if (d->file) { sdcard_fclose(d->file); d->file = NULL; }
+    mp3_seek_close(&d->seek);
 
-    s_file = sdcard_fopen(path, "rb");
-    if (!s_file) {
+    d->file = sdcard_fopen(path, "rb");
+    if (!d->file) {
         printf("mp3_player: failed to open %s\n", path);
         mutex_exit(&s_mp3_mutex);
         return false;
     }
 
-    int rd = sdcard_fread(s_file, s_decode_buffer, MP3_DECODE_BUFFER_SIZE - MAD_BUFFER_GUARD);
+    int rd = sdcard_fread(d->file, d->decode_buffer, MP3_DECODE_BUFFER_SIZE - MAD_BUFFER_GUARD);
+
+    // Skip ID3v2 tags (mad_header_decode doesn't do this automatically).
+    // Cover art easily outgrows the buffer, so read again past the tag.
+    d->data_start = id3v2_size(d->decode_buffer, rd);
+    if (d->data_start > 0) {
+        rd = -1;
+        if (sdcard_fseek(d->file, d->data_start))
+            rd = sdcard_fread(d->file, d->decode_buffer, MP3_DECODE_BUFFER_SIZE - MAD_BUFFER_GUARD);
+    }
     if (rd <= 0) {
-        sdcard_fclose(s_file); s_file = NULL;
+        sdcard_fclose(d->file); d->file = NULL;
         mutex_exit(&s_mp3_mutex);
         return false;
     }
-    s_bytes_in_buffer = rd;
-    s_buffer_pos = 0;
+    d->bytes_in_buffer = rd;
+    d->buffer_pos = 0;
 
-    s_ring_rd = s_ring_wr = 0;
+    d->ring_rd = d->ring_wr = 0;
 
     // Zero-pad guard bytes
-    memset(s_decode_buffer + s_bytes_in_buffer, 0, MAD_BUFFER_GUARD);
+    memset(d->decode_buffer + d->bytes_in_buffer, 0, MAD_BUFFER_GUARD);
 
     // Re-init libmad state for clean decode
-    mad_stream_init(s_mad_stream);
-    mad_frame_init(s_mad_frame);
-    mad_synth_init(s_mad_synth);
-
-    // Probe first frame header (skipping ID3 tags if present)
-    mad_stream_buffer(s_mad_stream, s_decode_buffer, s_bytes_in_buffer + MAD_BUFFER_GUARD);
-    
-    // Skip ID3v2 tags (mad_header_decode doesn't do this automatically)
-    int tag_len = skip_id3v2tag(s_mad_stream);
-    if (tag_len > 0) {
-        // consumed from s_decode_buffer
-        s_buffer_pos += tag_len;
-        s_bytes_in_buffer -= tag_len;
-    }
+    mad_stream_init(&d->stream);
+    mad_frame_init(&d->frame);
+    mad_synth_init(&d->synth);
 
-    if (mad_header_decode(&s_mad_frame->header, s_mad_stream) != 0) {
+    // Probe first frame header
+    mad_stream_buffer(&d->stream, d->decode_buffer, d->bytes_in_buffer + MAD_BUFFER_GUARD);
+    if (mad_header_decode(&d->frame.header, &d->stream) != 0) {
         printf("mp3_player: not an MP3 file (%s)\n", path);
-        sdcard_fclose(s_file); s_file = NULL;
+        sdcard_fclose(d->file); d->file = NULL;
         mutex_exit(&s_mp3_mutex);
         return false;
     }
 
-    player->sample_rate = s_mad_frame->header.samplerate;
-    player->channels    = MAD_NCHANNELS(&s_mad_frame->header);
-    player->length      = 0;
+    player->sample_rate = d->frame.header.samplerate;
+    player->channels    = MAD_NCHANNELS(&d->frame.header);
     player->position    = 0;
-    s_pcm_channels      = player->channels;
+
+    // Seek index: Xing/VBRI from this first frame, offsets from the cache
+    // or a background scan.  Without one, seeks decode from the start.
+    uint32_t first = (uint32_t)(d->stream.this_frame - d->decode_buffer);
+    if (!mp3_seek_open(&d->seek, path, d->stream.this_frame,
+                       (uint32_t)d->bytes_in_buffer - first, d->data_start + first))
+        printf("mp3_player: no seek index for %s\n", path);
+    player->length = mp3_seek_length(&d->seek, NULL);
 
     printf("mp3_player: loaded %s (%lu Hz, %lu ch)\n", path, (unsigned long)player->sample_rate, (unsigned long)player->channels);
 
-    // Re-init for clean decode from beginning (header_decode consumed some bytes)
-    mad_stream_init(s_mad_stream);
-    mad_frame_init(s_mad_frame);
-    mad_synth_init(s_mad_synth);
-    // Reset buffer position to start
-    s_buffer_pos = 0;
+    // Re-init for clean decode; play() seeks to the first audio frame
+    mad_stream_init(&d->stream);
+    mad_frame_init(&d->frame);
+    mad_synth_init(&d->synth);
+    d->seek_to = NO_SEEK;
+    d->start_at = 0;
+    d->loop_start = d->loop_end = 0;
+    d->looped = false;
+    d->start_pending = false;
 
     mutex_exit(&s_mp3_mutex);
     return true;
 }
 
-// ── Setup PWM + DMA and request deferred start on Core 1 ─────────────────────
-// Configures all hardware but does NOT start DMA or register the IRQ.
-// Sets s_dma_start_pending so mp3_player_update() on Core 1 finishes the job,
-// ensuring the DMA ISR fires on Core 1 (not the game loop core).
-static void setup_playback_hw(void) {
-    // Configure PWM with fractional divider for accurate sample rate
-    gpio_set_function(AUDIO_PIN_L, GPIO_FUNC_PWM);
-    gpio_set_function(AUDIO_PIN_R, GPIO_FUNC_PWM);
-    s_pwm_slice = pwm_gpio_to_slice_num(AUDIO_PIN_L);
-
-    uint32_t sys_clk = clock_get_hz(clk_sys);
-    uint32_t target = s_player.sample_rate * (uint32_t)(PWM_WRAP + 1);
-    uint32_t div_int = sys_clk / target;
-    uint32_t remainder = sys_clk - div_int * target;
-    uint32_t div_frac = (remainder * 16 + target / 2) / target;
-    if (div_int < 1) { div_int = 1; div_frac = 0; }
-
-    pwm_config cfg = pwm_get_default_config();
-    pwm_config_set_wrap(&cfg, PWM_WRAP);
-    pwm_config_set_clkdiv_int_frac(&cfg, div_int, div_frac);
-    pwm_init(s_pwm_slice, &cfg, true);
-
-    // Set up DMA channel paced by PWM wrap DREQ
-    if (s_dma_chan < 0)
-        s_dma_chan = dma_claim_unused_channel(true);
-
-    dma_channel_config dc = dma_channel_get_default_config(s_dma_chan);
-    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
-    channel_config_set_read_increment(&dc, true);
-    channel_config_set_write_increment(&dc, false);
-    channel_config_set_dreq(&dc, DREQ_PWM_WRAP0 + s_pwm_slice);
-
-    dma_channel_configure(s_dma_chan, &dc,
-        &pwm_hw->slice[s_pwm_slice].cc,
-        s_dma_buf[0],
-        DMA_BUF_SAMPLES,
-        false);                             // don't start yet
-
-    // Enable DMA IRQ for this channel (shared DMA register, core-independent)
-    dma_channel_set_irq1_enabled(s_dma_chan, true);
-
-    // Fade in from silence to avoid pop
-    s_fade_state = FADE_IN;
-    s_fade_pos = 0;
-    s_stop_after_fade = false;
-
-    // Pre-fill both DMA ping-pong buffers
-    fill_dma_buffer(s_dma_buf[0], DMA_BUF_SAMPLES);
-    fill_dma_buffer(s_dma_buf[1], DMA_BUF_SAMPLES);
-    s_dma_active_buf = 0;
-
-    // Signal Core 1 to register IRQ handler and start DMA
-    s_dma_start_pending = true;
+// ── Hand the output ring to the mixer, ramping up from silence ──────────────
+// The ramp ends at the level of the last fade(), so one set while stopped or
+// paused holds when the output starts.
+static void start_output(mp3_player_t *player, uint32_t fade_frames) {
+    mp3_decoder_t *d = dec(player);
+    audio_ring_set_rate(&d->out, player->sample_rate);
+    d->out.gain_l = (uint16_t)d->vol_scale;
+    d->out.gain_r = (uint16_t)d->vol_scale;
+
+    // The voice isn't in the mixer yet, so the envelope is ours to set.
+    d->env = 0;
+    d->env_step = 0;
+    d->stop_at_target = false;
+    post_ramp(d, d->level, fade_frames, false);
+
+    d->voice_active = audio_mixer_add_voice(mp3_voice_render, player);
 }
 
-bool mp3_player_play(mp3_player_t *player, uint8_t repeat_count) {
-    (void)repeat_count;
-    if (!player || !s_file) return false;
-
-    mutex_enter_blocking(&s_mp3_mutex);
+static bool play_locked(mp3_player_t *player, uint32_t fade_frames) {
+    mp3_decoder_t *d = dec(player);
+    if (!d->file) return false;
 
+    stop_playback(player);
     player->playing = true;
     player->paused  = false;
 
+    ring_reset(d);
+    d->eof = false;
+    d->looped = false;
+    d->seek_to = d->start_at;
+    d->start_at = 0;
+    player->position = d->seek_to;
+    if (!decoder_seek(d, true)) {
+        // The index hasn't reached the start point yet: Core 1 finishes
+        // the seek and starts the output
+        d->start_fade = fade_frames;
+        d->start_pending = true;
+        return true;
+    }
+    d->start_pending = false;
+
     // Pre-fill ring buffer before starting playback
-    s_ring_rd = s_ring_wr = 0;
-    s_staging_avail = 0;
-    s_staging_pos = 0;
-    decode_fill_ring();
-    refill_staging_buf();
+    decode_fill_ring(player);
+    refill_out_ring(d);
+
+    start_output(player, fade_frames);
+    return true;
+}
 
-    setup_playback_hw();
+bool mp3_player_play(mp3_player_t *player, uint8_t repeat_count) {
+    (void)repeat_count;
+    if (!player || !player->decoder) return false;
 
+    mutex_enter_blocking(&s_mp3_mutex);
+    bool ok = play_locked(player, CLICK_FADE_FRAMES);
     mutex_exit(&s_mp3_mutex);
-    return true;
+    return ok;
 }
 
 void mp3_player_stop(mp3_player_t *player) {
-    if (!player) return;
+    if (!player || !player->decoder) return;
 
-    // If in fed mode, delegate to stop_fed
-    if (s_fed_mode) {
+    // The fed player belongs to the video player
+    if (player == s_fed_player) {
         mp3_player_stop_fed();
         return;
     }
 
+    mp3_decoder_t *d = dec(player);
     mutex_enter_blocking(&s_mp3_mutex);
 
-    // If DMA is active, fade out before stopping to avoid pop
-    if (s_dma_active && player->playing) {
-        s_fade_state = FADE_OUT;
-        s_fade_pos = 0;
-        s_stop_after_fade = true;
-
-        // Wait for fade to complete (~1.5ms at 44.1kHz)
-        mutex_exit(&s_mp3_mutex);
-        sleep_ms(3);
-        mutex_enter_blocking(&s_mp3_mutex);
-    }
+    // Fade out before stopping to avoid pop
+    fade_out_and_wait(player);
 
     player->playing  = false;
     player->paused   = false;
     player->position = 0;
 
-    stop_playback();
-
-    if (s_file) { sdcard_fclose(s_file); s_file = NULL; }
+    stop_playback(player);
 
-    s_bytes_in_buffer = 0;
-    s_buffer_pos = 0;
-    s_ring_rd = s_ring_wr = 0;
-    s_staging_avail = 0;
-    s_staging_pos = 0;
+    // The file and its index stay open: play() starts again from the top
+    d->start_pending = false;
+    d->seek_to = NO_SEEK;
+    d->start_at = 0;
+    d->bytes_in_buffer = 0;
+    d->buffer_pos = 0;
+    ring_reset(d);
 
     mutex_exit(&s_mp3_mutex);
 }
 
 void mp3_player_pause(mp3_player_t *player) {
-    if (!player || !player->playing) return;
+    if (!player || !player->decoder || !player->playing) return;
     mutex_enter_blocking(&s_mp3_mutex);
     player->paused = true;
-    stop_playback();       // abort DMA + silence PWM — zero ISR overhead
+    stop_playback(player);   // out of the mixer; buffered PCM stays queued
     mutex_exit(&s_mp3_mutex);
 }
 
 void mp3_player_resume(mp3_player_t *player) {
-    if (!player || !player->paused || !player->playing) return;
+    if (!player || !player->decoder || !player->paused || !player->playing) return;
     mutex_enter_blocking(&s_mp3_mutex);
     player->paused = false;
-    setup_playback_hw();   // reconfigure PWM + DMA, deferred start on Core 1
+    decode_fill_ring(player);   // tops up after a seek while paused
+    refill_out_ring(dec(player));
+    start_output(player, CLICK_FADE_FRAMES);
     mutex_exit(&s_mp3_mutex);
 }
 
@@ -794,20 +880,62 @@ bool mp3_player_is_playing(const mp3_player_t *player) {
 }
 
 uint32_t mp3_player_get_position(const mp3_player_t *player) {
-    if (!player) return 0;
-    return player->position / player->channels;
+    if (!player || !player->decoder) return 0;
+    const mp3_decoder_t *d = dec(player);
+    uint32_t pos = player->position;
+    // The mixer counts straight on through a loop's wrap point
+    if (d->looped && d->wrap_at > d->loop_start && pos >= d->wrap_at)
+        pos = d->loop_start + (pos - d->loop_start) % (d->wrap_at - d->loop_start);
+    return pos;
 }
 
 uint32_t mp3_player_get_length(const mp3_player_t *player) {
-    if (!player) return 0;
-    return player->length;
+    if (!player || !player->decoder) return 0;
+    const mp3_decoder_t *d = dec(player);
+    return d->fed ? player->length : mp3_seek_length(&d->seek, NULL);
+}
+
+void mp3_player_set_offset(mp3_player_t *player, uint32_t sample) {
+    if (!player || !player->decoder) return;
+    mp3_decoder_t *d = dec(player);
+    if (d->fed || !d->file) return;
+
+    mutex_enter_blocking(&s_mp3_mutex);
+    if (player->playing && !player->paused) {
+        fade_out_and_wait(player);
+        d->start_at = sample;
+        play_locked(player, CLICK_FADE_FRAMES);
+    } else if (player->playing) {
+        // Paused: seek now, resume() picks up from there
+        ring_reset(d);
+        d->eof = false;
+        d->looped = false;
+        d->seek_to = sample;
+        player->position = sample;
+        decoder_seek(d, true);
+    } else {
+        d->start_at = sample;
+        player->position = sample;
+    }
+    mutex_exit(&s_mp3_mutex);
+}
+
+void mp3_player_set_loop_range(mp3_player_t *player, uint32_t start, uint32_t end) {
+    if (!player || !player->decoder) return;
+    mp3_decoder_t *d = dec(player);
+    player->loop = true;
+    d->loop_start = start;
+    d->loop_end = end > start ? end : 0;
 }
 
 void mp3_player_set_volume(mp3_player_t *player, uint8_t volume) {
-    if (!player) return;
+    if (!player || !player->decoder) return;
+    mp3_decoder_t *d = dec(player);
     if (volume > 100) volume = 100;
     player->volume = volume;
-    s_vol_scale = (uint32_t)volume * 256 / 100;
+    d->vol_scale = (uint32_t)volume * 256 / 100;
+    d->out.gain_l = (uint16_t)d->vol_scale;
+    d->out.gain_r = (uint16_t)d->vol_scale;
 }
 
 uint8_t mp3_player_get_volume(const mp3_player_t *player) {
@@ -825,6 +953,45 @@ void mp3_player_set_loop(mp3_player_t *player, bool loop) {
     player->loop = loop;
 }
 
+static uint32_t ms_to_frames(uint32_t ms) {
+    uint32_t frames = (uint32_t)((uint64_t)ms * AUDIO_MIXER_RATE / 1000);
+    return frames ? frames : 1;
+}
+
+void mp3_player_fade(mp3_player_t *player, uint8_t level, uint32_t ms, bool stop) {
+    if (!player || !player->decoder) return;
+    mp3_decoder_t *d = dec(player);
+    if (level > 100) level = 100;
+    int32_t target = (int32_t)((uint32_t)level * 256 / 100) << 16;
+
+    mutex_enter_blocking(&s_mp3_mutex);
+    // A fade out that stops leaves the level alone: the next play() comes
+    // back at the level it was stopped from.
+    if (!(stop && level == 0))
+        d->level = target;
+    if (d->voice_active && player->playing && !player->paused) {
+        post_ramp(d, target, ms_to_frames(ms), stop && level == 0);
+    } else if (stop && level == 0) {
+        // Nothing audible to ramp: just stop
+        stop_playback(player);
+        player->playing = false;
+        player->paused = false;
+    }
+    mutex_exit(&s_mp3_mutex);
+}
+
+bool mp3_player_crossfade(mp3_player_t *from, mp3_player_t *to, uint32_t ms) {
+    if (!to || !to->decoder || to == from) return false;
+
+    mutex_enter_blocking(&s_mp3_mutex);
+    bool ok = play_locked(to, ms_to_frames(ms));
+    mutex_exit(&s_mp3_mutex);
+
+    if (ok && from)
+        mp3_player_fade(from, 0, ms, true);
+    return ok;
+}
+
 // ── Fed mode API (video player audio) ─────────────────────────────────────────
 
 bool mp3_player_start_fed(uint32_t sample_rate, uint16_t channels) {
@@ -832,11 +999,20 @@ bool mp3_player_start_fed(uint32_t sample_rate, uint16_t channels) {
         if (!mp3_player_init()) return false;
     }
 
+    // The fed player is an instance of its own, so an app's music players
+    // keep going underneath the video's soundtrack.
+    if (!s_fed_player) {
+        s_fed_player = mp3_player_create();
+        if (!s_fed_player) return false;
+    }
+
     mutex_enter_blocking(&s_mp3_mutex);
+    mp3_player_t *player = s_fed_player;
+    mp3_decoder_t *d = dec(player);
 
     // Stop any current playback
-    stop_playback();
-    if (s_file) { sdcard_fclose(s_file); s_file = NULL; }
+    stop_playback(player);
+    if (d->file) { sdcard_fclose(d->file); d->file = NULL; }
 
     // Init fed ring in QMI PSRAM
     if (!s_fed_ring_buf) {
@@ -847,30 +1023,31 @@ bool mp3_player_start_fed(uint32_t sample_rate, uint16_t channels) {
             return false;
         }
     }
-    s_fed_mode = true;
+    d->fed = true;
     s_fed_wr = 0;
     s_fed_rd = 0;
 
     // Reset decode state
-    s_bytes_in_buffer = 0;
-    s_buffer_pos = 0;
-    s_ring_rd = s_ring_wr = 0;
-    s_staging_avail = 0;
-    s_staging_pos = 0;
+    d->bytes_in_buffer = 0;
+    d->buffer_pos = 0;
+    d->discard = 0;
+    d->sample_pos = 0;
+    d->eof = false;
+    ring_reset(d);
 
     // Init libmad
-    mad_stream_init(s_mad_stream);
-    mad_frame_init(s_mad_frame);
-    mad_synth_init(s_mad_synth);
+    mad_stream_init(&d->stream);
+    mad_frame_init(&d->frame);
+    mad_synth_init(&d->synth);
 
     // Configure player state
-    memset(&s_player, 0, sizeof(s_player));
-    s_player.sample_rate = sample_rate;
-    s_player.channels = channels;
-    s_player.playing = true;
-    s_player.volume = 100;
-    s_vol_scale = 256;
-    s_pcm_channels = (int)channels;
+    player->sample_rate = sample_rate;
+    player->channels = channels;
+    player->playing = true;
+    player->paused = false;
+    player->position = 0;
+    player->volume = 100;
+    d->vol_scale = 256;
 
     printf("[MP3] Fed mode started: %u Hz, %u ch\n",
            (unsigned)sample_rate, (unsigned)channels);
@@ -880,16 +1057,16 @@ bool mp3_player_start_fed(uint32_t sample_rate, uint16_t channels) {
 }
 
 void mp3_player_start_dma_fed(void) {
-    if (!s_fed_mode || !s_initialized) return;
+    if (!s_fed_player || !s_initialized) return;
 
     mutex_enter_blocking(&s_mp3_mutex);
 
     // Decode compressed data from fed ring into PCM ring
-    decode_fill_ring();
-    // Copy PCM data to SRAM staging buffer
-    refill_staging_buf();
-    // Configure PWM/DMA with real audio in the buffers (deferred start on Core 1)
-    setup_playback_hw();
+    decode_fill_ring(s_fed_player);
+    // Copy PCM data to the mixer's ring
+    refill_out_ring(dec(s_fed_player));
+    // Start mixing with real audio already queued
+    start_output(s_fed_player, CLICK_FADE_FRAMES);
 
     mutex_exit(&s_mp3_mutex);
 }
@@ -913,31 +1090,19 @@ uint32_t mp3_player_feed(const uint8_t *data, uint32_t len) {
 }
 
 void mp3_player_stop_fed(void) {
-    if (!s_fed_mode) return;
+    if (!s_fed_player) return;
 
     mutex_enter_blocking(&s_mp3_mutex);
+    mp3_player_t *player = s_fed_player;
 
     // Fade out if playing
-    if (s_dma_active && s_player.playing) {
-        s_fade_state = FADE_OUT;
-        s_fade_pos = 0;
-        s_stop_after_fade = true;
-        mutex_exit(&s_mp3_mutex);
-        sleep_ms(3);
-        mutex_enter_blocking(&s_mp3_mutex);
-    }
+    fade_out_and_wait(player);
 
-    stop_playback();
-    s_player.playing = false;
-    s_fed_mode = false;
+    s_fed_player = NULL;
+    decoder_free(player);
     s_fed_wr = 0;
     s_fed_rd = 0;
     if (s_fed_ring_buf) { umm_free(s_fed_ring_buf); s_fed_ring_buf = NULL; }
-    s_bytes_in_buffer = 0;
-    s_buffer_pos = 0;
-    s_ring_rd = s_ring_wr = 0;
-    s_staging_avail = 0;
-    s_staging_pos = 0;
 
     printf("[MP3] Fed mode stopped\n");
     mutex_exit(&s_mp3_mutex);
@@ -948,29 +1113,46 @@ uint32_t mp3_player_feed_space(void) {
 }
 
 bool mp3_player_is_fed_mode(void) {
-    return s_fed_mode;
+    return s_fed_player != NULL;
+}
+
+mp3_player_t *mp3_player_fed(void) {
+    return s_fed_player;
 }
 
 void mp3_player_update(void) {
     if (!s_initialized) return;
     if (!mutex_try_enter(&s_mp3_mutex, NULL)) return;
 
-    // Deferred DMA start: register the IRQ handler on THIS core (Core 1)
-    // so the audio ISR never preempts the game loop on Core 0.
-    if (s_dma_start_pending) {
-        if (!s_irq_on_core1) {
-            irq_set_exclusive_handler(DMA_IRQ_1, dma_audio_irq_handler);
-            irq_set_enabled(DMA_IRQ_1, true);
-            s_irq_on_core1 = true;
+    bool scanned = false;
+    for (int i = 0; i < MP3_MAX_PLAYERS; i++) {
+        mp3_player_t *player = &s_players[i];
+        mp3_decoder_t *d = dec(player);
+        if (!d) continue;
+
+        if (player->playing && !player->paused) {
+            refill_out_ring(d);
+            decode_fill_ring(player);
+            if (d->start_pending && d->seek_to == NO_SEEK) {
+                d->start_pending = false;
+                refill_out_ring(d);
+                start_output(player, d->start_fade);
+            } else if (d->eof && ring_available(d) == 0 && audio_ring_level(&d->out) == 0) {
+                // Played out to the end
+                player->playing = false;
+                stop_playback(player);
+            }
         }
-        s_dma_active = true;
-        dma_channel_start(s_dma_chan);
-        s_dma_start_pending = false;
-    }
 
-    if (s_player.playing && !s_player.paused) {
-        refill_staging_buf();
-        decode_fill_ring();
+        // One player's index grows per update, faster while a seek waits
+        if (!scanned && d->seek.scan_file) {
+            uint32_t budget = d->seek_to != NO_SEEK ? SCAN_BUDGET_SEEK : SCAN_BUDGET;
+            if (recursive_mutex_try_enter(&g_sdcard_mutex, NULL)) {
+                mp3_seek_scan(&d->seek, budget);
+                recursive_mutex_exit(&g_sdcard_mutex);
+            }
+            scanned = true;
+        }
     }
     mutex_exit(&s_mp3_mutex);
 }
@@ -4,14 +4,17 @@
 #include <stdbool.h>
 
 #define MP3_WORKING_BUFFER_SIZE 8192
+// Players decoding at once, each a mixer voice; the video player's fed
+// stream takes one while a video with audio is open.
+#define MP3_MAX_PLAYERS 4
 
 typedef struct {
-    void *decoder;
+    void *decoder;          // per-player decoder state, NULL if the slot is free
     uint8_t *working_buffer;
     bool playing;
     bool paused;
-    uint32_t position;
-    uint32_t length;
+    uint32_t position;      // samples heard since the last play/seek point
+    uint32_t length;        // samples, from the seek index at load
     uint8_t volume;
     bool loop;
     uint32_t sample_rate;
@@ -29,14 +32,30 @@ void mp3_player_stop(mp3_player_t *player);
 void mp3_player_pause(mp3_player_t *player);
 void mp3_player_resume(mp3_player_t *player);
 bool mp3_player_is_playing(const mp3_player_t *player);
+// Positions and lengths are in samples (frames) at the stream's rate,
+// excluding the encoder delay and padding of gapless (LAME) files.
 uint32_t mp3_player_get_position(const mp3_player_t *player);
 uint32_t mp3_player_get_length(const mp3_player_t *player);
+// Jump to a sample.  Exact once the seek index covers it; before that (a
+// file's first play) a Xing table gives an approximate jump, and without
+// one playback waits for the index to get there.
+void mp3_player_set_offset(mp3_player_t *player, uint32_t sample);
+// Loop [start, end) without a gap; end 0 = the end of the track.
+void mp3_player_set_loop_range(mp3_player_t *player, uint32_t start, uint32_t end);
 void mp3_player_set_volume(mp3_player_t *player, uint8_t volume);
 uint8_t mp3_player_get_volume(const mp3_player_t *player);
 void mp3_player_set_loop(mp3_player_t *player, bool loop);
 uint32_t mp3_player_get_sample_rate(const mp3_player_t *player);
 void mp3_player_update(void);
 
+// Ramp the player's level (0-100, applied on top of its volume) over ms.
+// With stop set, a ramp to 0 ends playback once it completes.  The level
+// persists: a player that is stopped or paused starts at it.
+void mp3_player_fade(mp3_player_t *player, uint8_t level, uint32_t ms, bool stop);
+// Start `to` from silence and ramp it up while `from` (may be NULL) ramps
+// down and stops, both over ms.
+bool mp3_player_crossfade(mp3_player_t *from, mp3_player_t *to, uint32_t ms);
+
 // Fed mode: decoder reads from an external ring buffer instead of SD file.
 // Used by video player to feed interleaved AVI audio data.
 bool     mp3_player_start_fed(uint32_t sample_rate, uint16_t channels);
@@ -45,3 +64,4 @@ uint32_t mp3_player_feed(const uint8_t *data, uint32_t len);
 void     mp3_player_stop_fed(void);
 uint32_t mp3_player_feed_space(void);
 bool     mp3_player_is_fed_mode(void);
+mp3_player_t *mp3_player_fed(void);   // the fed player, NULL when not in fed mode
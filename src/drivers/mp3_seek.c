@@ -0,0 +1,322 @@
+#include "mp3_seek.h"
+#include "umm_malloc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// On-disk index, followed by `count` uint32_t offsets.
+#define MP3_SEEK_MAGIC   0x4B534D50u  // "PMSK"
+#define MP3_SEEK_FORMAT  2
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t stride;
+    sdcard_file_id_t src;
+    uint32_t audio_start;
+    uint32_t total_frames;
+    uint32_t count;
+} mp3_seek_file_t;
+
+// Scanner read buffer; only Core 1 scans, one player at a time.
+#define SCAN_CHUNK 4096
+static uint8_t s_scan_buf[SCAN_CHUNK];
+
+static const uint16_t s_kbps_v1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t s_kbps_v2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+static const uint16_t s_rate_v1[3] = {44100, 48000, 32000};
+
+static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Bytes in the Layer III frame whose header is at p, 0 if p isn't one.
+// Free-format frames (bitrate index 0) can't be sized and are rejected.
+static uint32_t frame_bytes(const uint8_t *p, uint16_t *spf) {
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0)
+        return 0;
+    uint32_t ver = (p[1] >> 3) & 3;    // 0 = MPEG 2.5, 2 = MPEG 2, 3 = MPEG 1
+    uint32_t layer = (p[1] >> 1) & 3;  // 1 = Layer III
+    uint32_t br = p[2] >> 4;
+    uint32_t sr = (p[2] >> 2) & 3;
+    if (ver == 1 || layer != 1 || br == 0 || br == 15 || sr == 3)
+        return 0;
+    bool v1 = ver == 3;
+    uint32_t hz = s_rate_v1[sr] >> (v1 ? 0 : ver == 2 ? 1 : 2);
+    uint32_t kbps = v1 ? s_kbps_v1[br] : s_kbps_v2[br];
+    if (spf)
+        *spf = v1 ? 1152 : 576;
+    return (v1 ? 144000 : 72000) * kbps / hz + ((p[2] >> 1) & 1);
+}
+
+// Version, layer and sample rate may not change between frames of a file.
+#define HEADER_FIXED_BITS 0xFFFE0C00u
+
+static bool reserve(mp3_seek_t *s, uint32_t entries) {
+    if (entries <= s->capacity)
+        return true;
+    uint32_t cap = s->capacity ? s->capacity + s->capacity / 2 : 64;
+    if (cap < entries)
+        cap = entries;
+    uint32_t *grown = umm_realloc(s->offsets, cap * sizeof(uint32_t));
+    if (!grown)
+        return false;
+    s->offsets = grown;
+    s->capacity = cap;
+    return true;
+}
+
+static bool cache_load(mp3_seek_t *s) {
+    if (!s->cache_path[0])
+        return false;
+    int len = 0;
+    char *data = sdcard_read_file(s->cache_path, &len);
+    if (!data)
+        return false;
+
+    bool ok = false;
+    mp3_seek_file_t hdr;
+    if (len >= (int)sizeof(hdr)) {
+        memcpy(&hdr, data, sizeof(hdr));
+        ok = hdr.magic == MP3_SEEK_MAGIC && hdr.format == MP3_SEEK_FORMAT &&
+             hdr.stride == MP3_SEEK_STRIDE && sdcard_file_id_equal(&hdr.src, &s->src) &&
+             hdr.audio_start == s->audio_start && hdr.count > 0 &&
+             len == (int)(sizeof(hdr) + hdr.count * sizeof(uint32_t)) &&
+             reserve(s, hdr.count);
+    }
+    if (ok) {
+        memcpy(s->offsets, data + sizeof(hdr), hdr.count * sizeof(uint32_t));
+        s->count = hdr.count;
+        if (!s->total_frames)
+            s->total_frames = hdr.total_frames;
+        s->complete = true;
+    } else {
+        printf("[MP3] Stale or unreadable seek index %s\n", s->cache_path);
+    }
+    umm_free(data);
+    return ok;
+}
+
+static void cache_store(const mp3_seek_t *s) {
+    if (!s->cache_path[0])
+        return;
+    mp3_seek_file_t hdr = {
+        .magic = MP3_SEEK_MAGIC,
+        .format = MP3_SEEK_FORMAT,
+        .stride = MP3_SEEK_STRIDE,
+        .src = s->src,
+        .audio_start = s->audio_start,
+        .total_frames = s->scan_frames,
+        .count = s->count,
+    };
+    sdcard_part_t parts[] = {
+        {&hdr, sizeof(hdr)},
+        {s->offsets, s->count * sizeof(uint32_t)},
+    };
+    sdcard_write_file_atomic(s->cache_path, parts, 2);
+}
+
+// Reads the Xing/Info (with LAME tag) or VBRI header in the first frame.
+// Returns true if there was one: that frame is metadata, not audio.
+static bool parse_info_frame(mp3_seek_t *s, const uint8_t *frame, uint32_t avail) {
+    bool v1 = s->samples_per_frame == 1152;
+    bool mono = (frame[3] >> 6) == 3;
+    uint32_t side = v1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    const uint8_t *end = frame + (avail < s->first_frame_bytes ? avail : s->first_frame_bytes);
+    const uint8_t *x = frame + 4 + side;
+
+    if (x + 8 <= end && (memcmp(x, "Xing", 4) == 0 || memcmp(x, "Info", 4) == 0)) {
+        uint32_t flags = be32(x + 4);
+        const uint8_t *q = x + 8;
+        if ((flags & 1) && q + 4 <= end) {
+            s->total_frames = be32(q);
+            q += 4;
+        }
+        if (flags & 2)
+            q += 4;
+        if ((flags & 4) && q + 100 <= end) {
+            memcpy(s->toc, q, 100);
+            s->has_toc = true;
+            q += 100;
+        }
+        if (flags & 8)
+            q += 4;
+        // LAME extension: 9-byte encoder string, delay/padding 12 bits each
+        if (q + 24 <= end && (memcmp(q, "LAME", 4) == 0 || memcmp(q, "Lavc", 4) == 0 ||
+                              memcmp(q, "Lavf", 4) == 0)) {
+            s->enc_delay = (uint16_t)((q[21] << 4) | (q[22] >> 4));
+            s->enc_padding = (uint16_t)(((q[22] & 0x0F) << 8) | q[23]);
+            s->gapless = true;
+        }
+        return true;
+    }
+
+    const uint8_t *v = frame + 36;
+    if (v + 18 <= end && memcmp(v, "VBRI", 4) == 0) {
+        s->total_frames = be32(v + 14);
+        return true;
+    }
+    return false;
+}
+
+bool mp3_seek_open(mp3_seek_t *s, const char *path, const uint8_t *frame,
+                   uint32_t frame_avail, uint32_t frame_offset) {
+    memset(s, 0, sizeof(*s));
+    if (frame_avail < 4)
+        return false;
+    s->first_frame_bytes = (uint16_t)frame_bytes(frame, &s->samples_per_frame);
+    if (!s->first_frame_bytes) {
+        s->failed = true;   // free format: no way to find frame boundaries
+        return false;
+    }
+    s->header = be32(frame);
+    s->audio_start = frame_offset;
+    if (parse_info_frame(s, frame, frame_avail))
+        s->audio_start += s->first_frame_bytes;
+
+    if (!sdcard_file_id(path, &s->src)) {
+        s->failed = true;
+        return false;
+    }
+    s->audio_end = s->src.size;
+
+    s->scan_file = sdcard_fopen(path, "rb");
+    if (!s->scan_file) {
+        s->failed = true;
+        return false;
+    }
+    uint8_t tag[3];
+    if (s->src.size >= 128 + s->audio_start &&
+        sdcard_fseek(s->scan_file, s->src.size - 128) &&
+        sdcard_fread(s->scan_file, tag, 3) == 3 && memcmp(tag, "TAG", 3) == 0)
+        s->audio_end = s->src.size - 128;
+
+    // Frame 0 is always known, so playback can start before any scanning.
+    uint32_t est = s->total_frames ? s->total_frames
+                                   : (s->audio_end - s->audio_start) / s->first_frame_bytes;
+    if (!reserve(s, est / MP3_SEEK_STRIDE + 16)) {
+        s->failed = true;
+        mp3_seek_close(s);
+        return false;
+    }
+    s->offsets[0] = s->audio_start;
+    s->count = 1;
+
+    if (!sdcard_cache_path(MP3_SEEK_CACHE_SUBDIR, path, ".idx", s->cache_path,
+                           sizeof(s->cache_path)))
+        s->cache_path[0] = '\0';  // too long to cache; scan every time
+    if (cache_load(s)) {
+        sdcard_fclose(s->scan_file);
+        s->scan_file = NULL;
+    } else {
+        s->count = 1;
+        s->scan_pos = s->audio_start;
+    }
+    return true;
+}
+
+void mp3_seek_close(mp3_seek_t *s) {
+    if (s->scan_file) {
+        sdcard_fclose(s->scan_file);
+        s->scan_file = NULL;
+    }
+    if (s->offsets) {
+        umm_free(s->offsets);
+        s->offsets = NULL;
+    }
+    s->count = s->capacity = 0;
+    s->complete = false;
+}
+
+static void scan_finish(mp3_seek_t *s) {
+    sdcard_fclose(s->scan_file);
+    s->scan_file = NULL;
+    if (!s->total_frames)
+        s->total_frames = s->scan_frames;
+    s->complete = true;
+    printf("[MP3] Indexed %lu frames\n", (unsigned long)s->scan_frames);
+    cache_store(s);
+}
+
+void mp3_seek_scan(mp3_seek_t *s, uint32_t budget) {
+    if (s->complete || s->failed || !s->scan_file)
+        return;
+
+    while (budget > 0) {
+        if (s->scan_pos + 4 > s->audio_end) {
+            scan_finish(s);
+            return;
+        }
+        uint32_t want = s->audio_end - s->scan_pos;
+        if (want > SCAN_CHUNK)
+            want = SCAN_CHUNK;
+        int got = -1;
+        if (sdcard_fseek(s->scan_file, s->scan_pos))
+            got = sdcard_fread(s->scan_file, s_scan_buf, (int)want);
+        if (got < 0) {
+            s->failed = true;
+            return;
+        }
+        if (got < 4) {
+            scan_finish(s);
+            return;
+        }
+
+        // Walk header to header; resync a byte at a time over junk.
+        uint32_t i = 0;
+        while (i + 4 <= (uint32_t)got) {
+            const uint8_t *p = s_scan_buf + i;
+            uint32_t len = frame_bytes(p, NULL);
+            if (!len || (be32(p) & HEADER_FIXED_BITS) != (s->header & HEADER_FIXED_BITS)) {
+                i++;
+                continue;
+            }
+            if (s->scan_frames % MP3_SEEK_STRIDE == 0) {
+                uint32_t e = s->scan_frames / MP3_SEEK_STRIDE;
+                if (!reserve(s, e + 1)) {
+                    s->failed = true;
+                    return;
+                }
+                s->offsets[e] = s->scan_pos + i;
+                s->count = e + 1;
+            }
+            s->scan_frames++;
+            i += len;
+        }
+        s->scan_pos += i;
+        budget = budget > (uint32_t)got ? budget - (uint32_t)got : 0;
+    }
+}
+
+uint32_t mp3_seek_length(const mp3_seek_t *s, bool *exact) {
+    uint64_t frames = s->total_frames;
+    if (exact)
+        *exact = frames != 0;
+    if (!frames && s->first_frame_bytes)
+        frames = (s->audio_end - s->audio_start) / s->first_frame_bytes;
+    uint64_t samples = frames * s->samples_per_frame;
+    uint32_t trim = s->gapless ? s->enc_delay + s->enc_padding : 0;
+    return samples > trim ? (uint32_t)(samples - trim) : 0;
+}
+
+bool mp3_seek_locate(const mp3_seek_t *s, uint32_t frame,
+                     uint32_t *frame_at, uint32_t *offset) {
+    if (!s->count)
+        return false;
+    uint32_t e = frame / MP3_SEEK_STRIDE;
+    if (e < s->count) {
+        *frame_at = e * MP3_SEEK_STRIDE;
+        *offset = s->offsets[e];
+        return true;
+    }
+    if (s->has_toc && s->total_frames) {
+        uint32_t pct = (uint32_t)((uint64_t)frame * 100 / s->total_frames);
+        if (pct > 99)
+            pct = 99;
+        uint32_t bytes = s->audio_end - s->audio_start;
+        *frame_at = frame;
+        *offset = s->audio_start + (uint32_t)((uint64_t)s->toc[pct] * bytes / 256);
+        return true;
+    }
+    return false;
+}
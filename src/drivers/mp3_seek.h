@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdcard.h"
+
+// =============================================================================
+// MP3 seek index
+//
+// File offset of every MP3_SEEK_STRIDE-th Layer III frame, so the player can
+// jump to any sample by decoding at most a few frames.  The first frame's
+// Xing/Info or VBRI header gives the frame count (and the LAME tag the
+// encoder delay/padding) up front; the offsets come from /system/cache or a
+// background header scan of the file, which is cached once it completes.
+// =============================================================================
+
+#define MP3_SEEK_STRIDE       4
+#define MP3_SEEK_CACHE_SUBDIR "mp3"  // under SDCARD_CACHE_DIR
+
+typedef struct {
+    uint32_t *offsets;          // Lua heap, offsets[i] = frame i * STRIDE
+    uint32_t count;
+    uint32_t capacity;
+
+    uint32_t audio_start;       // first audio frame (past ID3v2 and Xing)
+    uint32_t audio_end;         // file size less any ID3v1 tag
+    uint32_t header;            // first frame header, to validate the scan
+    uint16_t samples_per_frame;
+    uint16_t first_frame_bytes;
+    uint32_t total_frames;      // 0 until known
+    bool     gapless;           // LAME tag gave the encoder delay/padding
+    uint16_t enc_delay;
+    uint16_t enc_padding;
+    uint8_t  toc[100];          // Xing byte-position table
+    bool     has_toc;
+    bool     complete;          // every frame indexed
+    bool     failed;            // unindexable (free format, read error)
+
+    sdfile_t scan_file;         // own handle, so decoding keeps its position
+    uint32_t scan_pos;
+    uint32_t scan_frames;
+
+    sdcard_file_id_t src;
+    char     cache_path[96];
+} mp3_seek_t;
+
+// libmad's own output lags the input by this many samples.
+#define MP3_DECODER_DELAY 529
+
+// Decoded samples that precede the first sample of the track.
+static inline uint32_t mp3_seek_start_trim(const mp3_seek_t *s) {
+    return s->gapless ? s->enc_delay + MP3_DECODER_DELAY : 0;
+}
+
+// At load (Core 0): `frame` holds the first frame header found, which sits
+// at file offset frame_offset.  Reads the cache or starts a scan.
+bool mp3_seek_open(mp3_seek_t *s, const char *path, const uint8_t *frame,
+                   uint32_t frame_avail, uint32_t frame_offset);
+void mp3_seek_close(mp3_seek_t *s);
+
+// Core 1, with g_sdcard_mutex held: index up to `budget` more bytes of the
+// file.  Writes the cache once the scan reaches the end.
+void mp3_seek_scan(mp3_seek_t *s, uint32_t budget);
+
+// Playable length in samples, less the encoder delay and padding.  Exact
+// when Xing/VBRI or a finished scan gave the frame count, else estimated
+// from the first frame's bitrate.
+uint32_t mp3_seek_length(const mp3_seek_t *s, bool *exact);
+
+// Latest indexed frame at or before `frame` and its file offset.  Falls
+// back to the Xing table (approximate) and fails if neither covers it yet.
+bool mp3_seek_locate(const mp3_seek_t *s, uint32_t frame,
+                     uint32_t *frame_at, uint32_t *offset);
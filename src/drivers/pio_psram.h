@@ -20,12 +20,22 @@ extern "C" {
 #define PIO_PSRAM_MAX_WRITE  8187
 #define PIO_PSRAM_MAX_READ   8191
 
-// Memory layout constants for PIO PSRAM
+// Memory layout constants for PIO PSRAM.  Regions are contiguous:
+//   0x000000  MP3 ring (player 0)        32 KB
+//   0x008000  video                     256 KB
+//   0x048000  native apps      4 MB - 288 KB  (3808 KB, ends at 0x400000)
+//   0x400000  MP3 rings (players 1..n)  128 KB
+//   0x420000  sound sample bank  4 MB - 128 KB  (3968 KB, to the end of 8 MB)
 #define PIO_PSRAM_MP3_RING_BASE    0x0000
 #define PIO_PSRAM_MP3_RING_SIZE    (32 * 1024)
 #define PIO_PSRAM_VIDEO_BASE       (32 * 1024)
 #define PIO_PSRAM_VIDEO_SIZE       (256 * 1024)
 #define PIO_PSRAM_APP_BASE         (288 * 1024)
+#define PIO_PSRAM_APP_SIZE         (PIO_PSRAM_MP3_EXTRA_BASE - PIO_PSRAM_APP_BASE)
+#define PIO_PSRAM_MP3_EXTRA_BASE   (4 * 1024 * 1024)  // rings of MP3 players 1..n
+#define PIO_PSRAM_MP3_EXTRA_SIZE   (128 * 1024)
+#define PIO_PSRAM_SOUND_BASE       (PIO_PSRAM_MP3_EXTRA_BASE + PIO_PSRAM_MP3_EXTRA_SIZE)
+#define PIO_PSRAM_SOUND_SIZE       (8 * 1024 * 1024 - PIO_PSRAM_SOUND_BASE)
 
 // Initialise PIO1 state machine, DMA channels, and reset the PSRAM chip.
 // Returns true on success.  Non-fatal if chip is not present.
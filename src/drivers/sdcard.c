@@ -9,8 +9,11 @@
 
 #include "ff.h"
 #include "diskio.h"
+#include "port/diskio_spi.h"
+#include "port/sd_cache.h"
 #include "umm_malloc.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -141,8 +144,40 @@ void sdcard_apply_clock(void) {
     spi_set_baudrate(SD_SPI_PORT, SD_SPI_BAUD);
 }
 
+// Sector cache size.  Taken from the Lua heap (QMI PSRAM), which is
+// memory-mapped, so hits cost a memcpy from either core.
+#define SDCARD_CACHE_BYTES (132 * 1024)
+
+void sdcard_cache_init(void) {
+    void *mem = umm_malloc(SDCARD_CACHE_BYTES);
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    bool ok = sd_cache_init(mem, SDCARD_CACHE_BYTES, s_fs.win);
+    recursive_mutex_exit(&g_sdcard_mutex);
+    if (!ok) {
+        printf("[SD] No memory for the sector cache\n");
+        umm_free(mem);
+    }
+}
+
+bool sdcard_cache_flush(void) {
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    bool ok = sd_cache_flush() == RES_OK;
+    recursive_mutex_exit(&g_sdcard_mutex);
+    return ok;
+}
+
+void sdcard_cache_enable(bool on) {
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    sd_cache_enable(on);
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
+static void async_abort(FIL *fp);
+
 bool sdcard_remount(void) {
     recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    async_abort(NULL);  // its file won't survive the remount
+    sd_cache_flush();  // the card is about to be re-initialised
     f_unmount("");
     s_mounted = false;
     sleep_ms(10);  // Brief delay for card to stabilize after unmount
@@ -215,9 +250,12 @@ int sdcard_fwrite(sdfile_t f, const void *buf, int len) {
 void sdcard_fclose(sdfile_t f) {
     if (!f) return;
     recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    async_abort((FIL *)f);  // a read still streaming into the caller's buffer
     f_sync((FIL *)f);   // Flush dirty sectors to SD before close
     f_close((FIL *)f);
+    sd_cache_flush();   // and whatever the sector cache still holds
     recursive_mutex_exit(&g_sdcard_mutex);
+    if (((FIL *)f)->cltbl) umm_free(((FIL *)f)->cltbl);  // async link map
     umm_free(f);  // Must match sdcard_fopen() which allocates via umm_malloc
 }
 
@@ -237,6 +275,208 @@ uint32_t sdcard_ftell(sdfile_t f) {
     return pos;
 }
 
+// ── Asynchronous reads ───────────────────────────────────────────────────────
+// The file's cluster chain is mapped once (FatFS fast seek), so sectors are
+// found without touching the FAT and each contiguous run of the read goes
+// to the card as one DMA-driven CMD18.  g_sdcard_mutex is held only inside
+// these calls: between them the run streams on by itself, and any other
+// card access first finishes it, so a token nobody waits on never keeps the
+// card from the other core.
+
+#define ASYNC_CLMT_WORDS 64   // link map: up to 31 fragments per file
+#define ASYNC_RESULTS    4    // results kept for tokens not yet waited on
+
+static struct {
+    sdcard_async_t token;     // latest issued
+    bool     active;          // token's read is still streaming
+    FIL     *fp;
+    uint8_t *buf;             // where the next run lands
+    FSIZE_t  start;           // file offset the read began at
+    FSIZE_t  pos;             // file offset of the next run
+    FSIZE_t  end;             // end of the whole sectors
+    UINT     tail;            // bytes after end, read once the runs are in
+    int      len;
+    struct {
+        sdcard_async_t token;
+        int            result;
+    } results[ASYNC_RESULTS];
+} s_async;
+
+static void async_record(sdcard_async_t token, int result) {
+    s_async.results[token % ASYNC_RESULTS].token = token;
+    s_async.results[token % ASYNC_RESULTS].result = result;
+}
+
+// Builds the file's link map on first use.  False if it has too many
+// fragments (or no memory): reads then just go through f_read().
+static bool async_map(FIL *fp) {
+    if (fp->cltbl) return true;
+    DWORD *tbl = (DWORD *)umm_malloc(ASYNC_CLMT_WORDS * sizeof(DWORD));
+    if (!tbl) return false;
+    tbl[0] = ASYNC_CLMT_WORDS;
+    fp->cltbl = tbl;
+    FSIZE_t pos = f_tell(fp);
+    if (f_lseek(fp, CREATE_LINKMAP) != FR_OK) {
+        fp->cltbl = NULL;
+        umm_free(tbl);
+        return false;
+    }
+    f_lseek(fp, pos);
+    return true;
+}
+
+// Disk sector holding file offset ofs (sector aligned), and how many
+// sectors run on contiguously from it.
+static LBA_t async_sector(FIL *fp, FSIZE_t ofs, UINT *run) {
+    FATFS *fs = fp->obj.fs;
+    DWORD cl = (DWORD)(ofs / ((DWORD)fs->csize * 512));
+    DWORD in_cl = (DWORD)(ofs / 512) % fs->csize;
+    const DWORD *tbl = fp->cltbl + 1;
+    for (DWORD ncl; (ncl = *tbl++) != 0; tbl++) {
+        if (cl < ncl) {
+            *run = (UINT)((ncl - cl) * fs->csize - in_cl);
+            return fs->database + (LBA_t)(*tbl + cl - 2) * fs->csize + in_cl;
+        }
+        cl -= ncl;
+    }
+    *run = 0;
+    return 0;
+}
+
+// Starts the next contiguous run.  False on a read error.
+static bool async_next_run(void) {
+    UINT run = 0;
+    LBA_t sector = async_sector(s_async.fp, s_async.pos, &run);
+    UINT count = (UINT)((s_async.end - s_async.pos) / 512);
+    if (count > run) count = run;
+    if (count == 0 || disk_read_start(0, s_async.buf, sector, count) != RES_OK)
+        return false;
+    s_async.buf += count * 512;
+    s_async.pos += (FSIZE_t)count * 512;
+    return true;
+}
+
+// Reads up to the first sector boundary now and starts streaming the whole
+// sectors after it.  False if either fails.
+static bool async_begin(FIL *fp, uint8_t *buf, int len, UINT head, FSIZE_t whole) {
+    FSIZE_t start = f_tell(fp);
+    UINT br = 0;
+    if (head && (f_read(fp, buf, head, &br) != FR_OK || br != head))
+        return false;
+    s_async.fp = fp;
+    s_async.buf = buf + head;
+    s_async.start = start;
+    s_async.pos = start + head;
+    s_async.end = s_async.pos + whole;
+    s_async.tail = (UINT)((FSIZE_t)len - head - whole);
+    s_async.len = len;
+    s_async.active = true;
+    if (async_next_run())
+        return true;
+    s_async.active = false;
+    return false;
+}
+
+// The runs are all in (ok) or one failed: read the tail after them, or put
+// the position back where the read began.
+static void async_finish(bool ok) {
+    FIL *fp = s_async.fp;
+    int result = -1;
+    UINT br = 0;
+    if (ok && f_lseek(fp, s_async.end) == FR_OK &&
+        f_read(fp, s_async.buf, s_async.tail, &br) == FR_OK)
+        result = s_async.len - (int)s_async.tail + (int)br;
+    else
+        f_lseek(fp, s_async.start);
+    s_async.active = false;
+    async_record(s_async.token, result);
+}
+
+// Moves the read along.  True once token's read has finished (or if it
+// isn't the one streaming).  Caller holds g_sdcard_mutex.
+static bool async_step(sdcard_async_t token) {
+    if (token != s_async.token || !s_async.active) return true;
+    int r = disk_read_poll();
+    if (r == 0) return false;
+    if (r > 0 && s_async.pos < s_async.end) {
+        if (async_next_run()) return false;
+        r = -1;
+    }
+    async_finish(r > 0);
+    if (r < 0) sdcard_log_corruption(FR_DISK_ERR, "sdcard_read_async", NULL);
+    return true;
+}
+
+// Stops the read streaming into fp (NULL: whatever is streaming).  Caller
+// holds g_sdcard_mutex.
+static void async_abort(FIL *fp) {
+    if (!s_async.active || (fp && s_async.fp != fp)) return;
+    disk_read_cancel();
+    async_finish(false);
+}
+
+sdcard_async_t sdcard_read_async(sdfile_t f, void *buf, int len) {
+    if (!f || len < 0) return -1;
+    FIL *fp = (FIL *)f;
+
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    while (!async_step(s_async.token))   // one read streams at a time
+        tight_loop_contents();
+    if (s_async.token == INT_MAX) s_async.token = 0;
+    sdcard_async_t token = ++s_async.token;
+
+    FSIZE_t pos = f_tell(fp);
+    FSIZE_t left = f_size(fp) > pos ? f_size(fp) - pos : 0;
+    if ((FSIZE_t)len > left) len = (int)left;
+
+    UINT head = (UINT)((512 - pos % 512) % 512);
+    if (head > (UINT)len) head = (UINT)len;
+    FSIZE_t whole = ((FSIZE_t)len - head) & ~(FSIZE_t)511;
+    if (whole && !(fp->flag & FA_WRITE) && async_map(fp) &&
+        async_begin(fp, (uint8_t *)buf, len, head, whole)) {
+        recursive_mutex_exit(&g_sdcard_mutex);
+        return token;
+    }
+
+    // Short, mid-write or unmappable: an ordinary read, already done
+    UINT br = 0;
+    FRESULT res = f_lseek(fp, pos);
+    if (res == FR_OK)
+        res = f_read(fp, buf, (UINT)len, &br);
+    async_record(token, res == FR_OK ? (int)br : -1);
+    recursive_mutex_exit(&g_sdcard_mutex);
+    if (res != FR_OK && is_fs_corruption(res))
+        sdcard_log_corruption(res, "sdcard_read_async", NULL);
+    return token;
+}
+
+bool sdcard_async_done(sdcard_async_t token) {
+    if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL))
+        return false;   // the other core has the card: ask again later
+    bool done = async_step(token);
+    recursive_mutex_exit(&g_sdcard_mutex);
+    return done;
+}
+
+int sdcard_async_wait(sdcard_async_t token) {
+    if (token <= 0) return -1;
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    while (!async_step(token))
+        tight_loop_contents();
+    int result = s_async.results[token % ASYNC_RESULTS].token == token
+                     ? s_async.results[token % ASYNC_RESULTS].result
+                     : -1;
+    recursive_mutex_exit(&g_sdcard_mutex);
+    return result;
+}
+
+void sdcard_async_cancel(sdcard_async_t token) {
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    if (token == s_async.token)
+        async_abort(NULL);
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
 bool sdcard_fexists(const char *path) {
     FILINFO *fi = (FILINFO *)umm_malloc(sizeof(FILINFO));
     if (!fi) return false;
@@ -480,7 +720,8 @@ char *sdcard_read_file(const char *path, int *out_len) {
     sdfile_t f = sdcard_fopen(path, "rb");
     if (!f) { umm_free(buf); return NULL; }
 
-    int n = sdcard_fread(f, buf, size);
+    // Streamed a fragment at a time rather than a cluster per f_read() pass
+    int n = sdcard_async_wait(sdcard_read_async(f, buf, size));
     sdcard_fclose(f);
 
     if (n < 0) { umm_free(buf); return NULL; }
@@ -488,3 +729,135 @@ char *sdcard_read_file(const char *path, int *out_len) {
     if (out_len) *out_len = n;
     return buf;
 }
+
+// ── Cache files ──────────────────────────────────────────────────────────────
+
+static int cache_sanitise(const char *s, char *out, int n, int out_len) {
+    for (; *s && n < out_len - 1; s++) {
+        char c = *s;
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-';
+        out[n++] = ok ? c : '_';
+    }
+    out[n] = '\0';
+    return *s ? -1 : n;  // -1 if truncated
+}
+
+bool sdcard_cache_path(const char *subdir, const char *name, const char *ext,
+                       char *out, int out_len) {
+    if (!subdir || !subdir[0] || strcmp(subdir, ".") == 0 ||
+        strcmp(subdir, "..") == 0)
+        return false;
+    int n = snprintf(out, out_len, SDCARD_CACHE_DIR "/");
+    if (n < 0 || n >= out_len)
+        return false;
+    n = cache_sanitise(subdir, out, n, out_len);
+    if (n < 0 || n >= out_len - 1)
+        return false;
+    out[n++] = '/';
+    while (*name == '/')
+        name++;
+    if (!*name)
+        return false;
+    n = cache_sanitise(name, out, n, out_len);
+    if (n < 0)
+        return false;
+    int e = snprintf(out + n, out_len - n, "%s", ext ? ext : "");
+    return e >= 0 && e < out_len - n;
+}
+
+uint32_t sdcard_hash(uint32_t h, const void *data, uint32_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--)
+        h = (h ^ *p++) * 16777619u;
+    return h;
+}
+
+static bool hash_span(sdfile_t f, uint32_t offset, uint32_t len, uint32_t *h) {
+    uint8_t buf[512];
+    if (!sdcard_fseek(f, offset))
+        return false;
+    while (len > 0) {
+        int n = len < sizeof(buf) ? (int)len : (int)sizeof(buf);
+        if (sdcard_fread(f, buf, n) != n)
+            return false;
+        *h = sdcard_hash(*h, buf, n);
+        len -= n;
+    }
+    return true;
+}
+
+bool sdcard_file_id_ends(const char *path, uint32_t end_bytes,
+                         sdcard_file_id_t *out) {
+    sdcard_stat_t st;
+    if (!sdcard_stat(path, &st) || st.is_dir)
+        return false;
+    sdfile_t f = sdcard_fopen(path, "rb");
+    if (!f)
+        return false;
+
+    uint32_t h = SDCARD_HASH_INIT;
+    bool ok;
+    if (st.size <= 2 * end_bytes)
+        ok = hash_span(f, 0, st.size, &h);
+    else
+        ok = hash_span(f, 0, end_bytes, &h) &&
+             hash_span(f, st.size - end_bytes, end_bytes, &h);
+    sdcard_fclose(f);
+
+    out->size = st.size;
+    out->fdate = st.fdate;
+    out->ftime = st.ftime;
+    out->hash = h;
+    return ok;
+}
+
+bool sdcard_file_id(const char *path, sdcard_file_id_t *out) {
+    return sdcard_file_id_ends(path, SDCARD_FINGERPRINT_BYTES, out);
+}
+
+// sdcard_mkdir() makes one level, and a fresh card has only /system.
+static bool mkdir_parents(const char *path) {
+    char dir[192];
+    int len = (int)strlen(path);
+    if (len >= (int)sizeof(dir))
+        return false;
+    memcpy(dir, path, len + 1);
+    for (int i = 1; i < len; i++) {
+        if (dir[i] != '/')
+            continue;
+        dir[i] = '\0';
+        bool ok = sdcard_fexists(dir) || sdcard_mkdir(dir);
+        dir[i] = '/';
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+bool sdcard_write_file_atomic(const char *path, const sdcard_part_t *parts,
+                              int count) {
+    char tmp_path[196];
+    int n = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (n < 0 || n >= (int)sizeof(tmp_path) || !mkdir_parents(path))
+        return false;
+
+    sdfile_t f = sdcard_fopen(tmp_path, "w");
+    if (!f)
+        return false;
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++)
+        ok = sdcard_fwrite(f, parts[i].data, (int)parts[i].len) ==
+             (int)parts[i].len;
+    sdcard_fclose(f);
+
+    if (ok) {
+        sdcard_delete(path);
+        ok = sdcard_rename(tmp_path, path);
+    }
+    if (!ok) {
+        sdcard_delete(tmp_path);
+        printf("[SDCARD] Failed to write %s\n", path);
+    }
+    return ok;
+}
@@ -33,6 +33,15 @@ bool sdcard_is_mounted(void);
 // Remount (e.g. after card swap). Returns true on success.
 bool sdcard_remount(void);
 
+// Sector cache between FatFS and the card for FAT, directory and small
+// file I/O.  Allocated from the Lua heap, so call once umm_malloc is up;
+// until then the card is used uncached.
+void sdcard_cache_init(void);
+// Write back dirty cached sectors (f_sync and sdcard_fclose already do).
+bool sdcard_cache_flush(void);
+// Off writes back and empties the cache, and I/O goes straight to the card.
+void sdcard_cache_enable(bool on);
+
 // ── File I/O ─────────────────────────────────────────────────────────────────
 
 typedef void *sdfile_t;  // opaque FIL* handle
@@ -47,6 +56,25 @@ int      sdcard_fsize_handle(sdfile_t f);  // Returns -1 on error
 bool     sdcard_fseek(sdfile_t f, uint32_t offset);
 uint32_t sdcard_ftell(sdfile_t f);
 
+// ── Asynchronous reads ───────────────────────────────────────────────────────
+// Reads len bytes at f's position into buf while the caller carries on
+// (e.g. decodes the previous block), then moves the position past them.
+// The whole sectors of a read-only file stream in by DMA; the bytes before
+// the first sector boundary, and any read that is too short or of a file
+// open for writing, are read before sdcard_read_async() returns, and the
+// token behaves the same.  One read streams at a time: starting another
+// finishes the first.  Leave f alone until the token is done; closing it
+// cancels the read.  The card is only locked inside these calls, and other
+// access waits at most for the run in flight, so a token may be dropped.
+typedef int sdcard_async_t;   // completion token, negative on bad arguments
+
+sdcard_async_t sdcard_read_async(sdfile_t f, void *buf, int len);
+bool sdcard_async_done(sdcard_async_t token);   // never blocks
+int  sdcard_async_wait(sdcard_async_t token);   // bytes read, -1 on error
+// Stop it streaming: buf is left partly filled, the position where the read
+// began, and wait() returns -1.
+void sdcard_async_cancel(sdcard_async_t token);
+
 // Create a directory (and parent directories if needed)
 bool     sdcard_mkdir(const char *path);
 
@@ -99,3 +127,55 @@ bool sdcard_disk_info(uint32_t *out_free_kb, uint32_t *out_total_kb);
 // Caller must free() the returned pointer. Returns NULL on error.
 // *out_len is set to the file size.
 char *sdcard_read_file(const char *path, int *out_len);
+
+// ── Cache files ──────────────────────────────────────────────────────────────
+// Data derived from another file (compiled Lua, MP3 seek and video frame
+// indexes) lives under SDCARD_CACHE_DIR/<subdir>/ and records the identity
+// of its source, so it can be thrown away once the source changes.
+
+#define SDCARD_CACHE_DIR "/system/cache"
+
+// SDCARD_CACHE_DIR "/<subdir>/<name><ext>", with leading '/' dropped from
+// name and anything but [A-Za-z0-9._-] in subdir and name mapped to '_'
+// (so "/music/a.mp3" becomes music_a.mp3).  False if the result doesn't fit
+// or subdir is empty, "." or "..".
+bool sdcard_cache_path(const char *subdir, const char *name, const char *ext,
+                       char *out, int out_len);
+
+// FatFS stamps don't change on-device (FF_FS_NORTC) and rewrites often keep
+// the size, so a file is identified by size, stamp and a content hash.
+#define SDCARD_HASH_INIT         2166136261u
+#define SDCARD_FINGERPRINT_BYTES 4096
+
+typedef struct {
+    uint32_t size;
+    uint16_t fdate;
+    uint16_t ftime;
+    uint32_t hash;
+} sdcard_file_id_t;
+
+// FNV-1a over len more bytes, starting from h (SDCARD_HASH_INIT).
+uint32_t sdcard_hash(uint32_t h, const void *data, uint32_t len);
+
+// Identity of path, hashing its first and last SDCARD_FINGERPRINT_BYTES
+// (all of it if smaller).  False if path is missing, a directory or unreadable.
+bool sdcard_file_id(const char *path, sdcard_file_id_t *out);
+// The same with end_bytes at each end, for checks that must be cheap.
+bool sdcard_file_id_ends(const char *path, uint32_t end_bytes,
+                         sdcard_file_id_t *out);
+
+static inline bool sdcard_file_id_equal(const sdcard_file_id_t *a,
+                                        const sdcard_file_id_t *b) {
+    return a->size == b->size && a->fdate == b->fdate &&
+           a->ftime == b->ftime && a->hash == b->hash;
+}
+
+// Write parts to path through path.tmp and a rename, so a power cut never
+// leaves a truncated file behind.  Creates missing parent directories.
+typedef struct {
+    const void *data;
+    uint32_t    len;
+} sdcard_part_t;
+
+bool sdcard_write_file_atomic(const char *path, const sdcard_part_t *parts,
+                              int count);
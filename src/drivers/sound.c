@@ -1,172 +1,553 @@
 #include "sound.h"
-#include "audio.h"
-#include "../hardware.h"
+#include "sound_bank.h"
+#include "ima_adpcm.h"
+#include "audio_mixer.h"
+#include "pio_psram.h"
 #include "sdcard.h"
-#include "hardware/pwm.h"
-#include "pico/time.h"
 #include "pico/stdlib.h"
+#include "pico/mutex.h"
+#include "pico/platform.h"
+#include "hardware/sync.h"
 #include "umm_malloc.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+// Staging ring for a bank-resident sample.  Holds raw sample frames; Core 1
+// (sound_poll) appends from PIO PSRAM, the mixer ISR consumes.  Frames are 1,
+// 2 or 4 bytes so one never straddles the wrap.
+struct sound_stream {
+    uint8_t buf[SOUND_STREAM_BUF_SIZE];
+    volatile uint32_t wr;       // free-running byte counters
+    volatile uint32_t rd;
+    uint32_t fetch_frame;       // next sample frame to copy in
+    uint32_t play_frame;        // sample frame at rd (for position)
+    volatile bool eos;          // last repeat fully copied in
+    sound_player_t *owner;
+};
+
+// Bounce buffer size for copies between the SD card, the Lua heap and the
+// sample bank.
+#define SOUND_COPY_CHUNK 4096
+
 static sound_context_t s_context;
-static repeating_timer_t s_playback_timer;
-static bool s_timer_active = false;
-static uint32_t s_timer_interval_us = 0;
+static sound_stream_t s_streams[SOUND_STREAM_SLOTS];
+// Guards stream ownership and refills.  Core 0 blocks on it; Core 1 only
+// tries, so the loop never stalls behind a play() call.
+static mutex_t s_stream_mutex;
+static bool s_stream_mutex_ready = false;
+static uint32_t s_play_seq = 0;
+// One ADPCM block read from the bank, decoded by the filler (under
+// s_stream_mutex).
+static uint8_t s_adpcm_raw[SOUND_ADPCM_MAX_BLOCK];
+
+static inline uint32_t frame_bytes(const sound_sample_t *sample) {
+    return (sample->bits_per_sample / 8) * sample->channels;
+}
 
-static bool parse_wav_header(sound_sample_t *sample, uint8_t *data, uint32_t size) {
-    if (size < 44)
+// Frame range [start, end) a player covers; false if empty.
+static bool play_bounds(const sound_player_t *player, uint32_t *start, uint32_t *end) {
+    const sound_sample_t *sample = player->sample;
+    uint32_t bpf = frame_bytes(sample);
+    if (bpf == 0)
         return false;
+    uint32_t total = sample->length / bpf;
+    *start = player->play_start < total ? player->play_start : total;
+    *end = total;
+    if (player->play_end > 0 && player->play_end < *end)
+        *end = player->play_end;
+    return *start < *end;
+}
 
-    if (memcmp(data, "RIFF", 4) != 0)
-        return false;
-    if (memcmp(data + 8, "WAVE", 4) != 0)
-        return false;
+// Fastest playback rate; keeps every run-length computation in 32 bits.
+#define SOUND_MAX_STEP (64u << 16)
 
-    uint32_t data_offset = 0;
-    uint32_t data_size = 0;
+// Recompute the 16.16 source step once per rate/sample change, not per block.
+static void player_update_step(sound_player_t *player) {
+    player->step = 0;
+    if (!player->sample || !player->sample->sample_rate)
+        return;
+    float step = player->rate * (float)player->sample->sample_rate *
+                 (65536.0f / AUDIO_MIXER_RATE);
+    player->step = step >= (float)SOUND_MAX_STEP ? SOUND_MAX_STEP : (uint32_t)step;
+}
 
-    uint32_t pos = 12;
-    while (pos + 8 < size) {
-        uint32_t chunk_id = *(uint32_t *)(data + pos);
-        uint32_t chunk_size = *(uint32_t *)(data + pos + 4);
-
-        if (chunk_id == *(uint32_t *)"fmt ") {
-            sample->channels = *(uint16_t *)(data + pos + 10);
-            sample->sample_rate = *(uint32_t *)(data + pos + 12);
-            sample->bits_per_sample = *(uint16_t *)(data + pos + 22);
-        } else if (chunk_id == *(uint32_t *)"data") {
-            data_offset = pos + 8;
-            data_size = chunk_size;
-            break;
-        }
+// ── Block kernels ────────────────────────────────────────────────────────────
+// One tight loop per (sample width, channels, interpolation), so nothing but
+// the 16.16 phase walk and a multiply-accumulate sits in the per-frame path.
+// pos is a frame index wrapped by mask (~0u for samples in linear memory);
+// with interpolation the caller guarantees pos + 1 is valid for the run.
+
+static inline __attribute__((always_inline)) int32_t
+fetch(const uint8_t *src, uint32_t idx, bool wide, bool stereo, int ch) {
+    if (wide)
+        return ((const int16_t *)src)[idx * (stereo ? 2 : 1) + ch];
+    return ((int32_t)src[idx * (stereo ? 2 : 1) + ch] - 128) << 8;
+}
 
-        pos += 8 + chunk_size;
-        if (chunk_size % 2 != 0)
-            pos++;
+static inline __attribute__((always_inline)) void
+mix_run(int32_t *mix, int n, const uint8_t *src, uint32_t mask,
+        uint32_t *pos_io, uint32_t *frac_io, uint32_t step, int32_t gain,
+        bool wide, bool stereo, bool lerp) {
+    uint32_t pos = *pos_io;
+    uint32_t frac = *frac_io;
+    for (int i = 0; i < n; i++) {
+        uint32_t idx = pos & mask;
+        int32_t left = fetch(src, idx, wide, stereo, 0);
+        int32_t right = stereo ? fetch(src, idx, wide, stereo, 1) : 0;
+        if (lerp) {
+            // 15-bit weight: (b - a) * w stays inside int32.
+            uint32_t next = (pos + 1) & mask;
+            int32_t w = (int32_t)(frac >> 1);
+            left += ((fetch(src, next, wide, stereo, 0) - left) * w) >> 15;
+            if (stereo)
+                right += ((fetch(src, next, wide, stereo, 1) - right) * w) >> 15;
+        }
+        if (!stereo)
+            right = left;
+        mix[0] += (left * gain) >> 8;
+        mix[1] += (right * gain) >> 8;
+        mix += 2;
+        frac += step;
+        pos += frac >> 16;
+        frac &= 0xFFFF;
     }
+    *pos_io = pos;
+    *frac_io = frac;
+}
 
-    if (data_offset == 0 || data_size == 0)
-        return false;
-
-    if (data_size > SOUND_MAX_SAMPLE_SIZE)
-        data_size = SOUND_MAX_SAMPLE_SIZE;
-
-    sample->data = umm_malloc(data_size);
-    if (!sample->data)
-        return false;
+typedef void (*mix_kernel_fn)(int32_t *mix, int n, const uint8_t *src, uint32_t mask,
+                              uint32_t *pos, uint32_t *frac, uint32_t step, int32_t gain);
 
-    memcpy(sample->data, data + data_offset, data_size);
-    sample->length = data_size;
-    sample->loaded = true;
+#define MIX_KERNEL(name, wide, stereo, lerp)                                       \
+    static void __time_critical_func(name)(int32_t *mix, int n, const uint8_t *src, \
+                                           uint32_t mask, uint32_t *pos,           \
+                                           uint32_t *frac, uint32_t step,          \
+                                           int32_t gain) {                         \
+        mix_run(mix, n, src, mask, pos, frac, step, gain, wide, stereo, lerp);     \
+    }
 
-    return true;
+MIX_KERNEL(mix_u8_mono,        false, false, false)
+MIX_KERNEL(mix_u8_stereo,      false, true,  false)
+MIX_KERNEL(mix_s16_mono,       true,  false, false)
+MIX_KERNEL(mix_s16_stereo,     true,  true,  false)
+MIX_KERNEL(mix_u8_mono_lerp,   false, false, true)
+MIX_KERNEL(mix_u8_stereo_lerp, false, true,  true)
+MIX_KERNEL(mix_s16_mono_lerp,  true,  false, true)
+MIX_KERNEL(mix_s16_stereo_lerp, true, true,  true)
+
+// [lerp][wide][stereo]
+static const mix_kernel_fn s_kernels[2][2][2] = {
+    {{mix_u8_mono, mix_u8_stereo}, {mix_s16_mono, mix_s16_stereo}},
+    {{mix_u8_mono_lerp, mix_u8_stereo_lerp}, {mix_s16_mono_lerp, mix_s16_stereo_lerp}},
+};
+
+// Output frames (at most max) before the read position reaches limit;
+// pos < limit on entry, so the answer is at least 1.
+static inline uint32_t run_length(uint32_t pos, uint32_t frac, uint32_t step,
+                                  uint32_t limit, uint32_t max) {
+    uint32_t reach = (uint32_t)(((uint64_t)frac + (uint64_t)step * (max - 1)) >> 16);
+    if (reach < limit - pos)
+        return max;
+    uint32_t dist = ((limit - pos) << 16) - frac;
+    return (dist + step - 1) / step;
 }
 
-void sound_init(void) {
-    if (s_timer_active) {
-        cancel_repeating_timer(&s_playback_timer);
-        s_timer_active = false;
+// ── Sample storage ───────────────────────────────────────────────────────────
+
+// Lua heap for small samples (mixed in place), the PIO PSRAM bank for the
+// rest.  Without PIO PSRAM everything goes to the heap.
+static bool sample_alloc(sound_sample_t *sample, uint32_t size) {
+    sample->data = NULL;
+    sample->in_bank = false;
+    sample->stored_size = size;
+    if (size <= SOUND_RAM_SAMPLE_MAX || !pio_psram_available()) {
+        sample->data = umm_malloc(size ? size : 1);
+        return sample->data != NULL;
     }
-    pwm_set_gpio_level(AUDIO_PIN_L, 0);
-    pwm_set_gpio_level(AUDIO_PIN_R, 0);
-    memset(&s_context, 0, sizeof(s_context));
+    if (!sound_bank_alloc(size, &sample->bank_addr))
+        return false;
+    sample->in_bank = true;
+    return true;
 }
 
-void sound_update(void) {
-    if (!s_timer_active)
-        return;
+static void sample_free(sound_sample_t *sample) {
+    if (sample->data)
+        umm_free(sample->data);
+    if (sample->in_bank)
+        sound_bank_free(sample->bank_addr, sample->stored_size);
+    sample->data = NULL;
+    sample->in_bank = false;
+    sample->loaded = false;
+    sample->adpcm = false;
+    sample->length = 0;
+    sample->stored_size = 0;
+}
 
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
-        sound_player_t *player = &s_context.players[i];
-        if (!player->playing || player->paused || !player->sample || !player->sample->loaded)
-            continue;
+static void sample_read(const sound_sample_t *sample, uint32_t offset, uint8_t *dst, uint32_t len) {
+    if (sample->in_bank)
+        pio_psram_read(sample->bank_addr + offset, dst, len);
+    else
+        memcpy(dst, sample->data + offset, len);
+}
 
-        sound_sample_t *sample = player->sample;
-        uint32_t pos = player->position;
+static void sample_write(sound_sample_t *sample, uint32_t offset, const uint8_t *src, uint32_t len) {
+    if (sample->in_bank)
+        pio_psram_write(sample->bank_addr + offset, src, len);
+    else
+        memcpy(sample->data + offset, src, len);
+}
 
-        uint32_t effective_end = sample->length;
-        if (player->play_end > 0) {
-            uint32_t bytes_per_sample = sample->bits_per_sample / 8;
-            uint32_t bytes_per_frame = bytes_per_sample * sample->channels;
-            uint32_t end_bytes = player->play_end * bytes_per_frame;
-            if (end_bytes < effective_end)
-                effective_end = end_bytes;
+// Decode ADPCM block `block` into the player's cache, if not already there.
+// Runs in the ISR for heap samples, and in the filler for bank samples.
+static const int16_t *adpcm_block(sound_player_t *player, uint32_t block) {
+    const sound_sample_t *sample = player->sample;
+    if (player->block_index != block) {
+        uint32_t offset = block * sample->block_align;
+        uint32_t len = sample->stored_size - offset;
+        if (len > sample->block_align)
+            len = sample->block_align;
+        const uint8_t *src = sample->data + offset;
+        if (sample->in_bank) {
+            pio_psram_read(sample->bank_addr + offset, s_adpcm_raw, len);
+            src = s_adpcm_raw;
         }
+        ima_adpcm_decode_block(src, len, sample->channels, player->block_pcm,
+                               sample->block_frames);
+        player->block_index = block;
+    }
+    return player->block_pcm;
+}
 
-        uint32_t effective_start = 0;
-        if (player->play_start > 0) {
-            uint32_t bytes_per_sample = sample->bits_per_sample / 8;
-            uint32_t bytes_per_frame = bytes_per_sample * sample->channels;
-            effective_start = player->play_start * bytes_per_frame;
+// Decode frames [first, first + count) of an ADPCM sample into dst's PCM
+// storage, a block at a time.
+static bool adpcm_copy_out(const sound_sample_t *src, uint32_t first, uint32_t count,
+                           sound_sample_t *dst) {
+    uint32_t bytes_per_frame = frame_bytes(src);
+    uint8_t *raw = umm_malloc(src->block_align);
+    int16_t *pcm = umm_malloc((uint32_t)src->block_frames * bytes_per_frame);
+    bool ok = raw && pcm;
+
+    for (uint32_t done = 0; ok && done < count;) {
+        uint32_t frame = first + done;
+        uint32_t block = frame / src->block_frames;
+        uint32_t base = block * src->block_frames;
+        uint32_t offset = block * src->block_align;
+        uint32_t len = src->stored_size - offset;
+        if (len > src->block_align)
+            len = src->block_align;
+        sample_read(src, offset, raw, len);
+        uint32_t got = ima_adpcm_decode_block(raw, len, src->channels, pcm, src->block_frames);
+        if (base + got <= frame) {
+            ok = false;
+            break;
         }
+        uint32_t n = base + got - frame;
+        if (n > count - done)
+            n = count - done;
+        sample_write(dst, done * bytes_per_frame,
+                     (const uint8_t *)(pcm + (frame - base) * src->channels), n * bytes_per_frame);
+        done += n;
+    }
 
-        if (pos < effective_start) {
-            player->position = effective_start;
-            pos = effective_start;
-        }
+    if (raw)
+        umm_free(raw);
+    if (pcm)
+        umm_free(pcm);
+    return ok;
+}
+
+// ── Mixer voices ─────────────────────────────────────────────────────────────
 
-        if (pos >= effective_end) {
+// Mixer voice for a heap-resident sample (DMA ISR, Core 1).  position stays
+// in bytes for the Lua bridge; the 16.16 fraction is only used here.
+static bool sound_voice_render(void *ctx, int32_t *mix, int frames) {
+    sound_player_t *player = (sound_player_t *)ctx;
+    sound_sample_t *sample = player->sample;
+    if (!player->playing || !sample || !sample->loaded || !sample->data) {
+        player->playing = false;
+        return false;
+    }
+    if (player->paused)
+        return true;
+
+    uint32_t start, end;
+    if (!play_bounds(player, &start, &end)) {
+        player->playing = false;
+        return false;
+    }
+    uint32_t bytes_per_frame = frame_bytes(sample);
+    uint32_t pos = player->position / bytes_per_frame;
+    if (pos < start)
+        pos = start;
+
+    uint32_t step = player->step;
+    uint32_t frac = player->frac;
+    bool lerp = player->interpolate && ((step | frac) & 0xFFFF);
+    const mix_kernel_fn *kernels = s_kernels[0][sample->bits_per_sample == 16];
+    const mix_kernel_fn *lerp_kernels = s_kernels[1][sample->bits_per_sample == 16];
+    bool stereo = sample->channels >= 2;
+
+    for (int i = 0; i < frames;) {
+        if (pos >= end) {
             player->repeats_played++;
             if (player->repeat_count > 0 && player->repeats_played >= player->repeat_count) {
                 player->playing = false;
-                player->position = effective_start;
-                continue;
+                player->position = start * bytes_per_frame;
+                return false;
             }
-            player->position = effective_start;
-            pos = effective_start;
+            pos = start;
+        }
+        // ADPCM plays one decoded block at a time.
+        const uint8_t *src = sample->data;
+        uint32_t base = 0, stop = end;
+        if (sample->adpcm) {
+            uint32_t block = pos / sample->block_frames;
+            base = block * sample->block_frames;
+            if (stop > base + sample->block_frames)
+                stop = base + sample->block_frames;
+            src = (const uint8_t *)adpcm_block(player, block);
         }
+        // Interpolate up to the last frame, which has no successor to blend.
+        bool lerp_run = lerp && stop - pos > 1;
+        uint32_t rel = pos - base;
+        uint32_t n = run_length(rel, frac, step, (lerp_run ? stop - 1 : stop) - base, frames - i);
+        (lerp_run ? lerp_kernels : kernels)[stereo](mix + i * 2, n, src, ~0u,
+                                                    &rel, &frac, step, player->gain);
+        pos = base + rel;
+        i += n;
+    }
 
-        uint32_t bytes_per_sample = sample->bits_per_sample / 8;
-        uint32_t bytes_per_frame = bytes_per_sample * sample->channels;
+    player->frac = frac;
+    player->position = pos * bytes_per_frame;
+    return true;
+}
 
-        if (pos + bytes_per_frame > sample->length) {
-            player->position = sample->length;
-            continue;
-        }
+// Mixer voice for a bank-resident sample: plays whatever sound_poll() has
+// staged.  Repeats are resolved by the filler, so the ring is one continuous
+// run of frames and the voice ends once the filler is done and it is empty.
+static bool sound_stream_render(void *ctx, int32_t *mix, int frames) {
+    sound_player_t *player = (sound_player_t *)ctx;
+    sound_sample_t *sample = player->sample;
+    sound_stream_t *s = player->stream;
+    if (!player->playing || !s || !sample) {
+        player->playing = false;
+        return false;
+    }
+    if (player->paused)
+        return true;
 
-        uint8_t left_8, right_8;
-        if (sample->bits_per_sample == 16) {
-            int16_t left_16 = *(int16_t *)(sample->data + pos);
-            left_8 = (uint8_t)((left_16 + 32768) >> 8);
-            if (sample->channels >= 2) {
-                int16_t right_16 = *(int16_t *)(sample->data + pos + 2);
-                right_8 = (uint8_t)((right_16 + 32768) >> 8);
-            } else {
-                right_8 = left_8;
-            }
+    uint32_t start, end;
+    if (!play_bounds(player, &start, &end)) {
+        player->playing = false;
+        return false;
+    }
+    uint32_t bytes_per_frame = frame_bytes(sample);
+    bool eos = s->eos;
+    __dmb();  // eos before wr: once set, wr is final
+    uint32_t rd = s->rd;
+    uint32_t avail = (s->wr - rd) / bytes_per_frame;
+    __dmb();
+
+    uint32_t step = player->step;
+    uint32_t frac = player->frac;
+    bool lerp = player->interpolate && ((step | frac) & 0xFFFF);
+    const mix_kernel_fn *kernels = s_kernels[0][sample->bits_per_sample == 16];
+    const mix_kernel_fn *lerp_kernels = s_kernels[1][sample->bits_per_sample == 16];
+    bool stereo = sample->channels >= 2;
+    uint32_t mask = SOUND_STREAM_BUF_SIZE / bytes_per_frame - 1;
+    uint32_t base = rd / bytes_per_frame;
+    uint32_t pos = base;
+    uint32_t limit = base + avail;
+
+    // Stops early on underrun, or at the end of the last repeat.
+    for (int i = 0; i < frames && pos - base < avail;) {
+        bool lerp_run = lerp && limit - pos > 1;
+        uint32_t n = run_length(pos, frac, step, lerp_run ? limit - 1 : limit, frames - i);
+        (lerp_run ? lerp_kernels : kernels)[stereo](mix + i * 2, n, s->buf, mask,
+                                                    &pos, &frac, step, player->gain);
+        i += n;
+    }
+    uint32_t used = pos - base;
+    if (used > avail)
+        used = avail;
+
+    if (eos && used >= avail) {
+        player->playing = false;
+        player->position = start * bytes_per_frame;
+        s->rd = rd + avail * bytes_per_frame;
+        return false;
+    }
+
+    uint32_t frame = s->play_frame + used;
+    while (frame >= end)
+        frame -= end - start;
+    s->play_frame = frame;
+    player->frac = frac;
+    player->position = frame * bytes_per_frame;
+    s->rd = rd + used * bytes_per_frame;
+    return true;
+}
+
+// Top up a player's staging ring from the bank.  Caller holds s_stream_mutex.
+static void stream_fill(sound_player_t *player) {
+    sound_stream_t *s = player->stream;
+    sound_sample_t *sample = player->sample;
+    uint32_t start, end;
+    if (!s || !sample || !play_bounds(player, &start, &end)) {
+        if (s)
+            s->eos = true;
+        return;
+    }
+    uint32_t bytes_per_frame = frame_bytes(sample);
+
+    while (!s->eos) {
+        uint32_t wr = s->wr;
+        uint32_t space = SOUND_STREAM_BUF_SIZE - (wr - s->rd);
+        uint32_t idx = wr & (SOUND_STREAM_BUF_SIZE - 1);
+        uint32_t n = SOUND_STREAM_BUF_SIZE - idx;
+        if (n > space)
+            n = space;
+        uint32_t left = (end - s->fetch_frame) * bytes_per_frame;
+        if (n > left)
+            n = left;
+        n -= n % bytes_per_frame;
+        if (n == 0)
+            break;
+
+        if (sample->adpcm) {
+            // Decode in the filler; the ring always holds PCM.
+            uint32_t block = s->fetch_frame / sample->block_frames;
+            uint32_t base = block * sample->block_frames;
+            uint32_t in_block = (base + sample->block_frames - s->fetch_frame) * bytes_per_frame;
+            if (n > in_block)
+                n = in_block;
+            const int16_t *pcm = adpcm_block(player, block);
+            memcpy(s->buf + idx, pcm + (s->fetch_frame - base) * sample->channels, n);
         } else {
-            left_8 = sample->data[pos];
-            if (sample->channels >= 2) {
-                right_8 = sample->data[pos + 1];
+            pio_psram_read(sample->bank_addr + s->fetch_frame * bytes_per_frame, s->buf + idx, n);
+        }
+        __dmb();  // data visible to the ISR before the new write index
+        s->wr = wr + n;
+        s->fetch_frame += n / bytes_per_frame;
+
+        if (s->fetch_frame >= end) {
+            player->repeats_played++;
+            if (player->repeat_count > 0 && player->repeats_played >= player->repeat_count) {
+                __dmb();
+                s->eos = true;
             } else {
-                right_8 = left_8;
+                s->fetch_frame = start;
             }
         }
+    }
+}
 
-        uint32_t volume = player->volume;
-        uint32_t left_level = (left_8 * volume) / 100;
-        uint32_t right_level = (right_8 * volume) / 100;
-        left_level = (left_level * 128) / 255;
-        right_level = (right_level * 128) / 255;
+// Silence a player and give back its stream slot.  Caller holds
+// s_stream_mutex.
+static void player_halt(sound_player_t *player) {
+    audio_mixer_remove_voice(sound_voice_render, player);
+    audio_mixer_remove_voice(sound_stream_render, player);
+    player->playing = false;
+    player->paused = false;
+    if (player->stream) {
+        player->stream->owner = NULL;
+        player->stream = NULL;
+    }
+}
 
-        pwm_set_gpio_level(AUDIO_PIN_L, left_level);
-        pwm_set_gpio_level(AUDIO_PIN_R, right_level);
+// The playing player to cut for `player`: lowest priority first, oldest
+// among equals, and never one that outranks it.
+static sound_player_t *pick_victim(const sound_player_t *player, bool streaming_only) {
+    sound_player_t *victim = NULL;
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
+        sound_player_t *p = &s_context.players[i];
+        if (p == player || !p->playing)
+            continue;
+        if (streaming_only && !p->stream)
+            continue;
+        if (p->priority > player->priority)
+            continue;
+        if (!victim || p->priority < victim->priority ||
+            (p->priority == victim->priority && (int32_t)(p->start_seq - victim->start_seq) < 0))
+            victim = p;
+    }
+    return victim;
+}
 
-        int advance = (int)(bytes_per_frame * player->rate);
-        if (advance < 1) advance = 1;
-        player->position += advance;
+static sound_stream_t *stream_claim(sound_player_t *player) {
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < SOUND_STREAM_SLOTS; i++) {
+            sound_stream_t *s = &s_streams[i];
+            if (s->owner && s->owner->playing)
+                continue;
+            if (s->owner)
+                player_halt(s->owner);
+            return s;
+        }
+        sound_player_t *victim = pick_victim(player, true);
+        if (!victim)
+            break;
+        player_halt(victim);
     }
+    return NULL;
+}
 
-    s_context.time_offset_us += s_timer_interval_us;
+// Stop every player using sample (before its storage changes).
+static void sample_stop_players(const sound_sample_t *sample) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
+        if (s_context.players[i].allocated && s_context.players[i].sample == sample)
+            sound_player_stop(&s_context.players[i]);
+    }
 }
 
-static bool playback_timer_callback(repeating_timer_t *rt) {
-    (void)rt;
-    sound_update();
-    return true;
+void sound_init(void) {
+    if (!s_stream_mutex_ready) {
+        mutex_init(&s_stream_mutex);
+        s_stream_mutex_ready = true;
+    }
+
+    mutex_enter_blocking(&s_stream_mutex);
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
+        player_halt(&s_context.players[i]);
+        if (s_context.players[i].block_pcm)
+            umm_free(s_context.players[i].block_pcm);
+    }
+    mutex_exit(&s_stream_mutex);
+
+    // Samples a previous app never freed (the Lua heap outlives apps).
+    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+        sound_sample_t *sample = s_context.samples[i];
+        if (sample) {
+            sample_free(sample);
+            free(sample);
+        }
+    }
+
+    memset(&s_context, 0, sizeof(s_context));
+    memset(s_streams, 0, sizeof(s_streams));
+    sound_bank_reset();
+    s_context.time_base_frames = audio_mixer_get_frames();
+}
+
+void sound_poll(void) {
+    if (!s_stream_mutex_ready || !mutex_try_enter(&s_stream_mutex, NULL))
+        return;
+    for (int i = 0; i < SOUND_STREAM_SLOTS; i++) {
+        sound_stream_t *s = &s_streams[i];
+        sound_player_t *player = s->owner;
+        if (!player)
+            continue;
+        if (!player->playing) {
+            // Finished on its own: the ISR has already dropped the voice.
+            player->stream = NULL;
+            s->owner = NULL;
+            continue;
+        }
+        stream_fill(player);
+    }
+    mutex_exit(&s_stream_mutex);
 }
 
 sound_sample_t *sound_sample_create(void) {
@@ -182,8 +563,8 @@ sound_sample_t *sound_sample_create(void) {
 void sound_sample_destroy(sound_sample_t *sample) {
     if (!sample)
         return;
-    if (sample->data)
-        umm_free(sample->data);
+    sample_stop_players(sample);
+    sample_free(sample);
     for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
         if (s_context.samples[i] == sample) {
             s_context.samples[i] = NULL;
@@ -193,6 +574,102 @@ void sound_sample_destroy(sound_sample_t *sample) {
     free(sample);  // allocated with calloc(), not umm_malloc
 }
 
+static inline uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+typedef struct {
+    uint16_t tag;
+    uint16_t channels;
+    uint16_t bits;
+    uint16_t block_align;
+    uint32_t sample_rate;
+    uint32_t fact_frames;   // 0 if there is no fact chunk
+    uint32_t data_offset;
+    uint32_t data_size;
+} wav_info_t;
+
+// Walk the RIFF chunks with seeks rather than reading the whole file, so a
+// sample of any size only costs its own storage.
+static bool wav_find_data(sdfile_t f, uint32_t file_size, wav_info_t *info) {
+    uint8_t hdr[12];
+    if (sdcard_fread(f, hdr, sizeof(hdr)) != (int)sizeof(hdr))
+        return false;
+    if (memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool have_fmt = false;
+    uint32_t pos = 12;
+    while (pos + 8 <= file_size) {
+        uint8_t chunk[16];
+        if (!sdcard_fseek(f, pos) || sdcard_fread(f, chunk, 8) != 8)
+            return false;
+        uint32_t chunk_size = rd32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size < 16 || sdcard_fread(f, chunk, 16) != 16)
+                return false;
+            info->tag = rd16(chunk);
+            info->channels = rd16(chunk + 2);
+            info->sample_rate = rd32(chunk + 4);
+            info->block_align = rd16(chunk + 12);
+            info->bits = rd16(chunk + 14);
+            have_fmt = true;
+        } else if (memcmp(chunk, "fact", 4) == 0) {
+            if (chunk_size >= 4 && sdcard_fread(f, chunk, 4) == 4)
+                info->fact_frames = rd32(chunk);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            info->data_offset = pos + 8;
+            info->data_size = chunk_size;
+            if (info->data_size > file_size - info->data_offset)
+                info->data_size = file_size - info->data_offset;
+            return have_fmt;
+        }
+
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    return false;
+}
+
+// Fill in the format fields of sample from info; returns the bytes of data
+// to keep, or 0 if the format isn't playable.
+static uint32_t wav_accept(const wav_info_t *info, sound_sample_t *sample) {
+    if (info->channels < 1 || info->channels > 2 || info->sample_rate == 0)
+        return 0;
+    sample->channels = (uint8_t)info->channels;
+    sample->sample_rate = info->sample_rate;
+    sample->adpcm = false;
+
+    if (info->tag == IMA_ADPCM_FORMAT_TAG) {
+        uint32_t block_frames = ima_adpcm_frames_in(info->block_align, info->channels);
+        if (info->bits != 4 || info->block_align > SOUND_ADPCM_MAX_BLOCK || block_frames < 2)
+            return 0;
+        uint32_t full = info->data_size / info->block_align;
+        uint32_t frames = full * block_frames +
+                          ima_adpcm_frames_in(info->data_size % info->block_align, info->channels);
+        if (info->fact_frames && info->fact_frames < frames)
+            frames = info->fact_frames;
+        sample->adpcm = true;
+        sample->block_align = info->block_align;
+        sample->block_frames = (uint16_t)block_frames;
+        sample->bits_per_sample = 16;
+        sample->length = frames * info->channels * 2;
+        return frames ? info->data_size : 0;
+    }
+
+    // PCM or WAVE_FORMAT_EXTENSIBLE
+    if ((info->tag != 1 && info->tag != 0xFFFE) || (info->bits != 8 && info->bits != 16))
+        return 0;
+    sample->bits_per_sample = (uint8_t)info->bits;
+    uint32_t size = info->data_size - info->data_size % frame_bytes(sample);
+    sample->length = size;
+    return size;
+}
+
 bool sound_sample_load(sound_sample_t *sample, const char *path) {
     if (!sample || !path)
         return false;
@@ -203,36 +680,63 @@ bool sound_sample_load(sound_sample_t *sample, const char *path) {
         return false;
     }
 
-    uint8_t header[44];
-    int read = sdcard_fread(f, header, sizeof(header));
-    if (read < 44) {
+    int file_size = sdcard_fsize_handle(f);
+    wav_info_t info = {0};
+    sound_sample_t fmt = {0};
+    uint32_t data_size = 0;
+    if (file_size >= 44 && wav_find_data(f, (uint32_t)file_size, &info))
+        data_size = wav_accept(&info, &fmt);
+    if (data_size == 0) {
         sdcard_fclose(f);
-        printf("sound: file too small\n");
+        printf("sound: failed to parse WAV\n");
         return false;
     }
 
-    uint32_t file_size = sdcard_fsize(path);
-    file_size = file_size > SOUND_MAX_SAMPLE_SIZE ? SOUND_MAX_SAMPLE_SIZE : file_size;
-
-    sdcard_fseek(f, 0);
-    uint8_t *data = umm_malloc(file_size);
-    if (!data) {
+    sample_stop_players(sample);
+    sample_free(sample);
+    if (!sample_alloc(sample, data_size)) {
         sdcard_fclose(f);
+        printf("sound: no room for %s (%lu bytes)\n", path, data_size);
         return false;
     }
 
-    uint32_t bytes_read = sdcard_fread(f, data, file_size);
+    bool ok = sdcard_fseek(f, info.data_offset);
+    if (ok && !sample->in_bank) {
+        ok = sdcard_fread(f, sample->data, data_size) == (int)data_size;
+    } else if (ok) {
+        uint8_t *chunk = umm_malloc(SOUND_COPY_CHUNK);
+        ok = chunk != NULL;
+        for (uint32_t done = 0; ok && done < data_size;) {
+            uint32_t n = data_size - done;
+            if (n > SOUND_COPY_CHUNK)
+                n = SOUND_COPY_CHUNK;
+            ok = sdcard_fread(f, chunk, n) == (int)n;
+            if (ok)
+                pio_psram_write(sample->bank_addr + done, chunk, n);
+            done += n;
+        }
+        if (chunk)
+            umm_free(chunk);
+    }
     sdcard_fclose(f);
 
-    if (!parse_wav_header(sample, data, bytes_read)) {
-        umm_free(data);
-        printf("sound: failed to parse WAV\n");
+    if (!ok) {
+        sample_free(sample);
+        printf("sound: read error on %s\n", path);
         return false;
     }
 
-    umm_free(data);
-    printf("sound: loaded %s (%lu Hz, %u bit, %u ch)\n",
-           path, sample->sample_rate, sample->bits_per_sample, sample->channels);
+    sample->length = fmt.length;
+    sample->sample_rate = fmt.sample_rate;
+    sample->bits_per_sample = fmt.bits_per_sample;
+    sample->channels = fmt.channels;
+    sample->adpcm = fmt.adpcm;
+    sample->block_align = fmt.block_align;
+    sample->block_frames = fmt.block_frames;
+    sample->loaded = true;
+    printf("sound: loaded %s (%lu Hz, %s, %u ch, %lu bytes%s)\n",
+           path, sample->sample_rate, sample->adpcm ? "ADPCM" : (sample->bits_per_sample == 16 ? "16 bit" : "8 bit"),
+           sample->channels, sample->stored_size, sample->in_bank ? ", bank" : "");
     return true;
 }
 
@@ -249,12 +753,13 @@ uint32_t sound_sample_get_sample_rate(const sound_sample_t *sample) {
 }
 
 sound_player_t *sound_player_create(void) {
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
         sound_player_t *player = &s_context.players[i];
-        if (!player->sample) {
+        if (!player->allocated) {
+            memset(player, 0, sizeof(*player));
+            player->allocated = true;
             player->volume = 100;
-            player->play_start = 0;
-            player->play_end = 0;
+            player->gain = 256;
             player->rate = 1.0f;
             return player;
         }
@@ -265,73 +770,105 @@ sound_player_t *sound_player_create(void) {
 void sound_player_destroy(sound_player_t *player) {
     if (player) {
         sound_player_stop(player);
+        if (player->block_pcm)
+            umm_free(player->block_pcm);
+        player->block_pcm = NULL;
+        player->block_pcm_cap = 0;
         player->sample = NULL;
+        player->allocated = false;
     }
 }
 
 bool sound_player_set_sample(sound_player_t *player, sound_sample_t *sample) {
     if (!player || !sample)
         return false;
+    if (player->playing)
+        sound_player_stop(player);
     player->sample = sample;
     player->position = 0;
+    player_update_step(player);
     return true;
 }
 
 void sound_player_play(sound_player_t *player, uint8_t repeat_count) {
-    if (!player || !player->sample || !player->sample->loaded)
+    if (!player || !player->sample || !player->sample->loaded || !s_stream_mutex_ready)
+        return;
+    uint32_t start, end;
+    if (!play_bounds(player, &start, &end))
         return;
 
-    player->playing = true;
-    player->paused = false;
+    mutex_enter_blocking(&s_stream_mutex);
+    player_halt(player);
+
+    if (sound_get_playing_source_count() >= SOUND_MAX_VOICES) {
+        sound_player_t *victim = pick_victim(player, false);
+        if (!victim) {
+            mutex_exit(&s_stream_mutex);
+            printf("sound: all voices busy with higher priority\n");
+            return;
+        }
+        player_halt(victim);
+    }
+
     player->repeat_count = repeat_count;
     player->repeats_played = 0;
-    player->position = 0;
+    player->position = start * frame_bytes(player->sample);
+    player->frac = 0;
+    player->start_seq = ++s_play_seq;
+    player_update_step(player);  // the sample may have been reloaded
+
+    // Halted above, so the ISR is done with any old block buffer.
+    player->block_index = UINT32_MAX;
+    if (player->sample->adpcm) {
+        uint32_t need = (uint32_t)player->sample->block_frames * player->sample->channels;
+        if (player->block_pcm_cap < need) {
+            if (player->block_pcm)
+                umm_free(player->block_pcm);
+            player->block_pcm = umm_malloc(need * sizeof(int16_t));
+            player->block_pcm_cap = player->block_pcm ? need : 0;
+        }
+        if (!player->block_pcm) {
+            mutex_exit(&s_stream_mutex);
+            printf("sound: no memory for ADPCM decode\n");
+            return;
+        }
+    }
 
-    uint32_t sample_rate = player->sample->sample_rate;
-    if (sample_rate > 0) {
-        s_timer_interval_us = 1000000 / sample_rate;
-        if (!s_timer_active) {
-            audio_pwm_setup(sample_rate);
-            alarm_pool_t *pool = audio_get_core1_alarm_pool();
-            if (pool) {
-                alarm_pool_add_repeating_timer_us(pool, -s_timer_interval_us,
-                                                  playback_timer_callback, NULL,
-                                                  &s_playback_timer);
-            } else {
-                add_repeating_timer_us(-s_timer_interval_us,
-                                       playback_timer_callback, NULL,
-                                       &s_playback_timer);
-            }
-            s_timer_active = true;
+    audio_voice_fn fn = sound_voice_render;
+    if (player->sample->in_bank) {
+        sound_stream_t *s = stream_claim(player);
+        if (!s) {
+            mutex_exit(&s_stream_mutex);
+            printf("sound: no free stream slot\n");
+            return;
         }
+        s->wr = 0;
+        s->rd = 0;
+        s->eos = false;
+        s->fetch_frame = start;
+        s->play_frame = start;
+        s->owner = player;
+        player->stream = s;
+        stream_fill(player);
+        fn = sound_stream_render;
     }
+
+    player->paused = false;
+    player->playing = true;
+    if (!audio_mixer_add_voice(fn, player))
+        player_halt(player);
+    mutex_exit(&s_stream_mutex);
 }
 
 void sound_player_stop(sound_player_t *player) {
-    if (!player)
+    if (!player || !s_stream_mutex_ready)
         return;
-    player->playing = false;
-    player->paused = false;
+    mutex_enter_blocking(&s_stream_mutex);
+    player_halt(player);
+    mutex_exit(&s_stream_mutex);
     player->position = 0;
     player->repeat_count = 0;
     player->repeats_played = 0;
-
-    pwm_set_gpio_level(AUDIO_PIN_L, 0);
-    pwm_set_gpio_level(AUDIO_PIN_R, 0);
-
-    bool any_playing = false;
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
-        if (s_context.players[i].playing) {
-            any_playing = true;
-            break;
-        }
-    }
-    if (!any_playing && s_timer_active) {
-        cancel_repeating_timer(&s_playback_timer);
-        s_timer_active = false;
-        pwm_set_enabled(pwm_gpio_to_slice_num(AUDIO_PIN_L), false);
-        pwm_set_enabled(pwm_gpio_to_slice_num(AUDIO_PIN_R), false);
-    }
 }
 
 void sound_player_set_volume(sound_player_t *player, uint8_t volume) {
@@ -340,6 +877,7 @@ void sound_player_set_volume(sound_player_t *player, uint8_t volume) {
     if (volume > 100)
         volume = 100;
     player->volume = volume;
+    player->gain = (int32_t)volume * 256 / 100;
 }
 
 uint8_t sound_player_get_volume(const sound_player_t *player) {
@@ -360,12 +898,31 @@ void sound_player_set_rate(sound_player_t *player, float rate) {
     if (!player) return;
     if (rate < 0.0f) rate = 0.0f;
     player->rate = rate;
+    player_update_step(player);
 }
 
 float sound_player_get_rate(const sound_player_t *player) {
     return player ? player->rate : 1.0f;
 }
 
+void sound_player_set_priority(sound_player_t *player, uint8_t priority) {
+    if (player)
+        player->priority = priority;
+}
+
+uint8_t sound_player_get_priority(const sound_player_t *player) {
+    return player ? player->priority : 0;
+}
+
+void sound_player_set_interpolation(sound_player_t *player, bool on) {
+    if (player)
+        player->interpolate = on;
+}
+
+bool sound_player_get_interpolation(const sound_player_t *player) {
+    return player && player->interpolate;
+}
+
 sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint8_t bits_per_sample, uint8_t channels) {
     sound_sample_t *sample = sound_sample_create();
     if (!sample) return NULL;
@@ -374,16 +931,26 @@ sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint
     uint32_t num_frames = (uint32_t)(seconds * sample_rate);
     uint32_t data_size = num_frames * bytes_per_frame;
 
-    if (data_size > SOUND_MAX_SAMPLE_SIZE)
-        data_size = SOUND_MAX_SAMPLE_SIZE;
-
-    sample->data = umm_malloc(data_size);
-    if (!sample->data) {
+    if (!sample_alloc(sample, data_size)) {
         sound_sample_destroy(sample);
         return NULL;
     }
 
-    memset(sample->data, 0, data_size);
+    if (sample->in_bank) {
+        uint8_t *zero = umm_malloc(SOUND_COPY_CHUNK);
+        if (!zero) {
+            sound_sample_destroy(sample);
+            return NULL;
+        }
+        memset(zero, 0, SOUND_COPY_CHUNK);
+        for (uint32_t done = 0; done < data_size; done += SOUND_COPY_CHUNK) {
+            uint32_t n = data_size - done;
+            sample_write(sample, done, zero, n < SOUND_COPY_CHUNK ? n : SOUND_COPY_CHUNK);
+        }
+        umm_free(zero);
+    } else {
+        memset(sample->data, 0, data_size);
+    }
     sample->length = data_size;
     sample->sample_rate = sample_rate;
     sample->bits_per_sample = bits_per_sample;
@@ -394,7 +961,7 @@ sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint
 }
 
 sound_sample_t *sound_sample_get_subsample(const sound_sample_t *sample, uint32_t start_frame, uint32_t end_frame) {
-    if (!sample || !sample->loaded || !sample->data)
+    if (!sample || !sample->loaded)
         return NULL;
 
     uint32_t bytes_per_frame = (sample->bits_per_sample / 8) * sample->channels;
@@ -406,17 +973,40 @@ sound_sample_t *sound_sample_get_subsample(const sound_sample_t *sample, uint32_
 
     uint32_t num_frames = end_frame - start_frame;
     uint32_t data_size = num_frames * bytes_per_frame;
+    uint32_t src_offset = start_frame * bytes_per_frame;
 
     sound_sample_t *sub = sound_sample_create();
     if (!sub) return NULL;
 
-    sub->data = umm_malloc(data_size);
-    if (!sub->data) {
+    if (!sample_alloc(sub, data_size)) {
         sound_sample_destroy(sub);
         return NULL;
     }
 
-    memcpy(sub->data, sample->data + start_frame * bytes_per_frame, data_size);
+    if (sample->adpcm) {
+        if (!adpcm_copy_out(sample, start_frame, num_frames, sub)) {
+            sound_sample_destroy(sub);
+            return NULL;
+        }
+    } else if (!sample->in_bank) {
+        sample_write(sub, 0, sample->data + src_offset, data_size);
+    } else if (!sub->in_bank) {
+        sample_read(sample, src_offset, sub->data, data_size);
+    } else {
+        uint8_t *chunk = umm_malloc(SOUND_COPY_CHUNK);
+        if (!chunk) {
+            sound_sample_destroy(sub);
+            return NULL;
+        }
+        for (uint32_t done = 0; done < data_size; done += SOUND_COPY_CHUNK) {
+            uint32_t n = data_size - done;
+            if (n > SOUND_COPY_CHUNK)
+                n = SOUND_COPY_CHUNK;
+            sample_read(sample, src_offset + done, chunk, n);
+            sample_write(sub, done, chunk, n);
+        }
+        umm_free(chunk);
+    }
     sub->length = data_size;
     sub->sample_rate = sample->sample_rate;
     sub->bits_per_sample = sample->bits_per_sample;
@@ -426,9 +1016,15 @@ sound_sample_t *sound_sample_get_subsample(const sound_sample_t *sample, uint32_
     return sub;
 }
 
+sound_sample_t *sound_sample_decompress(const sound_sample_t *sample) {
+    if (!sample || !sample->loaded || !sample->adpcm)
+        return NULL;
+    return sound_sample_get_subsample(sample, 0, sound_sample_get_length(sample));
+}
+
 int sound_get_playing_source_count(void) {
     int count = 0;
-    for (int i = 0; i < SOUND_MAX_SAMPLES; i++) {
+    for (int i = 0; i < SOUND_MAX_PLAYERS; i++) {
         if (s_context.players[i].playing)
             count++;
     }
@@ -436,9 +1032,9 @@ int sound_get_playing_source_count(void) {
 }
 
 uint32_t sound_get_current_time(void) {
-    return s_context.time_offset_us / 1000000;
+    return (audio_mixer_get_frames() - s_context.time_base_frames) / AUDIO_MIXER_RATE;
 }
 
 void sound_reset_time(void) {
-    s_context.time_offset_us = 0;
+    s_context.time_base_frames = audio_mixer_get_frames();
 }
@@ -3,40 +3,77 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#define SOUND_MAX_SAMPLES 4
-#define SOUND_MAX_SAMPLE_SIZE (64 * 1024)
+#define SOUND_MAX_SAMPLES 64
+#define SOUND_MAX_PLAYERS 32
+// Players heard at once; further play() calls steal a voice (see priority).
+#define SOUND_MAX_VOICES  24
+
+// Samples up to this size are kept in the Lua heap and mixed in place;
+// larger ones go to the PIO PSRAM sample bank and are streamed.
+#define SOUND_RAM_SAMPLE_MAX (64 * 1024)
+
+// Bank-resident samples play through one of these SRAM rings, refilled from
+// Core 1 by sound_poll().  Size must be a power of two.
+#define SOUND_STREAM_SLOTS    4
+#define SOUND_STREAM_BUF_SIZE 8192
+
+// Largest IMA ADPCM block accepted (WAV block_align).
+#define SOUND_ADPCM_MAX_BLOCK 2048
 
 typedef struct {
-    uint8_t *data;
-    uint32_t length;
+    uint8_t *data;          // Lua heap copy, or NULL when in_bank
+    uint32_t length;        // PCM bytes (as decoded, for ADPCM)
     uint32_t sample_rate;
-    uint8_t bits_per_sample;
+    uint8_t bits_per_sample; // of the PCM output: 16 for ADPCM
     uint8_t channels;
     bool loaded;
+    bool in_bank;
+    uint32_t bank_addr;     // PIO PSRAM address when in_bank
+    uint32_t stored_size;   // bytes held in data or the bank
+    bool adpcm;             // IMA ADPCM blocks, decoded while mixing
+    uint16_t block_align;   // ADPCM bytes per block
+    uint16_t block_frames;  // ADPCM frames per full block
 } sound_sample_t;
 
+typedef struct sound_stream sound_stream_t;
+
 typedef struct {
     sound_sample_t *sample;
+    bool allocated;
     bool playing;
     bool paused;
-    uint32_t position;
+    uint32_t position;      // byte offset into the sample data
+    uint32_t frac;          // 16.16 resampling phase below position
     uint8_t volume;
+    int32_t gain;           // volume as a multiplier, 256 = unity
     uint8_t repeat_count;
     uint8_t repeats_played;
+    uint8_t priority;       // higher survives voice stealing
     uint32_t play_start;
     uint32_t play_end;
     float rate;
+    uint32_t step;          // 16.16 source frames per output frame
+    bool interpolate;       // linear rather than nearest-frame resampling
+    uint32_t start_seq;     // play order, oldest is stolen first
+    sound_stream_t *stream; // staging ring while a bank sample plays
+    int16_t *block_pcm;     // decoded ADPCM block (block_frames frames)
+    uint32_t block_pcm_cap; // int16 values block_pcm can hold
+    uint32_t block_index;   // block in block_pcm, UINT32_MAX if none
 } sound_player_t;
 
 typedef struct {
     sound_sample_t *samples[SOUND_MAX_SAMPLES];
-    sound_player_t players[SOUND_MAX_SAMPLES];
+    sound_player_t players[SOUND_MAX_PLAYERS];
     uint8_t active_players;
-    uint32_t time_offset_us;
+    uint32_t time_base_frames;
 } sound_context_t;
 
+// Each playing player is a voice in the audio mixer, so up to
+// SOUND_MAX_VOICES of them are heard together.
 void sound_init(void);
-void sound_update(void);
+
+// Core 1 loop: refills the staging rings of bank-resident samples.
+void sound_poll(void);
 
 sound_sample_t *sound_sample_create(void);
 void sound_sample_destroy(sound_sample_t *sample);
@@ -55,9 +92,17 @@ bool sound_player_is_playing(const sound_player_t *player);
 void sound_player_set_play_range(sound_player_t *player, uint32_t start, uint32_t end);
 void sound_player_set_rate(sound_player_t *player, float rate);
 float sound_player_get_rate(const sound_player_t *player);
+void sound_player_set_priority(sound_player_t *player, uint8_t priority);
+uint8_t sound_player_get_priority(const sound_player_t *player);
+// Linear interpolation between source frames: smoother pitch-shifting for a
+// little more mixing time.  Off by default.
+void sound_player_set_interpolation(sound_player_t *player, bool on);
+bool sound_player_get_interpolation(const sound_player_t *player);
 
 sound_sample_t *sound_sample_new_blank(float seconds, uint32_t sample_rate, uint8_t bits_per_sample, uint8_t channels);
 sound_sample_t *sound_sample_get_subsample(const sound_sample_t *sample, uint32_t start_frame, uint32_t end_frame);
+// PCM copy of an ADPCM sample (NULL for PCM samples or out of memory).
+sound_sample_t *sound_sample_decompress(const sound_sample_t *sample);
 int sound_get_playing_source_count(void);
 
 uint32_t sound_get_current_time(void);
@@ -0,0 +1,101 @@
+#include "sound_bank.h"
+#include "pio_psram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t addr;
+    uint32_t size;
+} bank_extent_t;
+
+// Free extents, sorted by address and never adjacent (merged on free).
+static bank_extent_t s_free[SOUND_BANK_MAX_EXTENTS];
+static int s_free_count = 0;
+static bool s_ready = false;
+
+static inline uint32_t bank_round(uint32_t size) {
+    return (size + SOUND_BANK_ALIGN - 1) & ~(uint32_t)(SOUND_BANK_ALIGN - 1);
+}
+
+static bool bank_ensure(void) {
+    if (s_ready)
+        return true;
+    if (!pio_psram_available())
+        return false;
+    s_free[0].addr = PIO_PSRAM_SOUND_BASE;
+    s_free[0].size = PIO_PSRAM_SOUND_SIZE;
+    s_free_count = 1;
+    s_ready = true;
+    return true;
+}
+
+void sound_bank_reset(void) {
+    s_ready = false;
+    s_free_count = 0;
+}
+
+bool sound_bank_alloc(uint32_t size, uint32_t *addr) {
+    if (size == 0 || !bank_ensure())
+        return false;
+    size = bank_round(size);
+
+    for (int i = 0; i < s_free_count; i++) {
+        if (s_free[i].size < size)
+            continue;
+        *addr = s_free[i].addr;
+        s_free[i].addr += size;
+        s_free[i].size -= size;
+        if (s_free[i].size == 0) {
+            memmove(&s_free[i], &s_free[i + 1],
+                    (s_free_count - i - 1) * sizeof(bank_extent_t));
+            s_free_count--;
+        }
+        return true;
+    }
+    return false;
+}
+
+void sound_bank_free(uint32_t addr, uint32_t size) {
+    if (!s_ready || size == 0)
+        return;
+    size = bank_round(size);
+
+    int i = 0;
+    while (i < s_free_count && s_free[i].addr < addr)
+        i++;
+
+    bool merge_prev = i > 0 && s_free[i - 1].addr + s_free[i - 1].size == addr;
+    bool merge_next = i < s_free_count && addr + size == s_free[i].addr;
+
+    if (merge_prev && merge_next) {
+        s_free[i - 1].size += size + s_free[i].size;
+        memmove(&s_free[i], &s_free[i + 1],
+                (s_free_count - i - 1) * sizeof(bank_extent_t));
+        s_free_count--;
+    } else if (merge_prev) {
+        s_free[i - 1].size += size;
+    } else if (merge_next) {
+        s_free[i].addr = addr;
+        s_free[i].size += size;
+    } else if (s_free_count < SOUND_BANK_MAX_EXTENTS) {
+        memmove(&s_free[i + 1], &s_free[i],
+                (s_free_count - i) * sizeof(bank_extent_t));
+        s_free[i].addr = addr;
+        s_free[i].size = size;
+        s_free_count++;
+    } else {
+        // Table full: the space is lost until the next sound_bank_reset().
+        printf("[SOUND] bank free list full, leaking %lu bytes\n",
+               (unsigned long)size);
+    }
+}
+
+uint32_t sound_bank_free_bytes(void) {
+    if (!bank_ensure())
+        return 0;
+    uint32_t total = 0;
+    for (int i = 0; i < s_free_count; i++)
+        total += s_free[i].size;
+    return total;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =============================================================================
+// Sound sample bank
+//
+// First-fit allocator over the PIO PSRAM sound region (PIO_PSRAM_SOUND_BASE).
+// Samples too large for the Lua heap live here; the mixer ISR can't read PIO
+// PSRAM, so sound.c streams them through small SRAM rings from Core 1.
+// =============================================================================
+
+#define SOUND_BANK_ALIGN       256
+#define SOUND_BANK_MAX_EXTENTS 64
+
+// Forget every allocation (between apps).
+void sound_bank_reset(void);
+
+// False if PIO PSRAM is absent or no free extent is large enough.
+bool sound_bank_alloc(uint32_t size, uint32_t *addr);
+void sound_bank_free(uint32_t addr, uint32_t size);
+
+uint32_t sound_bank_free_bytes(void);
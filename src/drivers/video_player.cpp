@@ -15,6 +15,8 @@ extern "C" {
 #include <string.h>
 #include <stdlib.h>
 #include <pico/time.h>
+#include <pico/multicore.h>
+#include <hardware/sync.h>
 #include <hardware/watchdog.h>
 
 #include <JPEGDEC.h>
@@ -27,7 +29,6 @@ typedef struct {
 typedef struct {
     uint32_t ra_offset;   // byte offset within the ring buffer
     uint32_t size;        // JPEG payload size
-    bool     valid;
 } ra_frame_entry_t;
 
 typedef struct {
@@ -61,12 +62,29 @@ typedef struct {
     uint32_t consecutive_drops;
     uint32_t adaptive_stride;
 
-    // Read-ahead ring buffer (QMI PSRAM)
+    // Split decode: 0 untested, 1 frames carry usable restart markers,
+    // -1 they don't (checked once on the first full-width frame)
+    int8_t   split_mode;
+    video_stats_t stats;
+
+    // Read-ahead ring buffer (QMI PSRAM), filled by Core 1.  Frames
+    // [ra_first_frame, ra_end_frame) are buffered; Core 1 alone advances
+    // ra_end_frame and Core 0 alone ra_first_frame, except under
+    // g_sdcard_mutex (load, seek), which Core 1 holds for each fill step.
+    // A span still streaming in (ra_token) is cancelled before either.
     uint8_t         *ra_buffer;        // ring buffer base
     uint32_t         ra_capacity;      // buffer size in bytes
-    ra_frame_entry_t *ra_frames;       // per-frame metadata array
-    uint32_t         ra_frame_count;   // number of frames buffered
-    uint32_t         ra_first_frame;   // lowest frame number in buffer
+    ra_frame_entry_t *ra_frames;       // per-frame metadata, frame % RA_MAX_FRAMES
+    sdfile_t         ra_file;          // own handle, so fills never move priv->file
+    volatile uint32_t ra_first_frame;  // oldest frame still wanted
+    volatile uint32_t ra_end_frame;    // one past the newest buffered frame
+    uint32_t         ra_head;          // ring offset the next read lands at
+    bool             ra_filling;       // between the low and high watermarks
+    sdcard_async_t   ra_token;         // read streaming into the ring, 0 if none
+    uint32_t         ra_read_first;    // its frames: [ra_read_first, ra_read_last]
+    uint32_t         ra_read_last;
+    uint32_t         ra_read_pos;      // ring offset it lands at
+    uint32_t         ra_read_len;
     uint32_t         ra_hits;          // diagnostic: cache hits
     uint32_t         ra_misses;        // diagnostic: cache misses
 
@@ -135,6 +153,255 @@ static int jpeg_draw_cb_2x(JPEGDRAW *pDraw) {
     return 1;
 }
 
+// --- Split-frame decode across both cores ---
+// A frame with restart markers (DRI) can be cut at any restart boundary that
+// starts an MCU row.  The rows above and below become two self-contained
+// JPEGs: the original headers with the SOF height patched, followed by their
+// share of the entropy-coded data and an EOI.  Core 0 decodes the top slice
+// while Core 1 decodes the bottom one, both straight into the back buffer.
+// Slices are presented to JPEGDEC through read callbacks, so nothing but the
+// headers is copied.
+
+#define SPLIT_HDR_MAX 1024  // SOI..SOS; optimal Huffman tables are ~600 bytes
+
+typedef struct {
+    const uint8_t *src;            // the frame's JPEG data
+    uint32_t ent_start, ent_end;   // entropy-coded bytes taken from src
+    uint32_t hdr_len;
+    uint32_t size;                 // hdr_len + entropy + EOI
+    uint8_t  hdr[SPLIT_HDR_MAX];   // headers, SOF height patched
+} jpeg_slice_t;
+
+enum { SPLIT_IDLE, SPLIT_POSTED, SPLIT_BUSY, SPLIT_DONE };
+
+// Core 0 -> Core 1 handoff.  Core 0 fills the job and moves IDLE->POSTED;
+// Core 1 claims it POSTED->BUSY and publishes BUSY->DONE.  If Core 1 has not
+// claimed it by the time Core 0 is done with the top, Core 0 takes it back
+// (POSTED->IDLE) and decodes the bottom itself, so a busy Core 1 costs no
+// more than a single-core decode.
+static uint32_t      s_split_state = SPLIT_IDLE;
+static jpeg_slice_t  s_split_slices[2];     // top, bottom
+static uint16_t     *s_split_fb;            // where the bottom slice goes
+static bool          s_split_ok;
+static uint32_t      s_split_core1_us;
+
+// Core 1's decoder, also in SRAM: the two cores never share one.
+static JPEGDEC s_jpeg_core1;
+
+static const uint8_t k_jpeg_eoi[2] = {0xFF, 0xD9};
+
+static inline uint16_t be16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static int32_t slice_read(JPEGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
+    const jpeg_slice_t *s = (const jpeg_slice_t *)pFile->fHandle;
+    uint32_t ent_len = s->ent_end - s->ent_start;
+    if (iLen > pFile->iSize - pFile->iPos)
+        iLen = pFile->iSize - pFile->iPos;
+    int32_t n = 0;
+    while (n < iLen) {
+        uint32_t p = (uint32_t)(pFile->iPos + n);
+        const uint8_t *src;
+        uint32_t avail;
+        if (p < s->hdr_len) {
+            src = s->hdr + p;
+            avail = s->hdr_len - p;
+        } else if (p < s->hdr_len + ent_len) {
+            src = s->src + s->ent_start + (p - s->hdr_len);
+            avail = s->hdr_len + ent_len - p;
+        } else {
+            src = k_jpeg_eoi + (p - s->hdr_len - ent_len);
+            avail = s->size - p;
+        }
+        if (avail > (uint32_t)(iLen - n)) avail = (uint32_t)(iLen - n);
+        memcpy(pBuf + n, src, avail);
+        n += (int32_t)avail;
+    }
+    pFile->iPos += n;
+    return n;
+}
+
+static int32_t slice_seek(JPEGFILE *pFile, int32_t iPosition) {
+    if (iPosition < 0) iPosition = 0;
+    if (iPosition > pFile->iSize) iPosition = pFile->iSize;
+    pFile->iPos = iPosition;
+    return iPosition;
+}
+
+static void slice_close(void *pHandle) {
+    (void)pHandle;
+}
+
+static void slice_init(jpeg_slice_t *s, const uint8_t *buf, uint32_t hdr_len,
+                       uint32_t sof_h, uint16_t height,
+                       uint32_t ent_start, uint32_t ent_end) {
+    s->src = buf;
+    memcpy(s->hdr, buf, hdr_len);
+    s->hdr[sof_h] = (uint8_t)(height >> 8);
+    s->hdr[sof_h + 1] = (uint8_t)height;
+    s->hdr_len = hdr_len;
+    s->ent_start = ent_start;
+    s->ent_end = ent_end;
+    s->size = hdr_len + (ent_end - ent_start) + sizeof(k_jpeg_eoi);
+}
+
+// Offset of the n-th (1-based) RSTm marker at or after pos, or 0.
+static uint32_t find_restart(const uint8_t *buf, uint32_t pos, uint32_t end,
+                             uint32_t n) {
+    while (pos + 1 < end) {
+        const uint8_t *ff = (const uint8_t *)memchr(buf + pos, 0xFF, end - pos - 1);
+        if (!ff) return 0;
+        pos = (uint32_t)(ff - buf);
+        uint8_t m = buf[pos + 1];
+        if (m >= 0xD0 && m <= 0xD7 && --n == 0)
+            return pos;
+        pos += (m == 0xFF) ? 1 : 2;  // fill bytes may precede a marker
+    }
+    return 0;
+}
+
+// Cut a baseline JPEG into top and bottom slices near its middle MCU row.
+// With validate, also checks that the whole scan carries the restart
+// markers its DRI promises (done once per video).  Returns the height of
+// the top slice in pixels, or 0 if the frame can't be split.
+static int jpeg_split_frame(const uint8_t *buf, uint32_t size, bool validate,
+                            jpeg_slice_t *top, jpeg_slice_t *bot) {
+    if (size < 4 || buf[0] != 0xFF || buf[1] != 0xD8) return 0;
+
+    uint32_t pos = 2, sof_h = 0, hdr_len = 0, ri = 0;
+    uint16_t width = 0, height = 0;
+    int hmax = 1, vmax = 1, ncomp = 0;
+    while (pos + 4 <= size && !hdr_len) {
+        if (buf[pos] != 0xFF) return 0;
+        uint8_t m = buf[pos + 1];
+        if (m == 0xFF) { pos++; continue; }
+        uint32_t len = be16(buf + pos + 2);
+        if (len < 2 || pos + 2 + len > size) return 0;
+        const uint8_t *seg = buf + pos + 4;
+        if (m == 0xC0 || m == 0xC1) {
+            if (len < 8) return 0;
+            sof_h = pos + 5;
+            height = be16(seg + 1);
+            width = be16(seg + 3);
+            ncomp = seg[5];
+            if (len < 8u + 3u * (uint32_t)ncomp) return 0;
+            for (int c = 0; c < ncomp; c++) {
+                int hv = seg[7 + c * 3];
+                if ((hv >> 4) > hmax) hmax = hv >> 4;
+                if ((hv & 15) > vmax) vmax = hv & 15;
+            }
+        } else if (m >= 0xC2 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC) {
+            return 0;  // progressive, lossless or arithmetic: not supported
+        } else if (m == 0xDD && len >= 4) {
+            ri = be16(seg);
+        } else if (m == 0xDA) {
+            hdr_len = pos + 2 + len;
+        }
+        pos += 2 + len;
+    }
+    if (!hdr_len || !sof_h || !ri || !width || !height ||
+        hdr_len > SPLIT_HDR_MAX)
+        return 0;
+
+    if (ncomp == 1) hmax = vmax = 1;  // non-interleaved: 8x8 MCUs
+    uint32_t mcu_h = 8u * (uint32_t)vmax;
+    uint32_t cols = (width + 8u * hmax - 1) / (8u * hmax);
+    uint32_t rows = (height + mcu_h - 1) / mcu_h;
+
+    // Nearest MCU row to the middle that falls on a restart boundary
+    uint32_t split = 0;
+    for (uint32_t d = 0; d < rows / 2 && !split; d++) {
+        uint32_t r = rows / 2 + d;
+        if (r > 0 && r < rows && (r * cols) % ri == 0) split = r;
+        r = rows / 2 - d;
+        if (!split && r > 0 && (r * cols) % ri == 0) split = r;
+    }
+    if (!split) return 0;
+
+    uint32_t end = size;
+    if (end >= hdr_len + 2 && buf[end - 2] == 0xFF && buf[end - 1] == 0xD9)
+        end -= 2;
+
+    uint32_t rst = find_restart(buf, hdr_len, end, split * cols / ri);
+    if (!rst) return 0;
+    if (validate) {
+        uint32_t total = (rows * cols + ri - 1) / ri - 1;  // markers in the scan
+        uint32_t rest = total - split * cols / ri;
+        if (rest && !find_restart(buf, rst + 2, end, rest)) return 0;
+        if (find_restart(buf, rst + 2, end, rest + 1)) return 0;
+    }
+
+    uint16_t top_h = (uint16_t)(split * mcu_h);
+    slice_init(top, buf, hdr_len, sof_h, top_h, hdr_len, rst);
+    slice_init(bot, buf, hdr_len, sof_h, (uint16_t)(height - top_h), rst + 2, end);
+    return top_h;
+}
+
+static bool decode_slice(JPEGDEC *jpeg, jpeg_slice_t *slice, uint16_t *fb) {
+    if (!jpeg->open(slice, (int)slice->size, slice_close, slice_read,
+                    slice_seek, jpeg_draw_cb))
+        return false;
+    jpeg->setPixelType(RGB565_BIG_ENDIAN);
+    jpeg->setFramebuffer(fb);
+    bool ok = jpeg->decode(0, 0, 0) != 0;
+    jpeg->close();
+    return ok;
+}
+
+void video_player_core1_poll(void) {
+    uint32_t expected = SPLIT_POSTED;
+    if (__atomic_load_n(&s_split_state, __ATOMIC_RELAXED) != SPLIT_POSTED ||
+        !__atomic_compare_exchange_n(&s_split_state, &expected, SPLIT_BUSY,
+                                     false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+    uint64_t t0 = time_us_64();
+    s_split_ok = decode_slice(&s_jpeg_core1, &s_split_slices[1], s_split_fb);
+    s_split_core1_us = (uint32_t)(time_us_64() - t0);
+    __atomic_store_n(&s_split_state, SPLIT_DONE, __ATOMIC_RELEASE);
+}
+
+// Decode a full-width frame as two slices, the bottom one on Core 1.
+// Returns false (nothing drawn) if the frame has no usable restart markers.
+static bool decode_frame_split(video_priv_t *priv, const uint8_t *jpeg_buf,
+                               uint32_t size, uint16_t *fb) {
+    int top_h = jpeg_split_frame(jpeg_buf, size, priv->split_mode == 0,
+                                 &s_split_slices[0], &s_split_slices[1]);
+    if (priv->split_mode == 0) {
+        priv->split_mode = top_h ? 1 : -1;
+        printf("[VIDEO] Split decode %s\n",
+               top_h ? "on: bottom half of each frame on Core 1"
+                     : "off: frames have no restart markers");
+    }
+    if (!top_h) return false;
+
+    s_split_fb = fb + top_h * FB_WIDTH;
+    __atomic_store_n(&s_split_state, SPLIT_POSTED, __ATOMIC_RELEASE);
+    multicore_doorbell_set_other_core(WIFI_IPC_DOORBELL);
+
+    uint64_t t0 = time_us_64();
+    bool ok = decode_slice(priv->jpeg, &s_split_slices[0], fb);
+    uint64_t t1 = time_us_64();
+    priv->stats.core0_us += (uint32_t)(t1 - t0);
+
+    uint32_t expected = SPLIT_POSTED;
+    if (__atomic_compare_exchange_n(&s_split_state, &expected, SPLIT_IDLE,
+                                    false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        // Core 1 never got to it
+        ok = decode_slice(priv->jpeg, &s_split_slices[1], s_split_fb) && ok;
+        priv->stats.core0_us += (uint32_t)(time_us_64() - t1);
+        return ok;
+    }
+    while (__atomic_load_n(&s_split_state, __ATOMIC_ACQUIRE) != SPLIT_DONE)
+        tight_loop_contents();
+    priv->stats.sync_us += (uint32_t)(time_us_64() - t1);
+    priv->stats.core1_us += s_split_core1_us;
+    priv->stats.split_frames++;
+    ok = s_split_ok && ok;
+    __atomic_store_n(&s_split_state, SPLIT_IDLE, __ATOMIC_RELAXED);
+    return ok;
+}
+
 static uint8_t *buffer_pool_acquire(video_priv_t *priv, uint32_t needed_size) {
     for (int i = 0; i < VIDEO_BUFFER_POOL_SIZE; i++) {
         if (!priv->buffer_pool[i].in_use) {
@@ -177,110 +444,415 @@ static void buffer_pool_cleanup(video_priv_t *priv) {
     }
 }
 
-// Build a complete frame index (one entry per frame) for O(1) seeking
-// and instant skip-to-target in the update loop.
-static bool build_frame_index(video_priv_t *priv, video_player_t *player) {
-    priv->frame_index_capacity = player->frame_count;
-    if (priv->frame_index_capacity > VIDEO_MAX_FRAME_INDEX) {
-        priv->frame_index_capacity = VIDEO_MAX_FRAME_INDEX;
-    }
+// --- Frame index ---
+// Built from the fastest source available: a .pvidx file saved by an earlier
+// open, the AVI's own idx1 (one sequential read), or failing both a walk of
+// every chunk header in movi, whose result is then saved as a .pvidx.  The
+// whole index lives in PSRAM, so clip length is bounded only by the heap.
+
+#define PVIDX_MAGIC  0x58495650u  // "PVIX"
+#define PVIDX_FORMAT 2
+
+// On-disk index, followed by frame_count video then audio_count audio
+// frame_index_entry_t.
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t reserved;
+    sdcard_file_id_t src;
+    uint32_t movi_offset;
+    uint32_t frame_count;
+    uint32_t audio_count;
+} pvidx_file_t;
+
+#define IDX1_BLOCK 4096  // bytes of idx1 read at a time (256 entries)
 
-    priv->frame_index = (frame_index_entry_t *)umm_malloc(
-        priv->frame_index_capacity * sizeof(frame_index_entry_t));
-    if (!priv->frame_index) {
+enum { CHUNK_OTHER, CHUNK_VIDEO, CHUNK_AUDIO };
+
+static int chunk_kind(const uint8_t *id) {
+    if (id[2] == 'd' && (id[3] == 'b' || id[3] == 'c')) return CHUNK_VIDEO;
+    if (id[0] == '0' && id[1] == '1' && id[2] == 'w' && id[3] == 'b') return CHUNK_AUDIO;
+    return CHUNK_OTHER;
+}
+
+static bool index_reserve(frame_index_entry_t **index, uint32_t *capacity,
+                          uint32_t entries) {
+    if (entries <= *capacity)
+        return true;
+    uint32_t cap = *capacity ? *capacity + *capacity / 2 : 256;
+    if (cap < entries)
+        cap = entries;
+    frame_index_entry_t *grown = (frame_index_entry_t *)umm_realloc(
+        *index, cap * sizeof(frame_index_entry_t));
+    if (!grown)
         return false;
-    }
+    *index = grown;
+    *capacity = cap;
+    return true;
+}
 
-    // Allocate audio index if audio stream present
-    if (priv->has_audio) {
-        priv->audio_index_capacity = priv->frame_index_capacity;
-        priv->audio_index = (frame_index_entry_t *)umm_malloc(
-            priv->audio_index_capacity * sizeof(frame_index_entry_t));
-        // Non-fatal if alloc fails — video still works without audio
-        if (!priv->audio_index) {
+static bool index_add(video_priv_t *priv, int kind, uint32_t chunk_pos,
+                      uint32_t size) {
+    if (kind == CHUNK_VIDEO) {
+        if (!index_reserve(&priv->frame_index, &priv->frame_index_capacity,
+                           priv->frame_index_count + 1))
+            return false;
+        priv->frame_index[priv->frame_index_count].file_offset = chunk_pos;
+        priv->frame_index[priv->frame_index_count].chunk_size = size;
+        priv->frame_index_count++;
+    } else if (kind == CHUNK_AUDIO && priv->has_audio) {
+        // Non-fatal if this fails — video still works without audio
+        if (!index_reserve(&priv->audio_index, &priv->audio_index_capacity,
+                           priv->audio_index_count + 1)) {
             printf("[VIDEO] Warning: could not allocate audio index\n");
             priv->has_audio = false;
+            return true;
         }
+        priv->audio_index[priv->audio_index_count].file_offset = chunk_pos;
+        priv->audio_index[priv->audio_index_count].chunk_size = size;
+        priv->audio_index_count++;
     }
+    return true;
+}
 
-    uint32_t saved_pos = sdcard_ftell(priv->file);
-    sdcard_fseek(priv->file, priv->movi_offset);
+static void index_free(video_priv_t *priv) {
+    if (priv->frame_index) umm_free(priv->frame_index);
+    if (priv->audio_index) umm_free(priv->audio_index);
+    priv->frame_index = NULL;
+    priv->audio_index = NULL;
+    priv->frame_index_count = priv->frame_index_capacity = 0;
+    priv->audio_index_count = priv->audio_index_capacity = 0;
+}
 
-    uint32_t frame_num = 0;
-    uint32_t audio_num = 0;
-    uint8_t chunk[8];
+static bool index_load_cache(video_priv_t *priv, const char *cache_path,
+                             const sdcard_file_id_t *src) {
+    sdfile_t f = sdcard_fopen(cache_path, "rb");
+    if (!f)
+        return false;
 
-    while (sdcard_fread(priv->file, chunk, 8) == 8 && frame_num < priv->frame_index_capacity) {
-        uint32_t chunk_pos = sdcard_ftell(priv->file) - 8;
-        uint32_t size = *(uint32_t *)(chunk + 4);
-        uint32_t next_pos = sdcard_ftell(priv->file) + size;
-        if (next_pos & 1) next_pos++;
-
-        if (chunk[2] == 'd' && (chunk[3] == 'b' || chunk[3] == 'c')) {
-            priv->frame_index[frame_num].file_offset = chunk_pos;
-            priv->frame_index[frame_num].chunk_size = size;
-            frame_num++;
-            if (frame_num % 100 == 0) watchdog_update();
-        } else if (priv->has_audio && priv->audio_index &&
-                   chunk[0] == '0' && chunk[1] == '1' &&
-                   chunk[2] == 'w' && chunk[3] == 'b' &&
-                   audio_num < priv->audio_index_capacity) {
-            priv->audio_index[audio_num].file_offset = chunk_pos;
-            priv->audio_index[audio_num].chunk_size = size;
-            audio_num++;
+    pvidx_file_t hdr;
+    bool ok = sdcard_fread(f, &hdr, sizeof(hdr)) == (int)sizeof(hdr) &&
+              hdr.magic == PVIDX_MAGIC && hdr.format == PVIDX_FORMAT &&
+              sdcard_file_id_equal(&hdr.src, src) &&
+              hdr.movi_offset == priv->movi_offset && hdr.frame_count > 0 &&
+              sdcard_fsize_handle(f) == (int)(sizeof(hdr) +
+                  (hdr.frame_count + hdr.audio_count) * sizeof(frame_index_entry_t));
+    if (ok) {
+        int vbytes = (int)(hdr.frame_count * sizeof(frame_index_entry_t));
+        int abytes = (int)(hdr.audio_count * sizeof(frame_index_entry_t));
+        ok = index_reserve(&priv->frame_index, &priv->frame_index_capacity,
+                           hdr.frame_count) &&
+             sdcard_fread(f, priv->frame_index, vbytes) == vbytes;
+        if (ok) priv->frame_index_count = hdr.frame_count;
+        if (ok && priv->has_audio && hdr.audio_count) {
+            if (index_reserve(&priv->audio_index, &priv->audio_index_capacity,
+                              hdr.audio_count) &&
+                sdcard_fread(f, priv->audio_index, abytes) == abytes)
+                priv->audio_index_count = hdr.audio_count;
         }
-        sdcard_fseek(priv->file, next_pos);
     }
+    sdcard_fclose(f);
+    if (!ok) {
+        printf("[VIDEO] Stale or unreadable index %s\n", cache_path);
+        index_free(priv);
+    }
+    return ok;
+}
 
-    priv->frame_index_count = frame_num;
-    priv->audio_index_count = audio_num;
-    sdcard_fseek(priv->file, saved_pos);
+static void index_store_cache(const video_priv_t *priv, const char *cache_path,
+                              const sdcard_file_id_t *src) {
+    pvidx_file_t hdr = {};
+    hdr.magic = PVIDX_MAGIC;
+    hdr.format = PVIDX_FORMAT;
+    hdr.src = *src;
+    hdr.movi_offset = priv->movi_offset;
+    hdr.frame_count = priv->frame_index_count;
+    hdr.audio_count = priv->has_audio ? priv->audio_index_count : 0;
+    sdcard_part_t parts[] = {
+        {&hdr, sizeof(hdr)},
+        {priv->frame_index, (uint32_t)(hdr.frame_count * sizeof(frame_index_entry_t))},
+        {priv->audio_index, (uint32_t)(hdr.audio_count * sizeof(frame_index_entry_t))},
+    };
+    sdcard_write_file_atomic(cache_path, parts, 3);
+}
+
+// idx1 follows the movi LIST.  Its offsets point at chunk headers, counted
+// from the 'movi' fourcc in most writers but from the file start in some;
+// the first video entry tells which.
+static bool index_from_idx1(video_priv_t *priv) {
+    uint32_t pos = priv->movi_offset + priv->movi_size;
+    if (pos & 1) pos++;
+    uint8_t chunk[8];
+    if (!sdcard_fseek(priv->file, pos) || sdcard_fread(priv->file, chunk, 8) != 8 ||
+        memcmp(chunk, "idx1", 4) != 0)
+        return false;
+    uint32_t entries = *(uint32_t *)(chunk + 4) / 16;
+    if (entries == 0)
+        return false;
+
+    uint8_t *block = (uint8_t *)umm_malloc(IDX1_BLOCK);
+    if (!block)
+        return false;
 
-    if (priv->has_audio && audio_num > 0) {
-        printf("[VIDEO] Audio index: %u chunks\n", (unsigned)audio_num);
+    uint32_t base = 0;
+    bool base_known = false;
+    bool ok = true;
+    uint32_t done = 0;
+    while (ok && done < entries) {
+        uint32_t n = entries - done;
+        if (n > IDX1_BLOCK / 16) n = IDX1_BLOCK / 16;
+        sdcard_fseek(priv->file, pos + 8 + done * 16);
+        if (sdcard_fread(priv->file, block, (int)(n * 16)) != (int)(n * 16)) {
+            ok = false;
+            break;
+        }
+        for (uint32_t i = 0; i < n && ok; i++) {
+            const uint8_t *e = block + i * 16;
+            int kind = chunk_kind(e);
+            if (kind == CHUNK_OTHER) continue;
+            uint32_t offset = *(const uint32_t *)(e + 8);
+            uint32_t size = *(const uint32_t *)(e + 12);
+            if (!base_known) {
+                // Relative to 'movi' if the chunk id is found there
+                uint8_t id[4];
+                uint32_t rel = priv->movi_offset - 4;
+                sdcard_fseek(priv->file, rel + offset);
+                if (sdcard_fread(priv->file, id, 4) == 4 && memcmp(id, e, 4) == 0) {
+                    base = rel;
+                } else {
+                    sdcard_fseek(priv->file, offset);
+                    if (sdcard_fread(priv->file, id, 4) != 4 || memcmp(id, e, 4) != 0) {
+                        ok = false;
+                        break;
+                    }
+                }
+                base_known = true;
+            }
+            ok = index_add(priv, kind, base + offset, size);
+        }
+        done += n;
+        watchdog_update();
     }
+    umm_free(block);
 
+    if (!ok || priv->frame_index_count == 0) {
+        index_free(priv);
+        return false;
+    }
     return true;
 }
 
-#define RA_BUFFER_SIZE  (1024 * 1024)  // 1MB
-#define RA_MAX_FRAMES   256
+// Last resort: one seek and 8-byte read per chunk in movi.
+static bool index_from_chunks(video_priv_t *priv) {
+    uint32_t end = priv->movi_offset + priv->movi_size;
+    uint32_t pos = priv->movi_offset;
+    uint8_t chunk[8];
 
-// Bulk-read consecutive frames from SD into the QMI PSRAM ring buffer.
-static void ra_fill_from(video_priv_t *priv, uint32_t start_frame, uint32_t max_frames) {
-    if (!priv->ra_buffer || !priv->ra_frames || !priv->frame_index) return;
+    while (pos + 8 <= end && sdcard_fseek(priv->file, pos) &&
+           sdcard_fread(priv->file, chunk, 8) == 8) {
+        uint32_t size = *(uint32_t *)(chunk + 4);
+        if (memcmp(chunk, "LIST", 4) == 0) {
+            pos += 12;  // descend into 'rec ' lists
+            continue;
+        }
+        if (!index_add(priv, chunk_kind(chunk), pos, size)) {
+            index_free(priv);
+            return false;
+        }
+        if (priv->frame_index_count % 100 == 0) watchdog_update();
+        pos += 8 + size;
+        if (pos & 1) pos++;
+    }
+    return priv->frame_index_count > 0;
+}
 
+// Build a complete frame index (one entry per frame) for O(1) seeking
+// and instant skip-to-target in the update loop.
+static bool build_frame_index(video_priv_t *priv, const char *path) {
     uint64_t t_start = time_us_64();
-    uint32_t offset = 0;
-    uint32_t count = 0;
     uint32_t saved_pos = sdcard_ftell(priv->file);
+    const char *source = NULL;
+
+    char cache_path[VIDEO_INDEX_PATH_MAX];
+    sdcard_file_id_t src;
+    bool cacheable = sdcard_cache_path(VIDEO_INDEX_CACHE_SUBDIR, path, ".pvidx",
+                                       cache_path, sizeof(cache_path)) &&
+                     sdcard_file_id(path, &src);
+
+    if (cacheable && index_load_cache(priv, cache_path, &src)) {
+        source = "cache";
+    } else if (index_from_idx1(priv)) {
+        source = "idx1";
+    } else if (index_from_chunks(priv)) {
+        source = "chunks";
+        if (cacheable) index_store_cache(priv, cache_path, &src);
+    }
+    sdcard_fseek(priv->file, saved_pos);
 
-    priv->ra_first_frame = start_frame;
-    priv->ra_frame_count = 0;
+    if (!source)
+        return false;
+    printf("[VIDEO] Index from %s: %u frames, %u audio chunks in %ums\n", source,
+           (unsigned)priv->frame_index_count, (unsigned)priv->audio_index_count,
+           (unsigned)((time_us_64() - t_start) / 1000));
+    return true;
+}
+
+#define RA_BUFFER_SIZE  (1024 * 1024)  // 1MB
+#define RA_MAX_FRAMES   256
+#define RA_LOW_FRAMES   24              // start topping up below this many
+#define RA_PRIME_FRAMES 8               // read before play/seek returns
+#define RA_READ_MAX     (32 * 1024)     // longest single read while playing
+
+// The player whose ring Core 1 keeps topped up; set and cleared under
+// g_sdcard_mutex.
+static video_priv_t *volatile s_stream_priv;
+
+// Publish the frames of the read in flight once it has landed.
+static bool ra_fill_land(video_priv_t *priv) {
+    int n = sdcard_async_wait(priv->ra_token);
+    priv->ra_token = 0;
+    if (n != (int)priv->ra_read_len) {
+        priv->ra_filling = false;
+        return false;
+    }
+    uint32_t pos = priv->ra_read_pos;
+    uint32_t start = priv->frame_index[priv->ra_read_first].file_offset + 8;
+    for (uint32_t i = priv->ra_read_first; i <= priv->ra_read_last; i++) {
+        ra_frame_entry_t *r = &priv->ra_frames[i % RA_MAX_FRAMES];
+        r->ra_offset = pos + (priv->frame_index[i].file_offset + 8 - start);
+        r->size = priv->frame_index[i].chunk_size;
+    }
+    priv->ra_head = pos + priv->ra_read_len;
+    __dmb();  // data and entries visible before the frames are published
+    priv->ra_end_frame = priv->ra_read_last + 1;
+    return true;
+}
 
-    for (uint32_t i = start_frame; i < priv->frame_index_count && count < max_frames; i++) {
-        uint32_t size = priv->frame_index[i].chunk_size;
-        if (offset + size > priv->ra_capacity) break;
+// Drop the read in flight, e.g. before the ring is emptied or freed.
+// Caller holds g_sdcard_mutex.
+static void ra_fill_cancel(video_priv_t *priv) {
+    if (!priv->ra_token) return;
+    sdcard_async_cancel(priv->ra_token);
+    priv->ra_token = 0;
+}
 
-        uint32_t file_pos = priv->frame_index[i].file_offset + 8; // skip chunk header
-        sdcard_fseek(priv->file, file_pos);
-        sdcard_fread(priv->file, priv->ra_buffer + offset, size);
+// One read of consecutive frames into the ring: the frames are read as a
+// single span of the file (audio chunks between them included), placed
+// contiguously so each JPEG can be decoded in place, wrapping to the start
+// of the ring rather than splitting a span.  Tops up from below
+// RA_LOW_FRAMES until the ring is full.  The span streams in by DMA: unless
+// told to wait, a step only starts it and a later step publishes it, so
+// Core 1 gets on with audio in between.  Caller holds g_sdcard_mutex.
+// Returns false when there was nothing to do.
+static bool ra_fill_step(video_priv_t *priv, uint32_t max_read, bool wait) {
+    if (priv->ra_token) {
+        if (!wait && !sdcard_async_done(priv->ra_token))
+            return true;
+        return ra_fill_land(priv);
+    }
 
-        priv->ra_frames[count].ra_offset = offset;
-        priv->ra_frames[count].size = size;
-        priv->ra_frames[count].valid = true;
+    uint32_t first = priv->ra_first_frame;
+    uint32_t end = priv->ra_end_frame;
+    if (first > end) {
+        // Core 0 has moved past everything buffered: start again from there
+        end = first;
+        priv->ra_head = 0;
+        __dmb();
+        priv->ra_end_frame = end;
+    }
 
-        offset += size;
-        count++;
-        if (count % 20 == 0) watchdog_update();
+    uint32_t buffered = end - first;
+    if (end >= priv->frame_index_count || buffered >= RA_MAX_FRAMES - 1) {
+        priv->ra_filling = false;
+        return false;
     }
+    if (!priv->ra_filling && buffered >= RA_LOW_FRAMES)
+        return false;
 
-    priv->ra_frame_count = count;
-    sdcard_fseek(priv->file, saved_pos);
+    // Coalesce frames while the span stays within max_read (at least one)
+    uint32_t start = priv->frame_index[end].file_offset + 8;
+    uint32_t span_end = start + priv->frame_index[end].chunk_size;
+    uint32_t last = end;
+    while (last + 1 < priv->frame_index_count &&
+           last + 1 - first < RA_MAX_FRAMES - 1) {
+        const frame_index_entry_t *e = &priv->frame_index[last + 1];
+        uint32_t next_end = e->file_offset + 8 + e->chunk_size;
+        if (next_end - start > max_read) break;
+        span_end = next_end;
+        last++;
+    }
+    uint32_t len = span_end - start;
+
+    // Room for it in one piece, behind the oldest frame still wanted
+    uint32_t head = buffered ? priv->ra_head : 0;
+    uint32_t tail = buffered ? priv->ra_frames[first % RA_MAX_FRAMES].ra_offset : 0;
+    uint32_t pos;
+    if (!buffered || head > tail) {
+        if (priv->ra_capacity - head >= len) pos = head;
+        else if (buffered && tail >= len) pos = 0;
+        else if (!buffered && priv->ra_capacity >= len) pos = 0;
+        else pos = UINT32_MAX;
+    } else {
+        pos = (tail - head >= len) ? head : UINT32_MAX;
+    }
+    if (pos == UINT32_MAX) {
+        priv->ra_filling = false;  // full: wait for the low watermark again
+        return false;
+    }
+    priv->ra_filling = true;
+
+    sdcard_async_t token = -1;
+    if (sdcard_fseek(priv->ra_file, start))
+        token = sdcard_read_async(priv->ra_file, priv->ra_buffer + pos, (int)len);
+    if (token <= 0) {
+        priv->ra_filling = false;
+        return false;
+    }
+    priv->ra_token = token;
+    priv->ra_read_first = end;
+    priv->ra_read_last = last;
+    priv->ra_read_pos = pos;
+    priv->ra_read_len = len;
+    return wait ? ra_fill_land(priv) : true;
+}
+
+// Empty the ring so it refills from frame, and read the first few frames
+// now.  Core 0, before the clock starts (play, seek).
+static void ra_restart(video_priv_t *priv, uint32_t frame) {
+    if (!priv->ra_buffer || !priv->frame_index) return;
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    ra_fill_cancel(priv);
+    priv->ra_first_frame = frame;
+    priv->ra_end_frame = frame;
+    priv->ra_head = 0;
+    priv->ra_filling = false;
+    while (priv->ra_end_frame - priv->ra_first_frame < RA_PRIME_FRAMES &&
+           ra_fill_step(priv, RA_READ_MAX, true))
+        ;
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
 
-    uint64_t elapsed_ms = (time_us_64() - t_start) / 1000;
-    printf("[VIDEO] Read-ahead: %u frames (%uKB) in %ums\n",
-           (unsigned)count, (unsigned)(offset / 1024), (unsigned)elapsed_ms);
+static void ra_stream_start(video_priv_t *priv) {
+    if (!priv->ra_buffer || !priv->frame_index) return;
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    s_stream_priv = priv;
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
+static void ra_stream_stop(video_priv_t *priv) {
+    recursive_mutex_enter_blocking(&g_sdcard_mutex);
+    if (s_stream_priv == priv) s_stream_priv = NULL;
+    ra_fill_cancel(priv);  // the ring may be freed next
+    recursive_mutex_exit(&g_sdcard_mutex);
+}
+
+void video_player_stream_poll(void) {
+    if (!s_stream_priv) return;
+    // Non-blocking: skip if Core 0 owns the SD card
+    if (!recursive_mutex_try_enter(&g_sdcard_mutex, NULL)) return;
+    video_priv_t *priv = s_stream_priv;
+    if (priv) ra_fill_step(priv, RA_READ_MAX, false);
+    recursive_mutex_exit(&g_sdcard_mutex);
 }
 
 // Flush any deferred frame to the display.
@@ -361,8 +933,10 @@ void video_player_destroy(video_player_t *player) {
             priv->audio_active = false;
         }
         flush_pending(priv);
+        ra_stream_stop(priv);
         video_restore_clock(priv);
         if (priv->file) sdcard_fclose(priv->file);
+        if (priv->ra_file) sdcard_fclose(priv->ra_file);
         buffer_pool_cleanup(priv);
         if (priv->frame_index) umm_free(priv->frame_index);
         if (priv->audio_index) umm_free(priv->audio_index);
@@ -377,18 +951,16 @@ void video_player_destroy(video_player_t *player) {
 bool video_player_load(video_player_t *player, const char *path) {
     video_priv_t *priv = (video_priv_t *)player->priv;
 
+    ra_stream_stop(priv);
     if (priv->file) {
         sdcard_fclose(priv->file);
         priv->file = NULL;
     }
-    if (priv->frame_index) {
-        umm_free(priv->frame_index);
-        priv->frame_index = NULL;
-    }
-    if (priv->audio_index) {
-        umm_free(priv->audio_index);
-        priv->audio_index = NULL;
+    if (priv->ra_file) {
+        sdcard_fclose(priv->ra_file);
+        priv->ra_file = NULL;
     }
+    index_free(priv);
     if (priv->audio_active) {
         mp3_player_stop_fed();
         priv->audio_active = false;
@@ -521,24 +1093,35 @@ bool video_player_load(video_player_t *player, const char *path) {
     priv->consecutive_drops = 0;
     priv->adaptive_stride = 1;
     priv->pending_flush = false;
+    priv->split_mode = 0;
+    memset(&priv->stats, 0, sizeof(priv->stats));
 
-    if (!build_frame_index(priv, player)) {
+    if (!build_frame_index(priv, path)) {
         printf("[VIDEO] Warning: could not build frame index, seeking will be slow\n");
     }
 
-    // Allocate read-ahead buffer in QMI PSRAM
-    priv->ra_buffer = (uint8_t *)umm_malloc(RA_BUFFER_SIZE);
-    if (priv->ra_buffer) {
-        priv->ra_capacity = RA_BUFFER_SIZE;
+    // Allocate read-ahead buffer in QMI PSRAM (kept across loads)
+    if (!priv->ra_buffer) {
+        priv->ra_buffer = (uint8_t *)umm_malloc(RA_BUFFER_SIZE);
         priv->ra_frames = (ra_frame_entry_t *)umm_malloc(RA_MAX_FRAMES * sizeof(ra_frame_entry_t));
-        if (!priv->ra_frames) {
-            umm_free(priv->ra_buffer);
+        if (!priv->ra_buffer || !priv->ra_frames) {
+            if (priv->ra_buffer) umm_free(priv->ra_buffer);
+            if (priv->ra_frames) umm_free(priv->ra_frames);
             priv->ra_buffer = NULL;
-        } else {
-            ra_fill_from(priv, 0, RA_MAX_FRAMES);
+            priv->ra_frames = NULL;
         }
+        priv->ra_capacity = priv->ra_buffer ? RA_BUFFER_SIZE : 0;
     }
-    if (!priv->ra_buffer) {
+    if (priv->ra_buffer && !(priv->ra_file = sdcard_fopen(path, "rb"))) {
+        umm_free(priv->ra_buffer);
+        umm_free(priv->ra_frames);
+        priv->ra_buffer = NULL;
+        priv->ra_frames = NULL;
+        priv->ra_capacity = 0;
+    }
+    if (priv->ra_buffer) {
+        ra_restart(priv, 0);
+    } else {
         printf("[VIDEO] Read-ahead: allocation failed, continuing without cache\n");
     }
 
@@ -599,6 +1182,12 @@ void video_player_play(video_player_t *player) {
     player->playing = true;
     player->paused = false;
 
+    // Core 1 keeps the read-ahead ring topped up from here on
+    if (player->current_frame < priv->ra_first_frame ||
+        player->current_frame >= priv->ra_end_frame)
+        ra_restart(priv, player->current_frame);
+    ra_stream_start(priv);
+
     // Start audio if available (before capturing start_time_us so the clock
     // starts only after audio DMA is queued, keeping A/V in sync from frame 0)
     if (priv->has_audio && priv->audio_format == 0x0055 && !priv->audio_muted) {
@@ -618,6 +1207,7 @@ void video_player_play(video_player_t *player) {
 void video_player_stop(video_player_t *player) {
     video_priv_t *priv = (video_priv_t *)player->priv;
     flush_pending(priv);
+    ra_stream_stop(priv);
     if (priv->audio_active) {
         mp3_player_stop_fed();
         priv->audio_active = false;
@@ -631,7 +1221,7 @@ void video_player_pause(video_player_t *player) {
     flush_pending(priv);
     player->paused = true;
     if (priv->audio_active) {
-        mp3_player_pause(mp3_player_create());
+        mp3_player_pause(mp3_player_fed());
     }
 }
 
@@ -639,9 +1229,9 @@ void video_player_resume(video_player_t *player) {
     player->paused = false;
     video_priv_t *priv = (video_priv_t *)player->priv;
     if (priv->audio_active) {
-        mp3_player_t *mp3 = mp3_player_create();
-        if (mp3_player_is_playing(mp3)) {
-            // Already playing (e.g. seek restarted DMA while paused)
+        mp3_player_t *mp3 = mp3_player_fed();
+        if (!mp3 || mp3_player_is_playing(mp3)) {
+            // No fed stream, or already playing (e.g. seek restarted DMA while paused)
         } else if (mp3->playing && mp3->paused) {
             // Normal resume from pause
             mp3_player_resume(mp3);
@@ -661,16 +1251,14 @@ static bool decode_frame_at(video_player_t *player, video_priv_t *priv,
     bool from_cache = false;
 
     // Check read-ahead buffer
-    if (priv->ra_buffer && priv->ra_frame_count > 0
-        && target_frame >= priv->ra_first_frame
-        && target_frame < priv->ra_first_frame + priv->ra_frame_count) {
-        uint32_t idx = target_frame - priv->ra_first_frame;
-        if (priv->ra_frames[idx].valid) {
-            jpeg_buf = priv->ra_buffer + priv->ra_frames[idx].ra_offset;
-            size = priv->ra_frames[idx].size;
-            from_cache = true;
-            priv->ra_hits++;
-        }
+    if (priv->ra_buffer && target_frame >= priv->ra_first_frame
+        && target_frame < priv->ra_end_frame) {
+        __dmb();  // pairs with Core 1 publishing ra_end_frame
+        const ra_frame_entry_t *r = &priv->ra_frames[target_frame % RA_MAX_FRAMES];
+        jpeg_buf = priv->ra_buffer + r->ra_offset;
+        size = r->size;
+        from_cache = true;
+        priv->ra_hits++;
     }
 
     // Fallback: read from SD
@@ -699,13 +1287,30 @@ static bool decode_frame_at(video_player_t *player, video_priv_t *priv,
     uint64_t t_flush_wait = time_us_64();
 
     bool success = false;
+    bool split = false;
     bool use_adaptive = (priv->adaptive_stride > 1);
 
     JPEG_DRAW_CALLBACK *draw_cb = use_adaptive ? jpeg_draw_cb_2x : jpeg_draw_cb;
 
     uint64_t t_open_start = time_us_64();
-    if (priv->jpeg->openRAM(jpeg_buf, (int)size, draw_cb)) {
-        uint64_t t_setup_start = time_us_64();
+    uint64_t t_setup_start = t_open_start;
+    uint64_t t_dec_end = t_open_start;
+
+    // Step 6: Full-width frames with restart markers are decoded as two
+    // slices, the bottom one on Core 1.
+    if (!use_adaptive && priv->split_mode >= 0 &&
+        player->width == 320 && player->height <= 320) {
+        uint16_t *back_buf = display_get_back_buffer();
+        int y = (320 - (int)player->height) / 2;
+        split = decode_frame_split(priv, jpeg_buf, size, back_buf + y * FB_WIDTH);
+        if (split) {
+            t_dec_end = time_us_64();
+            success = true;
+        }
+    }
+
+    if (!split && priv->jpeg->openRAM(jpeg_buf, (int)size, draw_cb)) {
+        t_setup_start = time_us_64();
         priv->jpeg->setPixelType(RGB565_BIG_ENDIAN);
         int vw = priv->jpeg->getWidth();
         int vh = priv->jpeg->getHeight();
@@ -749,15 +1354,23 @@ static bool decode_frame_at(video_player_t *player, video_priv_t *priv,
             priv->jpeg->decode(x, y, scale);
         }
 
-        uint64_t t_dec_end = time_us_64();
+        t_dec_end = time_us_64();
         priv->jpeg->close();
-        uint64_t t_close = time_us_64();
+        priv->stats.core0_us += (uint32_t)(time_us_64() - t_open_start);
         success = true;
+    }
+
+    if (success) {
+        uint64_t t_close = time_us_64();
+
+        priv->stats.frames++;
+        priv->stats.read_us += (uint32_t)(t_sd_end - t_sd_start);
+        priv->stats.flush_wait_us += (uint32_t)(t_flush_wait - t_sd_end);
 
         // Print timing every 30 frames — split decode into open (header/Huffman parse)
         // vs decode (IDCT + pixel conversion) to identify the hot spot.
         if (player->current_frame % 30 == 0) {
-            printf("[VIDEO] f=%u sd=%ums flush=%ums open=%ums dec=%ums close=%ums total=%ums stride=%u src=%s ra=%u/%u\n",
+            printf("[VIDEO] f=%u sd=%ums flush=%ums open=%ums dec=%ums close=%ums total=%ums stride=%u src=%s ra=%u/%u split=%u/%u\n",
                    (unsigned)player->current_frame,
                    (unsigned)((t_sd_end - t_sd_start) / 1000),
                    (unsigned)((t_flush_wait - t_sd_end) / 1000),
@@ -768,7 +1381,9 @@ static bool decode_frame_at(video_player_t *player, video_priv_t *priv,
                    (unsigned)priv->adaptive_stride,
                    from_cache ? "cache" : "sd",
                    (unsigned)priv->ra_hits,
-                   (unsigned)(priv->ra_hits + priv->ra_misses));
+                   (unsigned)(priv->ra_hits + priv->ra_misses),
+                   (unsigned)priv->stats.split_frames,
+                   (unsigned)priv->stats.frames);
         }
 
         // Defer the flush — it will be issued at the start of the next
@@ -786,6 +1401,13 @@ static bool decode_frame_at(video_player_t *player, video_priv_t *priv,
     if (!from_cache) {
         buffer_pool_release(priv, jpeg_buf);
     }
+
+    // Done with this frame and everything before it: Core 1 may reuse the
+    // space (or, after a miss, restart the ring from the next frame).
+    if (priv->ra_buffer && target_frame >= priv->ra_first_frame) {
+        __dmb();
+        priv->ra_first_frame = target_frame + 1;
+    }
     return success;
 }
 
@@ -835,7 +1457,9 @@ bool video_player_update(video_player_t *player) {
     int32_t frames_behind = (int32_t)(target_frame - player->current_frame);
     if (frames_behind > 3) {
         priv->consecutive_drops++;
-        if (priv->consecutive_drops > 2 && priv->adaptive_stride < 4) {
+        // Split-decoded videos stay at full resolution and drop frames instead.
+        if (priv->consecutive_drops > 2 && priv->adaptive_stride < 4 &&
+            priv->split_mode <= 0) {
             priv->adaptive_stride++;
             printf("[VIDEO] Increasing stride to %u (behind by %d)\n",
                    (unsigned)priv->adaptive_stride, (int)frames_behind);
@@ -944,7 +1568,7 @@ void video_player_seek(video_player_t *player, uint32_t frame) {
 
     priv->adaptive_stride = 1;
     priv->consecutive_drops = 0;
-    priv->ra_frame_count = 0;  // invalidate read-ahead on seek
+    ra_restart(priv, player->current_frame);
 
     // Reposition audio: flush and restart the fed ring from the proportional
     // audio chunk for the target frame.  Do this before capturing start_time_us
@@ -988,6 +1612,12 @@ void video_player_reset_stats(video_player_t *player) {
     priv->dropped_frames = 0;
     priv->consecutive_drops = 0;
     priv->adaptive_stride = 1;
+    memset(&priv->stats, 0, sizeof(priv->stats));
+}
+
+void video_player_get_stats(video_player_t *player, video_stats_t *stats) {
+    video_priv_t *priv = (video_priv_t *)player->priv;
+    *stats = priv->stats;
 }
 
 bool video_player_has_audio(video_player_t *player) {
@@ -1000,7 +1630,7 @@ void video_player_set_audio_volume(video_player_t *player, uint8_t volume) {
     if (!player || !player->priv) return;
     video_priv_t *priv = (video_priv_t *)player->priv;
     if (priv->audio_active) {
-        mp3_player_set_volume(mp3_player_create(), volume);
+        mp3_player_set_volume(mp3_player_fed(), volume);
     }
 }
 
@@ -1008,7 +1638,7 @@ uint8_t video_player_get_audio_volume(video_player_t *player) {
     if (!player || !player->priv) return 0;
     video_priv_t *priv = (video_priv_t *)player->priv;
     if (priv->audio_active) {
-        return mp3_player_get_volume(mp3_player_create());
+        return mp3_player_get_volume(mp3_player_fed());
     }
     return 100;  // default
 }
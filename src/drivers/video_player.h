@@ -7,9 +7,13 @@
 extern "C" {
 #endif
 
-#define VIDEO_MAX_FRAME_INDEX 8192
 #define VIDEO_FRAME_INDEX_STRIDE 1
 
+// Frame indexes built by walking an AVI without idx1 are saved here, under
+// SDCARD_CACHE_DIR
+#define VIDEO_INDEX_CACHE_SUBDIR "video"
+#define VIDEO_INDEX_PATH_MAX     192
+
 #define VIDEO_BUFFER_POOL_SIZE 3
 #define VIDEO_MAX_JPEG_SIZE (96 * 1024)
 
@@ -32,6 +36,18 @@ typedef struct {
     void *priv;
 } video_player_t;
 
+// Per-stage timing totals since load or video_player_reset_stats(), in
+// microseconds.
+typedef struct {
+    uint32_t frames;         // frames decoded
+    uint32_t split_frames;   // of which split across both cores
+    uint32_t read_us;        // SD reads (read-ahead misses)
+    uint32_t flush_wait_us;  // waiting for the previous frame's display DMA
+    uint32_t core0_us;       // decoding on Core 0 (whole frames, top slices)
+    uint32_t core1_us;       // decoding bottom slices on Core 1
+    uint32_t sync_us;        // Core 0 waiting for Core 1 to finish its slice
+} video_stats_t;
+
 bool video_player_init(void);
 video_player_t *video_player_create(void);
 void video_player_destroy(video_player_t *player);
@@ -48,6 +64,13 @@ float video_player_get_fps(video_player_t *player);
 
 uint32_t video_player_get_dropped_frames(video_player_t *player);
 void video_player_reset_stats(video_player_t *player);
+void video_player_get_stats(video_player_t *player, video_stats_t *stats);
+
+// Core 1 tick: decodes the bottom slice of a split frame, if one is posted.
+void video_player_core1_poll(void);
+
+// Core 1 tick: tops up the playing video's read-ahead ring.
+void video_player_stream_poll(void);
 
 bool video_player_has_audio(video_player_t *player);
 void video_player_set_audio_volume(video_player_t *player, uint8_t volume);
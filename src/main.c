@@ -189,6 +189,7 @@ void __attribute__((naked)) isr_hardfault(void) {
 
 #include "drivers/audio.h"
 #include "drivers/fileplayer.h"
+#include "drivers/fs_queue.h"
 #include "drivers/mp3_player.h"
 #include "drivers/pio_psram.h"
 #include "drivers/pio_psram_bulk.h"
@@ -307,6 +308,7 @@ static void sys_poll(void) {
   kbd_poll();
   watchdog_update();
   http_fire_c_pending();
+  fs_queue_dispatch();
   if (kbd_consume_menu_press()) {
     if (system_menu_show_for_native())
       s_native_exit = true;
@@ -437,6 +439,67 @@ static int fs_list_dir(const char *path,
     return sdcard_list_dir(path, fs_list_dir_callback, NULL);
 }
 
+// Async requests carry the app's callback in one of these.  Every one is
+// free whenever the queue is empty, which also covers the requests an app
+// exit drops without a callback.
+typedef void (*fs_async_cb_t)(int id, int result, void *user);
+typedef struct {
+    fs_async_cb_t fn;
+    void *user;
+    bool in_use;
+} fs_async_ctx_t;
+static fs_async_ctx_t s_fs_async[FS_QUEUE_SLOTS];
+
+static fs_async_ctx_t *fs_async_ctx(fs_async_cb_t cb, void *user) {
+    if (fs_queue_pending() == 0)
+        memset(s_fs_async, 0, sizeof(s_fs_async));
+    for (int i = 0; i < FS_QUEUE_SLOTS; i++) {
+        if (s_fs_async[i].in_use) continue;
+        s_fs_async[i].fn = cb;
+        s_fs_async[i].user = user;
+        s_fs_async[i].in_use = true;
+        return &s_fs_async[i];
+    }
+    return NULL;
+}
+
+static void fs_async_done(const fs_result_t *res, void *user) {
+    fs_async_ctx_t *ctx = (fs_async_ctx_t *)user;
+    ctx->in_use = false;
+    if (ctx->fn)
+        ctx->fn(res->id, res->result, ctx->user);
+}
+
+static int fs_read_async(const char *path, uint32_t offset, void *buf, int len,
+                         fs_async_cb_t cb, void *user) {
+    if (!buf || len <= 0) return -1;
+    fs_async_ctx_t *ctx = fs_async_ctx(cb, user);
+    if (!ctx) return -1;
+    int id = fs_queue_read(path, offset, buf, (uint32_t)len, fs_async_done, ctx);
+    if (id < 0)
+        ctx->in_use = false;
+    return id;
+}
+
+static int fs_write_async(const char *path, const void *buf, int len,
+                          bool append, fs_async_cb_t cb, void *user) {
+    if (len < 0) return -1;
+    fs_async_ctx_t *ctx = fs_async_ctx(cb, user);
+    if (!ctx) return -1;
+    int id = fs_queue_write(path, buf, (uint32_t)len, append, false,
+                            fs_async_done, ctx);
+    if (id < 0)
+        ctx->in_use = false;
+    return id;
+}
+
+static bool fs_cancel_async(int id) {
+    void *ctx = NULL;
+    if (!fs_queue_cancel(id, &ctx)) return false;
+    ((fs_async_ctx_t *)ctx)->in_use = false;
+    return true;
+}
+
 static const picocalc_ui_t s_ui_impl = {
     .textInput       = text_input_show,
     .textInputSimple = ui_text_input,
@@ -542,6 +605,9 @@ static picocalc_fs_t s_fs_impl = {
     .seek = fs_seek,
     .tell = fs_tell,
     .listDir = fs_list_dir,
+    .readAsync = fs_read_async,
+    .writeAsync = fs_write_async,
+    .cancelAsync = fs_cancel_async,
 };
 
 // ── HTTP impl ─────────────────────────────────────────────────────────────────
@@ -1098,6 +1164,10 @@ static void core1_entry(void) {
       continue;
     }
 
+    // Bottom half of a split video frame; Core 0 rings the doorbell after
+    // posting it, so check on every wake-up rather than only on ticks.
+    video_player_core1_poll();
+
     if (s_core1_tick_pending) {
       s_core1_tick_pending = false;
 
@@ -1107,6 +1177,9 @@ static void core1_entry(void) {
       audio_stream_poll();
       mp3_player_update();
       fileplayer_update();
+      video_player_stream_poll();
+      sound_poll();
+      fs_queue_poll();
       if (g_native_audio_callback)
         g_native_audio_callback();
     }
@@ -1387,6 +1460,9 @@ int main(void) {
   lua_psram_alloc_init();
   watchdog_update();
 
+  // The SD sector cache lives in the PSRAM heap
+  sdcard_cache_init();
+
   // Write crash log from previous boot (if any) — must be after PSRAM init
   // because sdcard_fopen() uses umm_malloc() for the FIL struct.
   crash_log_save();
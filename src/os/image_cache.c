@@ -0,0 +1,223 @@
+#include "image_cache.h"
+#include "lua_psram_alloc.h"
+#include "../drivers/sdcard.h"
+#include "umm_malloc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Bytes hashed at each end of the file on every lookup.  One sector, so
+// repeat checks are served from the PSRAM sector cache (sd_cache).
+#define IMAGE_CACHE_CHECK_BYTES 512
+
+struct image_cache_entry {
+    image_cache_entry_t *prev, *next;  // towards MRU / LRU
+    uint32_t   hash;
+    int        refs;   // Lua images sharing the pixels
+    int        pins;   // image_cache_retain() count
+    pc_image_t img;
+    size_t     bytes;
+    sdcard_file_id_t src;  // file identity when decoded
+    bool       stale;      // file written through picocalc.fs since
+    char       path[];
+};
+
+static image_cache_entry_t *s_mru, *s_lru;
+static size_t s_bytes;
+static size_t s_max_bytes = IMAGE_CACHE_DEFAULT_BYTES;
+static uint32_t s_entries, s_hits, s_misses, s_evictions;
+
+static uint32_t path_hash(const char *path) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    while (*path)
+        h = (h ^ (uint8_t)*path++) * 16777619u;
+    return h;
+}
+
+static void cache_unlink(image_cache_entry_t *e) {
+    if (e->prev) e->prev->next = e->next; else s_mru = e->next;
+    if (e->next) e->next->prev = e->prev; else s_lru = e->prev;
+}
+
+static void cache_push_mru(image_cache_entry_t *e) {
+    e->prev = NULL;
+    e->next = s_mru;
+    if (s_mru) s_mru->prev = e; else s_lru = e;
+    s_mru = e;
+}
+
+static void cache_free(image_cache_entry_t *e) {
+    cache_unlink(e);
+    s_bytes -= e->bytes;
+    s_entries--;
+    umm_free(e->img.data);
+    umm_free(e);
+}
+
+static image_cache_entry_t *cache_find(const char *path, uint32_t hash) {
+    for (image_cache_entry_t *e = s_mru; e; e = e->next)
+        if (e->hash == hash && strcmp(e->path, path) == 0)
+            return e;
+    return NULL;
+}
+
+void image_cache_trim(bool all) {
+    image_cache_entry_t *e = s_lru;
+    while (e && (all || s_bytes > s_max_bytes)) {
+        image_cache_entry_t *prev = e->prev;
+        if (e->refs == 0 && e->pins == 0) {
+            cache_free(e);
+            s_evictions++;
+        }
+        e = prev;
+    }
+}
+
+// Stops e being found, returning its pins.  Images still using the old
+// pixels keep them; it is freed with the last of those.
+static int cache_forget(image_cache_entry_t *e) {
+    int pins = e->pins;
+    e->hash = 0;
+    e->path[0] = '\0';
+    e->pins = 0;
+    if (e->refs == 0)
+        cache_free(e);
+    return pins;
+}
+
+// Cached entry for path, loading it on a miss; no reference taken.
+static image_cache_entry_t *cache_lookup(const char *path) {
+    // Size, stamp and a hash of the file's ends: FatFS stamps don't change
+    // on-device (FF_FS_NORTC), so a same-size rewrite needs the hash.
+    sdcard_file_id_t src;
+    if (!sdcard_file_id_ends(path, IMAGE_CACHE_CHECK_BYTES, &src))
+        return NULL;
+
+    uint32_t hash = path_hash(path);
+    image_cache_entry_t *e = cache_find(path, hash);
+    int pins = 0;
+    if (e && (e->stale || !sdcard_file_id_equal(&e->src, &src))) {
+        // Rewritten since it was decoded: its pins move to the new entry.
+        pins = cache_forget(e);
+        e = NULL;
+    }
+    if (e) {
+        s_hits++;
+        cache_unlink(e);
+        cache_push_mru(e);
+        return e;
+    }
+
+    s_misses++;
+    if (lua_psram_alloc_is_low())
+        image_cache_trim(true);
+    pc_image_t *img = image_load(path);
+    if (!img && s_lru) {
+        image_cache_trim(true);
+        img = image_load(path);
+    }
+    if (!img)
+        return NULL;
+
+    size_t len = strlen(path);
+    e = (image_cache_entry_t *)umm_malloc(sizeof(*e) + len + 1);
+    if (!e) {
+        image_free(img);
+        return NULL;
+    }
+    memset(e, 0, sizeof(*e));
+    memcpy(e->path, path, len + 1);
+    e->hash = hash;
+    e->pins = pins;
+    e->img = *img;
+    e->bytes = (size_t)img->w * img->h * sizeof(uint16_t);
+    e->src = src;
+    umm_free(img);  // the struct; the pixels now belong to the entry
+
+    cache_push_mru(e);
+    s_bytes += e->bytes;
+    s_entries++;
+    return e;
+}
+
+image_cache_entry_t *image_cache_acquire(const char *path, pc_image_t *img) {
+    if (!path) return NULL;
+    image_cache_entry_t *e = cache_lookup(path);
+    if (!e) return NULL;
+    e->refs++;
+    if (img) *img = e->img;
+    image_cache_trim(false);  // the new image may have pushed us over
+    return e;
+}
+
+void image_cache_unref(image_cache_entry_t *e) {
+    if (!e || e->refs <= 0) return;
+    if (--e->refs > 0) return;
+    if (!e->path[0])
+        cache_free(e);  // superseded by a newer decode of its file
+    else
+        image_cache_trim(lua_psram_alloc_is_low());
+}
+
+bool image_cache_retain(const char *path) {
+    if (!path) return false;
+    image_cache_entry_t *e = cache_lookup(path);
+    if (!e) return false;
+    e->pins++;
+    image_cache_trim(false);
+    return true;
+}
+
+bool image_cache_release(const char *path) {
+    if (!path) return false;
+    image_cache_entry_t *e = cache_find(path, path_hash(path));
+    if (!e || e->pins == 0) return false;
+    if (--e->pins == 0)
+        image_cache_trim(false);
+    return true;
+}
+
+void image_cache_invalidate(const char *path) {
+    if (!path) return;
+    size_t len = strlen(path);
+    while (len > 1 && path[len - 1] == '/')
+        len--;
+    image_cache_entry_t *e = s_mru;
+    while (e) {
+        image_cache_entry_t *next = e->next;
+        if (strncmp(e->path, path, len) == 0 &&
+            (e->path[len] == '\0' || e->path[len] == '/')) {
+            // Pinned entries stay findable, so the next lookup moves the pins.
+            if (e->pins)
+                e->stale = true;
+            else
+                cache_forget(e);
+        }
+        e = next;
+    }
+}
+
+void image_cache_set_max_bytes(size_t bytes) {
+    s_max_bytes = bytes;
+    image_cache_trim(false);
+}
+
+void image_cache_reset(void) {
+    while (s_lru) {
+        if (s_lru->refs)
+            printf("[IMGCACHE] %s still referenced at reset\n", s_lru->path);
+        cache_free(s_lru);
+    }
+    s_max_bytes = IMAGE_CACHE_DEFAULT_BYTES;
+    s_hits = s_misses = s_evictions = 0;
+}
+
+void image_cache_get_stats(image_cache_stats_t *out) {
+    if (!out) return;
+    out->hits = s_hits;
+    out->misses = s_misses;
+    out->evictions = s_evictions;
+    out->entries = s_entries;
+    out->bytes = s_bytes;
+    out->max_bytes = s_max_bytes;
+}
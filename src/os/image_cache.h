@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../drivers/image_api.h"
+
+// =============================================================================
+// Decoded-image cache
+//
+// Path-keyed LRU of decoded images in PSRAM, so loading an asset again (scene
+// switches, re-entering a menu) is a lookup rather than an SD read and a
+// decode.  Images are immutable, so every Lua image loaded from a path shares
+// the entry's pixels and holds a reference to it.
+//
+// Only idle entries (no references, not retained) are ever freed: least
+// recently used first, whenever the cache is over its budget, and all of
+// them when the PSRAM heap runs low.  An entry whose file has changed size,
+// timestamp or the content at either end (sdcard_file_id()), or was written
+// through picocalc.fs, is reloaded.  Core 0 only.
+// =============================================================================
+
+#define IMAGE_CACHE_DEFAULT_BYTES (2u * 1024u * 1024u)
+
+typedef struct image_cache_entry image_cache_entry_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;
+    size_t   bytes;      // pixels held by all entries
+    size_t   max_bytes;
+} image_cache_stats_t;
+
+// The image at path with a reference taken, decoded with image_load() on a
+// miss.  *img receives its size and (shared, read-only) pixels.  NULL if the
+// file cannot be loaded.
+image_cache_entry_t *image_cache_acquire(const char *path, pc_image_t *img);
+void image_cache_unref(image_cache_entry_t *e);
+
+// Pin / unpin path; a pinned entry is never evicted.  Retaining loads the
+// image if it is not cached yet.  Pins nest.
+bool image_cache_retain(const char *path);
+bool image_cache_release(const char *path);
+
+// path (or everything under it, for a directory) was written, renamed or
+// deleted: its next load decodes the file again.
+void image_cache_invalidate(const char *path);
+
+// Budget for the cache; 0 keeps only images still in use.
+void image_cache_set_max_bytes(size_t bytes);
+
+// Frees idle entries until the cache is within budget, or every idle entry
+// with all set (low memory).
+void image_cache_trim(bool all);
+
+// Drops every entry and pin (app exit, after the Lua state is closed).
+void image_cache_reset(void);
+
+void image_cache_get_stats(image_cache_stats_t *out);
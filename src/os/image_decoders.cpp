@@ -376,14 +376,106 @@ bool decode_gif_file(const char *path, image_decode_result_t *result) {
   return false;
 }
 
+// --- Block streaming (regions, scaled loads, tile streams) ---
+
+typedef struct {
+  image_block_cb_t cb;
+  void *user;
+  bool stopped;   // cb asked to stop; the decoder reports that as an error
+  PNG *png;
+  uint16_t *row;  // PNG: one converted row
+} block_ctx_t;
+
+static int jpeg_block_draw(JPEGDRAW *pDraw) {
+  block_ctx_t *ctx = (block_ctx_t *)pDraw->pUser;
+  if (!ctx->cb(ctx->user, pDraw->x, pDraw->y, pDraw->iWidth, pDraw->iHeight,
+               pDraw->pPixels, pDraw->iWidth)) {
+    ctx->stopped = true;
+    return 0;
+  }
+  return 1;
+}
+
+static int png_block_draw(PNGDRAW *pDraw) {
+  block_ctx_t *ctx = (block_ctx_t *)pDraw->pUser;
+  ctx->png->getLineAsRGB565(pDraw, ctx->row, PNG_RGB565_LITTLE_ENDIAN, 0);
+  if (!ctx->cb(ctx->user, 0, pDraw->y, pDraw->iWidth, 1, ctx->row,
+               pDraw->iWidth)) {
+    ctx->stopped = true;
+    return 0;
+  }
+  return 1;
+}
+
+bool decode_jpeg_file_blocks(const char *path, int scale, image_block_cb_t cb,
+                             void *user) {
+  if (!path || !cb)
+    return false;
+
+  int scale_opt = 0;
+  if (scale >= 8)
+    scale_opt = JPEG_SCALE_EIGHTH;
+  else if (scale >= 4)
+    scale_opt = JPEG_SCALE_QUARTER;
+  else if (scale >= 2)
+    scale_opt = JPEG_SCALE_HALF;
+
+  JPEGDEC *jpeg = (JPEGDEC *)umm_malloc(sizeof(JPEGDEC));
+  if (!jpeg)
+    return false;
+
+  block_ctx_t ctx = {cb, user, false, NULL, NULL};
+  bool ok = false;
+  if (jpeg->open(path, my_file_open, my_file_close, my_jpeg_read, my_jpeg_seek,
+                 jpeg_block_draw)) {
+    jpeg->setPixelType(RGB565_LITTLE_ENDIAN);
+    jpeg->setUserPointer(&ctx);
+    ok = jpeg->decode(0, 0, scale_opt) || ctx.stopped;
+    if (!ok)
+      printf("[TGX] JPEG block decode failed with error: %d\n",
+             jpeg->getLastError());
+    jpeg->close();
+  } else {
+    printf("[TGX] JPEG file open failed with error: %d\n",
+           jpeg->getLastError());
+  }
+  umm_free(jpeg);
+  return ok;
+}
+
+bool decode_png_file_blocks(const char *path, image_block_cb_t cb,
+                            void *user) {
+  if (!path || !cb)
+    return false;
+
+  PNG *png = (PNG *)umm_malloc(sizeof(PNG));
+  if (!png)
+    return false;
+
+  block_ctx_t ctx = {cb, user, false, png, NULL};
+  bool ok = false;
+  if (png->open(path, my_file_open, my_file_close, my_png_read, my_png_seek,
+                png_block_draw)) {
+    ctx.row = (uint16_t *)umm_malloc(png->getWidth() * sizeof(uint16_t));
+    if (ctx.row) {
+      ok = png->decode(&ctx, 0) == PNG_SUCCESS || ctx.stopped;
+      umm_free(ctx.row);
+    }
+    png->close();
+  }
+  umm_free(png);
+  return ok;
+}
+
 extern "C" void tgx_draw_image_scaled(uint16_t *dst_fb, int dst_w, int dst_h,
+                                      int dst_stride,
                                       const uint16_t *src_data, int src_w,
                                       int src_h, int dst_x, int dst_y,
                                       float scale, float angle) {
   if (!dst_fb || !src_data)
     return;
 
-  tgx::Image<tgx::RGB565> dst_im(dst_fb, dst_w, dst_h);
+  tgx::Image<tgx::RGB565> dst_im(dst_fb, dst_w, dst_h, dst_stride);
   // Since tgx::Image requires non-const pointer for its constructor, we cast
   // away const. The blitScaledRotated method takes the source image by value or
   // const reference, so it won't modify the source pixels.
@@ -396,6 +488,7 @@ extern "C" void tgx_draw_image_scaled(uint16_t *dst_fb, int dst_w, int dst_h,
 }
 
 extern "C" void tgx_draw_image_scaled_masked(uint16_t *dst_fb, int dst_w, int dst_h,
+                                            int dst_stride,
                                             const uint16_t *src_data, int src_w,
                                             int src_h, int dst_x, int dst_y,
                                             float scale, float angle,
@@ -403,7 +496,7 @@ extern "C" void tgx_draw_image_scaled_masked(uint16_t *dst_fb, int dst_w, int ds
   if (!dst_fb || !src_data)
     return;
 
-  tgx::Image<tgx::RGB565> dst_im(dst_fb, dst_w, dst_h);
+  tgx::Image<tgx::RGB565> dst_im(dst_fb, dst_w, dst_h, dst_stride);
   tgx::Image<tgx::RGB565> src_im((uint16_t *)src_data, src_w, src_h);
 
   // Anchor at the center of the source image to draw it at the (dst_x, dst_y)
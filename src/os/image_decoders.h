@@ -38,15 +38,34 @@ bool decode_gif_buffer(const uint8_t *data, size_t len,
 // Decodes a GIF directly from a file path using FatFS streaming
 bool decode_gif_file(const char *path, image_decode_result_t *result);
 
+// Receives decoded pixels a block at a time: w x h RGB565 pixels (host byte
+// order) whose top-left is (x, y) in the decoded image, rows `stride` pixels
+// apart.  Return false to stop the decode early.
+typedef bool (*image_block_cb_t)(void *user, int x, int y, int w, int h,
+                                 const uint16_t *pixels, int stride);
+
+// Streams a JPEG file through cb one MCU strip at a time, decoded at 1/scale
+// (1, 2, 4 or 8) by the IDCT itself, so nothing larger than a strip is ever
+// held.  Stopping early through cb is not a failure.
+bool decode_jpeg_file_blocks(const char *path, int scale, image_block_cb_t cb,
+                             void *user);
+
+// Streams a PNG file through cb one row at a time.  Alpha is composited onto
+// black, as decode_png_file does.
+bool decode_png_file_blocks(const char *path, image_block_cb_t cb, void *user);
+
 // Draws a scaled/rotated image using tgx onto the destination framebuffer.
-// Both buffers must be in RGB565 format.
+// Both buffers must be in RGB565 format.  dst_stride is the row pitch of
+// dst_fb in pixels, so a sub-rectangle of a larger framebuffer can be passed.
 void tgx_draw_image_scaled(uint16_t *dst_fb, int dst_w, int dst_h,
+                           int dst_stride,
                            const uint16_t *src_data, int src_w, int src_h,
                            int dst_x, int dst_y, float scale, float angle);
 
 // Draws a scaled/rotated image using tgx with color-key transparency.
 // transparent_color: RGB565 color that will be treated as transparent (skipped).
 void tgx_draw_image_scaled_masked(uint16_t *dst_fb, int dst_w, int dst_h,
+                                  int dst_stride,
                                   const uint16_t *src_data, int src_w, int src_h,
                                   int dst_x, int dst_y, float scale, float angle,
                                   uint16_t transparent_color);
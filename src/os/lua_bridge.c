@@ -1,6 +1,7 @@
 #include "lua_bridge_internal.h"
 #include "lua_psram_alloc.h"
 #include "crashlog.h"
+#include "image_cache.h"
 
 char lua_bridge_exit_tag; // address used as sentinel, value irrelevant
 #include "../drivers/display.h"
@@ -55,13 +56,32 @@ void register_subtable(lua_State *L, const char *name,
   lua_setfield(L, -2, name);
 }
 
-// Instruction-count hook: fires every 256 Lua opcodes.
-// WiFi is now driven by Core 1 (wifi_poll every 5 ms) — no call needed here.
-static void menu_lua_hook(lua_State *L, lua_Debug *ar) {
-  (void)ar;
-  watchdog_update(); // kick watchdog — fires every 256 Lua opcodes
+// ── Instruction-count hook
+// ──────────────────────────────────────────────────────────────
+// The count hook itself only reads the 1 MHz timer.  The service work below
+// (watchdog, HTTP/TCP/file I/O callbacks, dev commands, menu/screenshot keys, low-heap
+// GC) runs at most once per LUA_HOOK_SERVICE_US.  The opcode count between
+// hook calls is retuned from the measured interval so the hook fires about
+// every LUA_HOOK_CHECK_US whatever the app's opcode throughput: tight
+// compute loops get a long count, apps that mostly sit in C calls a short
+// one.  WiFi is driven by Core 1 (wifi_poll every 5 ms) — no call needed here.
+
+#ifndef LUA_HOOK_SERVICE_US
+#define LUA_HOOK_SERVICE_US 2000
+#endif
+#define LUA_HOOK_CHECK_US (LUA_HOOK_SERVICE_US / 4)
+#define LUA_HOOK_COUNT_MIN 256
+#define LUA_HOOK_COUNT_MAX 65536
+
+static int s_hook_count;
+static uint32_t s_hook_last_us;    // previous hook call
+static uint32_t s_hook_service_us; // previous menu_lua_service() run
+
+static void menu_lua_service(lua_State *L) {
+  watchdog_update();
   http_lua_fire_pending(L); // fire any queued HTTP Lua callbacks
   tcp_lua_fire_pending(L);  // fire any queued TCP Lua callbacks
+  fs_lua_fire_pending(L);   // fire completed async file I/O callbacks
   dev_commands_poll();
   dev_commands_process();
   if (dev_commands_wants_exit()) {
@@ -90,15 +110,17 @@ static void menu_lua_hook(lua_State *L, lua_Debug *ar) {
     s_screenshot_pending = true;
 
   // Low-memory GC trigger: when the PSRAM heap drops below PSRAM_LOW_WATERMARK,
-  // force a full GC cycle to reclaim dead Lua objects before allocations start
-  // failing.  s_gc_triggered prevents hammering GC every 256 opcodes while
-  // memory stays low; it resets once the heap recovers above the watermark.
+  // force a full GC cycle to reclaim dead Lua objects, and drop the cached
+  // images nothing uses any more, before allocations start failing.
+  // s_gc_triggered prevents hammering GC on every service pass while memory
+  // stays low; it resets once the heap recovers above the watermark.
   static bool s_gc_triggered = false;
   if (lua_psram_alloc_is_low()) {
     if (!s_gc_triggered) {
       printf("[LUA] Memory low (%zu KB free), triggering emergency GC\n",
              lua_psram_alloc_free_size() / 1024);
       lua_gc(L, LUA_GCCOLLECT, 0);
+      image_cache_trim(true);
       s_gc_triggered = true;
       printf("[LUA] After GC: %zu KB free\n",
              lua_psram_alloc_free_size() / 1024);
@@ -108,88 +130,149 @@ static void menu_lua_hook(lua_State *L, lua_Debug *ar) {
   }
 }
 
+static void menu_lua_hook(lua_State *L, lua_Debug *ar) {
+  (void)ar;
+  uint32_t now = time_us_32();
+  uint32_t dt = now - s_hook_last_us;
+  s_hook_last_us = now;
+
+  // Halve or double the count when the interval leaves [CHECK/2, CHECK*2];
+  // the band keeps one slow C call (e.g. a flush) from whipsawing it.
+  int count = s_hook_count;
+  if (dt < LUA_HOOK_CHECK_US / 2 && count < LUA_HOOK_COUNT_MAX)
+    count <<= 1;
+  else if (dt > LUA_HOOK_CHECK_US * 2 && count > LUA_HOOK_COUNT_MIN)
+    count >>= 1;
+  if (count != s_hook_count) {
+    s_hook_count = count;
+    lua_sethook(L, menu_lua_hook, LUA_MASKCOUNT, count);
+  }
+
+  if (now - s_hook_service_us < LUA_HOOK_SERVICE_US)
+    return;
+  s_hook_service_us = now;
+  menu_lua_service(L);
+}
+
 
 void lua_bridge_game_init(lua_State *L);
 void lua_bridge_terminal_init(lua_State *L);
 void lua_bridge_register_3d(lua_State *L);
 
+// ── Sub-module table
+// ────────────────────────────────────────────────────────────── Eager modules
+// are built by lua_bridge_register(): they are used by nearly every app, or
+// their init resets per-launch OS state (system menu items, open HTTP slots,
+// target FPS and frame timings) that must not leak from the previous app.
+// Everything else is built by the picocalc table's __index the first time an
+// app touches it, so a small app never pays for graphics, sound, crypto and
+// friends.  Each init receives the picocalc table at -1 and may add more than
+// one key (network adds "wifi").
+
+typedef struct {
+  const char *name; // picocalc.<name> triggers the init
+  void (*init)(lua_State *L);
+  bool eager;
+} bridge_module_t;
+
+static const bridge_module_t s_modules[] = {
+    {"display", lua_bridge_display_init, true},
+    {"input", lua_bridge_input_init, true},
+    {"sys", lua_bridge_sys_init, true},
+    {"network", lua_bridge_network_init, true},
+    {"perf", lua_bridge_perf_init, true},
+    {"fs", lua_bridge_fs_init, false},
+    {"tcp", lua_bridge_tcp_init, false},
+    {"sysconfig", lua_bridge_config_init, false},
+    {"config", lua_bridge_appconfig_init, false},
+    {"graphics", lua_bridge_graphics_init, false},
+    {"ui", lua_bridge_ui_init, false},
+    {"audio", lua_bridge_audio_init, false},
+    {"sound", lua_bridge_sound_init, false},
+    {"repl", lua_bridge_repl_init, false},
+    {"video", lua_bridge_video_init, false},
+    {"game", lua_bridge_game_init, false},
+    {"terminal", lua_bridge_terminal_init, false},
+    {"crypto", lua_bridge_crypto_init, false},
+};
+#define BRIDGE_MODULE_COUNT (int)(sizeof(s_modules) / sizeof(s_modules[0]))
+
+// Per-launch load record, reset by lua_bridge_register()
+static bool s_module_loaded[BRIDGE_MODULE_COUNT];
+
+// Run a module's init against the picocalc table at -1 and log what it cost.
+static void bridge_load_module(lua_State *L, int i) {
+  s_module_loaded[i] = true; // set first: an init that raised is not re-run
+  size_t free_before = lua_psram_alloc_free_size();
+  absolute_time_t t0 = get_absolute_time();
+  s_modules[i].init(L);
+  long us = (long)absolute_time_diff_us(t0, get_absolute_time());
+  long bytes = (long)free_before - (long)lua_psram_alloc_free_size();
+  printf("[LUA] picocalc.%-9s %6ld us %7ld B%s\n", s_modules[i].name, us,
+         bytes, s_modules[i].eager ? "" : " (on demand)");
+}
+
+// picocalc.__index(t, key): materialise a lazy sub-module on first access.
+static int l_picocalc_index(lua_State *L) {
+  if (lua_type(L, 2) != LUA_TSTRING)
+    return 0;
+  const char *key = lua_tostring(L, 2);
+  for (int i = 0; i < BRIDGE_MODULE_COUNT; i++) {
+    if (s_module_loaded[i] || strcmp(s_modules[i].name, key) != 0)
+      continue;
+    lua_settop(L, 2);
+    lua_pushvalue(L, 1);
+    bridge_load_module(L, i);
+    lua_pop(L, 1);
+    lua_rawget(L, 1);
+    return 1;
+  }
+  return 0;
+}
+
 void lua_bridge_register(lua_State *L) {
   printf("[LUA] lua_bridge_register start, PSRAM free=%lu\n",
          (unsigned long)umm_free_heap_size());
-
-
-
-
-
-
-
+  absolute_time_t t_start = get_absolute_time();
 
   // Open standard Lua libs (but not io/os/package for sandboxing)
-  printf("[LUA] registering _G...\n");
   luaL_requiref(L, "_G", luaopen_base, 1);
   lua_pop(L, 1);
-  printf("[LUA] registering table...\n");
   luaL_requiref(L, "table", luaopen_table, 1);
   lua_pop(L, 1);
-  printf("[LUA] registering string...\n");
   luaL_requiref(L, "string", luaopen_string, 1);
   lua_pop(L, 1);
-  printf("[LUA] registering math...\n");
   luaL_requiref(L, "math", luaopen_math, 1);
   lua_pop(L, 1);
   printf("[LUA] stdlib done, PSRAM free=%lu\n",
          (unsigned long)umm_free_heap_size());
 
-  // Create the top-level `picocalc` table
+  // Create the top-level `picocalc` table with only the eager modules; the
+  // rest are filled in by l_picocalc_index on demand.
+  memset(s_module_loaded, 0, sizeof(s_module_loaded));
   lua_newtable(L);
-  printf("[LUA] registering display...\n");
-  lua_bridge_display_init(L);
-  printf("[LUA] registering input...\n");
-  lua_bridge_input_init(L);
-  printf("[LUA] registering sys...\n");
-  lua_bridge_sys_init(L);
-  printf("[LUA] registering fs...\n");
-  lua_bridge_fs_init(L);
-  printf("[LUA] registering network...\n");
-  lua_bridge_network_init(L);
-  printf("[LUA] registering tcp...\n");
-  lua_bridge_tcp_init(L);
-  printf("[LUA] registering config...\n");
-  lua_bridge_config_init(L);
-  printf("[LUA] registering appconfig...\n");
-  lua_bridge_appconfig_init(L);
-  printf("[LUA] registering perf...\n");
-  lua_bridge_perf_init(L);
-  printf("[LUA] registering graphics...\n");
-  lua_bridge_graphics_init(L);
-  printf("[LUA] registering 3D extensions...\n");
-  lua_bridge_register_3d(L);
-  printf("[LUA] registering ui...\n");
-  lua_bridge_ui_init(L);
-  printf("[LUA] registering audio...\n");
-  lua_bridge_audio_init(L);
-  printf("[LUA] registering sound...\n");
-  lua_bridge_sound_init(L);
-  printf("[LUA] registering repl...\n");
-  lua_bridge_repl_init(L);
-  printf("[LUA] registering video...\n");
-  lua_bridge_video_init(L);
-  printf("[LUA] registering game...\n");
-  lua_bridge_game_init(L);
-  printf("[LUA] registering terminal...\n");
-  lua_bridge_terminal_init(L);
-  printf("[LUA] registering crypto...\n");
-  lua_bridge_crypto_init(L);
-  printf("[LUA] all modules done, PSRAM free=%lu\n",
-         (unsigned long)umm_free_heap_size());
+  for (int i = 0; i < BRIDGE_MODULE_COUNT; i++) {
+    if (s_modules[i].eager)
+      bridge_load_module(L, i);
+  }
+  lua_bridge_register_3d(L); // global draw3DWireframeEx (one C function)
+
+  lua_newtable(L);
+  lua_pushcfunction(L, l_picocalc_index);
+  lua_setfield(L, -2, "__index");
+  lua_setmetatable(L, -2);
   // Set as global
   lua_setglobal(L, "picocalc");
 
-  // Install instruction-count hook for menu button interception.
-  // Fires every 256 Lua opcodes (~100µs-1ms) to catch menu button presses
-  // even during tight loops, without requiring apps to poll input.
-  lua_sethook(L, menu_lua_hook, LUA_MASKCOUNT, 256);
-  printf("[LUA] lua_bridge_register complete\n");
+  // Install instruction-count hook for menu button interception, so menu
+  // presses are caught even during tight loops without apps polling input.
+  // Starts at the shortest count and tunes itself from the first calls.
+  s_hook_count = LUA_HOOK_COUNT_MIN;
+  s_hook_last_us = s_hook_service_us = time_us_32();
+  lua_sethook(L, menu_lua_hook, LUA_MASKCOUNT, s_hook_count);
+  printf("[LUA] lua_bridge_register complete in %ld us, PSRAM free=%lu\n",
+         (long)absolute_time_diff_us(t_start, get_absolute_time()),
+         (unsigned long)umm_free_heap_size());
 }
 
 void lua_bridge_show_error(lua_State *L, const char *context) {
@@ -67,8 +67,13 @@ static int l_display_drawText(lua_State *L) {
   int y = (int)luaL_checknumber(L, 2);
   const char *text = luaL_checkstring(L, 3);
   uint16_t fg = l_checkcolor(L, 4);
-  uint16_t bg = (lua_gettop(L) >= 5) ? l_checkcolor(L, 5) : COLOR_BLACK;
-  int width = display_draw_text(x, y, text, fg, bg);
+  int width;
+  if (lua_isboolean(L, 5) && !lua_toboolean(L, 5)) {
+    width = display_draw_text_transparent(x, y, text, fg);
+  } else {
+    uint16_t bg = lua_isnoneornil(L, 5) ? COLOR_BLACK : l_checkcolor(L, 5);
+    width = display_draw_text(x, y, text, fg, bg);
+  }
   lua_pushinteger(L, width);
   return 1;
 }
@@ -87,6 +92,32 @@ static int l_display_flush(lua_State *L) {
   return 0;
 }
 
+// Push only the rects queued via display_add_dirty_rect() (the sprite
+// compositor fills these in) instead of the whole frame.
+static int l_display_flushDirty(lua_State *L) {
+  (void)L;
+  display_flush_dirty();
+  if (s_screenshot_pending) {
+    s_screenshot_pending = false;
+    screenshot_save();
+  }
+  return 0;
+}
+
+static int l_display_setClipRect(lua_State *L) {
+  display_set_clip_rect((int)luaL_checkinteger(L, 1),
+                        (int)luaL_checkinteger(L, 2),
+                        (int)luaL_checkinteger(L, 3),
+                        (int)luaL_checkinteger(L, 4));
+  return 0;
+}
+
+static int l_display_clearClipRect(lua_State *L) {
+  (void)L;
+  display_clear_clip_rect();
+  return 0;
+}
+
 static int l_display_getWidth(lua_State *L) {
   lua_pushinteger(L, FB_WIDTH);
   return 1;
@@ -213,6 +244,9 @@ static const luaL_Reg l_display_lib[] = {
     {"setScrollOffset", l_display_setScrollOffset},
     {"drawText", l_display_drawText},
     {"flush", l_display_flush},
+    {"flushDirty", l_display_flushDirty},
+    {"setClipRect", l_display_setClipRect},
+    {"clearClipRect", l_display_clearClipRect},
     {"getWidth", l_display_getWidth},
     {"getHeight", l_display_getHeight},
     {"setBrightness", l_display_setBrightness},
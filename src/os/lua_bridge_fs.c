@@ -4,7 +4,9 @@
 // Thin wrapper over sdcard_ functions, exposed to Lua
 
 #include "../drivers/sdcard.h"
+#include "../drivers/fs_queue.h"
 #include "file_browser.h"
+#include "image_cache.h"
 #include "umm_malloc.h"
 
 // ── Filesystem sandbox
@@ -87,6 +89,8 @@ static int l_fs_open(lua_State *L) {
     lua_pushnil(L);
     return 1;
   }
+  if (needs_write)
+    image_cache_invalidate(path);
   sdfile_t f = sdcard_fopen(path, mode);
   if (!f) {
     lua_pushnil(L);
@@ -306,6 +310,7 @@ static int l_fs_delete(lua_State *L) {
     return 2;
   }
   if (sdcard_delete(path)) {
+    image_cache_invalidate(path);
     lua_pushboolean(L, true);
     return 1;
   }
@@ -329,6 +334,8 @@ static int l_fs_rename(lua_State *L) {
     return 2;
   }
   if (sdcard_rename(src, dst)) {
+    image_cache_invalidate(src);
+    image_cache_invalidate(dst);
     lua_pushboolean(L, true);
     return 1;
   }
@@ -375,6 +382,7 @@ static int l_fs_copy(lua_State *L) {
   if (ctx.fn_ref != LUA_NOREF)
     luaL_unref(L, LUA_REGISTRYINDEX, ctx.fn_ref);
 
+  image_cache_invalidate(dst);  // even a failed copy may have replaced it
   if (ok) {
     lua_pushboolean(L, true);
     return 1;
@@ -464,6 +472,168 @@ static int l_fs_glob(lua_State *L) {
   return 1;
 }
 
+// ── Asynchronous I/O ─────────────────────────────────────────────────────────
+// Requests go to fs_queue and are carried out by Core 1; fs_lua_fire_pending
+// (called from menu_lua_hook) runs each callback with the result.  The
+// request's user pointer is the callback's registry ref.
+
+static lua_State *s_fire_L; // state the callbacks run on, during dispatch
+
+static void fs_async_cb(const fs_result_t *res, void *user) {
+  lua_State *L = s_fire_L;
+  int ref = (int)(intptr_t)user;
+  if (res->op == FS_REQ_WRITE)
+    image_cache_invalidate(res->path);
+  if (ref == LUA_NOREF)
+    return;
+  lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+  luaL_unref(L, LUA_REGISTRYINDEX, ref);
+
+  int nargs = 1;
+  switch (res->op) {
+  case FS_REQ_READ:
+    if (res->result >= 0) {
+      lua_pushlstring(L, res->data ? (const char *)res->data : "",
+                      (size_t)res->result);
+    } else {
+      lua_pushnil(L);
+      lua_pushstring(L, "read failed");
+      nargs = 2;
+    }
+    break;
+  case FS_REQ_WRITE:
+    lua_pushboolean(L, res->result >= 0);
+    if (res->result < 0) {
+      lua_pushstring(L, "write failed");
+      nargs = 2;
+    }
+    break;
+  case FS_REQ_STAT:
+    if (res->result >= 0) {
+      lua_newtable(L);
+      lua_pushinteger(L, (lua_Integer)res->stat.size); lua_setfield(L, -2, "size");
+      lua_pushboolean(L, res->stat.is_dir);            lua_setfield(L, -2, "is_dir");
+      push_mtime_fields(L, res->stat.fdate, res->stat.ftime);
+    } else {
+      lua_pushnil(L);
+      lua_pushstring(L, "not found");
+      nargs = 2;
+    }
+    break;
+  case FS_REQ_LIST: {
+    lua_newtable(L);
+    listdir_ctx_t ctx = {L, lua_gettop(L), 0};
+    const sdcard_entry_t *e = (const sdcard_entry_t *)res->data;
+    for (int i = 0; i < res->result; i++)
+      listdir_cb(&e[i], &ctx);
+    break;
+  }
+  }
+
+  if (lua_pcall(L, nargs, 0, 0) != LUA_OK) {
+    // Exit App chosen from the menu while the callback ran: keep unwinding.
+    if (lua_bridge_is_exit_sentinel(L, -1))
+      lua_error(L);
+    printf("[FS] Async callback error: %s\n", lua_tostring(L, -1));
+    lua_pop(L, 1);
+  }
+}
+
+void fs_lua_fire_pending(lua_State *L) {
+  s_fire_L = L;
+  fs_queue_dispatch();
+}
+
+// Registry ref for the callback at idx, LUA_NOREF when it is nil.
+static int fs_async_ref(lua_State *L, int idx, bool optional) {
+  if (optional && lua_isnoneornil(L, idx))
+    return LUA_NOREF;
+  luaL_checktype(L, idx, LUA_TFUNCTION);
+  lua_pushvalue(L, idx);
+  return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+// Pushes the request id, or releases the callback and returns nil, err.
+static int fs_async_result(lua_State *L, int id, int ref) {
+  if (id < 0) {
+    luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    lua_pushnil(L);
+    lua_pushstring(L, "request queue full");
+    return 2;
+  }
+  lua_pushinteger(L, id);
+  return 1;
+}
+
+static int fs_async_denied(lua_State *L) {
+  lua_pushnil(L);
+  lua_pushstring(L, "permission denied");
+  return 2;
+}
+
+// ── picocalc.fs.readAsync(path, callback [, offset [, len]]) → id ────────────
+static int l_fs_readAsync(lua_State *L) {
+  const char *path = luaL_checkstring(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  lua_Integer offset = luaL_optinteger(L, 3, 0);
+  lua_Integer len = luaL_optinteger(L, 4, 0);
+  luaL_argcheck(L, offset >= 0, 3, "negative offset");
+  luaL_argcheck(L, len >= 0, 4, "negative length");
+  if (!fs_sandbox_check(L, path, false))
+    return fs_async_denied(L);
+  int ref = fs_async_ref(L, 2, false);
+  int id = fs_queue_read(path, (uint32_t)offset, NULL, (uint32_t)len,
+                         fs_async_cb, (void *)(intptr_t)ref);
+  return fs_async_result(L, id, ref);
+}
+
+// ── picocalc.fs.writeAsync(path, data [, callback [, append]]) → id ──────────
+static int l_fs_writeAsync(lua_State *L) {
+  const char *path = luaL_checkstring(L, 1);
+  size_t len;
+  const char *data = luaL_checklstring(L, 2, &len);
+  bool append = lua_toboolean(L, 4);
+  if (!fs_sandbox_check(L, path, true))
+    return fs_async_denied(L);
+  int ref = fs_async_ref(L, 3, true);
+  int id = fs_queue_write(path, data, (uint32_t)len, append, true, fs_async_cb,
+                          (void *)(intptr_t)ref);
+  return fs_async_result(L, id, ref);
+}
+
+// ── picocalc.fs.statAsync(path, callback) → id ───────────────────────────────
+static int l_fs_statAsync(lua_State *L) {
+  const char *path = luaL_checkstring(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  if (!fs_sandbox_check(L, path, false))
+    return fs_async_denied(L);
+  int ref = fs_async_ref(L, 2, false);
+  int id = fs_queue_stat(path, fs_async_cb, (void *)(intptr_t)ref);
+  return fs_async_result(L, id, ref);
+}
+
+// ── picocalc.fs.listDirAsync(path, callback) → id ────────────────────────────
+static int l_fs_listDirAsync(lua_State *L) {
+  const char *path = luaL_checkstring(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  if (!fs_sandbox_check(L, path, false))
+    return fs_async_denied(L);
+  int ref = fs_async_ref(L, 2, false);
+  int id = fs_queue_list_dir(path, NULL, 0, fs_async_cb, (void *)(intptr_t)ref);
+  return fs_async_result(L, id, ref);
+}
+
+// ── picocalc.fs.cancelAsync(id) → ok ─────────────────────────────────────────
+static int l_fs_cancelAsync(lua_State *L) {
+  int id = (int)luaL_checkinteger(L, 1);
+  void *user = NULL;
+  bool ok = fs_queue_cancel(id, &user);
+  if (ok)
+    luaL_unref(L, LUA_REGISTRYINDEX, (int)(intptr_t)user);
+  lua_pushboolean(L, ok);
+  return 1;
+}
+
 static const luaL_Reg l_fs_lib[] = {
     {"open",     l_fs_open},     {"read",     l_fs_read},
     {"write",    l_fs_write},    {"close",    l_fs_close},
@@ -475,6 +645,9 @@ static const luaL_Reg l_fs_lib[] = {
     {"delete",   l_fs_delete},   {"rename",   l_fs_rename},
     {"copy",     l_fs_copy},     {"stat",     l_fs_stat},
     {"diskInfo", l_fs_diskInfo}, {"glob",     l_fs_glob},
+    {"readAsync",    l_fs_readAsync},    {"writeAsync",  l_fs_writeAsync},
+    {"statAsync",    l_fs_statAsync},    {"listDirAsync", l_fs_listDirAsync},
+    {"cancelAsync",  l_fs_cancelAsync},
     {NULL, NULL}};
 
 
@@ -1,5 +1,7 @@
 #include "lua_bridge_internal.h"
+#include "lua_psram_alloc.h"
 #include "../drivers/image_api.h"
+#include "image_cache.h"
 #include "pico/time.h"
 #include <math.h>
 
@@ -14,10 +16,15 @@ static lua_image_t *check_image(lua_State *L, int idx) {
 
 static int l_graphics_image_gc(lua_State *L) {
   lua_image_t *img = check_image(L, 1);
-  if (img->data) {
+  if (img->cache) {
+    image_cache_unref(img->cache);
+    img->cache = NULL;
+  } else if (img->data) {
     umm_free(img->data);
-    img->data = NULL;
   }
+  img->data = NULL;
+  display_rle_free(img->rle);
+  img->rle = NULL;
   return 0;
 }
 
@@ -68,6 +75,8 @@ static int l_graphics_image_new(lua_State *L) {
   img->h = loaded->h;
   img->data = loaded->data;        // steal ownership of pixel data
   img->transparent_color = 0;
+  img->rle = NULL;
+  img->cache = NULL;
   loaded->data = NULL;             // prevent image_free from freeing pixels
   umm_free(loaded);                // free just the temp struct
 
@@ -82,19 +91,20 @@ static int l_graphics_image_load(lua_State *L) {
     return luaL_error(L, "access denied");
   }
 
-  pc_image_t *loaded = image_load(path);
-  if (!loaded)
+  // Decoded pixels are shared with the image cache; __gc drops the reference.
+  // The userdata comes first so an allocation error can't leak one.
+  lua_image_t *img = (lua_image_t *)lua_newuserdata(L, sizeof(lua_image_t));
+  pc_image_t shared;
+  image_cache_entry_t *entry = image_cache_acquire(path, &shared);
+  if (!entry)
     return luaL_error(L, "failed to load image: %s", path);
 
-  // Steal pixel data from the loaded pc_image_t into a Lua-managed userdata.
-  // Lua owns the struct; only the pixel buffer is in PSRAM and freed by __gc.
-  lua_image_t *img = (lua_image_t *)lua_newuserdata(L, sizeof(lua_image_t));
-  img->w = loaded->w;
-  img->h = loaded->h;
-  img->data = loaded->data;        // steal ownership of pixel data
+  img->w = shared.w;
+  img->h = shared.h;
+  img->data = shared.data;
   img->transparent_color = 0;
-  loaded->data = NULL;             // prevent image_free from freeing pixels
-  umm_free(loaded);                // free just the temp struct
+  img->rle = NULL;
+  img->cache = entry;
 
   luaL_setmetatable(L, GRAPHICS_IMAGE_MT);
   return 1;
@@ -113,6 +123,8 @@ static int l_graphics_image_copy(lua_State *L) {
   dst->w = src->w;
   dst->h = src->h;
   dst->transparent_color = src->transparent_color;
+  dst->rle = NULL;
+  dst->cache = NULL;
   dst->data = (uint16_t *)umm_malloc(dst->w * dst->h * sizeof(uint16_t));
   if (!dst->data)
     return luaL_error(L, "out of memory allocating image copy");
@@ -121,6 +133,38 @@ static int l_graphics_image_copy(lua_State *L) {
   return 1;
 }
 
+// Colour key a blit with transparent_color `c` will actually use (0 = none).
+static inline uint16_t effective_key(uint16_t c) {
+  return c ? c : display_get_transparent_color();
+}
+
+// (Re)build img's run-length form for `key`.  Images are immutable, so it
+// stays valid until the key in effect changes.
+static bool image_build_rle(lua_image_t *img, uint16_t key) {
+  if (!key || !img->data)
+    return false;
+  if (img->rle && img->rle->key == key)
+    return true;
+  display_rle_image_t *rle = display_rle_encode(img->data, img->w, img->h, key);
+  if (!rle)
+    return false;
+  display_rle_free(img->rle);
+  img->rle = rle;
+  return true;
+}
+
+// display_draw_image_partial for a Lua image, going through its run-length
+// form when that was built for the key in effect.
+static void image_blit(const lua_image_t *img, uint16_t transparent_color,
+                       int x, int y, int sx, int sy, int sw, int sh,
+                       bool flip_x, bool flip_y) {
+  if (img->rle && img->rle->key == effective_key(transparent_color))
+    display_draw_rle(x, y, img->rle, sx, sy, sw, sh, flip_x, flip_y);
+  else
+    display_draw_image_partial(x, y, img->w, img->h, img->data, sx, sy, sw,
+                               sh, flip_x, flip_y, transparent_color);
+}
+
 static int l_graphics_image_draw(lua_State *L) {
   lua_image_t *img = check_image(L, 1);
   int x = luaL_checkinteger(L, 2);
@@ -155,8 +199,8 @@ static int l_graphics_image_draw(lua_State *L) {
     lua_pop(L, 1);
   }
 
-  display_draw_image_partial(x, y, img->w, img->h, img->data, sx, sy, sw, sh,
-                             flip_x, flip_y, img->transparent_color);
+  image_blit(img, img->transparent_color, x, y, sx, sy, sw, sh, flip_x,
+             flip_y);
   return 0;
 }
 
@@ -170,8 +214,8 @@ static int l_graphics_image_drawAnchored(lua_State *L) {
   x -= (int)(img->w * ax);
   y -= (int)(img->h * ay);
 
-  display_draw_image_partial(x, y, img->w, img->h, img->data, 0, 0, img->w,
-                             img->h, false, false, img->transparent_color);
+  image_blit(img, img->transparent_color, x, y, 0, 0, img->w, img->h, false,
+             false);
   return 0;
 }
 
@@ -186,9 +230,8 @@ static int l_graphics_image_drawTiled(lua_State *L) {
     for (int tx = 0; tx < rect_w; tx += img->w) {
       int draw_w = (tx + img->w > rect_w) ? (rect_w - tx) : img->w;
       int draw_h = (ty + img->h > rect_h) ? (rect_h - ty) : img->h;
-      display_draw_image_partial(x + tx, y + ty, img->w, img->h, img->data, 0,
-                                 0, draw_w, draw_h, false, false,
-                                 img->transparent_color);
+      image_blit(img, img->transparent_color, x + tx, y + ty, 0, 0, draw_w,
+                 draw_h, false, false);
     }
   }
 
@@ -241,6 +284,14 @@ static int l_graphics_image_setTransparentColor(lua_State *L) {
   return 0;
 }
 
+// image:optimize() -> bool: pre-encode the image as opaque runs for its
+// current colour key, so draws skip the per-pixel transparency test.
+static int l_graphics_image_optimize(lua_State *L) {
+  lua_image_t *img = check_image(L, 1);
+  lua_pushboolean(L, image_build_rle(img, effective_key(img->transparent_color)));
+  return 1;
+}
+
 static int l_graphics_image_getTransparentColor(lua_State *L) {
   lua_image_t *img = check_image(L, 1);
   if (img->transparent_color == 0)
@@ -260,6 +311,7 @@ static const luaL_Reg l_graphics_image_methods[] = {
     {"drawScaledNN", l_graphics_image_drawScaledNN},
     {"setTransparentColor", l_graphics_image_setTransparentColor},
     {"getTransparentColor", l_graphics_image_getTransparentColor},
+    {"optimize", l_graphics_image_optimize},
     {"setStorageLocation", l_graphics_image_setStorageLocation},
     {"getMetadata", l_graphics_image_getMetadata},
     {NULL, NULL}};
@@ -312,6 +364,8 @@ static int l_graphics_image_loadFromBuffer(lua_State *L) {
     img->h = res.h;
     img->data = res.data;
     img->transparent_color = 0;
+    img->rle = NULL;
+    img->cache = NULL;
     luaL_setmetatable(L, GRAPHICS_IMAGE_MT);
     return 1;
   }
@@ -323,20 +377,112 @@ static int l_graphics_image_loadRemote(lua_State *L) {
   return luaL_error(L, "loadRemote not implemented yet");
 }
 
+// Hands a pc_image_t's pixels to a new Lua image and frees the struct.
+static void push_loaded_image(lua_State *L, pc_image_t *loaded) {
+  lua_image_t *img = (lua_image_t *)lua_newuserdata(L, sizeof(lua_image_t));
+  img->w = loaded->w;
+  img->h = loaded->h;
+  img->data = loaded->data;
+  img->transparent_color = 0;
+  img->rle = NULL;
+  img->cache = NULL;
+  loaded->data = NULL;
+  umm_free(loaded);
+  luaL_setmetatable(L, GRAPHICS_IMAGE_MT);
+}
+
 static int l_graphics_image_getInfo(lua_State *L) {
-  return luaL_error(L, "getInfo not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+
+  image_info_t info;
+  if (!image_get_info(path, &info)) {
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_createtable(L, 0, 3);
+  lua_pushinteger(L, info.w);
+  lua_setfield(L, -2, "width");
+  lua_pushinteger(L, info.h);
+  lua_setfield(L, -2, "height");
+  lua_pushstring(L, image_format_name(info.format));
+  lua_setfield(L, -2, "format");
+  return 1;
 }
 
+// image.loadRegion(path, x, y, w, h [, scale])
 static int l_graphics_image_loadRegion(lua_State *L) {
-  return luaL_error(L, "loadRegion not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  int x = luaL_checkinteger(L, 2);
+  int y = luaL_checkinteger(L, 3);
+  int w = luaL_checkinteger(L, 4);
+  int h = luaL_checkinteger(L, 5);
+  int scale = luaL_optinteger(L, 6, 1);
+  luaL_argcheck(L, scale == 1 || scale == 2 || scale == 4 || scale == 8, 6,
+                "scale must be 1, 2, 4 or 8");
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+
+  pc_image_t *loaded = image_load_region(path, x, y, w, h, scale);
+  if (!loaded)
+    return luaL_error(L, "failed to load image region: %s", path);
+  push_loaded_image(L, loaded);
+  return 1;
 }
 
+// image.loadScaled(path, w [, h])
 static int l_graphics_image_loadScaled(lua_State *L) {
-  return luaL_error(L, "loadScaled not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  int w = luaL_checkinteger(L, 2);
+  int h = luaL_optinteger(L, 3, 0);
+  luaL_argcheck(L, w > 0, 2, "width must be positive");
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+
+  pc_image_t *loaded = image_load_scaled(path, w, h);
+  if (!loaded)
+    return luaL_error(L, "failed to load image: %s", path);
+  push_loaded_image(L, loaded);
+  return 1;
 }
 
+// image.drawFile(path, x, y [, scale])
+static int l_graphics_image_drawFile(lua_State *L) {
+  const char *path = luaL_checkstring(L, 1);
+  int x = luaL_checkinteger(L, 2);
+  int y = luaL_checkinteger(L, 3);
+  int scale = luaL_optinteger(L, 4, 1);
+  luaL_argcheck(L, scale == 1 || scale == 2 || scale == 4 || scale == 8, 4,
+                "scale must be 1, 2, 4 or 8");
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+
+  lua_pushboolean(L, image_draw_file(path, x, y, scale));
+  return 1;
+}
+
+#define GRAPHICS_IMAGESTREAM_MT "picocalc.graphics.imagestream"
+
+typedef struct {
+  image_stream_t *stream;
+} lua_image_stream_t;
+
+// image.newStream(path [, tile_w, tile_h])
 static int l_graphics_image_newStream(lua_State *L) {
-  return luaL_error(L, "newStream not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  int tile_w = luaL_optinteger(L, 2, 0);
+  int tile_h = luaL_optinteger(L, 3, 0);
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+
+  lua_image_stream_t *ls =
+      (lua_image_stream_t *)lua_newuserdata(L, sizeof(lua_image_stream_t));
+  ls->stream = image_stream_open(path, tile_w, tile_h);
+  if (!ls->stream)
+    return luaL_error(L, "failed to open image stream: %s", path);
+  luaL_setmetatable(L, GRAPHICS_IMAGESTREAM_MT);
+  return 1;
 }
 
 static int l_graphics_image_setPlaceholder(lua_State *L) {
@@ -365,27 +511,41 @@ static const luaL_Reg l_graphics_image_lib[] = {
     {"loadRegion", l_graphics_image_loadRegion},
     {"loadScaled", l_graphics_image_loadScaled},
     {"newStream", l_graphics_image_newStream},
+    {"drawFile", l_graphics_image_drawFile},
     {"setPlaceholder", l_graphics_image_setPlaceholder},
     {"getSupportedFormats", l_graphics_image_getSupportedFormats},
     {NULL, NULL}};
 
-#define GRAPHICS_IMAGESTREAM_MT "picocalc.graphics.imagestream"
-
-typedef struct {
-  void *stream_ptr; // Stub data
-} lua_image_stream_t;
-
 static int l_graphics_imagestream_gc(lua_State *L) {
-  (void)L;
+  lua_image_stream_t *ls =
+      (lua_image_stream_t *)luaL_checkudata(L, 1, GRAPHICS_IMAGESTREAM_MT);
+  image_stream_close(ls->stream);
+  ls->stream = NULL;
   return 0;
 }
 
+// Returns the next tile and its position in the image, or nil when done.
 static int l_graphics_imagestream_getNextTile(lua_State *L) {
-  return luaL_error(L, "getNextTile not implemented yet");
+  lua_image_stream_t *ls =
+      (lua_image_stream_t *)luaL_checkudata(L, 1, GRAPHICS_IMAGESTREAM_MT);
+  if (image_stream_done(ls->stream)) {
+    lua_pushnil(L);
+    return 1;
+  }
+  int x, y;
+  pc_image_t *tile = image_stream_next(ls->stream, &x, &y);
+  if (!tile)
+    return luaL_error(L, "image stream decode failed");
+  push_loaded_image(L, tile);
+  lua_pushinteger(L, x);
+  lua_pushinteger(L, y);
+  return 3;
 }
 
 static int l_graphics_imagestream_isComplete(lua_State *L) {
-  lua_pushboolean(L, false); // stub
+  lua_image_stream_t *ls =
+      (lua_image_stream_t *)luaL_checkudata(L, 1, GRAPHICS_IMAGESTREAM_MT);
+  lua_pushboolean(L, image_stream_done(ls->stream));
   return 1;
 }
 
@@ -395,21 +555,58 @@ static const luaL_Reg l_graphics_imagestream_methods[] = {
     {NULL, NULL}};
 
 static int l_graphics_cache_setMaxMemory(lua_State *L) {
-  return luaL_error(L, "setMaxMemory not implemented yet");
+  lua_Integer bytes = luaL_checkinteger(L, 1);
+  luaL_argcheck(L, bytes >= 0, 1, "must be non-negative");
+  image_cache_set_max_bytes((size_t)bytes);
+  return 0;
 }
 
 static int l_graphics_cache_retain(lua_State *L) {
-  return luaL_error(L, "retain not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  if (!fs_sandbox_check(L, path, false))
+    return luaL_error(L, "access denied");
+  lua_pushboolean(L, image_cache_retain(path));
+  return 1;
 }
 
 static int l_graphics_cache_release(lua_State *L) {
-  return luaL_error(L, "release not implemented yet");
+  const char *path = luaL_checkstring(L, 1);
+  lua_pushboolean(L, image_cache_release(path));
+  return 1;
+}
+
+// Drops every cached image nothing is using.
+static int l_graphics_cache_clear(lua_State *L) {
+  (void)L;
+  image_cache_trim(true);
+  return 0;
+}
+
+static int l_graphics_cache_getStats(lua_State *L) {
+  image_cache_stats_t st;
+  image_cache_get_stats(&st);
+  lua_createtable(L, 0, 6);
+  lua_pushinteger(L, st.hits);
+  lua_setfield(L, -2, "hits");
+  lua_pushinteger(L, st.misses);
+  lua_setfield(L, -2, "misses");
+  lua_pushinteger(L, st.evictions);
+  lua_setfield(L, -2, "evictions");
+  lua_pushinteger(L, st.entries);
+  lua_setfield(L, -2, "entries");
+  lua_pushinteger(L, (lua_Integer)st.bytes);
+  lua_setfield(L, -2, "bytes");
+  lua_pushinteger(L, (lua_Integer)st.max_bytes);
+  lua_setfield(L, -2, "maxBytes");
+  return 1;
 }
 
 static const luaL_Reg l_graphics_cache_lib[] = {
     {"setMaxMemory", l_graphics_cache_setMaxMemory},
     {"retain", l_graphics_cache_retain},
     {"release", l_graphics_cache_release},
+    {"clear", l_graphics_cache_clear},
+    {"getStats", l_graphics_cache_getStats},
     {NULL, NULL}};
 
 // drawGrid(x, y, cell_w, cell_h, cols, rows, color)
@@ -639,7 +836,6 @@ static int l_graphics_draw3DWireframe(lua_State *L) {
 // ── Sprite System ───────────────────────────────────────────────────────────────
 
 #define GRAPHICS_SPRITE_MT "picocalc.graphics.sprite"
-#define MAX_SPRITES 256
 
 typedef struct {
   int x, y;
@@ -666,6 +862,7 @@ typedef struct {
   int collides_with_mask;
   lua_image_t *image;
   uint16_t *frame_data;  // extracted frame pixels (NULL = use full image)
+  display_rle_image_t *frame_rle;  // run-length form of frame_data, or NULL
   int frame_w, frame_h;  // dimensions of extracted frame
   int scale_nn;         // integer scale for NN scaling
   bool use_nn_scaling;  // use NN instead of bilinear
@@ -673,10 +870,54 @@ typedef struct {
   lua_image_t *stencil;        // stencil image (deferred masking)
   uint8_t stencil_pattern[8];  // 8x8 dither stencil pattern
   bool has_stencil_pattern;    // true if stencil_pattern is active
+  bool drawn;                  // drawn_* holds the last composited bounds
+  int drawn_x, drawn_y, drawn_w, drawn_h;
+  int reg_index;               // position in s_sprites, -1 = not added
+  bool in_grid;                // grid_* holds the cells it is hashed into
+  int grid_x0, grid_y0, grid_x1, grid_y1;
+  uint32_t query_stamp;        // dedupes sprites spanning several cells
 } lua_sprite_t;
 
-static lua_sprite_t *s_sprites[MAX_SPRITES];
+// ── Sprite registry ─────────────────────────────────────────────────────────
+//
+// Added sprites live in s_sprites, a growable PSRAM array kept sorted by
+// z_index; equal z values keep insertion order.  Each entry's reg_index
+// tracks its slot so removal and re-sorting never search.
+//
+// Alongside it, every sprite is hashed into the uniform-grid cells its
+// collision bounds cover.  Cells hash into a fixed bucket table, so the
+// world has no fixed extent; a sprite covering more than
+// SPRITE_GRID_MAX_CELLS cells goes on s_grid_big instead and is a candidate
+// for every query.  If a bucket ever fails to grow, s_grid_ok drops and
+// queries fall back to scanning the whole list.
+
+#define SPRITE_GRID_SHIFT 5           // 32px cells
+#define SPRITE_GRID_BUCKETS 256       // power of two
+#define SPRITE_GRID_MAX_CELLS 64
+
+typedef struct {
+  lua_sprite_t **items;
+  int count, cap;
+} sprite_bucket_t;
+
+static lua_sprite_t **s_sprites = NULL;
 static int s_sprite_count = 0;
+static int s_sprite_cap = 0;
+
+static sprite_bucket_t s_grid[SPRITE_GRID_BUCKETS];
+static sprite_bucket_t s_grid_big;
+static bool s_grid_ok = true;
+static uint32_t s_query_stamp = 0;
+static sprite_bucket_t s_grid_scratch;  // candidate list returned by queries
+
+// Registry table mapping each added sprite (lightuserdata) to its userdata,
+// so the GC can't free a sprite that s_sprites still points at.
+static int s_sprite_anchor_ref = LUA_NOREF;
+
+// Background callback for the dirty-rect compositor.  LUA_NOREF disables
+// compositing: sprite.update() then draws every sprite over whatever the app
+// has already drawn, as it always has.
+static int s_sprite_bg_ref = LUA_NOREF;
 
 static uint8_t s_global_stencil[8];
 static bool s_has_global_stencil = false;
@@ -685,6 +926,268 @@ static lua_sprite_t *check_sprite(lua_State *L, int idx) {
   return (lua_sprite_t *)luaL_checkudata(L, idx, GRAPHICS_SPRITE_MT);
 }
 
+// Returns the effective on-screen pixel dimensions of a sprite.
+// Uses frame dimensions if a source rect has been extracted, otherwise the
+// full image dimensions, then applies NN or bilinear scaling.
+static void sprite_visual_size(const lua_sprite_t *s, int *w, int *h) {
+  int bw = s->frame_w > 0 ? s->frame_w : s->width;
+  int bh = s->frame_h > 0 ? s->frame_h : s->height;
+  if (s->use_nn_scaling && s->scale_nn > 1) {
+    *w = bw * s->scale_nn;
+    *h = bh * s->scale_nn;
+  } else {
+    *w = (int)(bw * s->scale);
+    *h = (int)(bh * s->scale_y);
+  }
+}
+
+// Helper: get collision bounds for a sprite at position (px, py)
+static void sprite_collide_bounds_at(const lua_sprite_t *s, int px, int py,
+                                      int *ox, int *oy, int *ow, int *oh) {
+  int cw, ch;
+  if (s->collide_w > 0) { cw = s->collide_w; ch = s->collide_h; }
+  else                   { sprite_visual_size(s, &cw, &ch); }
+  *ox = px + s->collide_x;
+  *oy = py + s->collide_y;
+  *ow = cw;
+  *oh = ch;
+}
+
+static bool sprite_bucket_push(sprite_bucket_t *b, lua_sprite_t *s) {
+  if (b->count == b->cap) {
+    int cap = b->cap ? b->cap * 2 : 8;
+    lua_sprite_t **items =
+        (lua_sprite_t **)umm_realloc(b->items, cap * sizeof(lua_sprite_t *));
+    if (!items)
+      return false;
+    b->items = items;
+    b->cap = cap;
+  }
+  b->items[b->count++] = s;
+  return true;
+}
+
+// Remove one occurrence of s (bucket order doesn't matter).
+static void sprite_bucket_drop(sprite_bucket_t *b, lua_sprite_t *s) {
+  for (int i = 0; i < b->count; i++) {
+    if (b->items[i] == s) {
+      b->items[i] = b->items[--b->count];
+      return;
+    }
+  }
+}
+
+static sprite_bucket_t *sprite_grid_bucket(int cx, int cy) {
+  uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+  return &s_grid[h & (SPRITE_GRID_BUCKETS - 1)];
+}
+
+// Grid cell range covered by a rect; false if the rect is empty.
+static bool sprite_grid_cells(int x, int y, int w, int h, int *cx0, int *cy0,
+                              int *cx1, int *cy1) {
+  if (w <= 0 || h <= 0)
+    return false;
+  *cx0 = x >> SPRITE_GRID_SHIFT;
+  *cy0 = y >> SPRITE_GRID_SHIFT;
+  *cx1 = (x + w - 1) >> SPRITE_GRID_SHIFT;
+  *cy1 = (y + h - 1) >> SPRITE_GRID_SHIFT;
+  return true;
+}
+
+static bool sprite_grid_is_big(int cx0, int cy0, int cx1, int cy1) {
+  return (cx1 - cx0 + 1) * (cy1 - cy0 + 1) > SPRITE_GRID_MAX_CELLS;
+}
+
+static void sprite_grid_remove(lua_sprite_t *s) {
+  if (!s->in_grid)
+    return;
+  if (sprite_grid_is_big(s->grid_x0, s->grid_y0, s->grid_x1, s->grid_y1)) {
+    sprite_bucket_drop(&s_grid_big, s);
+  } else {
+    for (int cy = s->grid_y0; cy <= s->grid_y1; cy++)
+      for (int cx = s->grid_x0; cx <= s->grid_x1; cx++)
+        sprite_bucket_drop(sprite_grid_bucket(cx, cy), s);
+  }
+  s->in_grid = false;
+}
+
+// Re-hash a registered sprite after its position or collision size changed.
+// Cheap when it stays inside the same cells.
+static void sprite_grid_update(lua_sprite_t *s) {
+  if (s->reg_index < 0)
+    return;
+  int x, y, w, h, cx0, cy0, cx1, cy1;
+  sprite_collide_bounds_at(s, s->x, s->y, &x, &y, &w, &h);
+  if (!sprite_grid_cells(x, y, w, h, &cx0, &cy0, &cx1, &cy1)) {
+    sprite_grid_remove(s);
+    return;
+  }
+  if (s->in_grid && cx0 == s->grid_x0 && cy0 == s->grid_y0 &&
+      cx1 == s->grid_x1 && cy1 == s->grid_y1)
+    return;
+
+  sprite_grid_remove(s);
+  s->grid_x0 = cx0;
+  s->grid_y0 = cy0;
+  s->grid_x1 = cx1;
+  s->grid_y1 = cy1;
+  s->in_grid = true;
+  if (sprite_grid_is_big(cx0, cy0, cx1, cy1)) {
+    if (!sprite_bucket_push(&s_grid_big, s))
+      s_grid_ok = false;
+    return;
+  }
+  for (int cy = cy0; cy <= cy1; cy++)
+    for (int cx = cx0; cx <= cx1; cx++)
+      if (!sprite_bucket_push(sprite_grid_bucket(cx, cy), s))
+        s_grid_ok = false;
+}
+
+static void sprite_grid_clear(void) {
+  for (int i = 0; i < SPRITE_GRID_BUCKETS; i++)
+    s_grid[i].count = 0;
+  s_grid_big.count = 0;
+  s_grid_ok = true;
+}
+
+static void sprite_candidate_add(lua_sprite_t *s) {
+  if (s->query_stamp == s_query_stamp)
+    return;
+  s->query_stamp = s_query_stamp;
+  if (!sprite_bucket_push(&s_grid_scratch, s))
+    s_grid_ok = false;
+}
+
+// Every registered sprite whose hashed collision bounds may touch the rect,
+// each once, in draw (z) order.  Callers still do the exact overlap test.
+// Returns the whole sprite list when the grid can't answer.
+static lua_sprite_t **sprite_grid_candidates(int x, int y, int w, int h,
+                                             int *count) {
+  int cx0, cy0, cx1, cy1;
+  if (!sprite_grid_cells(x, y, w, h, &cx0, &cy0, &cx1, &cy1)) {
+    *count = 0;
+    return s_sprites;
+  }
+  if (!s_grid_ok || sprite_grid_is_big(cx0, cy0, cx1, cy1))
+    goto full_scan;
+
+  if (++s_query_stamp == 0) {
+    for (int i = 0; i < s_sprite_count; i++)
+      s_sprites[i]->query_stamp = 0;
+    s_query_stamp = 1;
+  }
+  s_grid_scratch.count = 0;
+  for (int i = 0; i < s_grid_big.count; i++)
+    sprite_candidate_add(s_grid_big.items[i]);
+  for (int cy = cy0; cy <= cy1; cy++) {
+    for (int cx = cx0; cx <= cx1; cx++) {
+      sprite_bucket_t *b = sprite_grid_bucket(cx, cy);
+      for (int i = 0; i < b->count; i++)
+        sprite_candidate_add(b->items[i]);
+    }
+  }
+  if (!s_grid_ok)
+    goto full_scan;
+
+  // Insertion sort by registry slot: candidate lists are short.
+  lua_sprite_t **c = s_grid_scratch.items;
+  for (int i = 1; i < s_grid_scratch.count; i++) {
+    lua_sprite_t *v = c[i];
+    int j = i;
+    while (j > 0 && c[j - 1]->reg_index > v->reg_index) {
+      c[j] = c[j - 1];
+      j--;
+    }
+    c[j] = v;
+  }
+  *count = s_grid_scratch.count;
+  return c;
+
+full_scan:
+  *count = s_sprite_count;
+  return s_sprites;
+}
+
+static void sprite_registry_set(int i, lua_sprite_t *s) {
+  s_sprites[i] = s;
+  s->reg_index = i;
+}
+
+// Insert s into the z-sorted list after any sprites with the same z.
+static bool sprite_registry_add(lua_sprite_t *s) {
+  if (s->reg_index >= 0)
+    return true;
+  if (s_sprite_count == s_sprite_cap) {
+    int cap = s_sprite_cap ? s_sprite_cap * 2 : 64;
+    lua_sprite_t **list =
+        (lua_sprite_t **)umm_realloc(s_sprites, cap * sizeof(lua_sprite_t *));
+    if (!list)
+      return false;
+    s_sprites = list;
+    s_sprite_cap = cap;
+  }
+  int pos = s_sprite_count;
+  while (pos > 0 && s_sprites[pos - 1]->z_index > s->z_index) {
+    sprite_registry_set(pos, s_sprites[pos - 1]);
+    pos--;
+  }
+  sprite_registry_set(pos, s);
+  s_sprite_count++;
+  s->in_grid = false;
+  sprite_grid_update(s);
+  return true;
+}
+
+// Queue the area a sprite last occupied on screen for recompositing.
+static void sprite_invalidate_drawn(lua_sprite_t *s) {
+  if (s->drawn)
+    display_add_dirty_rect(s->drawn_x, s->drawn_y, s->drawn_w, s->drawn_h);
+  s->drawn = false;
+}
+
+static void sprite_registry_remove(lua_sprite_t *s) {
+  if (s->reg_index < 0)
+    return;
+  sprite_grid_remove(s);
+  for (int i = s->reg_index; i < s_sprite_count - 1; i++)
+    sprite_registry_set(i, s_sprites[i + 1]);
+  s_sprite_count--;
+  s->reg_index = -1;
+  sprite_invalidate_drawn(s);
+}
+
+static void sprite_anchor(lua_State *L, lua_sprite_t *s, int idx) {
+  idx = lua_absindex(L, idx);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, s_sprite_anchor_ref);
+  lua_pushvalue(L, idx);
+  lua_rawsetp(L, -2, s);
+  lua_pop(L, 1);
+}
+
+static void sprite_unanchor(lua_State *L, lua_sprite_t *s) {
+  lua_rawgeti(L, LUA_REGISTRYINDEX, s_sprite_anchor_ref);
+  lua_pushnil(L);
+  lua_rawsetp(L, -2, s);
+  lua_pop(L, 1);
+}
+
+// Move s to its new z position: one insertion-sort pass in either direction.
+static void sprite_registry_resort(lua_sprite_t *s) {
+  int i = s->reg_index;
+  if (i < 0)
+    return;
+  while (i > 0 && s_sprites[i - 1]->z_index > s->z_index) {
+    sprite_registry_set(i, s_sprites[i - 1]);
+    i--;
+  }
+  while (i < s_sprite_count - 1 && s_sprites[i + 1]->z_index < s->z_index) {
+    sprite_registry_set(i, s_sprites[i + 1]);
+    i++;
+  }
+  sprite_registry_set(i, s);
+  s->dirty = true;
+}
+
 static int l_sprite_new(lua_State *L);
 static int l_sprite_add(lua_State *L);
 static int l_sprite_remove(lua_State *L);
@@ -774,6 +1277,35 @@ static int l_sprite_clearClipRectsInRange(lua_State *L);
 static int l_sprite_addEmptyCollisionSprite(lua_State *L);
 static int l_graphics_setStencilPattern(lua_State *L);
 
+// Pre-encode what the sprite draws (its frame, or the shared image) as
+// opaque runs for the sprite's colour key.  Skipped when PSRAM is low: the
+// keyed per-pixel path still works without it.
+static void sprite_build_rle(lua_sprite_t *s) {
+  uint16_t key = effective_key(s->transparent_color);
+  if (!key || lua_psram_alloc_is_low())
+    return;
+  if (s->frame_data) {
+    if (s->frame_rle && s->frame_rle->key == key)
+      return;
+    display_rle_free(s->frame_rle);
+    s->frame_rle = display_rle_encode(s->frame_data, s->frame_w, s->frame_h,
+                                      key);
+  } else if (s->image) {
+    image_build_rle(s->image, key);
+  }
+}
+
+static void sprite_free_frame(lua_sprite_t *s) {
+  if (s->frame_data) {
+    umm_free(s->frame_data);
+    s->frame_data = NULL;
+  }
+  display_rle_free(s->frame_rle);
+  s->frame_rle = NULL;
+  s->frame_w = 0;
+  s->frame_h = 0;
+}
+
 static int l_sprite_gc(lua_State *L) {
   // getAllSprites() previously pushed proxy full-userdata of sizeof(lua_sprite_t*)
   // bytes with the sprite metatable.  Accessing frame_data (offset ~104) on such
@@ -781,10 +1313,10 @@ static int l_sprite_gc(lua_State *L) {
   // Guard against any undersized userdata as a safety net.
   if ((size_t)lua_rawlen(L, 1) < sizeof(lua_sprite_t)) return 0;
   lua_sprite_t *s = check_sprite(L, 1);
-  if (s->frame_data) {
-    umm_free(s->frame_data);
-    s->frame_data = NULL;
-  }
+  // Added sprites are anchored, so this only fires during lua_close(); the
+  // list must still never hold a dangling pointer.
+  sprite_registry_remove(s);
+  sprite_free_frame(s);
   s->image = NULL;
   s->stencil = NULL;
   s->has_stencil_pattern = false;
@@ -831,6 +1363,7 @@ static int l_sprite_new(lua_State *L) {
   s->collides_with_mask = 0;
   s->image = NULL;
   s->frame_data = NULL;
+  s->frame_rle = NULL;
   s->frame_w = 0;
   s->frame_h = 0;
   s->scale_nn = 1;
@@ -839,6 +1372,18 @@ static int l_sprite_new(lua_State *L) {
   s->stencil = NULL;
   memset(s->stencil_pattern, 0, sizeof(s->stencil_pattern));
   s->has_stencil_pattern = false;
+  s->drawn = false;
+  s->drawn_x = 0;
+  s->drawn_y = 0;
+  s->drawn_w = 0;
+  s->drawn_h = 0;
+  s->reg_index = -1;
+  s->in_grid = false;
+  s->grid_x0 = 0;
+  s->grid_y0 = 0;
+  s->grid_x1 = 0;
+  s->grid_y1 = 0;
+  s->query_stamp = 0;
 
   if (lua_isuserdata(L, 1)) {
     s->image = (lua_image_t *)lua_touserdata(L, 1);
@@ -854,51 +1399,213 @@ static int l_sprite_new(lua_State *L) {
 
 static int l_sprite_add(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
-  if (s_sprite_count >= MAX_SPRITES)
-    return luaL_error(L, "max sprites reached");
-  s_sprites[s_sprite_count++] = s;
+  if (!sprite_registry_add(s))
+    return luaL_error(L, "out of memory for sprite list");
+  sprite_anchor(L, s, 1);
   return 0;
 }
 
 static int l_sprite_remove(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
+  if (s->reg_index >= 0) {
+    sprite_registry_remove(s);
+    sprite_unanchor(L, s);
+  }
+  return 0;
+}
+
+// Blit a sprite's current frame with its top-left corner at (x, y).
+static void sprite_render(const lua_sprite_t *s, int x, int y) {
+  // Use extracted frame if available, otherwise the full image
+  const uint16_t *data = s->frame_data ? s->frame_data : s->image->data;
+  int src_w = s->frame_data ? s->frame_w : s->width;
+  int src_h = s->frame_data ? s->frame_h : s->height;
+
+  // Handle NN scaling
+  if (s->use_nn_scaling && s->scale_nn > 1) {
+    int dst_w = src_w * s->scale_nn;
+    int dst_h = src_h * s->scale_nn;
+    display_draw_image_scaled_nn(x, y, data, src_w, src_h, dst_w, dst_h, s->transparent_color);
+  } else if (s->rotation != 0.0f || s->scale != 1.0f || s->scale_y != 1.0f) {
+    display_draw_image_scaled(x, y, src_w, src_h,
+                              data, s->scale, s->rotation,
+                              s->transparent_color);
+  } else {
+    const display_rle_image_t *rle =
+        s->frame_data ? s->frame_rle : s->image->rle;
+    if (rle && rle->key == effective_key(s->transparent_color) &&
+        rle->w == src_w && rle->h == src_h)
+      display_draw_rle(x, y, rle, 0, 0, src_w, src_h, s->flip_x, s->flip_y);
+    else
+      display_draw_image_partial(x, y, src_w, src_h,
+                                 data, 0, 0, src_w, src_h,
+                                 s->flip_x, s->flip_y, s->transparent_color);
+  }
+}
+
+// Compute the on-screen rectangle sprite_render() would touch, clipped to
+// the screen.  Returns false if the sprite draws nothing this frame.
+static bool sprite_screen_rect(const lua_sprite_t *s, display_rect_t *out) {
+  if (!s->updates_enabled || !s->visible || !s->image)
+    return false;
+
+  int src_w = s->frame_data ? s->frame_w : s->width;
+  int src_h = s->frame_data ? s->frame_h : s->height;
+  int x0, y0, x1, y1;
+
+  if (s->use_nn_scaling && s->scale_nn > 1) {
+    x0 = s->x;
+    y0 = s->y;
+    x1 = x0 + src_w * s->scale_nn;
+    y1 = y0 + src_h * s->scale_nn;
+  } else if (s->rotation != 0.0f || s->scale != 1.0f || s->scale_y != 1.0f) {
+    // Same centre/extent maths as display_draw_image_scaled(), padded by a
+    // pixel for the integer centre it hands to TGX.
+    float half_w = src_w * s->scale * 0.5f;
+    float half_h = src_h * s->scale * 0.5f;
+    float cx = s->x + half_w;
+    float cy = s->y + half_h;
+    float c = fabsf(cosf(s->rotation));
+    float sn = fabsf(sinf(s->rotation));
+    float ex = half_w * c + half_h * sn;
+    float ey = half_w * sn + half_h * c;
+    x0 = (int)floorf(cx - ex) - 1;
+    y0 = (int)floorf(cy - ey) - 1;
+    x1 = (int)ceilf(cx + ex) + 1;
+    y1 = (int)ceilf(cy + ey) + 1;
+  } else {
+    x0 = s->x;
+    y0 = s->y;
+    x1 = x0 + src_w;
+    y1 = y0 + src_h;
+  }
+
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 > FB_WIDTH) x1 = FB_WIDTH;
+  if (y1 > FB_HEIGHT) y1 = FB_HEIGHT;
+  if (x0 >= x1 || y0 >= y1)
+    return false;
+
+  out->x = (int16_t)x0;
+  out->y = (int16_t)y0;
+  out->w = (int16_t)(x1 - x0);
+  out->h = (int16_t)(y1 - y0);
+  return true;
+}
+
+static bool sprite_rects_intersect(const display_rect_t *a, int bx, int by,
+                                   int bw, int bh) {
+  return a->x < bx + bw && bx < a->x + a->w &&
+         a->y < by + bh && by < a->y + a->h;
+}
+
+#define SPRITE_COMPOSITE_PASSES 3
+
+static bool sprite_rect_covered(const display_rect_t *r,
+                                const display_rect_t *done, int n) {
+  for (int i = 0; i < n; i++)
+    if (r->x >= done[i].x && r->y >= done[i].y &&
+        r->x + r->w <= done[i].x + done[i].w &&
+        r->y + r->h <= done[i].y + done[i].h)
+      return true;
+  return false;
+}
+
+// Background callback, then each sprite drawn over r, clipped to r.  Leaves
+// the error on the stack on failure.
+static int sprite_composite_rect(lua_State *L, const display_rect_t *r) {
+  display_set_clip_rect(r->x, r->y, r->w, r->h);
+
+  lua_rawgeti(L, LUA_REGISTRYINDEX, s_sprite_bg_ref);
+  lua_pushinteger(L, r->x);
+  lua_pushinteger(L, r->y);
+  lua_pushinteger(L, r->w);
+  lua_pushinteger(L, r->h);
+  int status = lua_pcall(L, 4, 0, 0);
+  if (status != LUA_OK)
+    return status;
+
+  for (int j = 0; j < s_sprite_count; j++) {
+    lua_sprite_t *s = s_sprites[j];
+    if (s->drawn && sprite_rects_intersect(r, s->drawn_x, s->drawn_y,
+                                           s->drawn_w, s->drawn_h))
+      sprite_render(s, s->x, s->y);
+  }
+  return LUA_OK;
+}
+
+// Dirty-rect compositor: diff every sprite's bounds against what was drawn
+// last frame, then repaint only the changed areas — background callback
+// first, then each intersecting sprite — clipped to each rect.  The rects
+// stay queued in the display driver for display.flushDirty().
+static int sprite_composite(lua_State *L) {
+  // After a full display_flush() the back buffer is a frame behind.
+  if (!display_back_buffer_in_sync())
+    display_add_dirty_rect(0, 0, FB_WIDTH, FB_HEIGHT);
+
   for (int i = 0; i < s_sprite_count; i++) {
-    if (s_sprites[i] == s) {
-      for (int j = i; j < s_sprite_count - 1; j++)
-        s_sprites[j] = s_sprites[j + 1];
-      s_sprite_count--;
-      break;
+    lua_sprite_t *s = s_sprites[i];
+    display_rect_t r;
+    bool vis = sprite_screen_rect(s, &r);
+    bool changed = vis != s->drawn ||
+                   (vis && (r.x != s->drawn_x || r.y != s->drawn_y ||
+                            r.w != s->drawn_w || r.h != s->drawn_h));
+    if (changed || s->dirty || (vis && s->always_redraw)) {
+      sprite_invalidate_drawn(s);
+      if (vis)
+        display_add_dirty_rect(r.x, r.y, r.w, r.h);
     }
+    s->drawn = vis;
+    if (vis) {
+      s->drawn_x = r.x;
+      s->drawn_y = r.y;
+      s->drawn_w = r.w;
+      s->drawn_h = r.h;
+    }
+    s->dirty = false;
   }
+
+  // Composite in passes: the background and draw callbacks may add rects of
+  // their own, which get a pass of their own this frame (a bounded number,
+  // so a callback that always dirties something can't loop).  A rect wholly
+  // inside one already composited is skipped; one that merged with it is
+  // simply redone.
+  display_rect_t done[DISPLAY_MAX_DIRTY_RECTS * SPRITE_COMPOSITE_PASSES];
+  int ndone = 0;
+  for (int pass = 0; pass < SPRITE_COMPOSITE_PASSES; pass++) {
+    const display_rect_t *list;
+    display_rect_t rects[DISPLAY_MAX_DIRTY_RECTS];
+    int n = display_get_dirty_rects(&list);
+    memcpy(rects, list, n * sizeof(display_rect_t));
+
+    int fresh = 0;
+    for (int i = 0; i < n; i++) {
+      const display_rect_t *r = &rects[i];
+      if (sprite_rect_covered(r, done, ndone))
+        continue;
+      fresh++;
+      if (sprite_composite_rect(L, r) != LUA_OK) {
+        display_clear_clip_rect();
+        return lua_error(L);
+      }
+      done[ndone++] = *r;
+    }
+    if (fresh == 0)
+      break;
+  }
+  display_clear_clip_rect();
   return 0;
 }
 
 static int l_sprite_update(lua_State *L) {
+  if (s_sprite_bg_ref != LUA_NOREF)
+    return sprite_composite(L);
+
   for (int i = 0; i < s_sprite_count; i++) {
     lua_sprite_t *s = s_sprites[i];
-    if (s->updates_enabled && s->visible && s->image) {
-      int draw_x = s->x;
-      int draw_y = s->y;
-      // Use extracted frame if available, otherwise the full image
-      const uint16_t *data = s->frame_data ? s->frame_data : s->image->data;
-      int src_w = s->frame_data ? s->frame_w : s->width;
-      int src_h = s->frame_data ? s->frame_h : s->height;
-      
-      // Handle NN scaling
-      if (s->use_nn_scaling && s->scale_nn > 1) {
-        int dst_w = src_w * s->scale_nn;
-        int dst_h = src_h * s->scale_nn;
-        display_draw_image_scaled_nn(draw_x, draw_y, data, src_w, src_h, dst_w, dst_h, s->transparent_color);
-      } else if (s->rotation != 0.0f || s->scale != 1.0f || s->scale_y != 1.0f) {
-        display_draw_image_scaled(draw_x, draw_y, src_w, src_h,
-                                  data, s->scale, s->rotation,
-                                  s->transparent_color);
-      } else {
-        display_draw_image_partial(draw_x, draw_y, src_w, src_h,
-                                   data, 0, 0, src_w, src_h,
-                                   s->flip_x, s->flip_y, s->transparent_color);
-      }
-    }
+    if (s->updates_enabled && s->visible && s->image)
+      sprite_render(s, s->x, s->y);
   }
   return 0;
 }
@@ -906,16 +1613,14 @@ static int l_sprite_update(lua_State *L) {
 static int l_sprite_setImage(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   // Changing the image invalidates any extracted frame
-  if (s->frame_data) {
-    umm_free(s->frame_data);
-    s->frame_data = NULL;
-    s->frame_w = 0;
-    s->frame_h = 0;
-  }
+  sprite_free_frame(s);
+  if (s->redraws_on_image_change)
+    s->dirty = true;
   if (lua_isnil(L, 2)) {
     s->image = NULL;
     s->width = 0;
     s->height = 0;
+    sprite_grid_update(s);
     return 0;
   }
   s->image = (lua_image_t *)luaL_checkudata(L, 2, GRAPHICS_IMAGE_MT);
@@ -927,6 +1632,8 @@ static int l_sprite_setImage(lua_State *L) {
     s->scale = (float)lua_tonumber(L, 4);
   if (lua_isnumber(L, 5))
     s->scale_y = (float)lua_tonumber(L, 5);
+  sprite_build_rle(s);
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -942,6 +1649,7 @@ static int l_sprite_moveTo(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->x = luaL_checkinteger(L, 2);
   s->y = luaL_checkinteger(L, 3);
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -949,6 +1657,7 @@ static int l_sprite_moveBy(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->x += luaL_checkinteger(L, 2);
   s->y += luaL_checkinteger(L, 3);
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -962,6 +1671,7 @@ static int l_sprite_getPosition(lua_State *L) {
 static int l_sprite_setZIndex(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->z_index = luaL_checkinteger(L, 2);
+  sprite_registry_resort(s);
   return 0;
 }
 
@@ -1011,6 +1721,7 @@ static int l_sprite_setSize(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->width = luaL_checkinteger(L, 2);
   s->height = luaL_checkinteger(L, 3);
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -1025,6 +1736,8 @@ static int l_sprite_setScale(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->scale = (float)luaL_checknumber(L, 2);
   s->scale_y = lua_isnumber(L, 3) ? (float)lua_tonumber(L, 3) : s->scale;
+  s->dirty = true;
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -1042,6 +1755,8 @@ static int l_sprite_setRotation(lua_State *L) {
     s->scale = (float)lua_tonumber(L, 3);
   if (lua_isnumber(L, 4))
     s->scale_y = (float)lua_tonumber(L, 4);
+  s->dirty = true;
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -1059,6 +1774,7 @@ static int l_sprite_setScaleNN(lua_State *L) {
   
   s->scale_nn = scale;
   s->use_nn_scaling = true;
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -1069,6 +1785,8 @@ static int l_sprite_setTransparentColor(lua_State *L) {
   } else {
     s->transparent_color = l_checkcolor(L, 2);
   }
+  sprite_build_rle(s);
+  s->dirty = true;
   return 0;
 }
 
@@ -1076,6 +1794,10 @@ static int l_sprite_copy(lua_State *L) {
   lua_sprite_t *src = check_sprite(L, 1);
   lua_sprite_t *dst = (lua_sprite_t *)lua_newuserdata(L, sizeof(lua_sprite_t));
   memcpy(dst, src, sizeof(lua_sprite_t));
+  dst->drawn = false;
+  dst->reg_index = -1;  // copies start outside the sprite list
+  dst->in_grid = false;
+  dst->frame_rle = NULL;  // rebuilt below; never shared
   // Deep-copy extracted frame data so each sprite owns its buffer
   if (src->frame_data && src->frame_w > 0 && src->frame_h > 0) {
     int sz = src->frame_w * src->frame_h * sizeof(uint16_t);
@@ -1084,6 +1806,7 @@ static int l_sprite_copy(lua_State *L) {
       memcpy(dst->frame_data, src->frame_data, sz);
     else
       dst->frame_data = NULL;
+    sprite_build_rle(dst);
   }
   luaL_setmetatable(L, GRAPHICS_SPRITE_MT);
   return 1;
@@ -1105,10 +1828,7 @@ static int l_sprite_setSourceRect(lua_State *L) {
   if (sy + sh > s->image->h) sh = s->image->h - sy;
   if (sw <= 0 || sh <= 0) return 0;
 
-  if (s->frame_data) {
-    umm_free(s->frame_data);
-    s->frame_data = NULL;
-  }
+  sprite_free_frame(s);
 
   s->frame_data = (uint16_t *)umm_malloc(sw * sh * sizeof(uint16_t));
   if (!s->frame_data) return 0;
@@ -1120,16 +1840,18 @@ static int l_sprite_setSourceRect(lua_State *L) {
 
   s->frame_w = sw;
   s->frame_h = sh;
+  sprite_build_rle(s);
+  s->dirty = true;
+  sprite_grid_update(s);
   return 0;
 }
 
 static int l_sprite_clearSourceRect(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   if (s->frame_data) {
-    umm_free(s->frame_data);
-    s->frame_data = NULL;
-    s->frame_w = 0;
-    s->frame_h = 0;
+    sprite_free_frame(s);
+    s->dirty = true;
+    sprite_grid_update(s);
   }
   return 0;
 }
@@ -1165,6 +1887,7 @@ static int l_sprite_setImageDrawMode(lua_State *L) {
 static int l_sprite_setImageFlip(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   s->flip_x = lua_toboolean(L, 2);
+  s->dirty = true;
   return 0;
 }
 
@@ -1244,58 +1967,33 @@ static int l_sprite_draw(lua_State *L) {
   
   if (!s->visible || !s->image)
     return 0;
-    
-  // Use extracted frame if available
-  const uint16_t *data = s->frame_data ? s->frame_data : s->image->data;
-  int src_w = s->frame_data ? s->frame_w : s->width;
-  int src_h = s->frame_data ? s->frame_h : s->height;
-  
-  // Handle NN scaling
-  if (s->use_nn_scaling && s->scale_nn > 1) {
-    int dst_w = src_w * s->scale_nn;
-    int dst_h = src_h * s->scale_nn;
-    display_draw_image_scaled_nn(x, y, data, src_w, src_h, dst_w, dst_h, s->transparent_color);
-  } else if (s->rotation != 0.0f || s->scale != 1.0f || s->scale_y != 1.0f) {
-    display_draw_image_scaled(x, y, src_w, src_h,
-                              data, s->scale,
-                              s->rotation, s->transparent_color);
-  } else {
-    display_draw_image_partial(x, y, src_w, src_h,
-                               data, 0, 0, src_w, src_h,
-                               s->flip_x, s->flip_y, s->transparent_color);
-  }
+
+  sprite_render(s, x, y);
   return 0;
 }
 
 static int l_sprite_updateSingle(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
-  if (s->updates_enabled && s->visible && s->image) {
-    int draw_x = s->x;
-    int draw_y = s->y;
-    // Use extracted frame if available
-    const uint16_t *data = s->frame_data ? s->frame_data : s->image->data;
-    int src_w = s->frame_data ? s->frame_w : s->width;
-    int src_h = s->frame_data ? s->frame_h : s->height;
-    
-    // Handle NN scaling
-    if (s->use_nn_scaling && s->scale_nn > 1) {
-      int dst_w = src_w * s->scale_nn;
-      int dst_h = src_h * s->scale_nn;
-      display_draw_image_scaled_nn(draw_x, draw_y, data, src_w, src_h, dst_w, dst_h, s->transparent_color);
-    } else if (s->rotation != 0.0f || s->scale != 1.0f || s->scale_y != 1.0f) {
-      display_draw_image_scaled(draw_x, draw_y, src_w, src_h,
-                                data, s->scale,
-                                s->rotation, s->transparent_color);
-    } else {
-      display_draw_image_partial(draw_x, draw_y, src_w, src_h,
-                               data, 0, 0, src_w, src_h,
-                               s->flip_x, s->flip_y, s->transparent_color);
-    }
-  }
+  if (s->updates_enabled && s->visible && s->image)
+    sprite_render(s, s->x, s->y);
   return 0;
 }
 
+// sprite.setBackgroundDrawingCallback(fn) — also callable as a method.
+// fn(x, y, w, h) must repaint the background inside that rect; drawing is
+// clipped to it.  Setting a callback switches sprite.update() to dirty-rect
+// compositing; nil switches back to drawing every sprite every frame.
 static int l_sprite_setBackgroundDrawingCallback(lua_State *L) {
+  int idx = lua_isuserdata(L, 1) ? 2 : 1;
+  if (s_sprite_bg_ref != LUA_NOREF)
+    luaL_unref(L, LUA_REGISTRYINDEX, s_sprite_bg_ref);
+  s_sprite_bg_ref = LUA_NOREF;
+  if (!lua_isnoneornil(L, idx)) {
+    luaL_checktype(L, idx, LUA_TFUNCTION);
+    lua_pushvalue(L, idx);
+    s_sprite_bg_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+  }
+  display_add_dirty_rect(0, 0, FB_WIDTH, FB_HEIGHT);
   return 0;
 }
 
@@ -1343,20 +2041,28 @@ static int l_sprite_newindex(lua_State *L) {
 
   if (!strcmp(key, "x")) {
     s->x = luaL_checkinteger(L, 3);
+    sprite_grid_update(s);
   } else if (!strcmp(key, "y")) {
     s->y = luaL_checkinteger(L, 3);
+    sprite_grid_update(s);
   } else if (!strcmp(key, "width")) {
     s->width = luaL_checkinteger(L, 3);
+    sprite_grid_update(s);
   } else if (!strcmp(key, "height")) {
     s->height = luaL_checkinteger(L, 3);
+    sprite_grid_update(s);
   } else if (!strcmp(key, "z")) {
     s->z_index = luaL_checkinteger(L, 3);
+    sprite_registry_resort(s);
   } else if (!strcmp(key, "visible")) {
     s->visible = lua_toboolean(L, 3);
   } else if (!strcmp(key, "scale")) {
     s->scale = (float)luaL_checknumber(L, 3);
+    s->dirty = true;
+    sprite_grid_update(s);
   } else if (!strcmp(key, "rotation")) {
     s->rotation = (float)luaL_checknumber(L, 3);
+    s->dirty = true;
   } else if (!strcmp(key, "tag")) {
     s->tag = luaL_checkinteger(L, 3);
   }
@@ -1463,8 +2169,17 @@ static int l_sprite_spriteCount(lua_State *L) {
 }
 
 static int l_sprite_removeAll(lua_State *L) {
-  (void)L;
+  for (int i = 0; i < s_sprite_count; i++) {
+    lua_sprite_t *s = s_sprites[i];
+    s->reg_index = -1;
+    s->in_grid = false;
+    sprite_invalidate_drawn(s);
+  }
   s_sprite_count = 0;
+  sprite_grid_clear();
+  luaL_unref(L, LUA_REGISTRYINDEX, s_sprite_anchor_ref);
+  lua_newtable(L);
+  s_sprite_anchor_ref = luaL_ref(L, LUA_REGISTRYINDEX);
   return 0;
 }
 
@@ -1476,14 +2191,9 @@ static int l_sprite_removeSprites(lua_State *L) {
     lua_rawgeti(L, 1, r);
     lua_sprite_t *target = (lua_sprite_t *)luaL_checkudata(L, -1, GRAPHICS_SPRITE_MT);
     lua_pop(L, 1);
-    
-    for (int i = 0; i < s_sprite_count; i++) {
-      if (s_sprites[i] == target) {
-        for (int j = i; j < s_sprite_count - 1; j++)
-          s_sprites[j] = s_sprites[j + 1];
-        s_sprite_count--;
-        break;
-      }
+    if (target->reg_index >= 0) {
+      sprite_registry_remove(target);
+      sprite_unanchor(L, target);
     }
   }
   return 0;
@@ -1540,6 +2250,7 @@ static int l_sprite_setCollideRect(lua_State *L) {
     s->collide_w = luaL_checkinteger(L, 4);
     s->collide_h = luaL_checkinteger(L, 5);
   }
+  sprite_grid_update(s);
   return 0;
 }
 
@@ -1569,24 +2280,10 @@ static int l_sprite_clearCollideRect(lua_State *L) {
   s->collide_y = 0;
   s->collide_w = s->width;
   s->collide_h = s->height;
+  sprite_grid_update(s);
   return 0;
 }
 
-// Returns the effective on-screen pixel dimensions of a sprite.
-// Uses frame dimensions if a source rect has been extracted, otherwise the
-// full image dimensions, then applies NN or bilinear scaling.
-static void sprite_visual_size(const lua_sprite_t *s, int *w, int *h) {
-  int bw = s->frame_w > 0 ? s->frame_w : s->width;
-  int bh = s->frame_h > 0 ? s->frame_h : s->height;
-  if (s->use_nn_scaling && s->scale_nn > 1) {
-    *w = bw * s->scale_nn;
-    *h = bh * s->scale_nn;
-  } else {
-    *w = (int)(bw * s->scale);
-    *h = (int)(bh * s->scale_y);
-  }
-}
-
 static bool spritesOverlap(lua_sprite_t *a, lua_sprite_t *b) {
   if (!a->collisions_enabled || !b->collisions_enabled) return false;
 
@@ -1610,9 +2307,12 @@ static int l_sprite_overlappingSprites(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   lua_createtable(L, 0, 0);
   int count = 0;
-  
-  for (int i = 0; i < s_sprite_count; i++) {
-    lua_sprite_t *other = s_sprites[i];
+
+  int x, y, w, h, n;
+  sprite_collide_bounds_at(s, s->x, s->y, &x, &y, &w, &h);
+  lua_sprite_t **cand = sprite_grid_candidates(x, y, w, h, &n);
+  for (int i = 0; i < n; i++) {
+    lua_sprite_t *other = cand[i];
     if (other != s && spritesOverlap(s, other)) {
       lua_pushlightuserdata(L, other);
       lua_rawseti(L, -2, ++count);
@@ -1628,11 +2328,16 @@ static int l_sprite_allOverlappingSprites(lua_State *L) {
   for (int i = 0; i < s_sprite_count; i++) {
     lua_sprite_t *a = s_sprites[i];
     if (!a->collisions_enabled) continue;
-    
-    for (int j = i + 1; j < s_sprite_count; j++) {
-      lua_sprite_t *b = s_sprites[j];
-      if (!b->collisions_enabled) continue;
-      
+
+    // Candidates come back in list order; take only those after a so each
+    // pair is reported once, as the old i < j scan did.
+    int x, y, w, h, n;
+    sprite_collide_bounds_at(a, a->x, a->y, &x, &y, &w, &h);
+    lua_sprite_t **cand = sprite_grid_candidates(x, y, w, h, &n);
+    for (int j = 0; j < n; j++) {
+      lua_sprite_t *b = cand[j];
+      if (b->reg_index <= i || !b->collisions_enabled) continue;
+
       if (spritesOverlap(a, b)) {
         lua_createtable(L, 2, 0);
 
@@ -1737,9 +2442,11 @@ static int l_sprite_querySpritesAtPoint(lua_State *L) {
   
   lua_createtable(L, 0, 0);
   int count = 0;
-  
-  for (int i = 0; i < s_sprite_count; i++) {
-    lua_sprite_t *s = s_sprites[i];
+
+  int n;
+  lua_sprite_t **cand = sprite_grid_candidates(px, py, 1, 1, &n);
+  for (int i = 0; i < n; i++) {
+    lua_sprite_t *s = cand[i];
     int sx = s->x + s->collide_x;
     int sy = s->y + s->collide_y;
     
@@ -1776,9 +2483,11 @@ static int l_sprite_querySpritesInRect(lua_State *L) {
   
   lua_createtable(L, 0, 0);
   int count = 0;
-  
-  for (int i = 0; i < s_sprite_count; i++) {
-    lua_sprite_t *s = s_sprites[i];
+
+  int n;
+  lua_sprite_t **cand = sprite_grid_candidates(rx, ry, rw, rh, &n);
+  for (int i = 0; i < n; i++) {
+    lua_sprite_t *s = cand[i];
     int sx = s->x + s->collide_x;
     int sy = s->y + s->collide_y;
     
@@ -1803,45 +2512,109 @@ static int l_sprite_querySpritesInRect(lua_State *L) {
 #define COLLISION_OVERLAP 3
 #define COLLISION_BOUNCE  4
 
-// Helper: get collision bounds for a sprite at position (px, py)
-static void sprite_collide_bounds_at(const lua_sprite_t *s, int px, int py,
-                                      int *ox, int *oy, int *ow, int *oh) {
-  int cw, ch;
-  if (s->collide_w > 0) { cw = s->collide_w; ch = s->collide_h; }
-  else                   { sprite_visual_size(s, &cw, &ch); }
-  *ox = px + s->collide_x;
-  *oy = py + s->collide_y;
-  *ow = cw;
-  *oh = ch;
+// One resolved contact from sprite_move_swept().
+typedef struct {
+  lua_sprite_t *other;
+  int normal_x, normal_y;
+  int touch_x, touch_y;  // sprite position when contact was made
+} sprite_hit_t;
+
+static bool sprite_can_hit(const lua_sprite_t *s, const lua_sprite_t *other) {
+  if (other == s || !other->collisions_enabled) return false;
+  // Group mask check: if both masks are non-zero, require overlap
+  if (s->collides_with_mask && other->group_mask &&
+      !(s->collides_with_mask & other->group_mask)) return false;
+  return true;
+}
+
+// Nearest blocker along one axis.  (a0, a1) is the mover's extent on the
+// sweep axis and (c0, c1) on the other; d is the signed move distance.
+// Sprites overlapping the mover before the move, or behind it, don't block,
+// so a sprite that starts embedded can always move out.  Returns the
+// distance actually travelled (always toward d) and the blocker, if any.
+static int sprite_sweep_axis(const lua_sprite_t *s, lua_sprite_t **cand, int n,
+                             bool x_axis, int a0, int a1, int c0, int c1,
+                             int d, lua_sprite_t **hit_out) {
+  int allowed = abs(d);
+  *hit_out = NULL;
+  for (int i = 0; i < n; i++) {
+    lua_sprite_t *other = cand[i];
+    if (!sprite_can_hit(s, other)) continue;
+    int bx, by, bw, bh;
+    sprite_collide_bounds_at(other, other->x, other->y, &bx, &by, &bw, &bh);
+    int b0 = x_axis ? bx : by, b1 = b0 + (x_axis ? bw : bh);
+    int e0 = x_axis ? by : bx, e1 = e0 + (x_axis ? bh : bw);
+    if (c0 >= e1 || c1 <= e0) continue;  // no overlap across the sweep
+    int gap = d > 0 ? b0 - a1 : a0 - b1;
+    if (gap >= 0 && gap < allowed) {
+      allowed = gap;
+      *hit_out = other;
+    }
+  }
+  return d > 0 ? allowed : -allowed;
 }
 
-// Helper: check if sprite `s` at position (sx, sy) overlaps any other sprite
-// in the active list, respecting group masks.
-static bool sprite_overlaps_any_at(lua_sprite_t *s, int sx, int sy,
-                                    lua_sprite_t **hit_out) {
+// Move s toward (goal_x, goal_y) with continuous swept-AABB resolution:
+// X first, then Y from wherever X stopped, so movers slide along walls and
+// never tunnel however far they travel in one call.  The broadphase is a
+// single grid query over the whole swept box.  Writes up to two contacts
+// to hits[] and returns how many; s is left at the resolved position.
+static int sprite_move_swept(lua_sprite_t *s, int goal_x, int goal_y,
+                             sprite_hit_t hits[2]) {
   int ax, ay, aw, ah;
-  sprite_collide_bounds_at(s, sx, sy, &ax, &ay, &aw, &ah);
+  sprite_collide_bounds_at(s, s->x, s->y, &ax, &ay, &aw, &ah);
+  int dx = goal_x - s->x;
+  int dy = goal_y - s->y;
+  int nhits = 0;
+
+  if (s->collisions_enabled && aw > 0 && ah > 0 && (dx || dy)) {
+    int qx = dx < 0 ? ax + dx : ax;
+    int qy = dy < 0 ? ay + dy : ay;
+    int n;
+    lua_sprite_t **cand =
+        sprite_grid_candidates(qx, qy, aw + abs(dx), ah + abs(dy), &n);
+    lua_sprite_t *hit;
+
+    if (dx) {
+      ax += sprite_sweep_axis(s, cand, n, true, ax, ax + aw, ay, ay + ah, dx,
+                              &hit);
+      if (hit) {
+        hits[nhits++] = (sprite_hit_t){hit, dx > 0 ? -1 : 1, 0,
+                                       ax - s->collide_x, s->y};
+      }
+    }
+    if (dy) {
+      ay += sprite_sweep_axis(s, cand, n, false, ay, ay + ah, ax, ax + aw, dy,
+                              &hit);
+      if (hit) {
+        hits[nhits++] = (sprite_hit_t){hit, 0, dy > 0 ? -1 : 1,
+                                       ax - s->collide_x, ay - s->collide_y};
+      }
+    }
+    goal_x = ax - s->collide_x;
+    goal_y = ay - s->collide_y;
+  }
 
-  for (int i = 0; i < s_sprite_count; i++) {
-    lua_sprite_t *other = s_sprites[i];
-    if (other == s || !other->collisions_enabled) continue;
-    // Group mask check: if both masks are non-zero, require overlap
-    if (s->collides_with_mask && other->group_mask &&
-        !(s->collides_with_mask & other->group_mask)) continue;
+  s->x = goal_x;
+  s->y = goal_y;
+  sprite_grid_update(s);
+  return nhits;
+}
 
-    int bx, by, bw, bh;
-    sprite_collide_bounds_at(other, other->x, other->y, &bx, &by, &bw, &bh);
-    if (ax < bx + bw && ax + aw > bx && ay < by + bh && ay + ah > by) {
-      if (hit_out) *hit_out = other;
-      return true;
-    }
+// Push the sprite userdata for s (added sprites are looked up in the anchor
+// table), falling back to lightuserdata for sprites not in the list.
+static void sprite_push(lua_State *L, lua_sprite_t *s) {
+  lua_rawgeti(L, LUA_REGISTRYINDEX, s_sprite_anchor_ref);
+  if (lua_rawgetp(L, -1, s) == LUA_TNIL) {
+    lua_pop(L, 1);
+    lua_pushlightuserdata(L, s);
   }
-  return false;
+  lua_remove(L, -2);
 }
 
 // sprite:moveWithCollisions(goalX, goalY)
 // Returns: actualX, actualY, collisions
-// Collisions is a table of {sprite, other, type, normal, touch, move}
+// Collisions is a table of {sprite, other, type, normal, touch}
 static int l_sprite_moveWithCollisions(lua_State *L) {
   lua_sprite_t *s = check_sprite(L, 1);
   int goalX, goalY;
@@ -1857,128 +2630,105 @@ static int l_sprite_moveWithCollisions(lua_State *L) {
     goalY = luaL_checkinteger(L, 3);
   }
 
-  if (!s->collisions_enabled) {
-    s->x = goalX;
-    s->y = goalY;
-    lua_pushinteger(L, goalX);
-    lua_pushinteger(L, goalY);
-    lua_newtable(L);
-    return 3;
-  }
+  sprite_hit_t hits[2];
+  int nhits = sprite_move_swept(s, goalX, goalY, hits);
 
-  int startX = s->x, startY = s->y;
-  int dx = goalX - startX;
-  int dy = goalY - startY;
+  lua_pushinteger(L, s->x);
+  lua_pushinteger(L, s->y);
+  lua_createtable(L, nhits, 0); // collisions table
+  for (int i = 0; i < nhits; i++) {
+    lua_createtable(L, 0, 5);
+
+    lua_pushvalue(L, 1);
+    lua_setfield(L, -2, "sprite");
+    sprite_push(L, hits[i].other);
+    lua_setfield(L, -2, "other");
+    lua_pushinteger(L, COLLISION_SLIDE);
+    lua_setfield(L, -2, "type");
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, hits[i].normal_x);
+    lua_setfield(L, -2, "x");
+    lua_pushinteger(L, hits[i].normal_y);
+    lua_setfield(L, -2, "y");
+    lua_setfield(L, -2, "normal");
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, hits[i].touch_x);
+    lua_setfield(L, -2, "x");
+    lua_pushinteger(L, hits[i].touch_y);
+    lua_setfield(L, -2, "y");
+    lua_setfield(L, -2, "touch");
 
-  lua_createtable(L, 0, 0); // collisions table
-  int coll_count = 0;
+    lua_rawseti(L, -2, i + 1);
+  }
+  return 3;
+}
 
-  // Try X movement first, then Y (axis-separated resolution)
-  int finalX = startX, finalY = startY;
+// Values written to the results table per collision by
+// moveAllWithCollisions: sprite, other, normalX, normalY, touchX, touchY.
+#define SPRITE_HIT_FIELDS 6
 
-  // --- X axis ---
-  if (dx != 0) {
-    lua_sprite_t *hit = NULL;
-    if (!sprite_overlaps_any_at(s, goalX, startY, &hit)) {
-      finalX = goalX;
-    } else {
-      int step = (dx > 0) ? 1 : -1;
-      int best = startX;
-      // Simple sweep: step pixel by pixel (capped at 320 iterations max)
-      int steps = abs(dx);
-      if (steps > FB_WIDTH) steps = FB_WIDTH;
-      for (int i = 1; i <= steps; i++) {
-        int testX = startX + step * i;
-        if (sprite_overlaps_any_at(s, testX, startY, &hit)) {
-          // Record collision
-          coll_count++;
-          lua_createtable(L, 0, 6);
-
-          // sprite (self)
-          lua_pushlightuserdata(L, s);
-          lua_setfield(L, -2, "sprite");
-          // other
-          lua_pushlightuserdata(L, hit);
-          lua_setfield(L, -2, "other");
-          // type (default: slide)
-          lua_pushinteger(L, COLLISION_SLIDE);
-          lua_setfield(L, -2, "type");
-          // normal
-          lua_createtable(L, 0, 2);
-          lua_pushinteger(L, dx > 0 ? -1 : 1);
-          lua_setfield(L, -2, "x");
-          lua_pushinteger(L, 0);
-          lua_setfield(L, -2, "y");
-          lua_setfield(L, -2, "normal");
-          // touch point
-          lua_createtable(L, 0, 2);
-          lua_pushinteger(L, best);
-          lua_setfield(L, -2, "x");
-          lua_pushinteger(L, startY);
-          lua_setfield(L, -2, "y");
-          lua_setfield(L, -2, "touch");
-
-          lua_rawseti(L, -2, coll_count);
-          break;
-        }
-        best = testX;
-      }
-      finalX = best;
-    }
+// sprite.moveAllWithCollisions(moves [, results])
+// moves is flat: {sprite1, goalX1, goalY1, sprite2, goalX2, goalY2, ...}.
+// Sprites are resolved in order, each against the others' updated
+// positions.  Collisions are written flat into `results` (reused when given,
+// so a game loop allocates nothing per frame); stale entries past the end
+// are cleared.  Returns: collision count, results
+static int l_sprite_moveAllWithCollisions(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TTABLE);
+  if (lua_isnoneornil(L, 2)) {
+    lua_settop(L, 1);
+    lua_newtable(L);
+  } else {
+    luaL_checktype(L, 2, LUA_TTABLE);
+    lua_settop(L, 2);
   }
 
-  // --- Y axis ---
-  if (dy != 0) {
-    lua_sprite_t *hit = NULL;
-    if (!sprite_overlaps_any_at(s, finalX, goalY, &hit)) {
-      finalY = goalY;
-    } else {
-      int step = (dy > 0) ? 1 : -1;
-      int best = startY;
-      int steps = abs(dy);
-      if (steps > FB_HEIGHT) steps = FB_HEIGHT;
-      for (int i = 1; i <= steps; i++) {
-        int testY = startY + step * i;
-        if (sprite_overlaps_any_at(s, finalX, testY, &hit)) {
-          coll_count++;
-          lua_createtable(L, 0, 6);
-
-          lua_pushlightuserdata(L, s);
-          lua_setfield(L, -2, "sprite");
-          lua_pushlightuserdata(L, hit);
-          lua_setfield(L, -2, "other");
-          lua_pushinteger(L, COLLISION_SLIDE);
-          lua_setfield(L, -2, "type");
-          lua_createtable(L, 0, 2);
-          lua_pushinteger(L, 0);
-          lua_setfield(L, -2, "x");
-          lua_pushinteger(L, dy > 0 ? -1 : 1);
-          lua_setfield(L, -2, "y");
-          lua_setfield(L, -2, "normal");
-          lua_createtable(L, 0, 2);
-          lua_pushinteger(L, finalX);
-          lua_setfield(L, -2, "x");
-          lua_pushinteger(L, best);
-          lua_setfield(L, -2, "y");
-          lua_setfield(L, -2, "touch");
-
-          lua_rawseti(L, -2, coll_count);
-          break;
-        }
-        best = testY;
-      }
-      finalY = best;
+  int n = (int)lua_rawlen(L, 1);
+  if (n % 3 != 0)
+    return luaL_error(L, "moves must be sprite, x, y triples");
+
+  int out = 0;
+  for (int i = 1; i <= n; i += 3) {
+    lua_rawgeti(L, 1, i);
+    lua_sprite_t *s = (lua_sprite_t *)luaL_testudata(L, -1, GRAPHICS_SPRITE_MT);
+    if (!s)
+      return luaL_error(L, "moves[%d] is not a sprite", i);
+    int okx, oky;
+    lua_rawgeti(L, 1, i + 1);
+    lua_rawgeti(L, 1, i + 2);
+    int gx = (int)lua_tointegerx(L, -2, &okx);
+    int gy = (int)lua_tointegerx(L, -1, &oky);
+    if (!okx || !oky)
+      return luaL_error(L, "moves[%d..%d] must be integer coordinates", i + 1, i + 2);
+    lua_pop(L, 2);
+
+    sprite_hit_t hits[2];
+    int nhits = sprite_move_swept(s, gx, gy, hits);
+    for (int h = 0; h < nhits; h++) {
+      lua_pushvalue(L, -1);
+      lua_rawseti(L, 2, ++out);
+      sprite_push(L, hits[h].other);
+      lua_rawseti(L, 2, ++out);
+      lua_pushinteger(L, hits[h].normal_x);
+      lua_rawseti(L, 2, ++out);
+      lua_pushinteger(L, hits[h].normal_y);
+      lua_rawseti(L, 2, ++out);
+      lua_pushinteger(L, hits[h].touch_x);
+      lua_rawseti(L, 2, ++out);
+      lua_pushinteger(L, hits[h].touch_y);
+      lua_rawseti(L, 2, ++out);
     }
+    lua_pop(L, 1);
   }
 
-  s->x = finalX;
-  s->y = finalY;
+  for (int k = (int)lua_rawlen(L, 2); k > out; k--) {
+    lua_pushnil(L);
+    lua_rawseti(L, 2, k);
+  }
 
-  lua_pushinteger(L, finalX);
-  lua_pushinteger(L, finalY);
-  lua_pushvalue(L, -3); // push the collisions table
-  lua_remove(L, -4);    // remove the original table position
-  return 3;
+  lua_pushinteger(L, out / SPRITE_HIT_FIELDS);
+  lua_pushvalue(L, 2);
+  return 2;
 }
 
 // sprite:collisionResponse(other) — returns response type string
@@ -2040,9 +2790,14 @@ static int l_sprite_markDirty(lua_State *L) {
   return 0;
 }
 
+// sprite.addDirtyRect(x, y, w, h) — also callable as a method.  Forces the
+// compositor to repaint that area next update (e.g. under a HUD change).
 static int l_sprite_addDirtyRect(lua_State *L) {
-  lua_sprite_t *s = check_sprite(L, 1);
-  (void)s;
+  int base = lua_isuserdata(L, 1) ? 2 : 1;
+  display_add_dirty_rect((int)luaL_checkinteger(L, base),
+                         (int)luaL_checkinteger(L, base + 1),
+                         (int)luaL_checkinteger(L, base + 2),
+                         (int)luaL_checkinteger(L, base + 3));
   return 0;
 }
 
@@ -2412,11 +3167,9 @@ static int l_sprite_addEmptyCollisionSprite(lua_State *L) {
     h = luaL_checkinteger(L, 4);
   }
 
-  if (s_sprite_count >= MAX_SPRITES)
-    return luaL_error(L, "max sprites reached");
-
   lua_sprite_t *s = (lua_sprite_t *)lua_newuserdata(L, sizeof(lua_sprite_t));
   memset(s, 0, sizeof(lua_sprite_t));
+  s->reg_index = -1;
   s->x = x;
   s->y = y;
   s->width = w;
@@ -2436,7 +3189,9 @@ static int l_sprite_addEmptyCollisionSprite(lua_State *L) {
 
   luaL_setmetatable(L, GRAPHICS_SPRITE_MT);
 
-  s_sprites[s_sprite_count++] = s;
+  if (!sprite_registry_add(s))
+    return luaL_error(L, "out of memory for sprite list");
+  sprite_anchor(L, s, -1);
 
   return 1;  // return the sprite userdata
 }
@@ -2458,6 +3213,9 @@ static const luaL_Reg l_sprite_lib[] = {
     {"setClipRectsInRange", l_sprite_setClipRectsInRange},
     {"clearClipRectsInRange", l_sprite_clearClipRectsInRange},
     {"addEmptyCollisionSprite", l_sprite_addEmptyCollisionSprite},
+    {"setBackgroundDrawingCallback", l_sprite_setBackgroundDrawingCallback},
+    {"addDirtyRect", l_sprite_addDirtyRect},
+    {"moveAllWithCollisions", l_sprite_moveAllWithCollisions},
     {NULL, NULL}};
 
 // ── Spritesheet System ─────────────────────────────────────────────────────────
@@ -2585,11 +3343,9 @@ static int l_spritesheet_drawFrame(lua_State *L) {
   
   bool flip = lua_toboolean(L, 5);
   
-  display_draw_image_partial(x, y, ss->image->w, ss->image->h,
-                            ss->image->data,
-                            ss->frame_x[frame_idx], ss->frame_y[frame_idx],
-                            ss->frame_w[frame_idx], ss->frame_h[frame_idx],
-                            flip, false, 0);
+  image_blit(ss->image, 0, x, y, ss->frame_x[frame_idx],
+             ss->frame_y[frame_idx], ss->frame_w[frame_idx],
+             ss->frame_h[frame_idx], flip, false);
   return 0;
 }
 
@@ -2698,8 +3454,7 @@ static int l_animation_loop_draw(lua_State *L) {
     return 0;
 
   lua_image_t *img = loop->frames[loop->current_frame];
-  display_draw_image_partial(x, y, img->w, img->h, img->data,
-                            0, 0, img->w, img->h, flip, false, 0);
+  image_blit(img, 0, x, y, 0, 0, img->w, img->h, flip, false);
   return 0;
 }
 
@@ -3347,7 +4102,11 @@ static const luaL_Reg l_font_lib[] = {
     {NULL, NULL}};
 
 void lua_bridge_graphics_init(lua_State *L) {
-  s_sprite_count = 0;  // reset on each app launch
+  s_sprite_count = 0;  // reset on each app launch; the list memory is reused
+  sprite_grid_clear();
+  lua_newtable(L);
+  s_sprite_anchor_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+  s_sprite_bg_ref = LUA_NOREF;  // refs belong to the previous lua_State
   s_blinker_count = 0;  // reset blinkers on each app launch
   s_has_global_stencil = false;
   memset(s_global_stencil, 0, sizeof(s_global_stencil));
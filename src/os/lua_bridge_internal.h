@@ -38,6 +38,8 @@ typedef struct {
     int h;
     uint16_t *data;
     uint16_t  transparent_color;  // 0 = disabled
+    display_rle_image_t *rle;     // run-length form from optimize(), or NULL
+    struct image_cache_entry *cache; // owner of data when shared, or NULL
 } lua_image_t;
 
 #define GRAPHICS_IMAGE_MT "picocalc.graphics.image"
@@ -46,6 +48,7 @@ uint16_t l_checkcolor(lua_State *L, int idx);
 bool fs_sandbox_check(lua_State *L, const char *path, bool write);
 void http_lua_fire_pending(lua_State *L);
 void tcp_lua_fire_pending(lua_State *L);
+void fs_lua_fire_pending(lua_State *L);
 extern bool s_screenshot_pending;
 
 void register_subtable(lua_State *L, const char *name, const luaL_Reg *funcs);
@@ -127,12 +127,28 @@ static int l_sound_sample_getFormat(lua_State *L) {
     lua_setfield(L, -2, "channels");
     lua_pushinteger(L, sample->sample_rate);
     lua_setfield(L, -2, "sampleRate");
+    lua_pushboolean(L, sample->adpcm);
+    lua_setfield(L, -2, "compressed");
     return 1;
 }
 
+// ADPCM samples are mixed straight from their compressed blocks; this is only
+// needed for a PCM copy (e.g. to trade memory for mixing time).
 static int l_sound_sample_decompress(lua_State *L) {
-    check_sample(L, 1);
-    lua_pushvalue(L, 1);
+    sound_sample_t *sample = check_sample(L, 1);
+    if (!sample->adpcm) {
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+    sound_sample_t *pcm = sound_sample_decompress(sample);
+    if (!pcm) {
+        lua_pushnil(L);
+        lua_pushstring(L, "out of memory");
+        return 2;
+    }
+    sound_sample_t **ud = lua_newuserdata(L, sizeof(sound_sample_t *));
+    *ud = pcm;
+    luaL_setmetatable(L, SAMPLE_USERDATA);
     return 1;
 }
 
@@ -309,6 +325,33 @@ static int l_sound_sampleplayer_getRate(lua_State *L) {
     return 1;
 }
 
+static int l_sound_sampleplayer_setPriority(lua_State *L) {
+    sound_player_t *player = check_player(L, 1);
+    lua_Integer priority = luaL_checkinteger(L, 2);
+    if (priority < 0) priority = 0;
+    if (priority > 255) priority = 255;
+    sound_player_set_priority(player, (uint8_t)priority);
+    return 0;
+}
+
+static int l_sound_sampleplayer_getPriority(lua_State *L) {
+    sound_player_t *player = check_player(L, 1);
+    lua_pushinteger(L, sound_player_get_priority(player));
+    return 1;
+}
+
+static int l_sound_sampleplayer_setInterpolation(lua_State *L) {
+    sound_player_t *player = check_player(L, 1);
+    sound_player_set_interpolation(player, lua_toboolean(L, 2));
+    return 0;
+}
+
+static int l_sound_sampleplayer_getInterpolation(lua_State *L) {
+    sound_player_t *player = check_player(L, 1);
+    lua_pushboolean(L, sound_player_get_interpolation(player));
+    return 1;
+}
+
 static int l_sound_sampleplayer_gc(lua_State *L) {
     sound_player_t *player = check_player(L, 1);
     g_api.soundplayer->playerFree(player);
@@ -316,8 +359,7 @@ static int l_sound_sampleplayer_gc(lua_State *L) {
 }
 
 static int l_sound_fileplayer_new(lua_State *L) {
-    size_t buffer_size = luaL_optinteger(L, 1, 8192);
-    (void)buffer_size;
+    lua_Integer buffer_size = luaL_optinteger(L, 1, FILEPLAYER_BUFFER_SIZE);
 
     fileplayer_t *player = (fileplayer_t *)g_api.soundplayer->filePlayerNew();
     if (!player) {
@@ -325,6 +367,7 @@ static int l_sound_fileplayer_new(lua_State *L) {
         lua_pushstring(L, "failed to create fileplayer");
         return 2;
     }
+    fileplayer_set_buffer_size(player, buffer_size > 0 ? (uint32_t)buffer_size : 0);
 
     fileplayer_t **ud = lua_newuserdata(L, sizeof(fileplayer_t *));
     *ud = player;
@@ -484,6 +527,31 @@ static int l_sound_fileplayer_setStopOnUnderrun(lua_State *L) {
     return 0;
 }
 
+static int l_sound_fileplayer_setBufferSize(lua_State *L) {
+    fileplayer_t *player = check_fileplayer(L, 1);
+    lua_Integer bytes = luaL_checkinteger(L, 2);
+    fileplayer_set_buffer_size(player, bytes > 0 ? (uint32_t)bytes : 0);
+    return 0;
+}
+
+static int l_sound_fileplayer_getStats(lua_State *L) {
+    fileplayer_t *player = check_fileplayer(L, 1);
+    fileplayer_stats_t st;
+    fileplayer_get_stats(player, &st);
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, st.buffer_size);
+    lua_setfield(L, -2, "bufferSize");
+    lua_pushinteger(L, st.buffered);
+    lua_setfield(L, -2, "buffered");
+    lua_pushinteger(L, st.low_water);
+    lua_setfield(L, -2, "lowWater");
+    lua_pushinteger(L, st.underruns);
+    lua_setfield(L, -2, "underruns");
+    lua_pushinteger(L, st.sd_busy);
+    lua_setfield(L, -2, "sdBusy");
+    return 1;
+}
+
 static int l_sound_fileplayer_gc(lua_State *L) {
     fileplayer_t *player = check_fileplayer(L, 1);
     g_api.soundplayer->filePlayerFree(player);
@@ -545,18 +613,43 @@ static int l_sound_mp3player_isPlaying(lua_State *L) {
     return 1;
 }
 
+// Positions cross the bridge in seconds; the player works in samples.
+static lua_Number mp3_samples_to_seconds(mp3_player_t *player, uint32_t samples) {
+    uint32_t rate = mp3_player_get_sample_rate(player);
+    return rate ? (lua_Number)samples / rate : 0;
+}
+
+static uint32_t mp3_seconds_to_samples(lua_State *L, mp3_player_t *player, int idx) {
+    lua_Number sec = luaL_optnumber(L, idx, 0);
+    return sec > 0 ? (uint32_t)(sec * mp3_player_get_sample_rate(player)) : 0;
+}
+
 static int l_sound_mp3player_getPosition(lua_State *L) {
     mp3_player_t *player = check_mp3player(L, 1);
-    lua_pushinteger(L, mp3_player_get_position(player));
+    lua_pushnumber(L, mp3_samples_to_seconds(player, mp3_player_get_position(player)));
     return 1;
 }
 
 static int l_sound_mp3player_getLength(lua_State *L) {
     mp3_player_t *player = check_mp3player(L, 1);
-    lua_pushinteger(L, mp3_player_get_length(player));
+    lua_pushnumber(L, mp3_samples_to_seconds(player, mp3_player_get_length(player)));
     return 1;
 }
 
+static int l_sound_mp3player_setOffset(lua_State *L) {
+    mp3_player_t *player = check_mp3player(L, 1);
+    luaL_checknumber(L, 2);
+    mp3_player_set_offset(player, mp3_seconds_to_samples(L, player, 2));
+    return 0;
+}
+
+static int l_sound_mp3player_setLoopRange(lua_State *L) {
+    mp3_player_t *player = check_mp3player(L, 1);
+    mp3_player_set_loop_range(player, mp3_seconds_to_samples(L, player, 2),
+                              mp3_seconds_to_samples(L, player, 3));
+    return 0;
+}
+
 static int l_sound_mp3player_setVolume(lua_State *L) {
     mp3_player_t *player = check_mp3player(L, 1);
     uint8_t vol = (uint8_t)luaL_checkinteger(L, 2);
@@ -583,6 +676,27 @@ static int l_sound_mp3player_setLoop(lua_State *L) {
     return 0;
 }
 
+static uint32_t seconds_to_ms(lua_State *L, int idx) {
+    lua_Number sec = luaL_optnumber(L, idx, 0);
+    return sec > 0 ? (uint32_t)(sec * 1000) : 0;
+}
+
+static int l_sound_mp3player_fade(lua_State *L) {
+    mp3_player_t *player = check_mp3player(L, 1);
+    lua_Integer level = luaL_checkinteger(L, 2);
+    uint32_t ms = seconds_to_ms(L, 3);
+    bool stop = lua_toboolean(L, 4);
+    mp3_player_fade(player, (uint8_t)(level < 0 ? 0 : level > 100 ? 100 : level), ms, stop);
+    return 0;
+}
+
+static int l_sound_mp3player_crossfade(lua_State *L) {
+    mp3_player_t *player = check_mp3player(L, 1);
+    mp3_player_t *next = check_mp3player(L, 2);
+    lua_pushboolean(L, mp3_player_crossfade(player, next, seconds_to_ms(L, 3)));
+    return 1;
+}
+
 static int l_sound_mp3player_gc(lua_State *L) {
     mp3_player_t *player = check_mp3player(L, 1);
     g_api.soundplayer->mp3PlayerFree(player);
@@ -631,6 +745,10 @@ static const luaL_Reg sound_player_methods[] = {
     {"setPlayRange", l_sound_sampleplayer_setPlayRange},
     {"setRate", l_sound_sampleplayer_setRate},
     {"getRate", l_sound_sampleplayer_getRate},
+    {"setPriority", l_sound_sampleplayer_setPriority},
+    {"getPriority", l_sound_sampleplayer_getPriority},
+    {"setInterpolation", l_sound_sampleplayer_setInterpolation},
+    {"getInterpolation", l_sound_sampleplayer_getInterpolation},
     {"__gc", l_sound_sampleplayer_gc},
     {NULL, NULL}
 };
@@ -651,6 +769,8 @@ static const luaL_Reg sound_fileplayer_methods[] = {
     {"didUnderrun", l_sound_fileplayer_didUnderrun},
     {"setFinishCallback", l_sound_fileplayer_setFinishCallback},
     {"setStopOnUnderrun", l_sound_fileplayer_setStopOnUnderrun},
+    {"setBufferSize", l_sound_fileplayer_setBufferSize},
+    {"getStats", l_sound_fileplayer_getStats},
     {"__gc", l_sound_fileplayer_gc},
     {NULL, NULL}
 };
@@ -664,10 +784,14 @@ static const luaL_Reg sound_mp3player_methods[] = {
     {"isPlaying", l_sound_mp3player_isPlaying},
     {"getPosition", l_sound_mp3player_getPosition},
     {"getLength", l_sound_mp3player_getLength},
+    {"setOffset", l_sound_mp3player_setOffset},
+    {"setLoopRange", l_sound_mp3player_setLoopRange},
     {"setVolume", l_sound_mp3player_setVolume},
     {"getVolume", l_sound_mp3player_getVolume},
     {"getSampleRate", l_sound_mp3player_getSampleRate},
     {"setLoop", l_sound_mp3player_setLoop},
+    {"fade", l_sound_mp3player_fade},
+    {"crossfade", l_sound_mp3player_crossfade},
     {"__gc", l_sound_mp3player_gc},
     {NULL, NULL}
 };
@@ -1,4 +1,5 @@
 #include "lua_bridge_internal.h"
+#include "lua_cache.h"
 #include "lua_psram_alloc.h"
 #include "ota_update.h"
 #include "version.h"
@@ -46,10 +47,11 @@ static int l_sys_sleep(lua_State *L) {
     if (now >= end_ms)
       break;
 
-    // Fire HTTP/TCP callbacks while sleeping so async requests can progress.
-    // WiFi is driven by Core 1; no poll needed here.
+    // Fire HTTP/TCP/file I/O callbacks while sleeping so async requests can
+    // progress.  WiFi is driven by Core 1; no poll needed here.
     http_lua_fire_pending(L);
     tcp_lua_fire_pending(L);
+    fs_lua_fire_pending(L);
 
     // Process dev commands (keypress, etc.) while sleeping.
     dev_commands_poll();
@@ -144,7 +146,7 @@ static int l_sys_getMemInfo(lua_State *L) {
 
   struct mallinfo mi = mallinfo();
 
-  lua_createtable(L, 0, 5);
+  lua_createtable(L, 0, 6);
   lua_pushinteger(L, (lua_Integer)psram_free);
   lua_setfield(L, -2, "psram_free");
   lua_pushinteger(L, (lua_Integer)psram_used);
@@ -155,6 +157,26 @@ static int l_sys_getMemInfo(lua_State *L) {
   lua_setfield(L, -2, "sram_free");
   lua_pushinteger(L, (lua_Integer)mi.uordblks);
   lua_setfield(L, -2, "sram_used");
+
+  // Per-size-class small-object slab usage
+  lua_slab_class_stats_t slab[LUA_SLAB_CLASS_COUNT];
+  int nslab = lua_psram_alloc_slab_stats(slab, LUA_SLAB_CLASS_COUNT);
+  lua_createtable(L, nslab, 0);
+  for (int i = 0; i < nslab; i++) {
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, slab[i].size);
+    lua_setfield(L, -2, "size");
+    lua_pushinteger(L, (lua_Integer)slab[i].chunks);
+    lua_setfield(L, -2, "chunks");
+    lua_pushinteger(L, (lua_Integer)slab[i].in_use);
+    lua_setfield(L, -2, "used");
+    lua_pushinteger(L, (lua_Integer)slab[i].cached);
+    lua_setfield(L, -2, "free");
+    lua_pushinteger(L, (lua_Integer)slab[i].allocs);
+    lua_setfield(L, -2, "allocs");
+    lua_rawseti(L, -2, i + 1);
+  }
+  lua_setfield(L, -2, "slab");
   return 1;
 }
 
@@ -216,36 +238,15 @@ static int l_sys_loadlib(lua_State *L) {
   if (strstr(name, "..") || strchr(name, '/'))
     return luaL_error(L, "invalid library name");
 
-  // Read file via SD card
-  sdfile_t f = sdcard_fopen(path, "r");
-  if (!f) {
+  // Compile (or fetch the cached bytecode for) the library.  System libs are
+  // shared by every app, so they get one cache directory of their own.
+  int status = lua_cache_load(L, path, "_syslib", path);
+  if (status == LUA_ERRFILE) {
     lua_pushnil(L);
-    lua_pushfstring(L, "cannot open %s", path);
+    lua_insert(L, -2);
     return 2;
   }
 
-  int size = sdcard_fsize(path);
-  if (size <= 0) {
-    sdcard_fclose(f);
-    lua_pushnil(L);
-    lua_pushfstring(L, "empty or unreadable: %s", path);
-    return 2;
-  }
-
-  char *buf = (char *)umm_malloc(size + 1);
-  if (!buf) {
-    sdcard_fclose(f);
-    return luaL_error(L, "out of memory loading %s (%d bytes)", path, size);
-  }
-
-  int read = sdcard_fread(f, buf, size);
-  sdcard_fclose(f);
-  buf[read] = '\0';
-
-  // Load and execute
-  int status = luaL_loadbuffer(L, buf, read, path);
-  umm_free(buf);
-
   if (status != LUA_OK)
     return lua_error(L);  // propagate compile error
 
@@ -252,6 +252,7 @@ static void terminal_service_hooks(lua_State* L) {
     watchdog_update();
     http_lua_fire_pending(L);
     tcp_lua_fire_pending(L);
+    fs_lua_fire_pending(L);
     dev_commands_poll();
     dev_commands_process();
     if (dev_commands_wants_exit()) {
@@ -143,6 +143,21 @@ static int l_video_getDroppedFrames(lua_State *L) {
     return 1;
 }
 
+static int l_video_getStats(lua_State *L) {
+    video_player_t *player = check_video(L, 1);
+    video_stats_t st;
+    video_player_get_stats(player, &st);
+    lua_newtable(L);
+    lua_pushinteger(L, st.frames); lua_setfield(L, -2, "frames");
+    lua_pushinteger(L, st.split_frames); lua_setfield(L, -2, "split_frames");
+    lua_pushinteger(L, st.read_us); lua_setfield(L, -2, "read_us");
+    lua_pushinteger(L, st.flush_wait_us); lua_setfield(L, -2, "flush_wait_us");
+    lua_pushinteger(L, st.core0_us); lua_setfield(L, -2, "core0_us");
+    lua_pushinteger(L, st.core1_us); lua_setfield(L, -2, "core1_us");
+    lua_pushinteger(L, st.sync_us); lua_setfield(L, -2, "sync_us");
+    return 1;
+}
+
 static int l_video_resetStats(lua_State *L) {
     video_player_t *player = check_video(L, 1);
     video_player_reset_stats(player);
@@ -181,6 +196,7 @@ static const luaL_Reg video_methods[] = {
     {"getSize", l_video_getSize},
     {"getInfo", l_video_getInfo},
     {"getDroppedFrames", l_video_getDroppedFrames},
+    {"getStats", l_video_getStats},
     {"resetStats", l_video_resetStats},
     {"setLoop", l_video_setLoop},
     {"setAutoFlush", l_video_setAutoFlush},
@@ -0,0 +1,136 @@
+#include "lua_cache.h"
+#include "../drivers/sdcard.h"
+#include "umm_malloc.h"
+
+#include "lauxlib.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// On-disk header, followed by the output of lua_dump().
+#define LUA_CACHE_MAGIC   0x43424C50u  // "PLBC"
+#define LUA_CACHE_FORMAT  4
+
+typedef struct {
+  uint32_t magic;
+  uint16_t format;
+  uint16_t stripped;
+  uint32_t lua_version;  // LUA_VERSION_RELEASE_NUM of the VM that wrote it
+  sdcard_file_id_t src;
+} lua_cache_header_t;
+
+// lua_dump() output, collected in the Lua heap and written in one go.
+typedef struct {
+  uint8_t *data;
+  uint32_t len;
+  uint32_t cap;
+} dump_buf_t;
+
+static int cache_dump_writer(lua_State *L, const void *p, size_t sz, void *ud) {
+  (void)L;
+  dump_buf_t *b = (dump_buf_t *)ud;
+  if (b->len + sz > b->cap) {
+    uint32_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + sz)
+      cap *= 2;
+    uint8_t *grown = (uint8_t *)umm_realloc(b->data, cap);
+    if (!grown)
+      return 1;
+    b->data = grown;
+    b->cap = cap;
+  }
+  memcpy(b->data + b->len, p, sz);
+  b->len += sz;
+  return 0;
+}
+
+// <cache_id>/<file>.luac under SDCARD_CACHE_DIR, the source's extension
+// replaced.
+static bool cache_path_for(const char *src_path, const char *cache_id,
+                           char *path, int path_len) {
+  const char *base = strrchr(src_path, '/');
+  base = base ? base + 1 : src_path;
+  const char *dot = strrchr(base, '.');
+  char name[64];
+  int n = snprintf(name, sizeof(name), "%.*s",
+                   dot ? (int)(dot - base) : (int)strlen(base), base);
+  if (n <= 0 || n >= (int)sizeof(name))
+    return false;
+  return sdcard_cache_path(cache_id, name, ".luac", path, path_len);
+}
+
+static bool cache_try_load(lua_State *L, const char *cache_path,
+                           const lua_cache_header_t *want,
+                           const char *chunkname) {
+  int len = 0;
+  char *data = sdcard_read_file(cache_path, &len);
+  if (!data)
+    return false;
+
+  bool ok = false;
+  lua_cache_header_t hdr;
+  if (len > (int)sizeof(hdr)) {
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic == want->magic && hdr.format == want->format &&
+        hdr.stripped == want->stripped &&
+        hdr.lua_version == want->lua_version &&
+        sdcard_file_id_equal(&hdr.src, &want->src)) {
+      // "b": never fall back to compiling whatever the file holds as text.
+      if (luaL_loadbufferx(L, data + sizeof(hdr), len - sizeof(hdr),
+                           chunkname, "b") == LUA_OK)
+        ok = true;
+      else
+        lua_pop(L, 1);
+    }
+  }
+  umm_free(data);
+  if (!ok)
+    printf("[LUAC] Stale or unreadable cache %s\n", cache_path);
+  return ok;
+}
+
+// Dump the function on top of the stack to cache_path.
+static void cache_store(lua_State *L, const char *cache_path,
+                        const lua_cache_header_t *hdr) {
+  dump_buf_t b = {0};
+  if (lua_dump(L, cache_dump_writer, &b, hdr->stripped) == 0) {
+    sdcard_part_t parts[] = {{hdr, sizeof(*hdr)}, {b.data, b.len}};
+    sdcard_write_file_atomic(cache_path, parts, 2);
+  }
+  umm_free(b.data);
+}
+
+int lua_cache_load(lua_State *L, const char *src_path, const char *cache_id,
+                   const char *chunkname) {
+  lua_cache_header_t hdr = {
+      .magic = LUA_CACHE_MAGIC,
+      .format = LUA_CACHE_FORMAT,
+      .stripped = LUA_CACHE_STRIP_DEBUG,
+      .lua_version = LUA_VERSION_RELEASE_NUM,
+  };
+  if (!sdcard_file_id(src_path, &hdr.src)) {
+    lua_pushfstring(L, "cannot open %s", src_path);
+    return LUA_ERRFILE;
+  }
+
+  char cache_path[160];
+  bool cacheable = cache_id && cache_path_for(src_path, cache_id, cache_path,
+                                              sizeof(cache_path));
+  if (cacheable && cache_try_load(L, cache_path, &hdr, chunkname))
+    return LUA_OK;
+
+  // Miss: compile the source.
+  int len = 0;
+  char *src = sdcard_read_file(src_path, &len);
+  if (!src) {
+    lua_pushfstring(L, "cannot read %s", src_path);
+    return LUA_ERRFILE;
+  }
+
+  int status = luaL_loadbuffer(L, src, len, chunkname);
+  umm_free(src);
+
+  if (status == LUA_OK && cacheable)
+    cache_store(L, cache_path, &hdr);
+  return status;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "lua.h"
+
+// =============================================================================
+// Lua bytecode cache
+//
+// Compiled chunks are kept on the SD card as
+//   /system/cache/<cache_id>/<name>.luac  (SDCARD_CACHE_DIR)
+// next to a small header recording the source file's identity (size, FatFS
+// modification stamp and a hash of both ends, see sdcard_file_id()) plus the
+// Lua VM version, so a hit never reads the source.  A cached chunk is only
+// used while all of those still match; otherwise the source is recompiled
+// and the cache file rewritten.
+// =============================================================================
+
+// Strip debug info (line numbers, local names) from cached bytecode.  Smaller
+// and faster to load, but runtime errors lose their line numbers.
+#ifndef LUA_CACHE_STRIP_DEBUG
+#define LUA_CACHE_STRIP_DEBUG 0
+#endif
+
+// Load the Lua source at src_path as a chunk named chunkname, going through
+// the bytecode cache for cache_id (an app ID or other directory-safe key;
+// other characters are replaced).  Same contract as luaL_loadbuffer: pushes
+// the compiled function and returns LUA_OK, or pushes an error message and
+// returns an error code (LUA_ERRFILE if the source can't be read).
+int lua_cache_load(lua_State *L, const char *src_path, const char *cache_id,
+                   const char *chunkname);
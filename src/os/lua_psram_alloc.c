@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 // Hardware spinlock protecting all umm_malloc heap operations across both cores.
 // Referenced by UMM_CRITICAL_ENTRY/EXIT in umm_malloc_cfgport.h.
@@ -29,6 +30,8 @@ void *UMM_MALLOC_CFG_HEAP_ADDR = NULL; // We initialize umm_malloc manually
 void *UMM_MALLOC_CFG_HEAP_ADDR = NULL; // Initialized in lua_psram_alloc_init
 #endif
 
+static void slab_init(void);
+
 static int l_panic(lua_State *L) {
   const char *msg = (lua_type(L, -1) == LUA_TSTRING)
                         ? lua_tostring(L, -1)
@@ -55,6 +58,7 @@ void lua_psram_alloc_init(void) {
   }
 #endif
   umm_init_heap(s_lua_psram_heap, UMM_MALLOC_CFG_HEAP_SIZE);
+  slab_init();
   printf("PSRAM Lua Allocator Initialized: %d bytes\n",
          (int)UMM_MALLOC_CFG_HEAP_SIZE);
   
@@ -64,29 +68,181 @@ void lua_psram_alloc_init(void) {
          free_after_init, free_after_init / 1024);
 }
 
+// ── Small-object slabs ────────────────────────────────────────────────────────
+//
+// umm_malloc's block body is 200 bytes (see umm_malloc_cfgport.h), so a 24-byte
+// table node would otherwise cost a whole block, and every call takes the
+// cross-core heap lock.  Blocks of up to LUA_SLAB_MAX_SIZE come from per-class
+// free lists instead.  Lua passes the old size on every free/realloc, so a
+// block's class is recovered from osize and small blocks carry no header.
+// That only holds if *every* small block is a slab block, so a small request
+// never falls back to umm; if no chunk can be had it fails and Lua runs an
+// emergency GC.  Chunks are kept for the life of the state and returned to
+// umm in lua_psram_close().
+
+typedef struct slab_free {
+  struct slab_free *next;
+} slab_free_t;
+
+typedef struct slab_chunk {
+  struct slab_chunk *next;
+  uint32_t pad;  // keep objects 8-byte aligned
+} slab_chunk_t;
+
+static const uint16_t s_slab_sizes[LUA_SLAB_CLASS_COUNT] = {
+    16, 24, 32, 40, 48, 64, 80, 96, 128, 160, 192, 256};
+
+// (size + 7) / 8 -> class index
+static uint8_t s_slab_lut[LUA_SLAB_MAX_SIZE / 8 + 1];
+
+static slab_free_t *s_slab_free[LUA_SLAB_CLASS_COUNT];
+static slab_chunk_t *s_slab_chunks = NULL;
+static lua_slab_class_stats_t s_slab_stats[LUA_SLAB_CLASS_COUNT];
+
+static void slab_init(void) {
+  int c = 0;
+  for (int i = 0; i <= LUA_SLAB_MAX_SIZE / 8; i++) {
+    while (s_slab_sizes[c] < i * 8)
+      c++;
+    s_slab_lut[i] = (uint8_t)c;
+  }
+  for (c = 0; c < LUA_SLAB_CLASS_COUNT; c++) {
+    s_slab_free[c] = NULL;
+    memset(&s_slab_stats[c], 0, sizeof(s_slab_stats[c]));
+    s_slab_stats[c].size = s_slab_sizes[c];
+  }
+}
+
+static inline int slab_class(size_t size) {
+  return s_slab_lut[(size + 7) >> 3];
+}
+
+// Carve a fresh chunk into free objects for class c.
+static bool slab_refill(int c) {
+  slab_chunk_t *chunk = (slab_chunk_t *)umm_malloc(LUA_SLAB_CHUNK_SIZE);
+  if (!chunk)
+    return false;
+  chunk->next = s_slab_chunks;
+  s_slab_chunks = chunk;
+
+  size_t sz = s_slab_sizes[c];
+  uint8_t *p = (uint8_t *)(chunk + 1);
+  uint8_t *end = (uint8_t *)chunk + LUA_SLAB_CHUNK_SIZE;
+  int n = 0;
+  for (; p + sz <= end; p += sz, n++) {
+    slab_free_t *f = (slab_free_t *)p;
+    f->next = s_slab_free[c];
+    s_slab_free[c] = f;
+  }
+  s_slab_stats[c].chunks++;
+  s_slab_stats[c].cached += n;
+  return true;
+}
+
+static void *slab_alloc(size_t size) {
+  int c = slab_class(size);
+  if (!s_slab_free[c] && !slab_refill(c))
+    return NULL;
+  slab_free_t *f = s_slab_free[c];
+  s_slab_free[c] = f->next;
+  s_slab_stats[c].cached--;
+  s_slab_stats[c].in_use++;
+  s_slab_stats[c].allocs++;
+  return f;
+}
+
+static void slab_release(void *ptr, size_t size) {
+  int c = slab_class(size);
+  slab_free_t *f = (slab_free_t *)ptr;
+  f->next = s_slab_free[c];
+  s_slab_free[c] = f;
+  s_slab_stats[c].in_use--;
+  s_slab_stats[c].cached++;
+}
+
+// Return every chunk to umm.  Only valid once no slab object is live.
+static void slab_reset(void) {
+  while (s_slab_chunks) {
+    slab_chunk_t *next = s_slab_chunks->next;
+    umm_free(s_slab_chunks);
+    s_slab_chunks = next;
+  }
+  slab_init();
+}
+
+static size_t slab_cached_bytes(void) {
+  size_t total = 0;
+  for (int c = 0; c < LUA_SLAB_CLASS_COUNT; c++)
+    total += (size_t)s_slab_stats[c].cached * s_slab_sizes[c];
+  return total;
+}
+
+int lua_psram_alloc_slab_stats(lua_slab_class_stats_t *out, int max) {
+  int n = max < LUA_SLAB_CLASS_COUNT ? max : LUA_SLAB_CLASS_COUNT;
+  memcpy(out, s_slab_stats, n * sizeof(lua_slab_class_stats_t));
+  return n;
+}
+
+static void *alloc_oom(size_t nsize) {
+  printf("[PSRAM] OOM: failed to allocate %zu bytes, %zu free\n",
+         nsize, umm_free_heap_size());
+  return NULL;
+}
+
 void *lua_psram_alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
   (void)ud;
-  (void)osize;
+
+  // With ptr == NULL, osize carries the object type, not a size.
+  if (!ptr)
+    osize = 0;
+  bool old_small = ptr && osize <= LUA_SLAB_MAX_SIZE;
 
   if (nsize == 0) {
-    umm_free(ptr);
+    if (old_small)
+      slab_release(ptr, osize);
+    else
+      umm_free(ptr);
     return NULL;
   }
 
-  void *result = umm_realloc(ptr, nsize);
-  if (!result) {
-    printf("[PSRAM] OOM: failed to allocate %zu bytes, %zu free\n",
-           nsize, umm_free_heap_size());
+  if (nsize <= LUA_SLAB_MAX_SIZE) {
+    if (old_small && slab_class(osize) == slab_class(nsize))
+      return ptr;
+    void *result = slab_alloc(nsize);
+    if (!result)
+      return alloc_oom(nsize);
+    if (ptr) {
+      memcpy(result, ptr, osize < nsize ? osize : nsize);
+      if (old_small)
+        slab_release(ptr, osize);
+      else
+        umm_free(ptr);
+    }
+    return result;
+  }
+
+  if (old_small) {
+    void *result = umm_malloc(nsize);
+    if (!result)
+      return alloc_oom(nsize);
+    memcpy(result, ptr, osize);
+    slab_release(ptr, osize);
+    return result;
   }
+
+  void *result = umm_realloc(ptr, nsize);
+  if (!result)
+    return alloc_oom(nsize);
   return result;
 }
 
+// Cached slab objects are free as far as Lua is concerned.
 size_t lua_psram_alloc_free_size(void) {
-  return umm_free_heap_size();
+  return umm_free_heap_size() + slab_cached_bytes();
 }
 
 bool lua_psram_alloc_is_low(void) {
-  return umm_free_heap_size() < PSRAM_LOW_WATERMARK;
+  return lua_psram_alloc_free_size() < PSRAM_LOW_WATERMARK;
 }
 
 size_t lua_psram_alloc_total_size(void) {
@@ -101,3 +257,8 @@ lua_State *lua_psram_newstate(void) {
   }
   return L;
 }
+
+void lua_psram_close(lua_State *L) {
+  lua_close(L);
+  slab_reset();
+}
@@ -2,6 +2,7 @@
 
 #include "lua.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 // Initialize the PSRAM allocator. Call once on boot.
 void lua_psram_alloc_init(void);
@@ -12,6 +13,10 @@ void *lua_psram_alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 // Create a new Lua state using the PSRAM allocator
 lua_State *lua_psram_newstate(void);
 
+// Close a state from lua_psram_newstate() and hand its slab chunks back to
+// the PSRAM heap.  Use instead of lua_close().
+void lua_psram_close(lua_State *L);
+
 // Memory stats for the PSRAM Lua heap
 size_t lua_psram_alloc_free_size(void);
 size_t lua_psram_alloc_total_size(void);
@@ -20,3 +25,23 @@ size_t lua_psram_alloc_total_size(void);
 // Used by the Lua debug hook to trigger GC before allocations start failing.
 #define PSRAM_LOW_WATERMARK (512u * 1024u)
 bool lua_psram_alloc_is_low(void);
+
+// ── Small-object slabs ────────────────────────────────────────────────────────
+// Lua allocations of up to LUA_SLAB_MAX_SIZE bytes are served from per-size-
+// class free lists carved out of LUA_SLAB_CHUNK_SIZE chunks of the PSRAM heap.
+// Only core 0 runs Lua, so the slabs take no lock; umm (and its cross-core
+// spinlock) is only touched to fetch a new chunk or for larger blocks.
+#define LUA_SLAB_MAX_SIZE    256
+#define LUA_SLAB_CHUNK_SIZE  4096
+#define LUA_SLAB_CLASS_COUNT 12
+
+typedef struct {
+  uint16_t size;    // object size for this class
+  uint32_t chunks;  // chunks carved for this class
+  uint32_t in_use;  // live objects
+  uint32_t cached;  // free objects ready for reuse
+  uint32_t allocs;  // total allocations served since the state was created
+} lua_slab_class_stats_t;
+
+// Fill up to `max` entries (one per size class); returns the count written.
+int lua_psram_alloc_slab_stats(lua_slab_class_stats_t *out, int max);
@@ -1,12 +1,15 @@
 #include "lua_runner.h"
 #include "launcher_types.h"
 #include "lua_bridge.h"
+#include "lua_cache.h"
 #include "lua_psram_alloc.h"
 #include "config.h"
+#include "image_cache.h"
 #include "system_menu.h"
 #include "../drivers/audio.h"
 #include "../drivers/display.h"
 #include "../drivers/fileplayer.h"
+#include "../drivers/fs_queue.h"
 #include "../drivers/mp3_player.h"
 #include "../drivers/sdcard.h"
 #include "../drivers/sound.h"
@@ -28,13 +31,11 @@ static bool lua_run(const app_entry_t *app) {
   printf("[LUA] Starting app '%s', PSRAM free: %zu\n",
          app->name, lua_psram_alloc_free_size());
 
-  // ── Load main.lua from SD ─────────────────────────────────────────────────
+  // ── Locate main.lua on SD ─────────────────────────────────────────────────
   char main_path[160];
   snprintf(main_path, sizeof(main_path), "%s/main.lua", app->path);
 
-  int lua_len = 0;
-  char *lua_src = sdcard_read_file(main_path, &lua_len);
-  if (!lua_src) {
+  if (!sdcard_fexists(main_path)) {
     display_clear(C_BG);
     display_draw_text(8, 8, "Failed to load app:", COLOR_RED, C_BG);
     display_draw_text(8, 20, main_path, COLOR_WHITE, C_BG);
@@ -44,14 +45,10 @@ static bool lua_run(const app_entry_t *app) {
     return false;
   }
 
-  printf("[LUA] Loaded %d bytes, PSRAM free: %zu\n",
-         lua_len, lua_psram_alloc_free_size());
-
   // ── Create Lua VM ─────────────────────────────────────────────────────────
   lua_State *L = lua_psram_newstate();
   if (!L) {
     printf("[LUA] FAILED: lua_psram_newstate returned NULL\n");
-    umm_free(lua_src);
     return false;
   }
 
@@ -62,8 +59,7 @@ static bool lua_run(const app_entry_t *app) {
   lua_pushcfunction(L, (lua_CFunction)lua_bridge_register);
   if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
     lua_bridge_show_error(L, "Init error:");
-    lua_close(L);
-    umm_free(lua_src);
+    lua_psram_close(L);
     return false;
   }
 
@@ -88,12 +84,18 @@ static bool lua_run(const app_entry_t *app) {
   display_clear(C_BG);
   display_flush();
 
-  int load_err = luaL_loadbuffer(L, lua_src, lua_len, app->name);
-  umm_free(lua_src);
+  // Compiled bytecode is reused from /system/cache/<app-id>/ while main.lua
+  // is unchanged, skipping the parser on most launches.
+  uint32_t t0 = to_ms_since_boot(get_absolute_time());
+  int load_err = lua_cache_load(L, main_path, app->id[0] ? app->id : app->name,
+                                app->name);
+  printf("[LUA] main.lua loaded in %lums, PSRAM free: %zu\n",
+         (unsigned long)(to_ms_since_boot(get_absolute_time()) - t0),
+         lua_psram_alloc_free_size());
 
   if (load_err != LUA_OK) {
     lua_bridge_show_error(L, "Load error:");
-    lua_close(L);
+    lua_psram_close(L);
     return false;
   }
 
@@ -106,7 +108,12 @@ static bool lua_run(const app_entry_t *app) {
     }
   }
 
-  lua_close(L);
+  // Requests still queued would land in buffers and callbacks of a closed
+  // state.
+  fs_queue_reset();
+  lua_psram_close(L);
+  // Every image is collected by now; cached ones belong to this app.
+  image_cache_reset();
 
   // Ensure no audio leaks into the next app or launcher.
   // lua_close() runs __gc handlers which destroy fileplayer/mp3player objects,
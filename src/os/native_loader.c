@@ -3,6 +3,7 @@
 #include "app_abi.h"
 #include "../drivers/audio.h"
 #include "../drivers/display.h"
+#include "../drivers/fs_queue.h"
 #include "../drivers/keyboard.h"
 #include "../drivers/sdcard.h"
 #include "../os/os.h"
@@ -626,6 +627,7 @@ static bool native_run(const app_entry_t *app) {
 out:
   // ── 9. Cleanup ─────────────────────────────────────────────────────────────
   g_native_audio_callback = NULL;
+  fs_queue_reset();  // before the app's buffers go
   g_core1_pause = true;
   while (!g_core1_paused)
     sleep_ms(1);
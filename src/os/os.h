@@ -169,6 +169,17 @@ typedef struct {
                         void (*callback)(const char *name, bool is_dir,
                                          uint32_t size, void *user),
                         void *user);
+    // Asynchronous reads and writes, done by Core 1 while the app carries on.
+    // cb(id, result, user) fires from sys->poll(): result is the byte count
+    // (short at end of file), or -1 on error.  buf must stay valid until
+    // then.  Return a request id, or -1 if the queue is full.
+    int      (*readAsync)(const char *path, uint32_t offset, void *buf, int len,
+                          void (*cb)(int id, int result, void *user), void *user);
+    // Creates (or with append, extends) path with len bytes of buf.
+    int      (*writeAsync)(const char *path, const void *buf, int len, bool append,
+                           void (*cb)(int id, int result, void *user), void *user);
+    // Drops a pending request without calling its callback.
+    bool     (*cancelAsync)(int id);
 } picocalc_fs_t;
 
 // --- System -----------------------------------------------------------------
@@ -289,6 +300,8 @@ typedef struct {
 
 // --- PSRAM Benchmark ---------------------------------------------------------
 
+// Native apps own PIO PSRAM 0x048000..0x3FFFFF (3808 KB); the rest holds
+// the OS MP3 rings, video buffer and sound sample bank.
 typedef struct {
     // Check if PIO PSRAM (mainboard) is available
     bool (*pioAvailable)(void);
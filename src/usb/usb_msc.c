@@ -71,6 +71,9 @@ void usb_msc_enter_mode(void) {
     f_getfree("", &free_clust, &fs);
   }
   f_unmount("");
+  // The host caches for itself, and MSC I/O runs from the USB IRQ: go
+  // straight to the card until we're back.
+  sdcard_cache_enable(false);
 
   // Cache sector count before entering MSC mode — avoids SPI CMD9 on every
   // host capacity query.  Must be done after f_unmount but before tud_disconnect.
@@ -164,6 +167,7 @@ void usb_msc_enter_mode(void) {
   sleep_ms(50);
 
   // Remount FatFS
+  sdcard_cache_enable(true);
   printf("[USB MSC] Remounting FatFS...\n");
   if (!sdcard_remount()) {
     printf("[USB MSC] WARNING: FatFS remount failed, retrying...\n");
@@ -9,9 +9,16 @@
  *
  * Optimizations:
  *   - Multi-block reads use single large SPI transfer (uf2loader approach)
+ *   - Block payloads move by DMA (CMD17/18 reads, CMD24/25 writes)
+ *   - Asynchronous CMD18 reads (disk_read_start/disk_read_poll) so callers
+ *     can work while sectors stream in
  *   - CMD23 pre-erase for multi-block writes
+ *   - Write-back sector cache in PSRAM for FAT, directory and other
+ *     single-sector I/O (sd_cache.c), flushed on CTRL_SYNC
  *   - Automatic fallback to per-block mode on errors
  *   - Config key "sd_optimized_read" to enable/disable (default: enabled)
+ *   - Config key "sd_read_crc" = 1 verifies each read block's CRC16
+ *     (default: skipped, as the card doesn't check ours either)
  *
  * References:
  *   SD Association Physical Layer Simplified Specification v8.00
@@ -20,8 +27,11 @@
 
 #include "ff.h"
 #include "diskio.h"
+#include "diskio_spi.h"
+#include "sd_cache.h"
 #include "hardware.h" /* SD_SPI_PORT, SD_PIN_CS, SD_SPI_BAUD */
 
+#include "hardware/dma.h"
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
 #include "pico/stdlib.h"
@@ -74,6 +84,38 @@ static bool sd_optimized_read_enabled(void) {
   return (val == NULL) || (val[0] != '0') || (val[1] != '\0');
 }
 
+/* Check if read CRCs are verified via config (default: skipped) */
+static bool sd_read_crc_enabled(void) {
+  const char *val = config_get("sd_read_crc");
+  return val && val[0] == '1' && val[1] == '\0';
+}
+
+static bool s_check_crc = false; /* latched per disk_read */
+
+/* ─── DMA state ─────────────────────────────────────────────────────────────
+ * Two channels per transfer: TX feeds the SPI FIFO (payload, or 0xFF while
+ * receiving) and RX drains it (into the buffer, or a sink while sending).
+ * Claimed on first use; without free channels the CPU path is used.
+ */
+
+static int s_dma_rx = -1;
+static int s_dma_tx = -1;
+static bool s_dma_tried = false;
+static const uint8_t s_dma_ones = 0xFF;
+static uint8_t s_dma_sink;
+
+/* ─── Asynchronous read state ───────────────────────────────────────────────
+ */
+
+static struct {
+  bool active;
+  bool failed;
+  bool waiting_token; /* between blocks: polling for the data token */
+  BYTE *buf;
+  UINT left;          /* blocks still to land, including the one on DMA */
+  absolute_time_t deadline;
+} s_async;
+
 /* ─── SPI low-level helpers ─────────────────────────────────────────────────
  */
 
@@ -98,6 +140,90 @@ static void spi_send_buf(const uint8_t *buf, size_t len) {
   spi_write_blocking(SD_SPI_PORT, buf, len);
 }
 
+static bool sd_dma_ready(void) {
+  if (!s_dma_tried) {
+    s_dma_tried = true;
+    s_dma_rx = dma_claim_unused_channel(false);
+    s_dma_tx = dma_claim_unused_channel(false);
+    if (s_dma_rx < 0 || s_dma_tx < 0) {
+      if (s_dma_rx >= 0)
+        dma_channel_unclaim(s_dma_rx);
+      if (s_dma_tx >= 0)
+        dma_channel_unclaim(s_dma_tx);
+      s_dma_rx = s_dma_tx = -1;
+      printf("[SD] No free DMA channels, using CPU transfers\n");
+    }
+  }
+  return s_dma_rx >= 0;
+}
+
+/* Start a len-byte DMA exchange: rx NULL discards MISO, tx NULL sends 0xFF. */
+static void spi_dma_start(uint8_t *rx, const uint8_t *tx, size_t len) {
+  spi_hw_t *hw = spi_get_hw(SD_SPI_PORT);
+
+  dma_channel_config c = dma_channel_get_default_config(s_dma_rx);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_dreq(&c, spi_get_dreq(SD_SPI_PORT, false));
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, rx != NULL);
+  dma_channel_configure(s_dma_rx, &c, rx ? rx : &s_dma_sink, &hw->dr, len,
+                        false);
+
+  c = dma_channel_get_default_config(s_dma_tx);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_dreq(&c, spi_get_dreq(SD_SPI_PORT, true));
+  channel_config_set_read_increment(&c, tx != NULL);
+  channel_config_set_write_increment(&c, false);
+  dma_channel_configure(s_dma_tx, &c, &hw->dr, tx ? tx : &s_dma_ones, len,
+                        false);
+
+  dma_start_channel_mask((1u << s_dma_rx) | (1u << s_dma_tx));
+}
+
+/* The RX channel finishes last: every byte has been clocked both ways. */
+static void spi_dma_wait(void) {
+  dma_channel_wait_for_finish_blocking(s_dma_rx);
+}
+
+/* Block payloads: DMA when available, else the blocking SDK calls. */
+static void sd_recv_data(uint8_t *buf, size_t len) {
+  if (sd_dma_ready()) {
+    spi_dma_start(buf, NULL, len);
+    spi_dma_wait();
+  } else {
+    spi_recv_buf(buf, len);
+  }
+}
+
+static void sd_send_data(const uint8_t *buf, size_t len) {
+  if (sd_dma_ready()) {
+    spi_dma_start(NULL, buf, len);
+    spi_dma_wait();
+  } else {
+    spi_send_buf(buf, len);
+  }
+}
+
+/* CRC16-CCITT (XMODEM) as used for SD data blocks, a nibble at a time. */
+static uint16_t sd_crc16(const uint8_t *p, size_t n) {
+  static const uint16_t tbl[16] = {
+      0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+      0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+  uint16_t crc = 0;
+  while (n--) {
+    crc = (uint16_t)((crc << 4) ^ tbl[(crc >> 12) ^ (*p >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ tbl[(crc >> 12) ^ (*p++ & 0x0F)]);
+  }
+  return crc;
+}
+
+/* Clock in the CRC after a block; false if checking and it doesn't match. */
+static bool sd_recv_crc(const uint8_t *block) {
+  uint16_t crc = (uint16_t)(spi_byte(0xFF) << 8);
+  crc |= spi_byte(0xFF);
+  return !s_check_crc || crc == sd_crc16(block, 512);
+}
+
 /* Wait until MISO = 0xFF (card not busy). Returns false on timeout. */
 static bool sd_wait_ready(uint32_t timeout_ms) {
   absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
@@ -253,7 +379,14 @@ static bool sd_init_card(void) {
 DSTATUS disk_initialize(BYTE pdrv) {
   if (pdrv != 0)
     return STA_NOINIT;
+  /* Re-init abandons any async read: the card is reset under it */
+  if (s_async.active && !s_async.waiting_token)
+    spi_dma_wait();
+  s_async.active = false;
+  s_async.failed = true;
   s_dstatus = sd_init_card() ? 0 : STA_NOINIT;
+  /* A remount may find a different card: nothing cached still applies */
+  sd_cache_invalidate();
   /* Reset optimization state on init */
   s_use_optimized_read = true;
   s_optimized_fail_count = 0;
@@ -297,15 +430,16 @@ static bool sd_read_multi_optimized(BYTE *buff, uint32_t addr, UINT count) {
    * by the actual data blocks in subsequent transfers. */
   UINT blocks_remaining = count;
   while (blocks_remaining > 0) {
-    /* Read one block (512 bytes) */
-    spi_recv_buf(buff, 512);
+    /* Read one block (512 bytes) and its CRC */
+    sd_recv_data(buff, 512);
+    if (!sd_recv_crc(buff)) {
+      sd_send_cmd(12, 0); /* STOP_TRANSMISSION */
+      spi_byte(0xFF);
+      return false;
+    }
     buff += 512;
     blocks_remaining--;
     
-    /* Discard CRC (2 bytes) */
-    spi_byte(0xFF);
-    spi_byte(0xFF);
-    
     /* If there are more blocks, the next 0xFE token should already be 
      * on the bus from the card. Read and verify it. */
     if (blocks_remaining > 0) {
@@ -349,9 +483,12 @@ static bool sd_read_multi_fallback(BYTE *buff, uint32_t addr, UINT count) {
       return false;
     }
 
-    spi_recv_buf(buff, 512);
-    spi_byte(0xFF); /* CRC high */
-    spi_byte(0xFF); /* CRC low  */
+    sd_recv_data(buff, 512);
+    if (!sd_recv_crc(buff)) {
+      sd_send_cmd(12, 0);
+      spi_byte(0xFF);
+      return false;
+    }
     buff += 512;
   }
 
@@ -363,12 +500,25 @@ static bool sd_read_multi_fallback(BYTE *buff, uint32_t addr, UINT count) {
   return true;
 }
 
+/* Any other card access first lets an async read run to completion. */
+static void sd_async_drain(void) {
+  while (s_async.active)
+    disk_read_poll();
+}
+
 DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
   if (pdrv != 0 || (s_dstatus & STA_NOINIT))
     return RES_NOTRDY;
+  return sd_cache_read(buff, sector, count);
+}
+
+/* Card read behind the cache */
+DRESULT sd_read_blocks(BYTE *buff, LBA_t sector, UINT count) {
+  sd_async_drain();
 
   /* Check if optimized reads are enabled via config */
   bool optimized_enabled = sd_optimized_read_enabled();
+  s_check_crc = sd_read_crc_enabled();
 
   /* SDSC uses byte address; SDHC uses block address */
   uint32_t addr = s_is_sdhc ? (uint32_t)sector : (uint32_t)sector * 512;
@@ -392,9 +542,11 @@ DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
       return RES_ERROR;
     }
 
-    spi_recv_buf(buff, 512);
-    spi_byte(0xFF); /* CRC high */
-    spi_byte(0xFF); /* CRC low  */
+    sd_recv_data(buff, 512);
+    if (!sd_recv_crc(buff)) {
+      sd_cs_high();
+      return RES_ERROR;
+    }
   } else {
     /* Multi-block read with optimized path and fallback */
     bool success = false;
@@ -444,6 +596,107 @@ DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
   return RES_OK;
 }
 
+/* ─── Asynchronous multi-block read ─────────────────────────────────────────
+ * CMD18 as above, but each block's payload is left running on DMA and the
+ * state machine only moves on when disk_read_poll() is called.
+ */
+
+static int sd_async_fail(void) {
+  sd_send_cmd(12, 0);
+  spi_byte(0xFF);
+  sd_cs_high();
+  spi_byte(0xFF);
+  s_async.active = false;
+  s_async.failed = true;
+  return -1;
+}
+
+DRESULT disk_read_start(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+  if (pdrv != 0 || (s_dstatus & STA_NOINIT))
+    return RES_NOTRDY;
+  sd_async_drain();
+  s_async.failed = false;
+  /* The DMA bypasses the cache: commit what it holds for these sectors */
+  if (sd_cache_flush_range(sector, count) != RES_OK)
+    return RES_ERROR;
+
+  /* No DMA: read it now, and the first poll reports it done */
+  if (!sd_dma_ready() || count == 0) {
+    DRESULT res = count ? disk_read(pdrv, buff, sector, count) : RES_OK;
+    s_async.failed = res != RES_OK;
+    return res;
+  }
+
+  s_check_crc = sd_read_crc_enabled();
+  uint32_t addr = s_is_sdhc ? (uint32_t)sector : (uint32_t)sector * 512;
+  sd_cs_low();
+  if (sd_send_cmd(18, addr) != 0x00) {
+    sd_cs_high();
+    return RES_ERROR;
+  }
+  s_async.buf = buff;
+  s_async.left = count;
+  s_async.waiting_token = true;
+  s_async.deadline = make_timeout_time_ms(SD_CMD_TIMEOUT_MS);
+  s_async.active = true;
+  disk_read_poll(); /* the first token is usually there already */
+  return RES_OK;
+}
+
+int disk_read_poll(void) {
+  if (!s_async.active)
+    return s_async.failed ? -1 : 1;
+
+  for (;;) {
+    if (s_async.waiting_token) {
+      uint8_t tok = spi_byte(0xFF);
+      if (tok == 0xFF)
+        return time_reached(s_async.deadline) ? sd_async_fail() : 0;
+      if (tok != SD_TOKEN_DATA_START)
+        return sd_async_fail();
+      s_async.waiting_token = false;
+      spi_dma_start(s_async.buf, NULL, 512);
+      return 0;
+    }
+
+    if (dma_channel_is_busy(s_dma_rx))
+      return 0;
+
+    /* A block has landed */
+    if (!sd_recv_crc(s_async.buf))
+      return sd_async_fail();
+    s_async.buf += 512;
+    if (--s_async.left == 0)
+      break;
+    s_async.waiting_token = true;
+    s_async.deadline = make_timeout_time_ms(SD_CMD_TIMEOUT_MS);
+  }
+
+  sd_send_cmd(12, 0);
+  spi_byte(0xFF); /* Discard stuff byte */
+  sd_wait_ready(SD_CMD_TIMEOUT_MS);
+  sd_cs_high();
+  spi_byte(0xFF);
+  s_async.active = false;
+  return 1;
+}
+
+void disk_read_cancel(void) {
+  if (!s_async.active)
+    return;
+  /* Let the block on DMA land (it is already in the caller's buffer),
+   * then stop the card sending the rest. */
+  if (!s_async.waiting_token) {
+    spi_dma_wait();
+    sd_recv_crc(s_async.buf);
+  }
+  sd_async_fail();
+}
+
+bool disk_read_busy(void) {
+  return s_async.active;
+}
+
 #if FF_FS_READONLY == 0
 
 DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
@@ -451,6 +704,12 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
     return RES_NOTRDY;
   if (s_dstatus & STA_PROTECT)
     return RES_WRPRT;
+  return sd_cache_write(buff, sector, count);
+}
+
+/* Card write behind the cache */
+DRESULT sd_write_blocks(const BYTE *buff, LBA_t sector, UINT count) {
+  sd_async_drain();
 
   uint32_t addr = s_is_sdhc ? (uint32_t)sector : (uint32_t)sector * 512;
 
@@ -465,7 +724,7 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
 
     spi_byte(0xFF);                /* One idle byte before token   */
     spi_byte(SD_TOKEN_DATA_START); /* Data start token             */
-    spi_send_buf(buff, 512);       /* 512 bytes of payload         */
+    sd_send_data(buff, 512);       /* 512 bytes of payload         */
     spi_byte(0xFF);                /* Dummy CRC (2 bytes)          */
     spi_byte(0xFF);
 
@@ -495,7 +754,7 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
     while (count--) {
       spi_byte(0xFF);                 /* Idle byte                */
       spi_byte(SD_TOKEN_MULTI_WRITE); /* Multi-block start token  */
-      spi_send_buf(buff, 512);
+      sd_send_data(buff, 512);
       spi_byte(0xFF); /* Dummy CRC               */
       spi_byte(0xFF);
 
@@ -532,9 +791,12 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
     return RES_PARERR;
   if (s_dstatus & STA_NOINIT)
     return RES_NOTRDY;
+  sd_async_drain();
 
   switch (cmd) {
   case CTRL_SYNC:
+    if (sd_cache_flush() != RES_OK)
+      return RES_ERROR;
     sd_cs_low();
     sd_wait_ready(500);
     sd_cs_high();
@@ -0,0 +1,34 @@
+/* diskio_spi.h — PicOS extensions to the FatFS SD card port
+ *
+ * Asynchronous multi-sector reads: CMD18 is issued at once and each block's
+ * payload streams in by DMA while the caller carries on, calling
+ * disk_read_poll() now and then to move the transfer along.
+ *
+ * One read at a time.  Every call here, and every disk_* call, must hold
+ * g_sdcard_mutex, but it need not be held in between: any other disk_*
+ * call first runs an outstanding read to completion, so another core that
+ * needs the card waits at most for the rest of the transfer.
+ */
+
+#ifndef DISKIO_SPI_H
+#define DISKIO_SPI_H
+
+#include <stdbool.h>
+
+#include "ff.h"
+#include "diskio.h"
+
+/* Start reading count sectors into buff.  RES_OK once under way (or, with
+ * no DMA channels free, already done). */
+DRESULT disk_read_start(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+
+/* Advance the read: 1 when every sector has landed, 0 while still in
+ * progress, -1 if it failed.  Each block has SD_CMD_TIMEOUT_MS to arrive. */
+int disk_read_poll(void);
+
+/* Stop the read after the block in flight; the next poll reports -1. */
+void disk_read_cancel(void);
+
+bool disk_read_busy(void);
+
+#endif /* DISKIO_SPI_H */
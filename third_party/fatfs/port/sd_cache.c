@@ -0,0 +1,294 @@
+/* sd_cache.c — write-back LRU sector cache between FatFS and the SD card
+ *
+ * Entries live in two LRU lists: one for sectors that passed through the
+ * FATFS window (FAT, directories, boot/FSInfo) and one for file data.  A
+ * victim comes from the data list while the metadata list is within its
+ * share (SDC_META_PCT of the cache), so a large file read cannot push the
+ * FAT out.  Lookups go through a hash of sector numbers.
+ */
+
+#include "sd_cache.h"
+
+#include <string.h>
+#include <stdio.h>
+
+#define SDC_SECTOR 512
+#define SDC_NONE 0xFFFF
+#define SDC_META_PCT 75 /* share of the entries metadata may hold */
+
+typedef struct {
+  LBA_t sector;
+  uint16_t prev, next; /* LRU list, towards LRU / MRU */
+  uint16_t hnext;      /* hash chain */
+  uint8_t list;        /* SDC_DATA or SDC_META, SDC_NONE_LIST when free */
+  uint8_t dirty;
+} sdc_entry_t;
+
+enum { SDC_DATA, SDC_META, SDC_NONE_LIST };
+
+typedef struct {
+  uint16_t mru, lru;
+  uint16_t count;
+} sdc_list_t;
+
+static sdc_entry_t *s_ent;
+static uint16_t *s_hash;
+static uint8_t *s_data;
+static uint16_t s_count;
+static uint16_t s_hash_mask;
+static uint16_t s_meta_max;
+static uint16_t s_free;   /* free entries, chained through next */
+static uint16_t s_dirty;  /* dirty entries */
+static sdc_list_t s_lists[2];
+static const BYTE *s_win;
+static bool s_on;
+static bool s_disabled;   /* sd_cache_enable(false) */
+
+static inline uint8_t *sdc_data(uint16_t e) {
+  return s_data + (uint32_t)e * SDC_SECTOR;
+}
+
+/* ─── Lists and hash ────────────────────────────────────────────────────────
+ */
+
+static void sdc_unlink(uint16_t e) {
+  sdc_entry_t *en = &s_ent[e];
+  sdc_list_t *l = &s_lists[en->list];
+  if (en->prev != SDC_NONE)
+    s_ent[en->prev].next = en->next;
+  else
+    l->lru = en->next;
+  if (en->next != SDC_NONE)
+    s_ent[en->next].prev = en->prev;
+  else
+    l->mru = en->prev;
+  l->count--;
+}
+
+static void sdc_push_mru(uint16_t e, uint8_t list) {
+  sdc_entry_t *en = &s_ent[e];
+  sdc_list_t *l = &s_lists[list];
+  en->list = list;
+  en->prev = l->mru;
+  en->next = SDC_NONE;
+  if (l->mru != SDC_NONE)
+    s_ent[l->mru].next = e;
+  else
+    l->lru = e;
+  l->mru = e;
+  l->count++;
+}
+
+/* Most recently used again; a data sector seen in the window turns meta. */
+static void sdc_touch(uint16_t e, bool meta) {
+  uint8_t list = (meta || s_ent[e].list == SDC_META) ? SDC_META : SDC_DATA;
+  if (s_lists[list].mru == e)
+    return;
+  sdc_unlink(e);
+  sdc_push_mru(e, list);
+}
+
+static uint16_t sdc_lookup(LBA_t sector) {
+  uint16_t e = s_hash[(uint32_t)sector & s_hash_mask];
+  while (e != SDC_NONE && s_ent[e].sector != sector)
+    e = s_ent[e].hnext;
+  return e;
+}
+
+static void sdc_hash_remove(uint16_t e) {
+  uint16_t *p = &s_hash[(uint32_t)s_ent[e].sector & s_hash_mask];
+  while (*p != e)
+    p = &s_ent[*p].hnext;
+  *p = s_ent[e].hnext;
+}
+
+static void sdc_release(uint16_t e) {
+  sdc_hash_remove(e);
+  sdc_unlink(e);
+  if (s_ent[e].dirty)
+    s_dirty--;
+  s_ent[e].dirty = 0;
+  s_ent[e].list = SDC_NONE_LIST;
+  s_ent[e].next = s_free;
+  s_free = e;
+}
+
+static DRESULT sdc_write_back(uint16_t e) {
+  if (!s_ent[e].dirty)
+    return RES_OK;
+  DRESULT res = sd_write_blocks(sdc_data(e), s_ent[e].sector, 1);
+  if (res == RES_OK) {
+    s_ent[e].dirty = 0;
+    s_dirty--;
+  }
+  return res;
+}
+
+/* A free entry for sector, evicting if need be; SDC_NONE if the victim
+ * could not be written back. */
+static uint16_t sdc_alloc(LBA_t sector, bool meta) {
+  if (s_free == SDC_NONE) {
+    sdc_list_t *data = &s_lists[SDC_DATA];
+    sdc_list_t *md = &s_lists[SDC_META];
+    uint16_t victim = (data->count && (md->count < s_meta_max || !meta))
+                          ? data->lru
+                          : (md->count ? md->lru : data->lru);
+    if (sdc_write_back(victim) != RES_OK)
+      return SDC_NONE;
+    sdc_release(victim);
+  }
+
+  uint16_t e = s_free;
+  s_free = s_ent[e].next;
+  s_ent[e].sector = sector;
+  s_ent[e].dirty = 0;
+  uint16_t *head = &s_hash[(uint32_t)sector & s_hash_mask];
+  s_ent[e].hnext = *head;
+  *head = e;
+  sdc_push_mru(e, meta ? SDC_META : SDC_DATA);
+  return e;
+}
+
+/* ─── Public interface ──────────────────────────────────────────────────────
+ */
+
+bool sd_cache_init(void *mem, uint32_t bytes, const BYTE *win) {
+  /* Layout: sector data (aligned), entries, hash heads */
+  uint32_t per = SDC_SECTOR + sizeof(sdc_entry_t) + 2 * sizeof(uint16_t);
+  uint32_t n = bytes / per;
+  if (n > SDC_NONE - 1)
+    n = SDC_NONE - 1;
+  if (!mem || n < 8)
+    return false;
+  uint32_t buckets = 1;
+  while (buckets < n)
+    buckets <<= 1;
+
+  s_on = false;
+  s_data = (uint8_t *)mem;
+  s_ent = (sdc_entry_t *)(s_data + n * SDC_SECTOR);
+  s_hash = (uint16_t *)(s_ent + n);
+  s_count = (uint16_t)n;
+  s_hash_mask = (uint16_t)(buckets - 1);
+  s_meta_max = (uint16_t)(n * SDC_META_PCT / 100);
+  s_win = win;
+  sd_cache_invalidate();
+  s_on = !s_disabled;
+  printf("[SD] Sector cache: %u sectors (%lu KB)\n", (unsigned)n,
+         (unsigned long)(n * SDC_SECTOR / 1024));
+  return true;
+}
+
+void sd_cache_invalidate(void) {
+  if (!s_ent)
+    return;
+  memset(s_hash, 0xFF, (s_hash_mask + 1u) * sizeof(uint16_t));
+  for (uint16_t i = 0; i < s_count; i++) {
+    s_ent[i].list = SDC_NONE_LIST;
+    s_ent[i].dirty = 0;
+    s_ent[i].next = i + 1 < s_count ? i + 1 : SDC_NONE;
+  }
+  s_free = 0;
+  s_dirty = 0;
+  for (int l = 0; l < 2; l++) {
+    s_lists[l].mru = s_lists[l].lru = SDC_NONE;
+    s_lists[l].count = 0;
+  }
+}
+
+void sd_cache_enable(bool on) {
+  s_disabled = !on;
+  if (!on && s_on) {
+    sd_cache_flush();
+    sd_cache_invalidate();
+  }
+  s_on = on && s_ent;
+}
+
+DRESULT sd_cache_read(BYTE *buff, LBA_t sector, UINT count) {
+  if (!s_on)
+    return sd_read_blocks(buff, sector, count);
+
+  if (count == 1) {
+    bool meta = buff == s_win;
+    uint16_t e = sdc_lookup(sector);
+    if (e != SDC_NONE) {
+      memcpy(buff, sdc_data(e), SDC_SECTOR);
+      sdc_touch(e, meta);
+      return RES_OK;
+    }
+    DRESULT res = sd_read_blocks(buff, sector, 1);
+    if (res == RES_OK && (e = sdc_alloc(sector, meta)) != SDC_NONE)
+      memcpy(sdc_data(e), buff, SDC_SECTOR);
+    return res;
+  }
+
+  /* Streaming: one transfer from the card, then any sectors that are newer
+   * in the cache on top.  Not cached, so it can't evict the FAT. */
+  DRESULT res = sd_read_blocks(buff, sector, count);
+  if (res != RES_OK || s_dirty == 0)
+    return res;
+  for (UINT i = 0; i < count; i++) {
+    uint16_t e = sdc_lookup(sector + i);
+    if (e != SDC_NONE && s_ent[e].dirty)
+      memcpy(buff + i * SDC_SECTOR, sdc_data(e), SDC_SECTOR);
+  }
+  return RES_OK;
+}
+
+DRESULT sd_cache_write(const BYTE *buff, LBA_t sector, UINT count) {
+  if (!s_on)
+    return sd_write_blocks(buff, sector, count);
+
+  if (count == 1) {
+    uint16_t e = sdc_lookup(sector);
+    bool meta = buff == s_win;
+    if (e == SDC_NONE)
+      e = sdc_alloc(sector, meta);
+    else
+      sdc_touch(e, meta);
+    if (e == SDC_NONE)
+      return sd_write_blocks(buff, sector, 1);
+    memcpy(sdc_data(e), buff, SDC_SECTOR);
+    if (!s_ent[e].dirty) {
+      s_ent[e].dirty = 1;
+      s_dirty++;
+    }
+    return RES_OK;
+  }
+
+  /* Bulk writes go straight to the card; cached copies take the new data. */
+  DRESULT res = sd_write_blocks(buff, sector, count);
+  if (res != RES_OK)
+    return res;
+  for (UINT i = 0; i < count; i++) {
+    uint16_t e = sdc_lookup(sector + i);
+    if (e == SDC_NONE)
+      continue;
+    memcpy(sdc_data(e), buff + i * SDC_SECTOR, SDC_SECTOR);
+    if (s_ent[e].dirty) {
+      s_ent[e].dirty = 0;
+      s_dirty--;
+    }
+  }
+  return RES_OK;
+}
+
+DRESULT sd_cache_flush(void) {
+  DRESULT res = RES_OK;
+  for (uint16_t e = 0; e < s_count && s_dirty; e++) {
+    if (s_ent[e].list != SDC_NONE_LIST && sdc_write_back(e) != RES_OK)
+      res = RES_ERROR;
+  }
+  return res;
+}
+
+DRESULT sd_cache_flush_range(LBA_t sector, UINT count) {
+  DRESULT res = RES_OK;
+  for (UINT i = 0; i < count && s_dirty; i++) {
+    uint16_t e = sdc_lookup(sector + i);
+    if (e != SDC_NONE && sdc_write_back(e) != RES_OK)
+      res = RES_ERROR;
+  }
+  return res;
+}
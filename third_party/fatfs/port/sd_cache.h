@@ -0,0 +1,47 @@
+/* sd_cache.h — write-back sector cache between FatFS and the SD card
+ *
+ * Single-sector reads and writes (FatFS's window: FAT and directory
+ * sectors; each FIL's sector buffer: small file I/O) are kept in an LRU
+ * cache in PSRAM.  Sectors read into the FATFS window are retained in
+ * preference to file data, so directory walks stop refetching the same FAT
+ * and directory sectors.  Multi-sector transfers (streaming) go straight to
+ * the card and leave the cache alone, apart from keeping it coherent.
+ *
+ * Dirty sectors are written back on eviction and by sd_cache_flush(), which
+ * disk_ioctl(CTRL_SYNC) calls, so every f_sync/f_close commits them.
+ *
+ * Like the rest of the port, callers hold g_sdcard_mutex.
+ */
+
+#ifndef SD_CACHE_H
+#define SD_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ff.h"
+#include "diskio.h"
+
+/* Hand the cache its memory (sectors plus bookkeeping) and the FATFS
+ * window, whose reads are the FAT/directory ones.  Off until called. */
+bool sd_cache_init(void *mem, uint32_t bytes, const BYTE *win);
+
+/* Off: writes back, empties the cache and passes all I/O straight through
+ * (USB mass storage, where the host does its own caching). */
+void sd_cache_enable(bool on);
+
+DRESULT sd_cache_read(BYTE *buff, LBA_t sector, UINT count);
+DRESULT sd_cache_write(const BYTE *buff, LBA_t sector, UINT count);
+
+/* Write back every dirty sector, or those in [sector, sector + count). */
+DRESULT sd_cache_flush(void);
+DRESULT sd_cache_flush_range(LBA_t sector, UINT count);
+
+/* Drop everything, dirty sectors included (new card). */
+void sd_cache_invalidate(void);
+
+/* Card access, provided by diskio_spi.c */
+DRESULT sd_read_blocks(BYTE *buff, LBA_t sector, UINT count);
+DRESULT sd_write_blocks(const BYTE *buff, LBA_t sector, UINT count);
+
+#endif /* SD_CACHE_H */
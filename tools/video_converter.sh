@@ -78,12 +78,15 @@ echo "Converting $FILE to AVI format for PicOS video player..."
 
 
 
+# Slice threading makes the MJPEG encoder emit restart markers, which let the
+# player decode the bottom half of each frame on the second core.
 if [ "$CROP_VIDEO" = true ]; then
     ffmpeg -i "$FILE" \
         -vf "fps=25,scale=320:320:force_original_aspect_ratio=increase,crop=320:320" \
         -vcodec mjpeg \
         -q:v $VIDEO_QUALITY \
         -huffman optimal \
+        -threads 4 \
         $AUDIO_OPTS \
         "$OUTPUT_DIR/${BASENAME}.avi"
 else
@@ -92,6 +95,7 @@ else
         -vcodec mjpeg \
         -q:v $VIDEO_QUALITY \
         -huffman optimal \
+        -threads 4 \
         $AUDIO_OPTS \
         "$OUTPUT_DIR/${BASENAME}.avi"
 fi